@@ -7,6 +7,7 @@
 #ifndef PACKAGER_PUBLIC_AD_CUE_GENERATOR_PARAMS_H_
 #define PACKAGER_PUBLIC_AD_CUE_GENERATOR_PARAMS_H_
 
+#include <cstdint>
 #include <vector>
 
 namespace shaka {
@@ -21,8 +22,30 @@ struct Cuepoint {
 
 /// Cuepoint generator related parameters.
 struct AdCueGeneratorParams {
+  /// What to do when a stream buffers more than allowed while waiting for the
+  /// other streams to reach a cue.
+  enum class BufferOverflowPolicy {
+    /// Block the input until the cue is promoted by the other streams.
+    kBlock,
+    /// Promote the cue without waiting for the other streams, which may then
+    /// not be aligned on it.
+    kPromoteCue,
+    /// Drop the oldest buffered samples, with a warning.
+    kDrop,
+  };
+
   /// List of cuepoints.
   std::vector<Cuepoint> cue_points;
+  /// Maximum payload bytes buffered per stream while aligning the cues. 0
+  /// means no limit.
+  uint64_t max_buffered_bytes = 0;
+  /// Maximum time span buffered per stream while aligning the cues. 0 means
+  /// no limit.
+  double max_buffered_duration_in_seconds = 0;
+  /// Applied when either limit above is exceeded. Streams aligned in the same
+  /// demuxer as a video stream wait for that video stream, so blocking or
+  /// promoting cannot help them; they always drop.
+  BufferOverflowPolicy buffer_overflow_policy = BufferOverflowPolicy::kBlock;
 };
 
 }  // namespace shaka
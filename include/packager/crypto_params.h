@@ -179,10 +179,18 @@ struct EncryptionParams {
   /// enabled, the key provider must support key rotation in this case.
   static constexpr double kNoKeyRotation = 0;
   double crypto_period_duration_in_seconds = kNoKeyRotation;
+  /// Number of crypto periods to fetch the keys of ahead, in the background,
+  /// with key rotation. If 0, the keys are fetched when a crypto period
+  /// starts.
+  int32_t crypto_period_prefetch_count = 0;
   /// Enable/disable subsample encryption for VP9.
   bool vp9_subsample_encryption = true;
   /// If true, uses CENC v1 (2012) spec for encryption instead of v3 (2016+).
   bool cencv1 = false;
+  /// If true, the samples of each segment, or chunk in low latency mode, are
+  /// encrypted in parallel on the CPU threads, and dispatched when the segment
+  /// ends. Otherwise each sample is encrypted as it arrives.
+  bool parallel_sample_encryption = false;
 
   /// Encrypted stream information that is used to determine stream label.
   struct EncryptedStreamAttributes {
@@ -8,6 +8,7 @@
 #define PACKAGER_PUBLIC_FILE_H_
 
 #include <cstdint>
+#include <memory>
 #include <string>
 
 #include <packager/buffer_callback_params.h>
@@ -24,6 +25,8 @@ extern const char* kUdpFilePrefix;
 extern const char* kHttpFilePrefix;
 const int64_t kWholeFile = -1;
 
+class FileMapping;
+
 /// Define an abstract file interface.
 class SHAKA_EXPORT File {
  public:
@@ -69,6 +72,26 @@ class SHAKA_EXPORT File {
   /// @return Number of bytes written, or a value < 0 on error.
   virtual int64_t Write(const void* buffer, uint64_t length) = 0;
 
+  /// A block of data for WriteV().
+  struct IoVec {
+    const void* data;
+    uint64_t length;
+  };
+
+  /// Write a sequence of blocks of data, in order. The default implementation
+  /// calls Write() for each block; implementations which can write all the
+  /// blocks at once without copying them, e.g. with writev, override it.
+  /// @param iov points to @a iov_count blocks of data.
+  /// @return Number of bytes written, or a value < 0 on error.
+  virtual int64_t WriteV(const IoVec* iov, size_t iov_count);
+
+  /// Map the whole file into memory for reading, so that it can be accessed
+  /// without copying it. The mapping stays valid after the file is closed,
+  /// for as long as it is referenced. It is not supported by default.
+  /// @return The mapping on success, or nullptr if the file cannot be mapped,
+  ///         in which case Read() should be used.
+  virtual std::shared_ptr<FileMapping> MapForReading();
+
   /// Close the file for writing.  This signals that no more data will be
   /// written.  Future writes are invalid and their behavior is undefined!
   /// Data may still be read from the file after calling this method.
@@ -154,6 +177,12 @@ class SHAKA_EXPORT File {
   /// @return true if `file_name` is a local and regular file.
   static bool IsLocalRegularFile(const char* file_name);
 
+  /// @param file_name is the name of the file to be checked.
+  /// @return true if `file_name` names a local file which is a regular file,
+  ///         or which does not exist yet, i.e. a local output which would be
+  ///         created as a regular file. Nothing is opened or created.
+  static bool IsLocalRegularFileName(const char* file_name);
+
   /// Generate callback file name.
   /// NOTE: THE GENERATED NAME IS ONLY VAID WHILE @a callback_params IS VALID.
   /// @param callback_params references BufferCallbackParams, which will be
@@ -26,6 +26,14 @@ struct Mp4OutputParams {
   /// and mdat atom. Each chunk is uploaded immediately upon creation,
   /// decoupling latency from segment duration.
   bool low_latency_dash_mode = false;
+  /// Write single-segment (on-demand) output in one pass. Space for the ftyp,
+  /// moov and sidx boxes is reserved at the start of the output file, media is
+  /// written directly after it, and the boxes are patched in place when
+  /// packaging completes, with a 'free' box covering the unused space. If the
+  /// reservation turns out too small, the media is moved with a kernel-side
+  /// copy instead. Only applies to local output files; the temp file in
+  /// temp_dir is used otherwise.
+  bool single_pass_on_demand = false;
 };
 
 }  // namespace shaka
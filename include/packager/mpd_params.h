@@ -32,6 +32,11 @@ struct MpdParams {
   /// Set MPD@minimumUpdatePeriod attribute, which indicates to the player how
   /// often to refresh the MPD in seconds. For dynamic MPD only.
   double minimum_update_period = 0;
+  /// Minimum interval, in seconds, between two writes of a dynamic MPD. The
+  /// updates within the interval are written out together. If the value is 0,
+  /// the MPD is written as soon as the previous write completes. For dynamic
+  /// MPD only.
+  double mpd_publish_interval = 0;
   /// Set MPD@suggestedPresentationDelay attribute. For 'dynamic' media
   /// presentations, it specifies a delay, in seconds, to be added to the media
   /// presentation time. The attribute is not set if the value is 0; the client
@@ -24,6 +24,7 @@
 #include <packager/mp4_output_params.h>
 #include <packager/mpd_params.h>
 #include <packager/status.h>
+#include <packager/telemetry_params.h>
 
 namespace shaka {
 
@@ -45,6 +46,12 @@ struct PackagingParams {
   std::string temp_dir;
   /// MP4 (ISO-BMFF) output related parameters.
   Mp4OutputParams mp4_output_params;
+  /// Write single-segment (on-demand) WebM output in one pass. Space for the
+  /// Cues is reserved after the segment header, clusters are written directly
+  /// to the output file, and the header and Cues are patched in place when
+  /// packaging completes. Only applies to local output files; the temp file
+  /// in temp_dir is used otherwise.
+  bool webm_single_pass_on_demand = false;
   /// The offset to be applied to transport stream (e.g. MPEG2-TS, HLS packed
   /// audio) timestamps to compensate for possible negative timestamps in the
   /// input.
@@ -62,9 +69,42 @@ struct PackagingParams {
   /// Create a human readable format of MediaInfo. The output file name will be
   /// the name specified by output flag, suffixed with `.media_info`.
   bool output_media_info = false;
+  /// Write the MediaInfo files in the protobuf binary (wire) format instead of
+  /// the text format. They are much faster to parse for outputs with many
+  /// subsegments; mpd_generator detects the format of its inputs. Only
+  /// applies if output_media_info is set.
+  bool output_media_info_binary = false;
   /// Only use a single thread to generate output.  This is useful in tests to
   /// avoid non-deterministic outputs.
   bool single_threaded = false;
+  /// Run each output stream (trick play, text conversion and muxing) on its
+  /// own thread, fed through a bounded queue. This speeds up inputs with many
+  /// outputs, at the cost of one thread per output. Those threads count
+  /// towards num_cpu_threads, and the outputs left without one run on the
+  /// thread of their input. Ignored if single_threaded is set.
+  bool parallel_outputs = false;
+  /// Number of worker threads for short CPU-bound and I/O tasks. 0 means one
+  /// per hardware thread. These only take effect before the first packaging
+  /// job of the process. Long-running tasks, such as jobs and UDP receivers,
+  /// get a thread of their own. Those threads are not limited by default, but
+  /// a number set here also limits them: num_cpu_threads limits the number of
+  /// jobs running at the same time, the others waiting for a free thread,
+  /// except for jobs aligned on cues which must all run at once and get a
+  /// thread each even if there are more of them. The I/O of local
+  /// files always runs on the I/O workers.
+  int num_cpu_threads = 0;
+  int num_io_threads = 0;
+  /// Map the local input files into memory instead of reading them, so that
+  /// the demuxers reference the input instead of copying it. The input files
+  /// must not be modified while they are packaged. Ignored on Windows.
+  bool mmap_inputs = false;
+  /// Split each VOD input into up to this many partitions on segment
+  /// boundaries, and package the partitions in parallel, each with a pipeline
+  /// of its own. 0 means one partition per CPU worker thread. Only applies to
+  /// MP4 inputs with a sample table, packaged into segmented MP4 outputs with
+  /// static manifests, and without trick play, ad cues or key rotation. The
+  /// other inputs are packaged as a whole. Ignored if single_threaded is set.
+  int vod_partitions = 1;
 
   /// DASH MPD related parameters.
   MpdParams mpd_params;
@@ -81,6 +121,9 @@ struct PackagingParams {
   /// CEA-608 / CEA-708 captions.
   std::vector<CeaCaption> closed_captions;
 
+  /// Pipeline telemetry parameters.
+  TelemetryParams telemetry_params;
+
   // Parameters for testing. Do not use in production.
   TestParams test_params;
 };
@@ -188,6 +231,13 @@ class SHAKA_EXPORT Packager {
   /// Cancel packaging. Note that it has to be called from another thread.
   void Cancel();
 
+  /// Can be called from another thread while packaging.
+  /// @return A snapshot of the pipeline statistics, if telemetry is enabled.
+  ///         The statistics are collected per process, so they include every
+  ///         live packager of the process. The handlers of a packager are
+  ///         dropped from the statistics when it is destroyed.
+  PipelineStats GetPipelineStats() const;
+
   /// @return The version of the library.
   static std::string GetLibraryVersion();
 
@@ -0,0 +1,76 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_PUBLIC_TELEMETRY_PARAMS_H_
+#define PACKAGER_PUBLIC_TELEMETRY_PARAMS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shaka {
+
+/// Pipeline telemetry related parameters.
+struct TelemetryParams {
+  enum class Format {
+    kJson,
+    /// Prometheus text exposition format.
+    kPrometheus,
+  };
+
+  /// Collect per handler, file and manifest statistics. Collection costs a
+  /// couple of clock reads per sample when enabled, and a single branch
+  /// otherwise.
+  bool enabled = false;
+  /// If not empty, the statistics are written to this file at the end of
+  /// packaging, and every @a snapshot_interval_seconds while packaging.
+  std::string output;
+  /// Format of @a output.
+  Format format = Format::kJson;
+  /// Interval between snapshots written to @a output. 0 means that only the
+  /// final statistics are written.
+  double snapshot_interval_seconds = 0;
+};
+
+/// Statistics collected by the pipeline telemetry.
+struct PipelineStats {
+  /// Statistics of a single handler input stream, file type or manifest
+  /// writer.
+  struct Entry {
+    /// "handler", "file" or "manifest".
+    std::string category;
+    /// The handler type followed by an instance number, e.g. "Muxer#2", the
+    /// file type, followed by the file name for UDP inputs, or the manifest
+    /// operation.
+    std::string name;
+    /// The input stream index of handlers, -1 otherwise.
+    int32_t stream_index = -1;
+    /// Samples processed by handlers, or operations for files and manifests.
+    uint64_t count = 0;
+    /// Payload bytes processed, read or written.
+    uint64_t bytes = 0;
+    /// Time spent processing, excluding the time spent in the downstream
+    /// handlers and in the other instrumented operations called meanwhile.
+    uint64_t time_us = 0;
+    /// Flush requests and the time spent handling them.
+    uint64_t flushes = 0;
+    uint64_t flush_time_us = 0;
+    /// Largest queue depth observed, for queues feeding the entry. Counted in
+    /// stream data for handlers and in bytes for files.
+    uint64_t max_queue_depth = 0;
+    /// Items lost before reaching the entry, e.g. UDP datagrams dropped by
+    /// the kernel.
+    uint64_t dropped = 0;
+  };
+
+  /// Time since the telemetry was enabled.
+  double elapsed_seconds = 0;
+  std::vector<Entry> entries;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_PUBLIC_TELEMETRY_PARAMS_H_
@@ -18,3 +18,21 @@ ABSL_FLAG(std::string,
           "{start_time}[,{duration}][;{start_time}[,{duration}]]..."
           "The start_time represents the start of the cue marker in "
           "seconds relative to the start of the program.");
+ABSL_FLAG(uint64_t,
+          ad_cue_max_buffered_bytes,
+          0,
+          "Maximum payload bytes buffered per stream while waiting for the "
+          "other streams to reach a cue. 0 means no limit.");
+ABSL_FLAG(double,
+          ad_cue_max_buffered_duration,
+          0,
+          "Maximum duration in seconds buffered per stream while waiting for "
+          "the other streams to reach a cue. 0 means no limit.");
+ABSL_FLAG(std::string,
+          ad_cue_buffer_overflow_policy,
+          "block",
+          "What to do when a stream exceeds --ad_cue_max_buffered_bytes or "
+          "--ad_cue_max_buffered_duration: 'block' waits for the other "
+          "streams, 'promote' places the cue without waiting for them, and "
+          "'drop' drops the oldest buffered samples. Streams demuxed with a "
+          "video stream always drop.");
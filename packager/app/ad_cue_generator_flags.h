@@ -11,5 +11,8 @@
 #include <absl/flags/flag.h>
 
 ABSL_DECLARE_FLAG(std::string, ad_cues);
+ABSL_DECLARE_FLAG(uint64_t, ad_cue_max_buffered_bytes);
+ABSL_DECLARE_FLAG(double, ad_cue_max_buffered_duration);
+ABSL_DECLARE_FLAG(std::string, ad_cue_buffer_overflow_policy);
 
 #endif  // PACKAGER_APP_AD_CUE_GENERATOR_FLAGS_H_
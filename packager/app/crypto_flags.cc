@@ -39,6 +39,19 @@ ABSL_FLAG(bool,
           cencv1,
           false,
           "Use CENC v1 (2012) instead of v3 (2016+) for encryption.");
+ABSL_FLAG(bool,
+          parallel_sample_encryption,
+          false,
+          "Encrypt the samples of each segment in parallel, on the CPU threads "
+          "set by --num_cpu_threads, instead of one at a time as they arrive. "
+          "Increases memory usage by up to a segment per stream.");
+ABSL_FLAG(int32_t,
+          crypto_period_prefetch_count,
+          0,
+          "Number of crypto periods to fetch the keys of ahead, in the "
+          "background, with key rotation. The keys are shared by the streams "
+          "with the same label. If 0, the keys are fetched when a crypto "
+          "period starts, which may stall packaging on the key server.");
 ABSL_FLAG(std::string,
           playready_extra_header_data,
           "",
@@ -88,6 +101,13 @@ bool ValidateCryptoFlags() {
     success = false;
   }
 
+  auto crypto_period_prefetch_count =
+      absl::GetFlag(FLAGS_crypto_period_prefetch_count);
+  if (!ValueNotGreaterThanTen("crypto_period_prefetch_count",
+                              crypto_period_prefetch_count)) {
+    success = false;
+  }
+
   auto playready_extra_header_data =
       absl::GetFlag(FLAGS_playready_extra_header_data);
   if (!ValueIsXml("playready_extra_header_data", playready_extra_header_data)) {
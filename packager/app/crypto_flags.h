@@ -18,6 +18,8 @@ ABSL_DECLARE_FLAG(int32_t, crypt_byte_block);
 ABSL_DECLARE_FLAG(int32_t, skip_byte_block);
 ABSL_DECLARE_FLAG(bool, vp9_subsample_encryption);
 ABSL_DECLARE_FLAG(bool, cencv1);
+ABSL_DECLARE_FLAG(bool, parallel_sample_encryption);
+ABSL_DECLARE_FLAG(int32_t, crypto_period_prefetch_count);
 ABSL_DECLARE_FLAG(std::string, playready_extra_header_data);
 
 namespace shaka {
@@ -9,12 +9,37 @@
 #include <set>
 
 #include <absl/log/check.h>
+#include <absl/log/log.h>
 
+#include <packager/file/work_stealing_executor.h>
+#include <packager/media/base/sample_pool.h>
 #include <packager/media/chunking/sync_point_queue.h>
 #include <packager/media/origin/origin_handler.h>
+#include <packager/utils/telemetry.h>
 
 namespace shaka {
 namespace media {
+namespace {
+
+void LogExecutorStats(const char* name, const WorkStealingExecutor& executor) {
+  const WorkStealingExecutor::Stats stats = executor.GetStats();
+  LOG(INFO) << name << " executor: " << stats.num_workers << " workers, "
+            << stats.tasks_run << " tasks run, " << stats.tasks_stolen
+            << " stolen, " << stats.queue_depth << " queued, "
+            << stats.blocking_tasks_run << " blocking tasks run on up to "
+            << stats.max_blocking_threads << " threads.";
+}
+
+void LogSamplePoolStats(const std::string& name, const SamplePool& pool) {
+  const SamplePool::Stats stats = pool.GetStats();
+  LOG(INFO) << "Job " << name << " sample pool: " << stats.allocations
+            << " allocations, " << stats.heap_allocations << " from the heap, "
+            << stats.oversized_allocations << " oversized, "
+            << stats.cached_bytes << " bytes cached.";
+}
+
+}  // namespace
+
 
 Job::Job(const std::string& name,
          std::shared_ptr<OriginHandler> work,
@@ -22,39 +47,48 @@ Job::Job(const std::string& name,
     : name_(name),
       work_(std::move(work)),
       on_complete_(on_complete),
-      status_(error::Code::UNKNOWN, "Job uninitialized") {
+      sample_pool_(SamplePool::Create()),
+      status_(error::Code::UNKNOWN, "Job uninitialized"),
+      telemetry_id_(Telemetry::kInvalidId) {
   DCHECK(work_);
 }
 
+Job::~Job() {
+  Telemetry::Release(telemetry_id_);
+  if (!telemetry_name_.empty())
+    Telemetry::ReleaseUniqueName(telemetry_name_);
+}
+
 const Status& Job::Initialize() {
   status_ = work_->Initialize();
   return status_;
 }
 
-void Job::Start() {
-  thread_.reset(new std::thread(&Job::Run, this));
-}
-
 void Job::Cancel() {
   work_->Cancel();
 }
 
 const Status& Job::Run() {
-  if (status_.ok())  // initialized correctly
+  if (status_.ok()) {  // initialized correctly
+    ScopedSamplePool scoped_sample_pool(sample_pool_);
+    // Accounts for the origin handler, as the time spent in the downstream
+    // handlers is recorded separately.
+    if (Telemetry::enabled() && telemetry_id_ == Telemetry::kInvalidId) {
+      telemetry_name_ = Telemetry::UniqueName(name_);
+      telemetry_id_ = Telemetry::Register(Telemetry::Category::kHandler,
+                                          telemetry_name_);
+    }
+    ScopedTelemetry telemetry(telemetry_id_, 0, 0);
     status_ = work_->Run();
+  }
+  if (VLOG_IS_ON(1))
+    LogSamplePoolStats(name_, *sample_pool_);
 
   on_complete_(this);
 
   return status_;
 }
 
-void Job::Join() {
-  if (thread_) {
-    thread_->join();
-    thread_ = nullptr;
-  }
-}
-
 JobManager::JobManager(std::unique_ptr<SyncPointQueue> sync_points)
     : sync_points_(std::move(sync_points)) {}
 
@@ -74,34 +108,71 @@ Status JobManager::InitializeJobs() {
 
 Status JobManager::RunJobs() {
   std::set<Job*> active_jobs;
+  {
+    absl::MutexLock lock(&mutex_);
+    for (auto& job : jobs_) {
+      pending_jobs_.push_back(job.get());
+      active_jobs.insert(job.get());
+    }
+  }
 
-  // Start every job and add it to the active jobs list so that we can wait
-  // on each one.
-  for (auto& job : jobs_) {
-    job->Start();
-
-    active_jobs.insert(job.get());
+  // Start a runner per job, or as many as the CPU executor allows. Jobs
+  // synchronized through the sync points block on each other, so they must all
+  // run at once and threads are reserved for all of them; other jobs wait for
+  // a runner to be free, and at least one is reserved in case the output
+  // queues of the jobs took all the threads.
+  WorkStealingExecutor::Cpu()->ReserveBlockingThreads(
+      sync_points_ ? jobs_.size() : 1);
+  Status status;
+  size_t num_runners = 0;
+  while (num_runners < jobs_.size()) {
+    {
+      absl::MutexLock lock(&mutex_);
+      ++num_runners_;
+    }
+    if (!WorkStealingExecutor::Cpu()->PostBlockingTask(
+            [this]() { RunPendingJobs(); })) {
+      absl::MutexLock lock(&mutex_);
+      --num_runners_;
+      break;
+    }
+    ++num_runners;
+  }
+  if (num_runners == 0) {
+    status = Status(error::INVALID_ARGUMENT,
+                    "No thread is available to run the jobs. Increase "
+                    "--num_cpu_threads.");
+  } else if (num_runners < jobs_.size() && sync_points_) {
+    status = Status(error::INVALID_ARGUMENT,
+                    "The jobs are aligned on cues, so they must all run at "
+                    "the same time, but the CPU threads are busy with other "
+                    "tasks. Increase --num_cpu_threads.");
+  }
+  if (num_runners < jobs_.size()) {
+    VLOG(1) << "Running " << jobs_.size() << " jobs on " << num_runners
+            << " threads.";
   }
 
   // Wait for all jobs to complete or any job to error.
-  Status status;
   {
     absl::MutexLock lock(&mutex_);
     while (status.ok() && active_jobs.size()) {
-      // any_job_complete_ is protected by mutex_.
-      any_job_complete_.Wait(&mutex_);
-
-      // complete_ is protected by mutex_.
+      // complete_ is protected by mutex_. It is checked before waiting as jobs
+      // may complete before this thread gets here.
       for (const auto& entry : complete_) {
         Job* job = entry.first;
         bool complete = entry.second;
-        if (complete) {
-          job->Join();
+        if (complete && active_jobs.erase(job) > 0)
           status.Update(job->status());
-          active_jobs.erase(job);
-        }
       }
+      if (!status.ok() || active_jobs.empty())
+        break;
+
+      // any_job_complete_ is protected by mutex_.
+      any_job_complete_.Wait(&mutex_);
     }
+    // The jobs which have not started yet are not run.
+    pending_jobs_.clear();
   }
 
   // If the main loop has exited and there are still jobs running,
@@ -112,8 +183,16 @@ Status JobManager::RunJobs() {
   for (auto& job : active_jobs)
     job->Cancel();
 
-  for (auto& job : active_jobs)
-    job->Join();
+  {
+    absl::MutexLock lock(&mutex_);
+    while (num_runners_ > 0)
+      runner_exited_.Wait(&mutex_);
+  }
+
+  if (VLOG_IS_ON(1)) {
+    LogExecutorStats("CPU", *WorkStealingExecutor::Cpu());
+    LogExecutorStats("I/O", *WorkStealingExecutor::Io());
+  }
 
   return status;
 }
@@ -125,6 +204,23 @@ void JobManager::OnJobComplete(Job* job) {
   any_job_complete_.Signal();
 }
 
+void JobManager::RunPendingJobs() {
+  while (true) {
+    Job* job = nullptr;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (pending_jobs_.empty()) {
+        --num_runners_;
+        runner_exited_.Signal();
+        return;
+      }
+      job = pending_jobs_.front();
+      pending_jobs_.pop_front();
+    }
+    job->Run();
+  }
+}
+
 void JobManager::CancelJobs() {
   if (sync_points_)
     sync_points_->Cancel();
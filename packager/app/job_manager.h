@@ -7,10 +7,10 @@
 #ifndef PACKAGER_APP_JOB_MANAGER_H_
 #define PACKAGER_APP_JOB_MANAGER_H_
 
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
-#include <thread>
 #include <vector>
 
 #include <absl/synchronization/mutex.h>
@@ -21,6 +21,7 @@ namespace shaka {
 namespace media {
 
 class OriginHandler;
+class SamplePool;
 class SyncPointQueue;
 
 // A job is a single line of work that is expected to run in parallel with
@@ -32,30 +33,20 @@ class Job {
   Job(const std::string& name,
       std::shared_ptr<OriginHandler> work,
       OnCompleteFunction on_complete);
+  ~Job();
 
   // Initialize the work object. Call before Start() or Run(). Updates status()
   // and returns it for convenience.
   const Status& Initialize();
 
-  // Begin the job in a new thread. This is only a request and will not block.
-  // If you want to wait for the job to complete, use |complete|.
-  // Use either Start() for threaded operation or Run() for non-threaded
-  // operation.  DO NOT USE BOTH!
-  void Start();
-
   // Run the job's work synchronously, blocking until complete. Updates status()
   // and returns it for convenience.
-  // Use either Start() for threaded operation or Run() for non-threaded
-  // operation.  DO NOT USE BOTH!
   const Status& Run();
 
   // Request that the job stops executing. This is only a request and will not
-  // block. If you want to wait for the job to complete, use |complete|.
+  // block.
   void Cancel();
 
-  // Join the thread, if any was started. Blocks until the thread has stopped.
-  void Join();
-
   // Get the current status of the job. If the job failed to initialize or
   // encountered an error during execution this will return the error.
   const Status& status() const { return status_; }
@@ -70,8 +61,13 @@ class Job {
   std::string name_;
   std::shared_ptr<OriginHandler> work_;
   OnCompleteFunction on_complete_;
-  std::unique_ptr<std::thread> thread_;
+  // Recycles the samples of this job. Each job has its own so that they do not
+  // contend with each other.
+  std::shared_ptr<SamplePool> sample_pool_;
   Status status_;
+  // Telemetry entry of the origin handler, released on destruction.
+  std::string telemetry_name_;
+  uint32_t telemetry_id_;
 };
 
 // Similar to a thread pool, JobManager manages multiple jobs that are expected
@@ -99,6 +95,10 @@ class JobManager {
   // Run all registered jobs. Before calling this make sure that
   // |InitializedJobs| returned |Status::OK|. This call is blocking and will
   // block until all jobs exit.
+  // The jobs run on the blocking threads of the CPU executor, which are only
+  // limited if PackagingParams::num_cpu_threads is set. Jobs then wait for a
+  // free thread, unless they are synchronized by |sync_points|, in which case
+  // they must all run at the same time and the limit is raised to cover them.
   virtual Status RunJobs();
 
   // Ask all jobs to stop running. This call is non-blocking and can be used to
@@ -112,6 +112,8 @@ class JobManager {
   JobManager& operator=(const JobManager&) = delete;
 
   void OnJobComplete(Job* job);
+  // Run the pending jobs one after the other until there are none left.
+  void RunPendingJobs();
 
   // Stored in JobManager so JobManager can cancel |sync_points| when any job
   // fails or is cancelled.
@@ -122,6 +124,10 @@ class JobManager {
   absl::Mutex mutex_;
   std::map<Job*, bool> complete_ ABSL_GUARDED_BY(mutex_);
   absl::CondVar any_job_complete_ ABSL_GUARDED_BY(mutex_);
+  // Jobs waiting for a thread, and the number of threads running jobs.
+  std::deque<Job*> pending_jobs_ ABSL_GUARDED_BY(mutex_);
+  size_t num_runners_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::CondVar runner_exited_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace media
@@ -23,6 +23,13 @@ ABSL_FLAG(bool,
           "Create a human readable format of MediaInfo. The output file name "
           "will be the name specified by output flag, suffixed with "
           "'.media_info'.");
+ABSL_FLAG(bool,
+          output_media_info_binary,
+          false,
+          "Write the MediaInfo files of --output_media_info in the protobuf "
+          "binary format instead of the human readable format. They are much "
+          "faster to parse for outputs with many subsegments. mpd_generator "
+          "accepts both formats.");
 ABSL_FLAG(std::string, mpd_output, "", "MPD output file name.");
 ABSL_FLAG(std::string,
           base_urls,
@@ -40,6 +47,13 @@ ABSL_FLAG(double,
           "Indicates to the player how often to refresh the media "
           "presentation description in seconds. This value is used for "
           "dynamic MPD only.");
+ABSL_FLAG(double,
+          mpd_publish_interval,
+          0.0,
+          "Minimum interval, in seconds, between two writes of a dynamic "
+          "MPD. The segments completed within the interval are published "
+          "together. If 0, the MPD is written as soon as the previous write "
+          "completes.");
 ABSL_FLAG(double,
           suggested_presentation_delay,
           0.0,
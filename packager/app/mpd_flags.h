@@ -14,9 +14,11 @@
 
 ABSL_DECLARE_FLAG(bool, generate_static_live_mpd);
 ABSL_DECLARE_FLAG(bool, output_media_info);
+ABSL_DECLARE_FLAG(bool, output_media_info_binary);
 ABSL_DECLARE_FLAG(std::string, mpd_output);
 ABSL_DECLARE_FLAG(std::string, base_urls);
 ABSL_DECLARE_FLAG(double, minimum_update_period);
+ABSL_DECLARE_FLAG(double, mpd_publish_interval);
 ABSL_DECLARE_FLAG(double, min_buffer_time);
 ABSL_DECLARE_FLAG(double, suggested_presentation_delay);
 ABSL_DECLARE_FLAG(std::string, utc_timings);
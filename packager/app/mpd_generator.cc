@@ -39,7 +39,7 @@ namespace {
 const char kUsage[] =
     "MPD generation driver program.\n"
     "This program accepts MediaInfo files in human readable text "
-    "format and outputs an MPD.\n"
+    "or protobuf binary format and outputs an MPD.\n"
     "The main use case for this is to output MPD for VOD.\n"
     "Limitations:\n"
     " Each MediaInfo can only have one of VideoInfo, AudioInfo, or TextInfo.\n"
@@ -87,11 +87,10 @@ ExitStatus RunMpdGenerator() {
   for (Iterator it = base_urls.begin(); it != base_urls.end(); ++it)
     mpd_writer.AddBaseUrl(*it);
 
-  for (const std::string& file : input_files) {
-    if (!mpd_writer.AddFile(file)) {
-      LOG(WARNING) << "MpdWriter failed to read " << file << ", skipping.";
-    }
-  }
+  std::vector<std::string> failed_files;
+  mpd_writer.AddFiles(input_files, &failed_files);
+  for (const std::string& file : failed_files)
+    LOG(WARNING) << "MpdWriter failed to read " << file << ", skipping.";
 
   if (!mpd_writer.WriteMpdToFile(absl::GetFlag(FLAGS_output).c_str())) {
     LOG(ERROR) << "Failed to write MPD to " << absl::GetFlag(FLAGS_output);
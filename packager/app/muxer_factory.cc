@@ -21,20 +21,24 @@ namespace media {
 MuxerFactory::MuxerFactory(const PackagingParams& packaging_params)
     : mp4_params_(packaging_params.mp4_output_params),
       temp_dir_(packaging_params.temp_dir),
+      webm_single_pass_on_demand_(packaging_params.webm_single_pass_on_demand),
       transport_stream_timestamp_offset_ms_(
           packaging_params.transport_stream_timestamp_offset_ms) {}
 
 std::shared_ptr<Muxer> MuxerFactory::CreateMuxer(
     MediaContainerName output_format,
-    const StreamDescriptor& stream) {
+    const StreamDescriptor& stream,
+    const std::optional<MuxerOptions::Partition>& partition) {
   MuxerOptions options;
   options.mp4_params = mp4_params_;
   options.transport_stream_timestamp_offset_ms =
       transport_stream_timestamp_offset_ms_;
   options.temp_dir = temp_dir_;
+  options.webm_single_pass_on_demand = webm_single_pass_on_demand_;
   options.output_file_name = stream.output;
   options.segment_template = stream.segment_template;
   options.bandwidth = stream.bandwidth;
+  options.partition = partition;
 
   std::shared_ptr<Muxer> muxer;
 
@@ -8,9 +8,11 @@
 #define PACKAGER_APP_MUXER_FACTORY_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 
 #include <packager/media/base/container_names.h>
+#include <packager/media/base/muxer_options.h>
 #include <packager/mp4_output_params.h>
 #include <packager/mpd/base/mpd_builder.h>
 
@@ -32,8 +34,12 @@ class MuxerFactory {
 
   /// Create a new muxer using the factory's settings for the given
   /// stream.
-  std::shared_ptr<Muxer> CreateMuxer(MediaContainerName output_format,
-                                     const StreamDescriptor& stream);
+  /// @param partition is set if the muxer only writes a partition of the
+  ///        output.
+  std::shared_ptr<Muxer> CreateMuxer(
+      MediaContainerName output_format,
+      const StreamDescriptor& stream,
+      const std::optional<MuxerOptions::Partition>& partition = std::nullopt);
 
   /// For testing, if you need to replace the clock that muxers work with
   /// this will replace the clock for all muxers created after this call.
@@ -49,6 +55,7 @@ class MuxerFactory {
 
   const Mp4OutputParams mp4_params_;
   const std::string temp_dir_;
+  const bool webm_single_pass_on_demand_;
   int32_t transport_stream_timestamp_offset_ms_ = 0;
   std::shared_ptr<Clock> clock_ = nullptr;
 };
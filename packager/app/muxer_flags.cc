@@ -47,6 +47,20 @@ ABSL_FLAG(bool,
           "Indicates whether to generate 'sidx' box in media segments. Note "
           "that it is required for DASH on-demand profile (not using segment "
           "template).");
+ABSL_FLAG(bool,
+          mp4_single_pass_on_demand,
+          false,
+          "MP4 only: write single-segment output directly into the output "
+          "file, reserving space for the header boxes, instead of writing "
+          "the media to a temporary file and copying it afterwards. Only "
+          "applies to local output files.");
+ABSL_FLAG(bool,
+          webm_single_pass_on_demand,
+          false,
+          "WebM only: write single-segment output directly into the output "
+          "file, reserving space for the Cues, instead of writing the "
+          "clusters to a temporary file and copying them afterwards. Only "
+          "applies to local output files.");
 ABSL_FLAG(std::string,
           temp_dir,
           "",
@@ -18,6 +18,8 @@ ABSL_DECLARE_FLAG(bool, segment_sap_aligned);
 ABSL_DECLARE_FLAG(double, fragment_duration);
 ABSL_DECLARE_FLAG(bool, fragment_sap_aligned);
 ABSL_DECLARE_FLAG(bool, generate_sidx_in_media_segments);
+ABSL_DECLARE_FLAG(bool, mp4_single_pass_on_demand);
+ABSL_DECLARE_FLAG(bool, webm_single_pass_on_demand);
 ABSL_DECLARE_FLAG(std::string, temp_dir);
 ABSL_DECLARE_FLAG(bool, mp4_include_pssh_in_stream);
 ABSL_DECLARE_FLAG(int32_t, transport_stream_timestamp_offset_ms);
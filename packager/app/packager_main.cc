@@ -58,6 +58,57 @@ ABSL_FLAG(bool,
           single_threaded,
           false,
           "If enabled, only use one thread when generating content.");
+ABSL_FLAG(bool,
+          parallel_outputs,
+          false,
+          "If enabled, each output stream is muxed on its own thread, which "
+          "speeds up inputs with many outputs. Ignored if --single_threaded "
+          "is set.");
+ABSL_FLAG(int32_t,
+          num_cpu_threads,
+          0,
+          "Number of worker threads for CPU-bound tasks. 0 means one per "
+          "hardware thread. If set, it also limits the number of jobs running "
+          "at the same time, which is not limited otherwise. Jobs aligned on "
+          "cues must all run at once, so they get a thread each even if there "
+          "are more of them.");
+ABSL_FLAG(int32_t,
+          num_io_threads,
+          0,
+          "Number of worker threads for I/O tasks. 0 means one per hardware "
+          "thread. If set, it also limits the number of threads for network "
+          "I/O which may block, such as UDP inputs.");
+ABSL_FLAG(bool,
+          mmap_inputs,
+          false,
+          "If enabled, local input files are mapped into memory instead of "
+          "being read, which avoids copying them. The input files must not "
+          "be modified while they are packaged.");
+ABSL_FLAG(int32_t,
+          vod_partitions,
+          1,
+          "Split each VOD input into up to this many partitions on segment "
+          "boundaries, packaged in parallel. 0 means one partition per CPU "
+          "worker thread. Only applies to MP4 inputs with a sample table, "
+          "packaged into segmented MP4 outputs with static manifests; other "
+          "inputs are packaged as a whole. Ignored if --single_threaded is "
+          "set.");
+ABSL_FLAG(std::string,
+          telemetry_output,
+          "",
+          "If set, per handler, file and manifest statistics are collected "
+          "and written to this file.");
+ABSL_FLAG(std::string,
+          telemetry_format,
+          "json",
+          "Format of --telemetry_output: 'json' or 'prometheus' (text "
+          "exposition format).");
+ABSL_FLAG(double,
+          telemetry_interval,
+          0,
+          "Interval in seconds between the statistics written to "
+          "--telemetry_output while packaging. 0 means that they are only "
+          "written at the end.");
 
 // From absl/log:
 ABSL_DECLARE_FLAG(int, stderrthreshold);
@@ -375,6 +426,26 @@ std::optional<PackagingParams> GetPackagingParams() {
 
   packaging_params.temp_dir = absl::GetFlag(FLAGS_temp_dir);
   packaging_params.single_threaded = absl::GetFlag(FLAGS_single_threaded);
+  packaging_params.parallel_outputs = absl::GetFlag(FLAGS_parallel_outputs);
+  packaging_params.num_cpu_threads = absl::GetFlag(FLAGS_num_cpu_threads);
+  packaging_params.num_io_threads = absl::GetFlag(FLAGS_num_io_threads);
+  packaging_params.mmap_inputs = absl::GetFlag(FLAGS_mmap_inputs);
+  packaging_params.vod_partitions = absl::GetFlag(FLAGS_vod_partitions);
+
+  TelemetryParams& telemetry_params = packaging_params.telemetry_params;
+  telemetry_params.output = absl::GetFlag(FLAGS_telemetry_output);
+  telemetry_params.enabled = !telemetry_params.output.empty();
+  telemetry_params.snapshot_interval_seconds =
+      absl::GetFlag(FLAGS_telemetry_interval);
+  const std::string telemetry_format = absl::GetFlag(FLAGS_telemetry_format);
+  if (telemetry_format == "json") {
+    telemetry_params.format = TelemetryParams::Format::kJson;
+  } else if (telemetry_format == "prometheus") {
+    telemetry_params.format = TelemetryParams::Format::kPrometheus;
+  } else {
+    LOG(ERROR) << "Unknown --telemetry_format " << telemetry_format;
+    return std::nullopt;
+  }
 
   AdCueGeneratorParams& ad_cue_generator_params =
       packaging_params.ad_cue_generator_params;
@@ -382,6 +453,26 @@ std::optional<PackagingParams> GetPackagingParams() {
                    &ad_cue_generator_params.cue_points)) {
     return std::nullopt;
   }
+  ad_cue_generator_params.max_buffered_bytes =
+      absl::GetFlag(FLAGS_ad_cue_max_buffered_bytes);
+  ad_cue_generator_params.max_buffered_duration_in_seconds =
+      absl::GetFlag(FLAGS_ad_cue_max_buffered_duration);
+  const std::string buffer_overflow_policy =
+      absl::GetFlag(FLAGS_ad_cue_buffer_overflow_policy);
+  if (buffer_overflow_policy == "block") {
+    ad_cue_generator_params.buffer_overflow_policy =
+        AdCueGeneratorParams::BufferOverflowPolicy::kBlock;
+  } else if (buffer_overflow_policy == "promote") {
+    ad_cue_generator_params.buffer_overflow_policy =
+        AdCueGeneratorParams::BufferOverflowPolicy::kPromoteCue;
+  } else if (buffer_overflow_policy == "drop") {
+    ad_cue_generator_params.buffer_overflow_policy =
+        AdCueGeneratorParams::BufferOverflowPolicy::kDrop;
+  } else {
+    LOG(ERROR) << "Unknown --ad_cue_buffer_overflow_policy "
+               << buffer_overflow_policy;
+    return std::nullopt;
+  }
 
   ChunkingParams& chunking_params = packaging_params.chunking_params;
   chunking_params.segment_duration_in_seconds =
@@ -434,9 +525,13 @@ std::optional<PackagingParams> GetPackagingParams() {
 
     encryption_params.crypto_period_duration_in_seconds =
         absl::GetFlag(FLAGS_crypto_period_duration);
+    encryption_params.crypto_period_prefetch_count =
+        absl::GetFlag(FLAGS_crypto_period_prefetch_count);
     encryption_params.vp9_subsample_encryption =
         absl::GetFlag(FLAGS_vp9_subsample_encryption);
     encryption_params.cencv1 = absl::GetFlag(FLAGS_cencv1);
+    encryption_params.parallel_sample_encryption =
+        absl::GetFlag(FLAGS_parallel_sample_encryption);
     encryption_params.stream_label_func = std::bind(
         &Packager::DefaultStreamLabelFunction,
         absl::GetFlag(FLAGS_max_sd_pixels), absl::GetFlag(FLAGS_max_hd_pixels),
@@ -512,12 +607,18 @@ std::optional<PackagingParams> GetPackagingParams() {
   mp4_params.include_pssh_in_stream =
       absl::GetFlag(FLAGS_mp4_include_pssh_in_stream);
   mp4_params.low_latency_dash_mode = absl::GetFlag(FLAGS_low_latency_dash_mode);
+  mp4_params.single_pass_on_demand =
+      absl::GetFlag(FLAGS_mp4_single_pass_on_demand);
+  packaging_params.webm_single_pass_on_demand =
+      absl::GetFlag(FLAGS_webm_single_pass_on_demand);
 
   packaging_params.transport_stream_timestamp_offset_ms =
       absl::GetFlag(FLAGS_transport_stream_timestamp_offset_ms);
   packaging_params.default_text_zero_bias_ms =
       absl::GetFlag(FLAGS_default_text_zero_bias_ms);
   packaging_params.output_media_info = absl::GetFlag(FLAGS_output_media_info);
+  packaging_params.output_media_info_binary =
+      absl::GetFlag(FLAGS_output_media_info_binary);
 
   MpdParams& mpd_params = packaging_params.mpd_params;
   mpd_params.mpd_output = absl::GetFlag(FLAGS_mpd_output);
@@ -530,6 +631,7 @@ std::optional<PackagingParams> GetPackagingParams() {
   mpd_params.base_urls = base_urls;
   mpd_params.min_buffer_time = absl::GetFlag(FLAGS_min_buffer_time);
   mpd_params.minimum_update_period = absl::GetFlag(FLAGS_minimum_update_period);
+  mpd_params.mpd_publish_interval = absl::GetFlag(FLAGS_mpd_publish_interval);
   mpd_params.suggested_presentation_delay =
       absl::GetFlag(FLAGS_suggested_presentation_delay);
   mpd_params.time_shift_buffer_depth =
@@ -0,0 +1,86 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <packager/file/io_cache.h>
+#include <packager/media/base/buffer_writer.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// Box writing is dominated by small big-endian integer appends.
+void BM_BufferWriterAppendInt(benchmark::State& state) {
+  const int kNumValues = 1024;
+  for (auto _ : state) {
+    BufferWriter writer;
+    for (int i = 0; i < kNumValues; ++i) {
+      writer.AppendInt(static_cast<uint8_t>(i));
+      writer.AppendInt(static_cast<uint16_t>(i));
+      writer.AppendInt(static_cast<uint32_t>(i));
+      writer.AppendInt(static_cast<uint64_t>(i));
+    }
+    benchmark::DoNotOptimize(writer.Buffer());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          kNumValues * 15);
+}
+BENCHMARK(BM_BufferWriterAppendInt);
+
+void BM_BufferWriterAppendArray(benchmark::State& state) {
+  const size_t kTotalSize = 1 << 20;
+  const size_t size = static_cast<size_t>(state.range(0));
+  const std::vector<uint8_t> data(size, 0x5a);
+  for (auto _ : state) {
+    BufferWriter writer;
+    for (size_t written = 0; written < kTotalSize; written += size)
+      writer.AppendArray(data.data(), data.size());
+    benchmark::DoNotOptimize(writer.Buffer());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(kTotalSize));
+}
+BENCHMARK(BM_BufferWriterAppendArray)->RangeMultiplier(16)->Range(16, 64 << 10);
+
+}  // namespace
+}  // namespace media
+
+namespace {
+
+// Moves 16MB through an IoCache from a writer thread to a reader thread, with
+// the block size used for each call given by the benchmark argument.
+void BM_IoCacheThroughput(benchmark::State& state) {
+  const uint64_t kCacheSize = 1 << 20;
+  const uint64_t kTotalSize = 16 << 20;
+  const size_t block_size = static_cast<size_t>(state.range(0));
+  std::vector<uint8_t> write_block(block_size, 0x5a);
+  std::vector<uint8_t> read_block(block_size);
+
+  for (auto _ : state) {
+    IoCache cache(kCacheSize);
+    std::thread writer([&cache, &write_block]() {
+      for (uint64_t written = 0; written < kTotalSize;)
+        written += cache.Write(write_block.data(), write_block.size());
+      cache.Close();
+    });
+    while (cache.Read(read_block.data(), read_block.size()) > 0) {
+    }
+    writer.join();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(kTotalSize));
+}
+BENCHMARK(BM_IoCacheThroughput)
+    ->RangeMultiplier(8)
+    ->Range(512, 256 << 10)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace shaka
@@ -0,0 +1,160 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <packager/media/base/buffer_writer.h>
+#include <packager/media/codecs/h264_parser.h>
+#include <packager/media/codecs/h265_parser.h>
+#include <packager/media/codecs/nal_unit_to_byte_stream_converter.h>
+#include <packager/media/codecs/nalu_reader.h>
+#include <packager/media/codecs/start_code_scanner.h>
+#include <packager/media/codecs/start_code_scanner_internal.h>
+#include <packager/media/test/test_data_util.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// From h265_parser_unittest.cc.
+const uint8_t kH265SpsData[] = {
+    0x42, 0x01, 0x01, 0x01, 0x60, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x3f, 0xa0, 0x05, 0x02, 0x01, 0x69, 0x65, 0x95, 0xe4, 0x93,
+    0x2b, 0xc0, 0x40, 0x40, 0x00, 0x00, 0xfa, 0x40, 0x00, 0x1d, 0x4c, 0x02};
+const uint8_t kH265PpsData[] = {0x44, 0x01, 0xc1, 0x73, 0xd1, 0x89};
+const uint8_t kH265SliceData[] = {
+    0x26, 0x01, 0xaf, 0x08, 0x4c, 0x2e, 0xa6, 0x56, 0xd9, 0xaf, 0x50, 0xeb,
+    0x94, 0x9a, 0xae, 0x89, 0x29, 0x0e, 0x42, 0x9f, 0xb9, 0x5e, 0x85, 0xd5};
+
+// Builds a synthetic Annex B stream of about 1MB, made of NAL units of
+// |nalu_size| bytes which contain no start code emulation.
+std::vector<uint8_t> MakeAnnexbStream(size_t nalu_size) {
+  const size_t kStreamSize = 1 << 20;
+  const uint8_t kStartCode[] = {0x00, 0x00, 0x00, 0x01};
+  std::vector<uint8_t> stream;
+  stream.reserve(kStreamSize + nalu_size + sizeof(kStartCode));
+  while (stream.size() < kStreamSize) {
+    stream.insert(stream.end(), std::begin(kStartCode), std::end(kStartCode));
+    // A non-IDR slice NAL unit header, then payload.
+    stream.push_back(0x41);
+    for (size_t i = 1; i < nalu_size; ++i)
+      stream.push_back(static_cast<uint8_t>(1 + i % 255));
+  }
+  return stream;
+}
+
+void BM_NaluReaderAnnexb(benchmark::State& state) {
+  const std::vector<uint8_t> stream =
+      MakeAnnexbStream(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    NaluReader reader(Nalu::kH264, kIsAnnexbByteStream, stream.data(),
+                      stream.size());
+    Nalu nalu;
+    int num_nalus = 0;
+    while (reader.Advance(&nalu) == NaluReader::kOk)
+      ++num_nalus;
+    benchmark::DoNotOptimize(num_nalus);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(stream.size()));
+}
+BENCHMARK(BM_NaluReaderAnnexb)->RangeMultiplier(8)->Range(64, 64 << 10);
+
+// Reads and parses every NAL unit of a real H.264 Annex B stream.
+void BM_H264ParserStream(benchmark::State& state) {
+  const std::vector<uint8_t> stream = ReadTestDataFile("test-25fps.h264");
+  if (stream.empty()) {
+    state.SkipWithError("Failed to read test-25fps.h264.");
+    return;
+  }
+  for (auto _ : state) {
+    H264Parser parser;
+    NaluReader reader(Nalu::kH264, kIsAnnexbByteStream, stream.data(),
+                      stream.size());
+    Nalu nalu;
+    while (reader.Advance(&nalu) == NaluReader::kOk) {
+      int id;
+      H264SliceHeader shdr;
+      switch (nalu.type()) {
+        case Nalu::H264_IDRSlice:
+        case Nalu::H264_NonIDRSlice:
+          parser.ParseSliceHeader(nalu, &shdr);
+          break;
+        case Nalu::H264_SPS:
+          parser.ParseSps(nalu, &id);
+          break;
+        case Nalu::H264_PPS:
+          parser.ParsePps(nalu, &id);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(stream.size()));
+}
+BENCHMARK(BM_H264ParserStream);
+
+void BM_H265ParserSliceHeader(benchmark::State& state) {
+  H265Parser parser;
+  Nalu nalu;
+  int id;
+  if (!nalu.Initialize(Nalu::kH265, kH265SpsData, sizeof(kH265SpsData)) ||
+      parser.ParseSps(nalu, &id) != H265Parser::kOk ||
+      !nalu.Initialize(Nalu::kH265, kH265PpsData, sizeof(kH265PpsData)) ||
+      parser.ParsePps(nalu, &id) != H265Parser::kOk ||
+      !nalu.Initialize(Nalu::kH265, kH265SliceData, sizeof(kH265SliceData))) {
+    state.SkipWithError("Failed to parse the parameter sets.");
+    return;
+  }
+  for (auto _ : state) {
+    H265SliceHeader header;
+    benchmark::DoNotOptimize(parser.ParseSliceHeader(nalu, &header));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_H265ParserSliceHeader);
+
+// Scans the payload of MakeAnnexbStream(), which has no start code, for start
+// codes, to measure the raw scan cost per byte. The argument selects the
+// backend: 0 for the portable one, 1 for the one chosen at runtime.
+void BM_FindStartCodePrefix(benchmark::State& state) {
+  const std::vector<uint8_t> stream = MakeAnnexbStream(16 << 20);
+  const uint8_t* payload = stream.data() + 4;
+  const size_t payload_size = stream.size() - 4;
+  for (auto _ : state) {
+    const size_t offset =
+        state.range(0) == 0
+            ? internal::ScanZeroZeroSequence(payload, payload_size, 1, 1)
+            : FindStartCodePrefix(payload, payload_size);
+    benchmark::DoNotOptimize(offset);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(payload_size));
+}
+BENCHMARK(BM_FindStartCodePrefix)->Arg(0)->Arg(1);
+
+// Escapes the payload of MakeAnnexbStream(), as done for every NAL unit when
+// converting to Annex B.
+void BM_EscapeNalByteSequence(benchmark::State& state) {
+  const std::vector<uint8_t> stream = MakeAnnexbStream(16 << 20);
+  BufferWriter output(stream.size());
+  for (auto _ : state) {
+    output.Clear();
+    EscapeNalByteSequence(stream.data() + 4, stream.size() - 4, &output);
+    benchmark::DoNotOptimize(output.Buffer());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(stream.size() - 4));
+}
+BENCHMARK(BM_EscapeNalByteSequence);
+
+}  // namespace
+}  // namespace media
+}  // namespace shaka
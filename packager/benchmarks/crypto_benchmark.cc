@@ -0,0 +1,76 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <packager/media/base/aes_encryptor.h>
+#include <packager/media/base/aes_pattern_cryptor.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const uint8_t kKey[] = {
+    0x6f, 0xc9, 0x6f, 0xe6, 0x28, 0xa2, 0x65, 0xb1,
+    0x3a, 0xed, 0xde, 0xc0, 0xbc, 0x42, 0x1f, 0x4d,
+};
+const uint8_t kIv[] = {
+    0x3c, 0x13, 0xb1, 0x9e, 0x01, 0x8f, 0xf4, 0x5d,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+void RunCryptor(benchmark::State& state, AesCryptor* cryptor) {
+  const std::vector<uint8_t> key(std::begin(kKey), std::end(kKey));
+  const std::vector<uint8_t> iv(std::begin(kIv), std::end(kIv));
+  if (!cryptor->InitializeWithIv(key, iv)) {
+    state.SkipWithError("Failed to initialize the cryptor.");
+    return;
+  }
+
+  const size_t size = static_cast<size_t>(state.range(0));
+  std::vector<uint8_t> plaintext(size, 0x5a);
+  std::vector<uint8_t> ciphertext(cryptor->RequiredOutputSize(size));
+  for (auto _ : state) {
+    size_t ciphertext_size = ciphertext.size();
+    if (!cryptor->Crypt(plaintext.data(), size, ciphertext.data(),
+                        &ciphertext_size)) {
+      state.SkipWithError("Crypt failed.");
+      return;
+    }
+    benchmark::DoNotOptimize(ciphertext.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(size));
+}
+
+void BM_AesCtrEncrypt(benchmark::State& state) {
+  AesCtrEncryptor cryptor;
+  RunCryptor(state, &cryptor);
+}
+BENCHMARK(BM_AesCtrEncrypt)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+void BM_AesCbcEncrypt(benchmark::State& state) {
+  AesCbcEncryptor cryptor(kNoPadding);
+  RunCryptor(state, &cryptor);
+}
+BENCHMARK(BM_AesCbcEncrypt)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+// 'cbcs' with the 1:9 pattern used for video.
+void BM_AesPatternEncrypt(benchmark::State& state) {
+  AesPatternCryptor cryptor(
+      1, 9, AesPatternCryptor::kEncryptIfCryptByteBlockRemaining,
+      AesCryptor::kUseConstantIv,
+      std::unique_ptr<AesCryptor>(new AesCbcEncryptor(kNoPadding)));
+  RunCryptor(state, &cryptor);
+}
+BENCHMARK(BM_AesPatternEncrypt)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+}  // namespace
+}  // namespace media
+}  // namespace shaka
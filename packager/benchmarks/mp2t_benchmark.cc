@@ -0,0 +1,203 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <packager/media/base/audio_stream_info.h>
+#include <packager/media/base/buffer_writer.h>
+#include <packager/media/base/media_sample.h>
+#include <packager/media/base/stream_info.h>
+#include <packager/media/base/text_sample.h>
+#include <packager/media/formats/mp2t/continuity_counter.h>
+#include <packager/media/formats/mp2t/mp2t_media_parser.h>
+#include <packager/media/formats/mp2t/pes_packet.h>
+#include <packager/media/formats/mp2t/pes_packet_generator.h>
+#include <packager/media/formats/mp2t/program_map_table_writer.h>
+#include <packager/media/formats/mp2t/ts_packet.h>
+#include <packager/media/formats/mp2t/ts_packet_writer_util.h>
+#include <packager/media/formats/mp2t/ts_writer.h>
+#include <packager/media/test/test_data_util.h>
+
+namespace shaka {
+namespace media {
+namespace mp2t {
+namespace {
+
+const int32_t kZeroTransportStreamTimestampOffset = 0;
+const int32_t kTimeScale = 90000;
+// AAC-LC, 44.1 kHz, stereo.
+const uint8_t kAudioSpecificConfig[] = {0x12, 0x10};
+// The duration of an AAC frame at 44.1 kHz, in 90 kHz ticks.
+const int64_t kFrameDuration = 1024 * 90000 / 44100;
+// One second of audio.
+const int kNumSamples = 44;
+const int kTsPacketSize = 188;
+const int kElementaryPid = 0x50;
+
+std::shared_ptr<AudioStreamInfo> CreateAacStreamInfo() {
+  return std::make_shared<AudioStreamInfo>(
+      0, kTimeScale, 0, kCodecAAC, "mp4a.40.2", kAudioSpecificConfig,
+      sizeof(kAudioSpecificConfig), 16, 2, 44100, 0, 0, 0, 0, "und", false);
+}
+
+std::vector<std::shared_ptr<MediaSample>> CreateSamples(size_t sample_size) {
+  const std::vector<uint8_t> data(sample_size, 0x5a);
+  std::vector<std::shared_ptr<MediaSample>> samples;
+  for (int i = 0; i < kNumSamples; ++i) {
+    auto sample = MediaSample::CopyFrom(data.data(), data.size(), true);
+    sample->set_pts(i * kFrameDuration);
+    sample->set_dts(i * kFrameDuration);
+    sample->set_duration(kFrameDuration);
+    samples.push_back(sample);
+  }
+  return samples;
+}
+
+// Converts samples to PES packets, then packetizes them into TS packets.
+void BM_PesToTsPackets(benchmark::State& state) {
+  const size_t sample_size = static_cast<size_t>(state.range(0));
+  const std::vector<std::shared_ptr<MediaSample>> samples =
+      CreateSamples(sample_size);
+  std::shared_ptr<AudioStreamInfo> stream_info = CreateAacStreamInfo();
+  const std::vector<uint8_t> audio_specific_config(
+      std::begin(kAudioSpecificConfig), std::end(kAudioSpecificConfig));
+
+  int64_t num_packets = 0;
+  for (auto _ : state) {
+    PesPacketGenerator generator(kZeroTransportStreamTimestampOffset);
+    TsWriter ts_writer(std::unique_ptr<ProgramMapTableWriter>(
+        new AudioProgramMapTableWriter(kCodecAAC, audio_specific_config)));
+    BufferWriter buffer;
+    if (!generator.Initialize(*stream_info) ||
+        !ts_writer.NewSegment(&buffer)) {
+      state.SkipWithError("Failed to initialize.");
+      return;
+    }
+    for (const auto& sample : samples) {
+      if (!generator.PushSample(*sample)) {
+        state.SkipWithError("Failed to push sample.");
+        return;
+      }
+      while (generator.NumberOfReadyPesPackets() > 0) {
+        if (!ts_writer.AddPesPacket(generator.GetNextPesPacket(), &buffer)) {
+          state.SkipWithError("Failed to add PES packet.");
+          return;
+        }
+      }
+    }
+    benchmark::DoNotOptimize(buffer.Buffer());
+    num_packets += buffer.Size() / kTsPacketSize;
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          kNumSamples * static_cast<int64_t>(sample_size));
+  state.counters["packets"] =
+      benchmark::Counter(static_cast<double>(num_packets),
+                         benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_PesToTsPackets)->RangeMultiplier(4)->Range(64, 4096);
+
+// Packetizes |state.range(0)| bytes PES payloads into a segment buffer, e.g. a
+// video frame of a high bitrate rendition, without the PES generation.
+void BM_WritePayloadToTsPackets(benchmark::State& state) {
+  const std::vector<uint8_t> payload(static_cast<size_t>(state.range(0)), 0x5a);
+  const int kPayloadsPerSegment = 64;
+  const uint64_t kPcrBase = 0x1ABCDEF01ULL;
+
+  int64_t num_packets = 0;
+  for (auto _ : state) {
+    ContinuityCounter continuity_counter;
+    BufferWriter segment_buffer;
+    for (int i = 0; i < kPayloadsPerSegment; ++i) {
+      WritePayloadToBufferWriter(payload.data(), payload.size(), true,
+                                 kElementaryPid, true, kPcrBase,
+                                 &continuity_counter, &segment_buffer);
+    }
+    benchmark::DoNotOptimize(segment_buffer.Buffer());
+    num_packets += segment_buffer.Size() / kTsPacketSize;
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          kPayloadsPerSegment *
+                          static_cast<int64_t>(payload.size()));
+  state.counters["packets"] =
+      benchmark::Counter(static_cast<double>(num_packets),
+                         benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_WritePayloadToTsPackets)
+    ->RangeMultiplier(8)
+    ->Range(1024, 256 << 10);
+
+// Synchronizes on and parses the headers of every TS packet of a real file,
+// which is the per packet work of the demuxer before the PES payloads are
+// handed to the elementary stream parsers.
+void BM_TsPacketHeaders(benchmark::State& state) {
+  const std::vector<uint8_t> data = ReadTestDataFile("bear-640x360.ts");
+  const int size = static_cast<int>(data.size());
+
+  for (auto _ : state) {
+    TsPacket ts_packet;
+    int offset = 0;
+    int num_packets = 0;
+    while (size - offset >= TsPacket::kPacketSize) {
+      const int num_synced_packets =
+          TsPacket::CountSyncedPackets(data.data() + offset, size - offset);
+      if (num_synced_packets == 0) {
+        offset += std::max(1, TsPacket::Sync(data.data() + offset,
+                                             size - offset));
+        continue;
+      }
+      for (int i = 0; i < num_synced_packets; ++i) {
+        if (TsPacket::Parse(data.data() + offset, size - offset, &ts_packet))
+          ++num_packets;
+        offset += TsPacket::kPacketSize;
+      }
+    }
+    benchmark::DoNotOptimize(num_packets);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * size);
+}
+BENCHMARK(BM_TsPacketHeaders);
+
+// Parses a real file end to end, appending it |state.range(0)| bytes at a time.
+void BM_Mp2tMediaParser(benchmark::State& state) {
+  const std::vector<uint8_t> data = ReadTestDataFile("bear-640x360.ts");
+  const size_t chunk_size = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    Mp2tMediaParser parser;
+    size_t num_samples = 0;
+    parser.Init(
+        [](const std::vector<std::shared_ptr<StreamInfo>>&) {},
+        [&num_samples](uint32_t, std::shared_ptr<MediaSample>) {
+          ++num_samples;
+          return true;
+        },
+        [](uint32_t, std::shared_ptr<TextSample>) { return true; }, nullptr);
+    for (size_t offset = 0; offset < data.size(); offset += chunk_size) {
+      const size_t size = std::min(chunk_size, data.size() - offset);
+      if (!parser.Parse(data.data() + offset, static_cast<int>(size))) {
+        state.SkipWithError("Failed to parse bear-640x360.ts.");
+        return;
+      }
+    }
+    if (!parser.Flush()) {
+      state.SkipWithError("Failed to flush.");
+      return;
+    }
+    benchmark::DoNotOptimize(num_samples);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data.size()));
+}
+BENCHMARK(BM_Mp2tMediaParser)->Arg(188)->Arg(64 * 1024);
+
+}  // namespace
+}  // namespace mp2t
+}  // namespace media
+}  // namespace shaka
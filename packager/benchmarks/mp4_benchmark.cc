@@ -0,0 +1,70 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <packager/media/formats/mp4/box_definitions.h>
+#include <packager/media/formats/mp4/box_reader.h>
+#include <packager/media/test/test_data_util.h>
+
+namespace shaka {
+namespace media {
+namespace mp4 {
+namespace {
+
+// Returns the offset of the top-level box of |box_type| in |data|, or
+// |data.size()| if there isn't one.
+size_t FindTopLevelBox(const std::vector<uint8_t>& data, FourCC box_type) {
+  size_t offset = 0;
+  while (offset < data.size()) {
+    FourCC type = FOURCC_NULL;
+    uint64_t box_size = 0;
+    bool err = false;
+    if (!BoxReader::StartBox(data.data() + offset, data.size() - offset, &type,
+                             &box_size, &err) ||
+        box_size == 0) {
+      break;
+    }
+    if (type == box_type)
+      return offset;
+    offset += box_size;
+  }
+  return data.size();
+}
+
+// Parses the full 'moov' box tree of a real file.
+void BM_BoxReaderParseMoov(benchmark::State& state) {
+  const std::vector<uint8_t> data = ReadTestDataFile("bear-640x360.mp4");
+  const size_t moov_offset = FindTopLevelBox(data, FOURCC_moov);
+  if (moov_offset == data.size()) {
+    state.SkipWithError("Failed to find 'moov' in bear-640x360.mp4.");
+    return;
+  }
+  const uint8_t* moov_data = data.data() + moov_offset;
+  const size_t moov_size = data.size() - moov_offset;
+
+  for (auto _ : state) {
+    bool err = false;
+    std::unique_ptr<BoxReader> reader(
+        BoxReader::ReadBox(moov_data, moov_size, &err));
+    Movie moov;
+    if (!reader || !moov.Parse(reader.get())) {
+      state.SkipWithError("Failed to parse 'moov'.");
+      return;
+    }
+    benchmark::DoNotOptimize(moov.tracks.size());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BoxReaderParseMoov);
+
+}  // namespace
+}  // namespace mp4
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,177 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// End-to-end benchmarks which run complete packaging jobs. Inputs and outputs
+// are memory:// files, so that the results reflect the packaging pipeline
+// rather than the disk.
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_format.h>
+#include <benchmark/benchmark.h>
+
+#include <packager/file.h>
+#include <packager/file/memory_file.h>
+#include <packager/media/test/test_data_util.h>
+#include <packager/packager.h>
+
+namespace shaka {
+namespace {
+
+const char kMp4Input[] = "memory://benchmark/input.mp4";
+const char kWebVttInput[] = "memory://benchmark/input.vtt";
+const char kOutputDir[] = "memory://benchmark/output/";
+const double kSegmentDurationInSeconds = 2.0;
+
+const uint8_t kKeyId[] = {
+    0xe5, 0x00, 0x7e, 0x6e, 0x9d, 0xcd, 0x5a, 0xc0,
+    0x95, 0x20, 0x2e, 0xd3, 0x75, 0x83, 0x82, 0xcd,
+};
+const uint8_t kKey[] = {
+    0x6f, 0xc9, 0x6f, 0xe6, 0x28, 0xa2, 0x65, 0xb1,
+    0x3a, 0xed, 0xde, 0xc0, 0xbc, 0x42, 0x1f, 0x4d,
+};
+
+// A synthetic WebVTT file of |num_cues| one second cues.
+std::string MakeWebVtt(int num_cues) {
+  std::string webvtt = "WEBVTT\n\n";
+  for (int i = 0; i < num_cues; ++i) {
+    absl::StrAppendFormat(
+        &webvtt, "%02d:%02d:%02d.000 --> %02d:%02d:%02d.500\nCue number %d\n\n",
+        i / 3600, i / 60 % 60, i % 60, i / 3600, i / 60 % 60, i % 60, i);
+  }
+  return webvtt;
+}
+
+// Replaces all the memory files with just the inputs.
+bool WriteInputs() {
+  MemoryFile::DeleteAll();
+  const std::vector<uint8_t> mp4 =
+      media::ReadTestDataFile("bear-640x360.mp4");
+  return !mp4.empty() &&
+         File::WriteStringToFile(kMp4Input,
+                                 std::string(mp4.begin(), mp4.end())) &&
+         File::WriteStringToFile(kWebVttInput, MakeWebVtt(3600));
+}
+
+std::string Output(const std::string& name) {
+  return kOutputDir + name;
+}
+
+PackagingParams MakePackagingParams() {
+  PackagingParams params;
+  params.temp_dir = kOutputDir;
+  params.chunking_params.segment_duration_in_seconds =
+      kSegmentDurationInSeconds;
+  return params;
+}
+
+void AddRawKey(PackagingParams* params, uint32_t protection_scheme) {
+  params->encryption_params.key_provider = KeyProvider::kRawKey;
+  params->encryption_params.protection_scheme = protection_scheme;
+  params->encryption_params.raw_key.key_map[""].key_id.assign(
+      std::begin(kKeyId), std::end(kKeyId));
+  params->encryption_params.raw_key.key_map[""].key.assign(std::begin(kKey),
+                                                          std::end(kKey));
+}
+
+std::vector<StreamDescriptor> MakeAudioVideoDescriptors(
+    const std::string& extension) {
+  std::vector<StreamDescriptor> descriptors(2);
+  descriptors[0].input = kMp4Input;
+  descriptors[0].stream_selector = "video";
+  descriptors[0].segment_template = Output("video_$Number$." + extension);
+  descriptors[1].input = kMp4Input;
+  descriptors[1].stream_selector = "audio";
+  descriptors[1].segment_template = Output("audio_$Number$." + extension);
+  if (extension == "m4s") {
+    descriptors[0].output = Output("video_init.mp4");
+    descriptors[1].output = Output("audio_init.mp4");
+  }
+  return descriptors;
+}
+
+// Runs the packaging job once per iteration. The memory files are reset
+// outside of the timed region.
+void RunPackager(benchmark::State& state,
+                 const PackagingParams& params,
+                 const std::vector<StreamDescriptor>& descriptors) {
+  if (!WriteInputs()) {
+    state.SkipWithError("Failed to write the inputs.");
+    return;
+  }
+  // Streams sharing an input are demuxed together.
+  std::set<std::string> inputs;
+  for (const StreamDescriptor& descriptor : descriptors)
+    inputs.insert(descriptor.input);
+  int64_t input_size = 0;
+  for (const std::string& input : inputs)
+    input_size += File::GetFileSize(input.c_str());
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    WriteInputs();
+    state.ResumeTiming();
+
+    Packager packager;
+    Status status = packager.Initialize(params, descriptors);
+    if (status.ok())
+      status = packager.Run();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          input_size);
+  MemoryFile::DeleteAll();
+}
+
+void BM_PackagerRemuxMp4ToDash(benchmark::State& state) {
+  PackagingParams params = MakePackagingParams();
+  params.mpd_params.mpd_output = Output("output.mpd");
+  RunPackager(state, params, MakeAudioVideoDescriptors("m4s"));
+}
+BENCHMARK(BM_PackagerRemuxMp4ToDash)->Unit(benchmark::kMillisecond);
+
+void BM_PackagerEncryptMp4ToDash(benchmark::State& state) {
+  PackagingParams params = MakePackagingParams();
+  params.mpd_params.mpd_output = Output("output.mpd");
+  AddRawKey(&params, EncryptionParams::kProtectionSchemeCenc);
+  RunPackager(state, params, MakeAudioVideoDescriptors("m4s"));
+}
+BENCHMARK(BM_PackagerEncryptMp4ToDash)->Unit(benchmark::kMillisecond);
+
+void BM_PackagerRemuxMp4ToHlsTs(benchmark::State& state) {
+  PackagingParams params = MakePackagingParams();
+  params.hls_params.master_playlist_output = Output("master.m3u8");
+  RunPackager(state, params, MakeAudioVideoDescriptors("ts"));
+}
+BENCHMARK(BM_PackagerRemuxMp4ToHlsTs)->Unit(benchmark::kMillisecond);
+
+void BM_PackagerEncryptMp4ToHlsTs(benchmark::State& state) {
+  PackagingParams params = MakePackagingParams();
+  params.hls_params.master_playlist_output = Output("master.m3u8");
+  AddRawKey(&params, EncryptionParams::kProtectionSchemeCbcs);
+  RunPackager(state, params, MakeAudioVideoDescriptors("ts"));
+}
+BENCHMARK(BM_PackagerEncryptMp4ToHlsTs)->Unit(benchmark::kMillisecond);
+
+void BM_PackagerWebVttToMp4(benchmark::State& state) {
+  PackagingParams params = MakePackagingParams();
+  std::vector<StreamDescriptor> descriptors(1);
+  descriptors[0].input = kWebVttInput;
+  descriptors[0].stream_selector = "text";
+  descriptors[0].output = Output("text_init.mp4");
+  descriptors[0].segment_template = Output("text_$Number$.m4s");
+  RunPackager(state, params, descriptors);
+}
+BENCHMARK(BM_PackagerWebVttToMp4)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace shaka
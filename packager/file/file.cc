@@ -18,8 +18,10 @@
 #include <absl/strings/str_format.h>
 
 #include <packager/file/callback_file.h>
+#include <packager/file/file_mapping.h>
 #include <packager/file/file_util.h>
 #include <packager/file/http_file.h>
+#include <packager/file/http_upload_queue.h>
 #include <packager/file/local_file.h>
 #include <packager/file/memory_file.h>
 #include <packager/file/threaded_io_file.h>
@@ -102,30 +104,60 @@ File* CreateUdpFile(const char* file_name, const char* mode) {
   return new UdpFile(file_name);
 }
 
-File* CreateHttpsFile(const char* file_name, const char* mode) {
+// Files written to HTTP servers are uploaded in the background if the upload
+// queue is enabled.
+bool IsQueuedUpload(const char* mode) {
+  return strcmp(mode, "w") == 0 && HttpUploadQueue::GetInstance();
+}
+
+File* CreateHttpOrHttpsFile(const std::string& url, const char* mode) {
+  if (IsQueuedUpload(mode))
+    return new QueuedUploadFile(url, HttpUploadQueue::GetInstance());
   HttpMethod method = HttpMethod::kGet;
   if (strcmp(mode, "r") != 0) {
     method = HttpMethod::kPut;
   }
-  return new HttpFile(method, std::string("https://") + file_name);
+  return new HttpFile(method, url);
+}
+
+// Manifests are uploaded after the segments queued before them.
+bool WriteHttpOrHttpsFileAtomically(const std::string& url,
+                                    const std::string& contents) {
+  HttpUploadQueue* queue = HttpUploadQueue::GetInstance();
+  if (!queue)
+    return File::WriteStringToFile(url.c_str(), contents);
+  queue->UploadManifest(url, contents);
+  return true;
+}
+
+File* CreateHttpsFile(const char* file_name, const char* mode) {
+  return CreateHttpOrHttpsFile(std::string("https://") + file_name, mode);
 }
 
 bool DeleteHttpsFile(const char* file_name) {
   return HttpFile::Delete(std::string("https://") + file_name);
 }
 
+bool WriteHttpsFileAtomically(const char* file_name,
+                              const std::string& contents) {
+  return WriteHttpOrHttpsFileAtomically(std::string("https://") + file_name,
+                                        contents);
+}
+
 File* CreateHttpFile(const char* file_name, const char* mode) {
-  HttpMethod method = HttpMethod::kGet;
-  if (strcmp(mode, "r") != 0) {
-    method = HttpMethod::kPut;
-  }
-  return new HttpFile(method, std::string("http://") + file_name);
+  return CreateHttpOrHttpsFile(std::string("http://") + file_name, mode);
 }
 
 bool DeleteHttpFile(const char* file_name) {
   return HttpFile::Delete(std::string("http://") + file_name);
 }
 
+bool WriteHttpFileAtomically(const char* file_name,
+                             const std::string& contents) {
+  return WriteHttpOrHttpsFileAtomically(std::string("http://") + file_name,
+                                        contents);
+}
+
 File* CreateMemoryFile(const char* file_name, const char* mode) {
   return new MemoryFile(file_name, mode);
 }
@@ -145,8 +177,10 @@ static const FileTypeInfo kFileTypeInfo[] = {
     {kUdpFilePrefix, &CreateUdpFile, nullptr, nullptr},
     {kMemoryFilePrefix, &CreateMemoryFile, &DeleteMemoryFile, nullptr},
     {kCallbackFilePrefix, &CreateCallbackFile, nullptr, nullptr},
-    {kHttpFilePrefix, &CreateHttpFile, &DeleteHttpFile, nullptr},
-    {kHttpsFilePrefix, &CreateHttpsFile, &DeleteHttpsFile, nullptr},
+    {kHttpFilePrefix, &CreateHttpFile, &DeleteHttpFile,
+     &WriteHttpFileAtomically},
+    {kHttpsFilePrefix, &CreateHttpsFile, &DeleteHttpsFile,
+     &WriteHttpsFileAtomically},
 };
 
 std::string_view GetFileTypePrefix(std::string_view file_name) {
@@ -180,19 +214,29 @@ File* File::Create(const char* file_name, const char* mode) {
     // Disable caching for memory and callback files.
     return internal_file.release();
   }
+  if ((file_type_prefix == kHttpFilePrefix ||
+       file_type_prefix == kHttpsFilePrefix) &&
+      IsQueuedUpload(mode)) {
+    // Queued uploads are written to memory.
+    return internal_file.release();
+  }
 
   if (absl::GetFlag(FLAGS_io_cache_size)) {
-    // Enable threaded I/O for "r", "w", and "a" modes only.
+    // Enable threaded I/O for "r", "w", and "a" modes only. Network files and
+    // inputs such as pipes may block indefinitely.
     if (!strcmp(mode, "r")) {
       return new ThreadedIoFile(std::move(internal_file),
                                 ThreadedIoFile::kInputMode,
                                 absl::GetFlag(FLAGS_io_cache_size),
-                                absl::GetFlag(FLAGS_io_block_size));
+                                absl::GetFlag(FLAGS_io_block_size),
+                                !IsLocalRegularFile(file_name));
     } else if (!strcmp(mode, "w") || !strcmp(mode, "a")) {
+      const bool is_local = file_type_prefix.empty() ||
+                            file_type_prefix == kLocalFilePrefix;
       return new ThreadedIoFile(std::move(internal_file),
                                 ThreadedIoFile::kOutputMode,
                                 absl::GetFlag(FLAGS_io_cache_size),
-                                absl::GetFlag(FLAGS_io_block_size));
+                                absl::GetFlag(FLAGS_io_block_size), !is_local);
     }
   }
 
@@ -318,10 +362,7 @@ bool File::WriteFileAtomically(const char* file_name,
 
   // Skip the warning message for memory files, which is meant for testing
   // anyway..
-  // Also check for http files, as they can't do atomic writes.
-  if (strncmp(file_name, kMemoryFilePrefix, strlen(kMemoryFilePrefix)) != 0 &&
-      strncmp(file_name, kHttpFilePrefix, strlen(kHttpFilePrefix)) != 0 &&
-      strncmp(file_name, kHttpsFilePrefix, strlen(kHttpsFilePrefix)) != 0) {
+  if (strncmp(file_name, kMemoryFilePrefix, strlen(kMemoryFilePrefix)) != 0) {
     LOG(WARNING) << "Writing to " << file_name
                  << " is not guaranteed to be atomic.";
   }
@@ -364,6 +405,27 @@ bool File::Copy(const char* from_file_name, const char* to_file_name) {
   return true;
 }
 
+int64_t File::WriteV(const IoVec* iov, size_t iov_count) {
+  int64_t total_written = 0;
+  for (size_t i = 0; i < iov_count; ++i) {
+    const uint8_t* data = static_cast<const uint8_t*>(iov[i].data);
+    uint64_t remaining = iov[i].length;
+    while (remaining > 0) {
+      const int64_t written = Write(data, remaining);
+      if (written <= 0)
+        return total_written > 0 ? total_written : written;
+      data += written;
+      remaining -= written;
+      total_written += written;
+    }
+  }
+  return total_written;
+}
+
+std::shared_ptr<FileMapping> File::MapForReading() {
+  return nullptr;
+}
+
 int64_t File::Copy(File* source, File* destination) {
   return Copy(source, destination, kWholeFile);
 }
@@ -418,6 +480,22 @@ bool File::IsLocalRegularFile(const char* file_name) {
   return std::filesystem::is_regular_file(real_file_path, ec);
 }
 
+bool File::IsLocalRegularFileName(const char* file_name) {
+  std::string_view real_file_name;
+  const FileTypeInfo* file_type = GetFileTypeInfo(file_name, &real_file_name);
+  DCHECK(file_type);
+
+  if (file_type->type != kLocalFilePrefix)
+    return false;
+
+  std::error_code ec;
+  auto real_file_path = std::filesystem::u8path(real_file_name);
+  const std::filesystem::file_type type =
+      std::filesystem::status(real_file_path, ec).type();
+  return type == std::filesystem::file_type::regular ||
+         type == std::filesystem::file_type::not_found;
+}
+
 std::string File::MakeCallbackFileName(
     const BufferCallbackParams& callback_params,
     const std::string& name) {
@@ -0,0 +1,82 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/file_mapping.h>
+
+#if !defined(OS_WIN)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !defined(OS_WIN)
+
+#include <algorithm>
+#include <cerrno>
+
+#include <absl/log/log.h>
+
+#include <packager/macros/compiler.h>
+
+namespace shaka {
+
+FileMapping::FileMapping(const uint8_t* data, uint64_t size)
+    : data_(data), size_(size) {}
+
+FileMapping::~FileMapping() {
+#if !defined(OS_WIN)
+  if (munmap(const_cast<uint8_t*>(data_), size_) != 0)
+    LOG(WARNING) << "Failed to unmap file, error " << errno;
+#endif  // !defined(OS_WIN)
+}
+
+std::shared_ptr<FileMapping> FileMapping::Map(int fd) {
+#if defined(OS_WIN)
+  // Not implemented. The callers fall back to reading the file.
+  UNUSED(fd);
+  return nullptr;
+#else
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    LOG(ERROR) << "Failed to get the file size, error " << errno;
+    return nullptr;
+  }
+  if (!S_ISREG(file_stat.st_mode) || file_stat.st_size <= 0)
+    return nullptr;
+
+  const uint64_t size = static_cast<uint64_t>(file_stat.st_size);
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    LOG(WARNING) << "Failed to map file, error " << errno;
+    return nullptr;
+  }
+  // The inputs are demuxed front to back.
+  if (madvise(data, size, MADV_SEQUENTIAL) != 0)
+    VLOG(1) << "madvise(MADV_SEQUENTIAL) failed, error " << errno;
+  return std::shared_ptr<FileMapping>(
+      new FileMapping(static_cast<const uint8_t*>(data), size));
+#endif  // defined(OS_WIN)
+}
+
+void FileMapping::WillNeed(uint64_t offset, uint64_t length) {
+#if defined(OS_WIN)
+  UNUSED(offset);
+  UNUSED(length);
+#else
+  if (offset >= size_)
+    return;
+  length = std::min(length, size_ - offset);
+  // madvise() takes page aligned addresses.
+  static const uint64_t kPageSize =
+      static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+  const uint64_t aligned_offset = offset / kPageSize * kPageSize;
+  length += offset - aligned_offset;
+  if (madvise(const_cast<uint8_t*>(data_) + aligned_offset, length,
+              MADV_WILLNEED) != 0) {
+    VLOG(1) << "madvise(MADV_WILLNEED) failed, error " << errno;
+  }
+#endif  // defined(OS_WIN)
+}
+
+}  // namespace shaka
@@ -0,0 +1,50 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_FILE_MAPPING_H_
+#define PACKAGER_FILE_FILE_MAPPING_H_
+
+#include <cstdint>
+#include <memory>
+
+#include <packager/macros/classes.h>
+
+namespace shaka {
+
+/// A read-only memory mapping of a whole file. The file must not be modified
+/// or truncated while it is mapped.
+class FileMapping {
+ public:
+  ~FileMapping();
+
+  /// Map the content of the file open as @a fd. The mapping does not depend
+  /// on @a fd after this call, so the file can be closed.
+  /// @return The mapping on success, nullptr if the file is empty or cannot
+  ///         be mapped.
+  static std::shared_ptr<FileMapping> Map(int fd);
+
+  /// @return A pointer to the file content.
+  const uint8_t* data() const { return data_; }
+
+  /// @return The size of the file content in bytes.
+  uint64_t size() const { return size_; }
+
+  /// Hint that the range starting at @a offset will be accessed soon, so that
+  /// it is read ahead.
+  void WillNeed(uint64_t offset, uint64_t length);
+
+ private:
+  FileMapping(const uint8_t* data, uint64_t size);
+
+  const uint8_t* const data_;
+  const uint64_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileMapping);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_FILE_MAPPING_H_
@@ -0,0 +1,73 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/file_mapping.h>
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
+#include <packager/file/file_test_util.h>
+
+namespace shaka {
+
+namespace {
+const char kContent[] = "file content to be mapped";
+}  // namespace
+
+#if !defined(OS_WIN)
+
+TEST(FileMappingTest, MapLocalFile) {
+  TempFile temp_file;
+  ASSERT_TRUE(File::WriteStringToFile(temp_file.path().c_str(), kContent));
+
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(temp_file.path().c_str(), "r"));
+  ASSERT_TRUE(file);
+  std::shared_ptr<FileMapping> mapping = file->MapForReading();
+  ASSERT_TRUE(mapping);
+  // The mapping outlives the file.
+  file.reset();
+
+  ASSERT_EQ(sizeof(kContent) - 1, mapping->size());
+  EXPECT_EQ(kContent,
+            std::string(reinterpret_cast<const char*>(mapping->data()),
+                        mapping->size()));
+
+  // Out of range hints are ignored.
+  mapping->WillNeed(1, mapping->size());
+  mapping->WillNeed(mapping->size(), 100);
+  EXPECT_EQ(kContent,
+            std::string(reinterpret_cast<const char*>(mapping->data()),
+                        mapping->size()));
+}
+
+TEST(FileMappingTest, EmptyFileIsNotMapped) {
+  TempFile temp_file;
+  ASSERT_TRUE(File::WriteStringToFile(temp_file.path().c_str(), ""));
+
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(temp_file.path().c_str(), "r"));
+  ASSERT_TRUE(file);
+  EXPECT_FALSE(file->MapForReading());
+}
+
+#endif  // !defined(OS_WIN)
+
+TEST(FileMappingTest, MemoryFileIsNotMapped) {
+  const char kFileName[] = "memory://file_to_map";
+  ASSERT_TRUE(File::WriteStringToFile(kFileName, kContent));
+
+  std::unique_ptr<File, FileCloser> file(File::Open(kFileName, "r"));
+  ASSERT_TRUE(file);
+  EXPECT_FALSE(file->MapForReading());
+  file.reset();
+  ASSERT_TRUE(File::Delete(kFileName));
+}
+
+}  // namespace shaka
@@ -6,14 +6,17 @@
 
 #include <packager/file.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <filesystem>
 #include <locale>
+#include <vector>
 
 #include <absl/flags/declare.h>
 #include <gtest/gtest.h>
 
 #include <packager/file/file_test_util.h>
+#include <packager/file/work_stealing_executor.h>
 #include <packager/flag_saver.h>
 
 ABSL_DECLARE_FLAG(uint64_t, io_cache_size);
@@ -160,6 +163,42 @@ TEST_F(LocalFileTest, Write) {
   EXPECT_EQ(data_, read_data);
 }
 
+TEST_F(LocalFileTest, WriteV) {
+  File* file = File::Open(local_file_name_.c_str(), "w");
+  ASSERT_TRUE(file != NULL);
+
+  // Buffered data must be written before the blocks.
+  const int kHeaderSize = 10;
+  EXPECT_EQ(kHeaderSize, file->Write(&data_[0], kHeaderSize));
+
+  // More blocks than a single writev call accepts, some of them empty.
+  const int kNumBlocks = 3000;
+  std::vector<File::IoVec> iov;
+  std::string expected = data_.substr(0, kHeaderSize);
+  for (int i = 0; i < kNumBlocks; ++i) {
+    const int offset = i % kDataSize;
+    const int length = std::min(i % 7, kDataSize - offset);
+    iov.push_back({&data_[offset], static_cast<uint64_t>(length)});
+    expected.append(data_, offset, length);
+  }
+  const int64_t blocks_size = expected.size() - kHeaderSize;
+  EXPECT_EQ(blocks_size, file->WriteV(iov.data(), iov.size()));
+
+  // The file position is updated.
+  uint64_t position = 0;
+  EXPECT_TRUE(file->Tell(&position));
+  EXPECT_EQ(expected.size(), position);
+  EXPECT_EQ(kDataSize, file->Write(&data_[0], kDataSize));
+  expected += data_;
+  EXPECT_TRUE(file->Close());
+
+  std::string read_data;
+  const uint32_t max_size = static_cast<uint32_t>(expected.size() + 1);
+  ASSERT_EQ(expected.size(),
+            ReadFile(local_file_name_no_prefix_, &read_data, max_size));
+  EXPECT_EQ(expected, read_data);
+}
+
 TEST_F(LocalFileTest, Read_And_Eof) {
   WriteFile(local_file_name_no_prefix_, data_);
 
@@ -251,6 +290,23 @@ TEST_F(LocalFileTest, IsLocalRegular) {
   ASSERT_TRUE(File::IsLocalRegularFile(local_file_name_.c_str()));
 }
 
+TEST_F(LocalFileTest, IsLocalRegularFileName) {
+  // A local file which does not exist yet.
+  DeleteFile(local_file_name_no_prefix_);
+  EXPECT_TRUE(File::IsLocalRegularFileName(local_file_name_.c_str()));
+  EXPECT_TRUE(File::IsLocalRegularFileName(local_file_name_no_prefix_.c_str()));
+
+  WriteFile(local_file_name_no_prefix_, data_);
+  EXPECT_TRUE(File::IsLocalRegularFileName(local_file_name_.c_str()));
+
+  const std::string directory =
+      std::filesystem::path(local_file_name_no_prefix_).parent_path().string();
+  EXPECT_FALSE(File::IsLocalRegularFileName(directory.c_str()));
+  EXPECT_FALSE(File::IsLocalRegularFileName("memory://file"));
+  EXPECT_FALSE(File::IsLocalRegularFileName("udp://127.0.0.1:1234"));
+  EXPECT_FALSE(File::IsLocalRegularFileName("http://example.com/file"));
+}
+
 TEST_F(LocalFileTest, UnicodePath) {
   // Delete the temp file already created.
   DeleteFile(local_file_name_no_prefix_);
@@ -402,6 +458,73 @@ INSTANTIATE_TEST_SUITE_P(TestSeekWithDifferentCacheSizes,
                          // is just under the data size of 1k.
                          ::testing::Values(0u, 20u, 61u, 1000u));
 
+// The I/O of all the threaded files runs on the fixed I/O workers, so the
+// number of threads does not grow with the number of open files.
+TEST_F(LocalFileTest, ThreadedFilesShareIoWorkers) {
+  const int kNumFiles = 64;
+  const uint64_t kFileSize = 64 * 1024;
+  // Smaller than the files, so that their I/O has to be resumed many times.
+  const uint64_t kCacheSize = 4096;
+  const uint64_t kBlockSize = 1024;
+  const uint64_t kChunkSize = 1000;
+
+  FlagSaver local_backup_io_block_size(&FLAGS_io_block_size);
+  absl::SetFlag(&FLAGS_io_block_size, kBlockSize);
+  absl::SetFlag(&FLAGS_io_cache_size, kCacheSize);
+
+  std::string contents(kFileSize, 0);
+  for (uint64_t i = 0; i < kFileSize; ++i)
+    contents[i] = static_cast<char>(i * 7 % 251);
+
+  const WorkStealingExecutor::Stats stats_before =
+      WorkStealingExecutor::Io()->GetStats();
+
+  std::vector<std::string> paths(kNumFiles);
+  std::vector<File*> files(kNumFiles);
+  for (int i = 0; i < kNumFiles; ++i) {
+    paths[i] = generate_unique_temp_path();
+    files[i] = File::Open(paths[i].c_str(), "w");
+    ASSERT_TRUE(files[i]);
+  }
+  // All the files are written to at the same time.
+  for (uint64_t offset = 0; offset < kFileSize; offset += kChunkSize) {
+    const uint64_t size = std::min(kChunkSize, kFileSize - offset);
+    for (File* file : files)
+      ASSERT_EQ(static_cast<int64_t>(size),
+                file->Write(contents.data() + offset, size));
+  }
+  for (File* file : files)
+    ASSERT_TRUE(file->Close());
+
+  for (int i = 0; i < kNumFiles; ++i) {
+    files[i] = File::Open(paths[i].c_str(), "r");
+    ASSERT_TRUE(files[i]);
+  }
+  std::vector<std::string> read_contents(kNumFiles);
+  std::vector<char> buffer(kChunkSize);
+  bool all_eof = false;
+  while (!all_eof) {
+    all_eof = true;
+    for (int i = 0; i < kNumFiles; ++i) {
+      const int64_t size = files[i]->Read(buffer.data(), buffer.size());
+      ASSERT_GE(size, 0);
+      read_contents[i].append(buffer.data(), size);
+      all_eof &= size == 0;
+    }
+  }
+  for (int i = 0; i < kNumFiles; ++i) {
+    ASSERT_TRUE(files[i]->Close());
+    EXPECT_EQ(contents, read_contents[i]);
+    DeleteFile(paths[i]);
+  }
+
+  const WorkStealingExecutor::Stats stats_after =
+      WorkStealingExecutor::Io()->GetStats();
+  EXPECT_EQ(stats_before.max_blocking_threads,
+            stats_after.max_blocking_threads);
+  EXPECT_GT(stats_after.tasks_run, stats_before.tasks_run);
+}
+
 TEST(FileTest, MakeCallbackFileName) {
   const BufferCallbackParams* params =
       reinterpret_cast<BufferCallbackParams*>(1000);
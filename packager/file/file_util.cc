@@ -12,10 +12,21 @@
 #include <unistd.h>
 #endif
 
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif  // defined(__linux__)
+
 #include <filesystem>
 #include <thread>
 
+#include <absl/log/log.h>
 #include <absl/strings/str_format.h>
+#include <absl/strings/strip.h>
+
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
 
 namespace shaka {
 namespace {
@@ -38,6 +49,70 @@ std::string TempFileName() {
   return absl::StrFormat("packager-tempfile-%x-%zx-%x", process_id, thread_id,
                          instance_id);
 }
+
+#if defined(__linux__)
+// Copies [offset, end of file) of |from_file_name| to the end of
+// |to_file_name| with copy_file_range(). Sets |*supported| to false, without
+// copying anything, if the kernel or file system cannot do it.
+bool KernelAppendFileRange(const std::string& from_file_name,
+                           uint64_t offset,
+                           const std::string& to_file_name,
+                           bool* supported) {
+  *supported = true;
+  // Only the local file prefix is allowed here, see AppendFileRange().
+  const std::string from_path(absl::StripPrefix(from_file_name, "file://"));
+  const std::string to_path(absl::StripPrefix(to_file_name, "file://"));
+
+  const int from_fd = open(from_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (from_fd < 0) {
+    LOG(ERROR) << "Cannot open " << from_path << ", error " << errno;
+    return false;
+  }
+  const int to_fd = open(to_path.c_str(), O_WRONLY | O_CLOEXEC);
+  if (to_fd < 0) {
+    LOG(ERROR) << "Cannot open " << to_path << ", error " << errno;
+    close(from_fd);
+    return false;
+  }
+
+  bool result = true;
+  struct stat from_stat;
+  loff_t from_offset = static_cast<loff_t>(offset);
+  loff_t to_offset = lseek(to_fd, 0, SEEK_END);
+  if (fstat(from_fd, &from_stat) != 0 || to_offset < 0) {
+    LOG(ERROR) << "Cannot stat " << from_path << " or " << to_path
+               << ", error " << errno;
+    result = false;
+  }
+  while (result && from_offset < from_stat.st_size) {
+    const ssize_t copied =
+        copy_file_range(from_fd, &from_offset, to_fd, &to_offset,
+                        static_cast<size_t>(from_stat.st_size - from_offset), 0);
+    if (copied > 0)
+      continue;
+    if (copied == 0)  // The source was truncated underneath us.
+      break;
+    if (errno == EINTR)
+      continue;
+    const bool nothing_copied = from_offset == static_cast<loff_t>(offset);
+    if (nothing_copied && (errno == ENOSYS || errno == EXDEV ||
+                           errno == EINVAL || errno == EOPNOTSUPP)) {
+      *supported = false;
+    } else {
+      LOG(ERROR) << "copy_file_range from " << from_path << " to " << to_path
+                 << " failed, error " << errno;
+    }
+    result = false;
+  }
+  close(from_fd);
+  if (close(to_fd) != 0 && result) {
+    LOG(ERROR) << "Cannot close " << to_path << ", error " << errno;
+    result = false;
+  }
+  return result;
+}
+#endif  // defined(__linux__)
+
 }  // namespace
 
 bool TempFilePath(const std::string& temp_dir, std::string* temp_file_path) {
@@ -53,6 +128,39 @@ bool TempFilePath(const std::string& temp_dir, std::string* temp_file_path) {
   return true;
 }
 
+bool AppendFileRange(const std::string& from_file_name,
+                     uint64_t offset,
+                     const std::string& to_file_name) {
+  if (!File::IsLocalRegularFile(from_file_name.c_str()) ||
+      !File::IsLocalRegularFile(to_file_name.c_str())) {
+    LOG(ERROR) << "AppendFileRange only supports local files: "
+               << from_file_name << ", " << to_file_name;
+    return false;
+  }
+
+#if defined(__linux__)
+  bool supported = false;
+  const bool result =
+      KernelAppendFileRange(from_file_name, offset, to_file_name, &supported);
+  if (supported)
+    return result;
+  VLOG(1) << "copy_file_range is not supported, copying " << from_file_name
+          << " in user space.";
+#endif  // defined(__linux__)
+
+  std::unique_ptr<File, FileCloser> from_file(
+      File::Open(from_file_name.c_str(), "r"));
+  std::unique_ptr<File, FileCloser> to_file(
+      File::Open(to_file_name.c_str(), "a"));
+  if (!from_file || !to_file || !from_file->Seek(offset)) {
+    LOG(ERROR) << "Cannot open " << from_file_name << " or " << to_file_name;
+    return false;
+  }
+  if (File::Copy(from_file.get(), to_file.get()) < 0)
+    return false;
+  return to_file.release()->Close();
+}
+
 std::string MakePathRelative(const std::filesystem::path& media_path,
                              const std::filesystem::path& parent_path) {
   auto relative_path = std::filesystem::relative(media_path, parent_path);
@@ -4,6 +4,7 @@
 // license that can be found in the LICENSE file or at
 // https://developers.google.com/open-source/licenses/bsd
 
+#include <cstdint>
 #include <filesystem>
 #include <string>
 
@@ -16,6 +17,16 @@ namespace shaka {
 /// @returns true on success, false otherwise.
 bool TempFilePath(const std::string& temp_dir, std::string* temp_file_path);
 
+/// Append the contents of local file @a from_file_name, starting at byte
+/// @a offset, to the end of local file @a to_file_name. On Linux the data is
+/// moved with copy_file_range(), which avoids the round trip through user
+/// space and lets file systems with reflink support share the extents instead
+/// of copying them.
+/// @returns true on success, false otherwise.
+bool AppendFileRange(const std::string& from_file_name,
+                     uint64_t offset,
+                     const std::string& to_file_name);
+
 std::string MakePathRelative(const std::filesystem::path& media_path,
                              const std::filesystem::path& parent_path);
 
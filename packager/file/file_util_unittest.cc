@@ -9,6 +9,8 @@
 #include <absl/log/log.h>
 #include <gtest/gtest.h>
 
+#include <packager/file.h>
+
 namespace shaka {
 
 TEST(FileUtilTest, TempFilePathInDesignatedDirectory) {
@@ -36,4 +38,40 @@ TEST(FileUtilTest, TempFilePathCalledTwice) {
   LOG(INFO) << "temp file path2: " << temp_file_path2;
 }
 
+TEST(FileUtilTest, AppendFileRange) {
+  std::string from_file_name;
+  std::string to_file_name;
+  ASSERT_TRUE(TempFilePath("", &from_file_name));
+  ASSERT_TRUE(TempFilePath("", &to_file_name));
+  ASSERT_TRUE(File::WriteStringToFile(from_file_name.c_str(), "0123456789"));
+  ASSERT_TRUE(File::WriteStringToFile(to_file_name.c_str(), "abc"));
+
+  EXPECT_TRUE(AppendFileRange(from_file_name, 4, to_file_name));
+  std::string contents;
+  ASSERT_TRUE(File::ReadFileToString(to_file_name.c_str(), &contents));
+  EXPECT_EQ("abc456789", contents);
+
+  // Appending from the end of the file is a no-op.
+  EXPECT_TRUE(AppendFileRange(from_file_name, 10, to_file_name));
+  contents.clear();
+  ASSERT_TRUE(File::ReadFileToString(to_file_name.c_str(), &contents));
+  EXPECT_EQ("abc456789", contents);
+
+  EXPECT_TRUE(File::Delete(from_file_name.c_str()));
+  EXPECT_TRUE(File::Delete(to_file_name.c_str()));
+}
+
+TEST(FileUtilTest, AppendFileRangeRequiresLocalFiles) {
+  const char kMemoryFileName[] = "memory://file1";
+  std::string to_file_name;
+  ASSERT_TRUE(TempFilePath("", &to_file_name));
+  ASSERT_TRUE(File::WriteStringToFile(kMemoryFileName, "0123456789"));
+  ASSERT_TRUE(File::WriteStringToFile(to_file_name.c_str(), "abc"));
+
+  EXPECT_FALSE(AppendFileRange(kMemoryFileName, 4, to_file_name));
+
+  EXPECT_TRUE(File::Delete(kMemoryFileName));
+  EXPECT_TRUE(File::Delete(to_file_name.c_str()));
+}
+
 }  // namespace shaka
@@ -0,0 +1,177 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/http_connection_pool.h>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/strings/match.h>
+#include <curl/curl.h>
+
+namespace shaka {
+
+namespace {
+
+// Upper bound of the time the pool thread sleeps without activity. curl wakes
+// it up earlier for its own timeouts, and Start() and Resume() wake it up
+// right away.
+const int kMaxPollTimeoutMs = 1000;
+
+void LockShare(CURL* /* curl */,
+               curl_lock_data data,
+               curl_lock_access /* access */,
+               void* user) {
+  static_cast<absl::Mutex*>(user)[data].Lock();
+}
+
+void UnlockShare(CURL* /* curl */, curl_lock_data data, void* user) {
+  static_cast<absl::Mutex*>(user)[data].Unlock();
+}
+
+}  // namespace
+
+// static
+HttpConnectionPool* HttpConnectionPool::GetInstance() {
+  static HttpConnectionPool* pool = []() {
+    // Not cleaned up, as the pool is never destroyed.
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    return new HttpConnectionPool;
+  }();
+  return pool;
+}
+
+HttpConnectionPool::HttpConnectionPool()
+    : multi_(curl_multi_init()),
+      share_(curl_share_init()),
+      share_mutexes_(new absl::Mutex[CURL_LOCK_DATA_LAST]) {
+  CHECK(multi_);
+  CHECK(share_);
+  curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+  // Connections and the DNS cache are shared by the multi handle already. The
+  // TLS sessions are not.
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &LockShare);
+  curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &UnlockShare);
+  curl_share_setopt(share_, CURLSHOPT_USERDATA, share_mutexes_.get());
+}
+
+void HttpConnectionPool::SetupRequest(CURL* curl) {
+  curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+  // Negotiate HTTP/2 on TLS connections, and wait for a connection being made
+  // to the same host rather than making another one, so that the request can
+  // be multiplexed on it.
+  curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+  curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+}
+
+void HttpConnectionPool::Start(CURL* curl, DoneCallback on_done) {
+  DCHECK(curl);
+  DCHECK(on_done);
+  {
+    absl::MutexLock lock(&mutex_);
+    pending_starts_.emplace_back(curl, std::move(on_done));
+    if (!thread_) {
+      thread_.reset(new std::thread(&HttpConnectionPool::ThreadMain, this));
+      thread_->detach();
+    }
+  }
+  curl_multi_wakeup(multi_);
+}
+
+void HttpConnectionPool::Resume(CURL* curl) {
+  {
+    absl::MutexLock lock(&mutex_);
+    pending_resumes_.push_back(curl);
+  }
+  curl_multi_wakeup(multi_);
+}
+
+HttpConnectionPool::Stats HttpConnectionPool::GetStats() {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+void HttpConnectionPool::ThreadMain() {
+  while (true) {
+    ProcessPendingRequests();
+
+    int running_requests = 0;
+    CURLMcode res = curl_multi_perform(multi_, &running_requests);
+    LOG_IF(ERROR, res != CURLM_OK)
+        << "curl_multi_perform failed: " << curl_multi_strerror(res);
+
+    int queued_messages = 0;
+    while (CURLMsg* message = curl_multi_info_read(multi_, &queued_messages)) {
+      if (message->msg == CURLMSG_DONE)
+        OnRequestDone(message->easy_handle, message->data.result);
+    }
+
+    curl_multi_poll(multi_, nullptr, 0, kMaxPollTimeoutMs, nullptr);
+  }
+}
+
+void HttpConnectionPool::ProcessPendingRequests() {
+  std::vector<std::pair<CURL*, DoneCallback>> starts;
+  std::vector<CURL*> resumes;
+  {
+    absl::MutexLock lock(&mutex_);
+    starts.swap(pending_starts_);
+    resumes.swap(pending_resumes_);
+  }
+
+  for (auto& start : starts) {
+    CURLMcode res = curl_multi_add_handle(multi_, start.first);
+    if (res != CURLM_OK) {
+      LOG(ERROR) << "curl_multi_add_handle failed: "
+                 << curl_multi_strerror(res);
+      start.second(CURLE_FAILED_INIT);
+      continue;
+    }
+    requests_[start.first] = std::move(start.second);
+  }
+  // The request may have completed since it was paused, and its handle may
+  // even have been reused for another request. Resuming a request which is
+  // not paused is harmless.
+  for (CURL* curl : resumes) {
+    if (requests_.find(curl) != requests_.end())
+      curl_easy_pause(curl, CURLPAUSE_CONT);
+  }
+}
+
+void HttpConnectionPool::OnRequestDone(CURL* curl, int curl_code) {
+  long num_connects = 0;
+  long http_version = 0;
+  char* scheme = nullptr;
+  curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &num_connects);
+  curl_easy_getinfo(curl, CURLINFO_HTTP_VERSION, &http_version);
+  curl_easy_getinfo(curl, CURLINFO_SCHEME, &scheme);
+  {
+    absl::MutexLock lock(&mutex_);
+    ++stats_.requests;
+    if (curl_code != CURLE_OK)
+      ++stats_.failed_requests;
+    stats_.new_connections += num_connects;
+    if (num_connects > 0 && scheme && absl::EqualsIgnoreCase(scheme, "https"))
+      stats_.tls_connections += num_connects;
+    if (num_connects == 0 && curl_code == CURLE_OK)
+      ++stats_.reused_connections;
+    if (http_version >= CURL_HTTP_VERSION_2_0)
+      ++stats_.http2_requests;
+  }
+
+  curl_multi_remove_handle(multi_, curl);
+  auto iter = requests_.find(curl);
+  DCHECK(iter != requests_.end());
+  DoneCallback on_done = std::move(iter->second);
+  requests_.erase(iter);
+  // The request may be destroyed as soon as it is notified.
+  on_done(curl_code);
+}
+
+}  // namespace shaka
@@ -0,0 +1,104 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_HTTP_CONNECTION_POOL_H_
+#define PACKAGER_FILE_HTTP_CONNECTION_POOL_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
+typedef void CURL;
+typedef void CURLM;
+typedef void CURLSH;
+
+namespace shaka {
+
+/// Process-wide pool of HTTP connections, shared by all the HttpFile requests,
+/// including the key requests of HttpKeyFetcher.
+///
+/// All the requests are performed by a single curl multi handle on a dedicated
+/// thread. Connections are kept alive between requests to the same host, and
+/// concurrent requests to an HTTP/2 host are multiplexed on one connection. DNS
+/// and TLS sessions are shared as well, so the connections which still have to
+/// be made skip the full TLS handshake.
+///
+/// The callbacks of the requests run on the pool thread, and must not block.
+/// A request waiting for data returns CURL_READFUNC_PAUSE or
+/// CURL_WRITEFUNC_PAUSE from its callbacks, and is resumed with Resume().
+class HttpConnectionPool {
+ public:
+  struct Stats {
+    uint64_t requests = 0;
+    uint64_t failed_requests = 0;
+    /// Number of connections made, i.e. TCP handshakes.
+    uint64_t new_connections = 0;
+    /// Number of the connections made which are TLS connections.
+    uint64_t tls_connections = 0;
+    /// Number of requests which reused a connection.
+    uint64_t reused_connections = 0;
+    /// Number of requests sent over HTTP/2 or later, which may have been
+    /// multiplexed with other requests.
+    uint64_t http2_requests = 0;
+  };
+
+  using DoneCallback = std::function<void(int curl_code)>;
+
+  /// @return The process-wide pool.
+  static HttpConnectionPool* GetInstance();
+
+  /// Sets the options of @a curl which are specific to the pool. Called before
+  /// the request is started.
+  void SetupRequest(CURL* curl);
+
+  /// Starts performing the request of @a curl. @a on_done is called on the
+  /// pool thread with the CURLcode of the request once it is complete, after
+  /// which the pool does not use @a curl anymore.
+  void Start(CURL* curl, DoneCallback on_done);
+
+  /// Resumes a request paused by one of its callbacks. Can be called from any
+  /// thread, and is ignored if the request is complete.
+  void Resume(CURL* curl);
+
+  Stats GetStats();
+
+ private:
+  HttpConnectionPool();
+  // Never destroyed, as requests may still be running on exit.
+  ~HttpConnectionPool() = delete;
+  HttpConnectionPool(const HttpConnectionPool&) = delete;
+  HttpConnectionPool& operator=(const HttpConnectionPool&) = delete;
+
+  void ThreadMain();
+  // Adds the started requests and resumes the paused ones.
+  void ProcessPendingRequests();
+  void OnRequestDone(CURL* curl, int curl_code);
+
+  CURLM* const multi_;
+  CURLSH* const share_;
+  // Locks of the data shared through |share_|, indexed by curl_lock_data.
+  std::unique_ptr<absl::Mutex[]> share_mutexes_;
+
+  absl::Mutex mutex_;
+  std::vector<std::pair<CURL*, DoneCallback>> pending_starts_
+      ABSL_GUARDED_BY(mutex_);
+  std::vector<CURL*> pending_resumes_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<std::thread> thread_ ABSL_GUARDED_BY(mutex_);
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+
+  // Only accessed by the pool thread.
+  std::map<CURL*, DoneCallback> requests_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_HTTP_CONNECTION_POOL_H_
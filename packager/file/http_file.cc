@@ -15,9 +15,10 @@
 #include <curl/curl.h>
 
 #include <packager/file/file_closer.h>
-#include <packager/file/thread_pool.h>
+#include <packager/file/http_connection_pool.h>
 #include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
+#include <packager/utils/telemetry.h>
 #include <packager/version/version.h>
 
 ABSL_FLAG(std::string,
@@ -61,26 +62,6 @@ namespace {
 constexpr const char* kBinaryContentType = "application/octet-stream";
 constexpr const int kMinLogLevelForCurlDebugFunction = 2;
 
-size_t CurlWriteCallback(char* buffer, size_t size, size_t nmemb, void* user) {
-  IoCache* cache = reinterpret_cast<IoCache*>(user);
-  size_t length = size * nmemb;
-  if (cache) {
-    length = cache->Write(buffer, length);
-    VLOG(3) << "CurlWriteCallback length=" << length;
-  } else {
-    // For the case of HTTP Put, the returned data may not be consumed. Return
-    // the size of the data to avoid curl errors.
-  }
-  return length;
-}
-
-size_t CurlReadCallback(char* buffer, size_t size, size_t nitems, void* user) {
-  IoCache* cache = reinterpret_cast<IoCache*>(user);
-  size_t length = cache->Read(buffer, size * nitems);
-  VLOG(3) << "CurlRead length=" << length;
-  return length;
-}
-
 int CurlDebugCallback(CURL* /* handle */,
                       curl_infotype type,
                       const char* data,
@@ -139,16 +120,6 @@ int CurlDebugCallback(CURL* /* handle */,
   return 0;
 }
 
-class LibCurlInitializer {
- public:
-  LibCurlInitializer() { curl_global_init(CURL_GLOBAL_DEFAULT); }
-
-  ~LibCurlInitializer() { curl_global_cleanup(); }
-
-  LibCurlInitializer(const LibCurlInitializer&) = delete;
-  LibCurlInitializer& operator=(const LibCurlInitializer&) = delete;
-};
-
 template <typename List>
 bool AppendHeader(const std::string& header, List* list) {
   auto* temp = curl_slist_append(list->get(), header.c_str());
@@ -179,6 +150,8 @@ HttpFile::HttpFile(HttpMethod method,
       isUpload_(method == HttpMethod::kPut || method == HttpMethod::kPost),
       download_cache_(absl::GetFlag(FLAGS_io_cache_size)),
       upload_cache_(absl::GetFlag(FLAGS_io_cache_size)),
+      // Initializes libcurl, so before curl_easy_init().
+      pool_(HttpConnectionPool::GetInstance()),
       curl_(curl_easy_init()),
       status_(Status::OK),
       user_agent_(absl::GetFlag(FLAGS_user_agent)),
@@ -188,7 +161,6 @@ HttpFile::HttpFile(HttpMethod method,
           absl::GetFlag(FLAGS_client_cert_private_key_file)),
       client_cert_private_key_password_(
           absl::GetFlag(FLAGS_client_cert_private_key_password)) {
-  static LibCurlInitializer lib_curl_initializer;
   if (user_agent_.empty()) {
     user_agent_ += "ShakaPackager/" + GetPackagerVersion();
   }
@@ -239,12 +211,19 @@ bool HttpFile::Open() {
   // TODO: Implement retrying with exponential backoff, see
   // "widevine_key_source.cc"
 
-  ThreadPool::instance.PostTask(std::bind(&HttpFile::ThreadMain, this));
+  SetupRequest();
+  pool_->Start(curl_.get(),
+               [this](int curl_code) { OnRequestDone(curl_code); });
 
   return true;
 }
 
 Status HttpFile::CloseWithStatus() {
+  const Status result = CloseWithRequestStatus();
+  return absl::GetFlag(FLAGS_ignore_http_output_failures) ? Status::OK : result;
+}
+
+Status HttpFile::CloseWithRequestStatus() {
   VLOG(2) << "Closing " << url_;
 
   // Close the upload cache first so the thread will finish uploading.
@@ -252,13 +231,21 @@ Status HttpFile::CloseWithStatus() {
   // Don't close the download cache, so that the server's response (HTTP status
   // code at minimum) can still be written after uploading is complete.
   // The task will close the download cache when it is complete.
-  upload_cache_.Close();
-  task_exit_event_.WaitForNotification();
+  static const uint32_t telemetry_id =
+      Telemetry::Register(Telemetry::Category::kFile, "HttpFile request");
+  {
+    // Records the time spent waiting for the end of the request.
+    ScopedTelemetry telemetry(telemetry_id, 1, 0);
+    upload_cache_.Close();
+    ResumeIfPaused(&upload_paused_);
+    task_exit_event_.WaitForNotification();
+    telemetry.set_bytes(bytes_transferred_);
+  }
 
   const Status result = status_;
   LOG_IF(ERROR, !result.ok()) << "HttpFile request failed: " << result;
   delete this;
-  return absl::GetFlag(FLAGS_ignore_http_output_failures) ? Status::OK : result;
+  return result;
 }
 
 bool HttpFile::Close() {
@@ -267,18 +254,23 @@ bool HttpFile::Close() {
 
 int64_t HttpFile::Read(void* buffer, uint64_t length) {
   VLOG(2) << "Reading from " << url_ << ", length=" << length;
-  return download_cache_.Read(buffer, length);
+  const int64_t result = download_cache_.Read(buffer, length);
+  ResumeIfPaused(&download_paused_);
+  return result;
 }
 
 int64_t HttpFile::Write(const void* buffer, uint64_t length) {
   DCHECK(!upload_cache_.closed());
   VLOG(2) << "Writing to " << url_ << ", length=" << length;
-  return upload_cache_.Write(buffer, length);
+  const int64_t result = upload_cache_.Write(buffer, length);
+  ResumeIfPaused(&upload_paused_);
+  return result;
 }
 
 void HttpFile::CloseForWriting() {
   VLOG(2) << "Closing further writes to " << url_;
   upload_cache_.Close();
+  ResumeIfPaused(&upload_paused_);
 }
 
 int64_t HttpFile::Size() {
@@ -312,8 +304,57 @@ void HttpFile::CurlDelete::operator()(curl_slist* headers) {
   curl_slist_free_all(headers);
 }
 
+// static
+size_t HttpFile::CurlWriteCallback(char* buffer,
+                                   size_t size,
+                                   size_t nmemb,
+                                   void* user) {
+  HttpFile* file = static_cast<HttpFile*>(user);
+  IoCache* cache = &file->download_cache_;
+  size_t length = size * nmemb;
+  // The paused flag is set before checking the cache, so that Read() either
+  // makes room before the check, or resumes the request after it.
+  file->download_paused_.store(true);
+  if (cache->BytesFree() < length && cache->BytesCached() > 0 &&
+      !cache->closed()) {
+    VLOG(3) << "CurlWriteCallback paused, length=" << length;
+    return CURL_WRITEFUNC_PAUSE;
+  }
+  file->download_paused_.store(false);
+  // Only blocks if |length| is larger than the whole cache.
+  length = cache->Write(buffer, length);
+  VLOG(3) << "CurlWriteCallback length=" << length;
+  return length;
+}
+
+// static
+size_t HttpFile::CurlReadCallback(char* buffer,
+                                  size_t size,
+                                  size_t nitems,
+                                  void* user) {
+  HttpFile* file = static_cast<HttpFile*>(user);
+  IoCache* cache = &file->upload_cache_;
+  // See CurlWriteCallback.
+  file->upload_paused_.store(true);
+  if (cache->BytesCached() == 0 && !cache->closed()) {
+    VLOG(3) << "CurlRead paused";
+    return CURL_READFUNC_PAUSE;
+  }
+  file->upload_paused_.store(false);
+  // Does not block, as there is data in the cache, or it is closed.
+  size_t length = cache->Read(buffer, size * nitems);
+  VLOG(3) << "CurlRead length=" << length;
+  return length;
+}
+
+void HttpFile::ResumeIfPaused(std::atomic<bool>* paused) {
+  if (paused->exchange(false))
+    pool_->Resume(curl_.get());
+}
+
 void HttpFile::SetupRequest() {
   auto* curl = curl_.get();
+  pool_->SetupRequest(curl);
 
   switch (method_) {
     case HttpMethod::kGet:
@@ -336,10 +377,10 @@ void HttpFile::SetupRequest() {
   curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
   curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
   curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &CurlWriteCallback);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &download_cache_);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
   if (isUpload_) {
     curl_easy_setopt(curl, CURLOPT_READFUNCTION, &CurlReadCallback);
-    curl_easy_setopt(curl, CURLOPT_READDATA, &upload_cache_);
+    curl_easy_setopt(curl, CURLOPT_READDATA, this);
   }
 
   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request_headers_.get());
@@ -370,10 +411,13 @@ void HttpFile::SetupRequest() {
   }
 }
 
-void HttpFile::ThreadMain() {
-  SetupRequest();
-
-  CURLcode res = curl_easy_perform(curl_.get());
+void HttpFile::OnRequestDone(int curl_code) {
+  const CURLcode res = static_cast<CURLcode>(curl_code);
+  curl_off_t uploaded = 0;
+  curl_off_t downloaded = 0;
+  curl_easy_getinfo(curl_.get(), CURLINFO_SIZE_UPLOAD_T, &uploaded);
+  curl_easy_getinfo(curl_.get(), CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+  bytes_transferred_ = uploaded + downloaded;
   if (res != CURLE_OK) {
     std::string error_message = curl_easy_strerror(res);
     if (res == CURLE_HTTP_RETURNED_ERROR) {
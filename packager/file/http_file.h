@@ -7,6 +7,8 @@
 #ifndef PACKAGER_FILE_HTTP_H_
 #define PACKAGER_FILE_HTTP_H_
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -21,6 +23,8 @@ struct curl_slist;
 
 namespace shaka {
 
+class HttpConnectionPool;
+
 enum class HttpMethod {
   kGet,
   kPost,
@@ -33,6 +37,9 @@ enum class HttpMethod {
 /// Note that calling Flush will indicate EOF for the upload and no more can be
 /// uploaded.
 ///
+/// Requests are performed by the process-wide HttpConnectionPool, which keeps
+/// the connections alive between files.
+///
 /// About how to use this, please visit the corresponding documentation [1].
 ///
 /// [1]
@@ -53,6 +60,10 @@ class HttpFile : public File {
 
   Status CloseWithStatus();
 
+  /// Same as CloseWithStatus(), but returns the failure of the request even
+  /// with --ignore_http_output_failures.
+  Status CloseWithRequestStatus();
+
   /// @name File implementation overrides.
   /// @{
   bool Close() override;
@@ -75,8 +86,22 @@ class HttpFile : public File {
     void operator()(curl_slist* headers);
   };
 
+  // curl callbacks, called on the connection pool thread. They must not block,
+  // so they pause the request when the caches are empty or full instead.
+  static size_t CurlWriteCallback(char* buffer,
+                                  size_t size,
+                                  size_t nmemb,
+                                  void* user);
+  static size_t CurlReadCallback(char* buffer,
+                                 size_t size,
+                                 size_t nitems,
+                                 void* user);
+
   void SetupRequest();
-  void ThreadMain();
+  void OnRequestDone(int curl_code);
+  // Resumes the request if it has been paused by the callback owning
+  // |paused|.
+  void ResumeIfPaused(std::atomic<bool>* paused);
 
   const std::string url_;
   const std::string upload_content_type_;
@@ -85,6 +110,7 @@ class HttpFile : public File {
   const bool isUpload_;
   IoCache download_cache_;
   IoCache upload_cache_;
+  HttpConnectionPool* const pool_;
   std::unique_ptr<CURL, CurlDelete> curl_;
   // The headers need to remain alive for the duration of the request.
   std::unique_ptr<curl_slist, CurlDelete> request_headers_;
@@ -95,7 +121,12 @@ class HttpFile : public File {
   std::string client_cert_private_key_file_;
   std::string client_cert_private_key_password_;
 
-  // Signaled when the "curl easy perform" task completes.
+  // Set by the callbacks when they pause the request.
+  std::atomic<bool> download_paused_{false};
+  std::atomic<bool> upload_paused_{false};
+  uint64_t bytes_transferred_ = 0;
+
+  // Signaled when the request completes.
   absl::Notification task_exit_event_;
 };
 
@@ -7,6 +7,7 @@
 #include <packager/file/http_file.h>
 
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include <absl/strings/str_split.h>
@@ -15,6 +16,7 @@
 
 #include <packager/file.h>
 #include <packager/file/file_closer.h>
+#include <packager/file/http_connection_pool.h>
 #include <packager/macros/logging.h>
 #include <packager/media/test/test_web_server.h>
 
@@ -328,4 +330,65 @@ TEST_F(HttpFileTest, TimeoutNotTriggered) {
   ASSERT_TRUE(file.release()->Close());
 }
 
+TEST_F(HttpFileTest, ReusesConnections) {
+  const HttpConnectionPool::Stats initial_stats =
+      HttpConnectionPool::GetInstance()->GetStats();
+
+  for (int i = 0; i < 3; ++i) {
+    FilePtr file(new HttpFile(HttpMethod::kPut, server_.ReflectUrl(),
+                              kBinaryContentType, kNoHeaders,
+                              kDefaultTestTimeout));
+    ASSERT_TRUE(file->Open());
+    const std::string data = "segment " + std::to_string(i);
+    ASSERT_EQ(file->Write(data.data(), data.size()),
+              static_cast<int64_t>(data.size()));
+    file->CloseForWriting();
+
+    auto json = HandleResponse(file);
+    ASSERT_TRUE(json.is_object());
+    ASSERT_TRUE(file.release()->Close());
+    ASSERT_JSON_STRING(json, "body", data);
+  }
+
+  const HttpConnectionPool::Stats stats =
+      HttpConnectionPool::GetInstance()->GetStats();
+  EXPECT_EQ(3u, stats.requests - initial_stats.requests);
+  // The first request may reuse a connection of a previous test.
+  EXPECT_LE(2u, stats.reused_connections - initial_stats.reused_connections);
+  EXPECT_GE(1u, stats.new_connections - initial_stats.new_connections);
+}
+
+TEST_F(HttpFileTest, ConcurrentUploads) {
+  const int kNumUploads = 8;
+  std::vector<std::string> bodies(kNumUploads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumUploads; ++i) {
+    threads.emplace_back([this, i, &bodies]() {
+      FilePtr file(new HttpFile(HttpMethod::kPut, server_.ReflectUrl(),
+                                kBinaryContentType, kNoHeaders,
+                                kDefaultTestTimeout));
+      ASSERT_TRUE(file->Open());
+      // Written in several chunks, so that the requests are paused and
+      // resumed while the other requests are running.
+      const std::string data(1000, 'a' + i);
+      for (int chunk = 0; chunk < 10; ++chunk) {
+        ASSERT_EQ(file->Write(data.data(), data.size()),
+                  static_cast<int64_t>(data.size()));
+        ASSERT_TRUE(file->Flush());
+      }
+      file->CloseForWriting();
+
+      auto json = HandleResponse(file);
+      ASSERT_TRUE(json.is_object());
+      ASSERT_TRUE(file.release()->Close());
+      bodies[i] = GetJsonString(json, "body");
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (int i = 0; i < kNumUploads; ++i)
+    EXPECT_EQ(std::string(10000, 'a' + i), bodies[i]);
+}
+
 }  // namespace shaka
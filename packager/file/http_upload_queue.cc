@@ -0,0 +1,321 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/http_upload_queue.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include <absl/flags/declare.h>
+#include <absl/flags/flag.h>
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+
+#include <packager/file/file_closer.h>
+#include <packager/file/http_file.h>
+#include <packager/macros/compiler.h>
+
+ABSL_FLAG(int32_t,
+          http_upload_concurrency,
+          0,
+          "Maximum number of concurrent uploads of http(s) outputs. If "
+          "non-zero, segments are written to memory and uploaded in the "
+          "background, and manifests are only uploaded once the segments "
+          "written before them are. If 0, each output is uploaded while it is "
+          "written.");
+ABSL_FLAG(uint64_t,
+          http_upload_queue_size,
+          256ULL << 20,
+          "Maximum size in bytes of the outputs waiting to be uploaded with "
+          "--http_upload_concurrency. Packaging waits for uploads to complete "
+          "above it.");
+ABSL_FLAG(int32_t,
+          http_upload_retries,
+          3,
+          "Number of retries of a failed upload with "
+          "--http_upload_concurrency, with an exponential backoff starting at "
+          "one second.");
+
+ABSL_DECLARE_FLAG(bool, ignore_http_output_failures);
+
+namespace shaka {
+
+namespace {
+
+const absl::Duration kMaxRetryDelay = absl::Seconds(30);
+
+Status PutFile(const std::string& url, const std::string& data) {
+  std::unique_ptr<HttpFile, FileCloser> file(
+      new HttpFile(HttpMethod::kPut, url));
+  if (!file->Open())
+    return Status(error::FILE_FAILURE, "Cannot open " + url);
+
+  // The request fails without consuming the data if the server responds
+  // early, in which case Write() returns 0.
+  uint64_t written = 0;
+  while (written < data.size()) {
+    const int64_t result =
+        file->Write(data.data() + written, data.size() - written);
+    if (result <= 0)
+      break;
+    written += result;
+  }
+  file->CloseForWriting();
+  return file.release()->CloseWithRequestStatus();
+}
+
+}  // namespace
+
+HttpUploadQueue::HttpUploadQueue(const Options& options, UploadFunction upload)
+    : options_(options), upload_(upload ? std::move(upload) : &PutFile) {
+  DCHECK_GT(options_.max_concurrent_uploads, 0u);
+  for (size_t i = 0; i < options_.max_concurrent_uploads; ++i)
+    workers_.emplace_back(&HttpUploadQueue::WorkerMain, this);
+}
+
+HttpUploadQueue::~HttpUploadQueue() {
+  Status status = Flush();
+  LOG_IF(ERROR, !status.ok()) << "Uploads failed: " << status;
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+    entry_ready_.SignalAll();
+  }
+  for (std::thread& worker : workers_)
+    worker.join();
+}
+
+// static
+HttpUploadQueue* HttpUploadQueue::GetInstance() {
+  // Never destroyed, as files may be closed during static destruction.
+  static HttpUploadQueue* queue = []() -> HttpUploadQueue* {
+    const int32_t concurrency = absl::GetFlag(FLAGS_http_upload_concurrency);
+    if (concurrency <= 0)
+      return nullptr;
+    Options options;
+    options.max_concurrent_uploads = concurrency;
+    options.max_queued_bytes = absl::GetFlag(FLAGS_http_upload_queue_size);
+    options.max_retries =
+        std::max(0, absl::GetFlag(FLAGS_http_upload_retries));
+    return new HttpUploadQueue(options);
+  }();
+  return queue;
+}
+
+void HttpUploadQueue::Upload(const std::string& url, std::string data) {
+  Entry entry;
+  entry.url = url;
+  entry.data = std::move(data);
+  Add(std::move(entry));
+}
+
+void HttpUploadQueue::UploadManifest(const std::string& url,
+                                     std::string data) {
+  Entry entry;
+  entry.is_manifest = true;
+  entry.url = url;
+  entry.data = std::move(data);
+  Add(std::move(entry));
+}
+
+Status HttpUploadQueue::Flush() {
+  absl::MutexLock lock(&mutex_);
+  while (!pending_.empty() || num_in_flight_ > 0)
+    upload_done_.Wait(&mutex_);
+  Status status = status_;
+  status_ = Status::OK;
+  return status;
+}
+
+HttpUploadQueue::Stats HttpUploadQueue::GetStats() {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+void HttpUploadQueue::Add(Entry entry) {
+  absl::MutexLock lock(&mutex_);
+  WaitForRoom(entry.data.size());
+  entry.sequence_number = next_sequence_number_++;
+  queued_bytes_ += entry.data.size();
+  stats_.max_queued_bytes = std::max(stats_.max_queued_bytes, queued_bytes_);
+
+  if (!entry.is_manifest)
+    outstanding_files_.insert(entry.sequence_number);
+  pending_.push_back(std::move(entry));
+  entry_ready_.Signal();
+}
+
+void HttpUploadQueue::WorkerMain() {
+  while (true) {
+    Entry entry;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto iter = FindReadyEntry();
+      while (!shutdown_ && iter == pending_.end()) {
+        entry_ready_.Wait(&mutex_);
+        iter = FindReadyEntry();
+      }
+      if (iter == pending_.end())
+        return;
+      if (iter->is_manifest)
+        iter = SkipToLatestReadyVersion(iter);
+      entry = std::move(*iter);
+      pending_.erase(iter);
+      ++num_in_flight_;
+      if (entry.is_manifest)
+        manifests_in_flight_.insert(entry.url);
+    }
+
+    const Status status = UploadWithRetries(entry);
+
+    absl::MutexLock lock(&mutex_);
+    --num_in_flight_;
+    queued_bytes_ -= entry.data.size();
+    if (entry.is_manifest) {
+      manifests_in_flight_.erase(entry.url);
+      ++stats_.manifests_uploaded;
+    } else {
+      outstanding_files_.erase(entry.sequence_number);
+      ++stats_.files_uploaded;
+    }
+    if (status.ok()) {
+      stats_.bytes_uploaded += entry.data.size();
+    } else {
+      ++stats_.failed_uploads;
+      LOG(ERROR) << "Failed to upload " << entry.url << ": " << status;
+      if (!absl::GetFlag(FLAGS_ignore_http_output_failures))
+        status_.Update(status);
+    }
+    // The manifests waiting for this upload may be ready now.
+    entry_ready_.SignalAll();
+    upload_done_.SignalAll();
+  }
+}
+
+std::list<HttpUploadQueue::Entry>::iterator HttpUploadQueue::FindReadyEntry() {
+  for (auto iter = pending_.begin(); iter != pending_.end(); ++iter) {
+    if (IsReady(*iter))
+      return iter;
+  }
+  return pending_.end();
+}
+
+bool HttpUploadQueue::IsReady(const Entry& entry) {
+  if (!entry.is_manifest)
+    return true;
+  const bool files_uploaded =
+      outstanding_files_.empty() ||
+      *outstanding_files_.begin() > entry.sequence_number;
+  // Versions of a manifest are uploaded in order.
+  return files_uploaded && manifests_in_flight_.count(entry.url) == 0;
+}
+
+std::list<HttpUploadQueue::Entry>::iterator
+HttpUploadQueue::SkipToLatestReadyVersion(std::list<Entry>::iterator iter) {
+  // The versions are queued in order, and a version is ready if a later one
+  // is.
+  auto latest = iter;
+  for (auto next = std::next(iter); next != pending_.end(); ++next) {
+    if (next->is_manifest && next->url == iter->url && IsReady(*next))
+      latest = next;
+  }
+  while (iter != latest) {
+    if (iter->is_manifest && iter->url == latest->url) {
+      queued_bytes_ -= iter->data.size();
+      ++stats_.manifests_replaced;
+      iter = pending_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  return latest;
+}
+
+Status HttpUploadQueue::UploadWithRetries(const Entry& entry) {
+  absl::Duration retry_delay = options_.initial_retry_delay;
+  for (int retry = 0;; ++retry) {
+    Status status = upload_(entry.url, entry.data);
+    if (status.ok() || retry >= options_.max_retries)
+      return status;
+
+    LOG(WARNING) << "Failed to upload " << entry.url << ": " << status
+                 << ". Retrying in " << retry_delay << ".";
+    {
+      absl::MutexLock lock(&mutex_);
+      ++stats_.retries;
+    }
+    absl::SleepFor(retry_delay);
+    retry_delay = std::min(retry_delay * 2, kMaxRetryDelay);
+  }
+}
+
+void HttpUploadQueue::WaitForRoom(uint64_t size) {
+  if (queued_bytes_ == 0 || queued_bytes_ + size <= options_.max_queued_bytes)
+    return;
+  ++stats_.writer_waits;
+  while (queued_bytes_ > 0 &&
+         queued_bytes_ + size > options_.max_queued_bytes) {
+    upload_done_.Wait(&mutex_);
+  }
+}
+
+QueuedUploadFile::QueuedUploadFile(const std::string& url,
+                                   HttpUploadQueue* queue)
+    : File(url), url_(url), queue_(queue) {
+  DCHECK(queue_);
+}
+
+QueuedUploadFile::~QueuedUploadFile() {}
+
+bool QueuedUploadFile::Close() {
+  queue_->Upload(url_, std::move(data_));
+  delete this;
+  return true;
+}
+
+int64_t QueuedUploadFile::Read(void* buffer, uint64_t length) {
+  UNUSED(buffer);
+  UNUSED(length);
+  LOG(ERROR) << "QueuedUploadFile does not support Read().";
+  return -1;
+}
+
+int64_t QueuedUploadFile::Write(const void* buffer, uint64_t length) {
+  if (data_.size() < position_ + length)
+    data_.resize(position_ + length);
+  memcpy(&data_[position_], buffer, length);
+  position_ += length;
+  return length;
+}
+
+void QueuedUploadFile::CloseForWriting() {}
+
+int64_t QueuedUploadFile::Size() {
+  return data_.size();
+}
+
+bool QueuedUploadFile::Flush() {
+  return true;
+}
+
+bool QueuedUploadFile::Seek(uint64_t position) {
+  if (position > data_.size())
+    return false;
+  position_ = position;
+  return true;
+}
+
+bool QueuedUploadFile::Tell(uint64_t* position) {
+  *position = position_;
+  return true;
+}
+
+bool QueuedUploadFile::Open() {
+  return true;
+}
+
+}  // namespace shaka
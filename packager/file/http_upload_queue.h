@@ -0,0 +1,177 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_HTTP_UPLOAD_QUEUE_H_
+#define PACKAGER_FILE_HTTP_UPLOAD_QUEUE_H_
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
+
+#include <packager/file.h>
+#include <packager/status.h>
+
+namespace shaka {
+
+/// Uploads files to HTTP servers in the background, so that packaging does not
+/// wait for the server.
+///
+/// Files are uploaded by a bounded number of worker threads, and retried with
+/// an exponential backoff when an upload fails. The files waiting to be
+/// uploaded are held in memory, up to a limit after which the writers block
+/// until some uploads complete.
+///
+/// Manifests are uploaded only once all the files queued before them have been
+/// uploaded, so that they never reference segments which are not available
+/// yet. When several versions of a manifest can be uploaded, only the latest
+/// one is, and the older ones are dropped.
+class HttpUploadQueue {
+ public:
+  struct Options {
+    size_t max_concurrent_uploads = 4;
+    /// Maximum size of the queued files, in bytes. A file larger than this
+    /// is queued once the queue is empty.
+    uint64_t max_queued_bytes = 256ULL << 20;
+    /// Number of retries of a failed upload.
+    int max_retries = 3;
+    /// Delay before the first retry, doubled for each of the next ones.
+    absl::Duration initial_retry_delay = absl::Seconds(1);
+  };
+
+  struct Stats {
+    uint64_t files_uploaded = 0;
+    uint64_t manifests_uploaded = 0;
+    /// Number of manifest versions dropped for a newer version.
+    uint64_t manifests_replaced = 0;
+    uint64_t bytes_uploaded = 0;
+    uint64_t retries = 0;
+    uint64_t failed_uploads = 0;
+    uint64_t max_queued_bytes = 0;
+    /// Number of times a writer blocked because the queue was full.
+    uint64_t writer_waits = 0;
+  };
+
+  /// Uploads @a data to @a url.
+  using UploadFunction =
+      std::function<Status(const std::string& url, const std::string& data)>;
+
+  /// @param upload performs the uploads. They are HTTP PUT requests if not
+  ///        set.
+  explicit HttpUploadQueue(const Options& options,
+                           UploadFunction upload = nullptr);
+  /// Waits for the queued uploads to complete.
+  ~HttpUploadQueue();
+
+  /// @return The process-wide queue uploading the http(s) outputs, or nullptr
+  ///         if --http_upload_concurrency is 0.
+  static HttpUploadQueue* GetInstance();
+
+  /// Queues the upload of a file. Blocks while the queue is full.
+  void Upload(const std::string& url, std::string data);
+
+  /// Queues the upload of a manifest, to be uploaded after all the files queued
+  /// before it. Blocks while the queue is full.
+  void UploadManifest(const std::string& url, std::string data);
+
+  /// Waits for all the queued uploads to complete.
+  /// @return The first upload failure since the last call, if any. Failures
+  ///         are ignored with --ignore_http_output_failures.
+  Status Flush();
+
+  Stats GetStats();
+
+ private:
+  struct Entry {
+    uint64_t sequence_number = 0;
+    bool is_manifest = false;
+    std::string url;
+    std::string data;
+  };
+
+  HttpUploadQueue(const HttpUploadQueue&) = delete;
+  HttpUploadQueue& operator=(const HttpUploadQueue&) = delete;
+
+  void Add(Entry entry);
+  void WorkerMain();
+  // @return true if |entry| can be uploaded.
+  bool IsReady(const Entry& entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // @return The first entry which can be uploaded, or pending_.end().
+  std::list<Entry>::iterator FindReadyEntry()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Drops the versions of the manifest at |iter| which are older than the
+  // latest one ready to be uploaded.
+  // @return The latest version ready to be uploaded.
+  std::list<Entry>::iterator SkipToLatestReadyVersion(
+      std::list<Entry>::iterator iter) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  Status UploadWithRetries(const Entry& entry);
+  void WaitForRoom(uint64_t size) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const Options options_;
+  const UploadFunction upload_;
+
+  absl::Mutex mutex_;
+  // Signaled when an entry may have become ready, or on shutdown.
+  absl::CondVar entry_ready_;
+  // Signaled when an upload completes.
+  absl::CondVar upload_done_;
+  std::list<Entry> pending_ ABSL_GUARDED_BY(mutex_);
+  // Sequence numbers of the files which are pending or being uploaded.
+  std::set<uint64_t> outstanding_files_ ABSL_GUARDED_BY(mutex_);
+  // URLs of the manifests being uploaded.
+  std::set<std::string> manifests_in_flight_ ABSL_GUARDED_BY(mutex_);
+  size_t num_in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t queued_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t next_sequence_number_ ABSL_GUARDED_BY(mutex_) = 0;
+  Status status_ ABSL_GUARDED_BY(mutex_);
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::vector<std::thread> workers_;
+};
+
+/// A file written to memory, and queued for upload to an HTTP server when
+/// closed.
+class QueuedUploadFile : public File {
+ public:
+  QueuedUploadFile(const std::string& url, HttpUploadQueue* queue);
+
+  /// @name File implementation overrides.
+  /// @{
+  bool Close() override;
+  int64_t Read(void* buffer, uint64_t length) override;
+  int64_t Write(const void* buffer, uint64_t length) override;
+  void CloseForWriting() override;
+  int64_t Size() override;
+  bool Flush() override;
+  bool Seek(uint64_t position) override;
+  bool Tell(uint64_t* position) override;
+  /// @}
+
+ protected:
+  ~QueuedUploadFile() override;
+  bool Open() override;
+
+ private:
+  QueuedUploadFile(const QueuedUploadFile&) = delete;
+  QueuedUploadFile& operator=(const QueuedUploadFile&) = delete;
+
+  const std::string url_;
+  HttpUploadQueue* const queue_;
+  std::string data_;
+  uint64_t position_ = 0;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_HTTP_UPLOAD_QUEUE_H_
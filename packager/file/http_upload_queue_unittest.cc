@@ -0,0 +1,225 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/http_upload_queue.h>
+
+#include <map>
+#include <memory>
+#include <thread>
+
+#include <absl/synchronization/notification.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <packager/file/file_closer.h>
+#include <packager/status/status_test_util.h>
+
+namespace shaka {
+
+namespace {
+
+const char kSegmentUrl[] = "http://origin/segment.m4s";
+const char kNextSegmentUrl[] = "http://origin/next.m4s";
+const char kManifestUrl[] = "http://origin/manifest.mpd";
+
+}  // namespace
+
+class HttpUploadQueueTest : public testing::Test {
+ protected:
+  HttpUploadQueueTest() {
+    options_.max_concurrent_uploads = 2;
+    options_.initial_retry_delay = absl::Milliseconds(1);
+  }
+
+  void CreateQueue() {
+    queue_.reset(new HttpUploadQueue(
+        options_, [this](const std::string& url, const std::string& data) {
+          if (url == kSegmentUrl && block_segment_)
+            release_segment_.WaitForNotification();
+          if (url == kNextSegmentUrl && block_next_segment_)
+            release_next_segment_.WaitForNotification();
+          absl::MutexLock lock(&mutex_);
+          if (failures_ > 0) {
+            --failures_;
+            return Status(error::HTTP_FAILURE, "Service unavailable.");
+          }
+          uploads_.emplace_back(url, data);
+          return Status::OK;
+        }));
+  }
+
+  std::vector<std::pair<std::string, std::string>> uploads() {
+    absl::MutexLock lock(&mutex_);
+    return uploads_;
+  }
+
+  HttpUploadQueue::Options options_;
+  bool block_segment_ = false;
+  absl::Notification release_segment_;
+  bool block_next_segment_ = false;
+  absl::Notification release_next_segment_;
+  std::unique_ptr<HttpUploadQueue> queue_;
+
+  absl::Mutex mutex_;
+  int failures_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::vector<std::pair<std::string, std::string>> uploads_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+TEST_F(HttpUploadQueueTest, UploadsFiles) {
+  CreateQueue();
+  for (int i = 0; i < 10; ++i)
+    queue_->Upload("http://origin/" + std::to_string(i), std::to_string(i));
+  ASSERT_OK(queue_->Flush());
+
+  std::map<std::string, std::string> uploaded;
+  for (const auto& upload : uploads())
+    uploaded[upload.first] = upload.second;
+  ASSERT_EQ(10u, uploaded.size());
+  for (int i = 0; i < 10; ++i) {
+    const std::string url = "http://origin/" + std::to_string(i);
+    EXPECT_EQ(std::to_string(i), uploaded[url]);
+  }
+
+  const HttpUploadQueue::Stats stats = queue_->GetStats();
+  EXPECT_EQ(10u, stats.files_uploaded);
+  EXPECT_EQ(10u, stats.bytes_uploaded);
+}
+
+TEST_F(HttpUploadQueueTest, UploadsManifestsAfterFiles) {
+  block_segment_ = true;
+  CreateQueue();
+  queue_->Upload(kSegmentUrl, "segment");
+  queue_->UploadManifest(kManifestUrl, "manifest");
+  // A file queued after the manifest does not hold it back.
+  queue_->Upload(kNextSegmentUrl, "next");
+
+  absl::SleepFor(absl::Milliseconds(50));
+  for (const auto& upload : uploads())
+    EXPECT_NE(kManifestUrl, upload.first);
+
+  release_segment_.Notify();
+  ASSERT_OK(queue_->Flush());
+  EXPECT_THAT(uploads(),
+              testing::ElementsAre(
+                  testing::Pair(kNextSegmentUrl, "next"),
+                  testing::Pair(kSegmentUrl, "segment"),
+                  testing::Pair(kManifestUrl, "manifest")));
+}
+
+TEST_F(HttpUploadQueueTest, ReplacesPendingManifests) {
+  block_segment_ = true;
+  CreateQueue();
+  queue_->Upload(kSegmentUrl, "segment");
+  queue_->UploadManifest(kManifestUrl, "manifest 1");
+  queue_->UploadManifest(kManifestUrl, "manifest 2");
+
+  release_segment_.Notify();
+  ASSERT_OK(queue_->Flush());
+  EXPECT_THAT(uploads(),
+              testing::ElementsAre(testing::Pair(kSegmentUrl, "segment"),
+                                   testing::Pair(kManifestUrl, "manifest 2")));
+  EXPECT_EQ(1u, queue_->GetStats().manifests_replaced);
+}
+
+TEST_F(HttpUploadQueueTest, UploadsManifestsWhileNewerVersionsWait) {
+  block_segment_ = true;
+  block_next_segment_ = true;
+  CreateQueue();
+  queue_->Upload(kSegmentUrl, "segment");
+  queue_->UploadManifest(kManifestUrl, "manifest 1");
+  queue_->Upload(kNextSegmentUrl, "next");
+  queue_->UploadManifest(kManifestUrl, "manifest 2");
+
+  release_segment_.Notify();
+  // The first version does not wait for the next segment.
+  while (queue_->GetStats().manifests_uploaded == 0)
+    absl::SleepFor(absl::Milliseconds(1));
+  EXPECT_THAT(uploads(),
+              testing::ElementsAre(testing::Pair(kSegmentUrl, "segment"),
+                                   testing::Pair(kManifestUrl, "manifest 1")));
+
+  release_next_segment_.Notify();
+  ASSERT_OK(queue_->Flush());
+  EXPECT_THAT(uploads(),
+              testing::ElementsAre(testing::Pair(kSegmentUrl, "segment"),
+                                   testing::Pair(kManifestUrl, "manifest 1"),
+                                   testing::Pair(kNextSegmentUrl, "next"),
+                                   testing::Pair(kManifestUrl, "manifest 2")));
+  EXPECT_EQ(0u, queue_->GetStats().manifests_replaced);
+}
+
+TEST_F(HttpUploadQueueTest, RetriesFailedUploads) {
+  {
+    absl::MutexLock lock(&mutex_);
+    failures_ = 2;
+  }
+  CreateQueue();
+  queue_->Upload(kSegmentUrl, "segment");
+  ASSERT_OK(queue_->Flush());
+
+  EXPECT_THAT(uploads(),
+              testing::ElementsAre(testing::Pair(kSegmentUrl, "segment")));
+  EXPECT_EQ(2u, queue_->GetStats().retries);
+}
+
+TEST_F(HttpUploadQueueTest, ReportsFailedUploads) {
+  options_.max_retries = 1;
+  {
+    absl::MutexLock lock(&mutex_);
+    failures_ = 2;
+  }
+  CreateQueue();
+  queue_->Upload(kSegmentUrl, "segment");
+  EXPECT_EQ(error::HTTP_FAILURE, queue_->Flush().error_code());
+  EXPECT_EQ(1u, queue_->GetStats().failed_uploads);
+
+  // The failure is only reported once.
+  queue_->Upload(kSegmentUrl, "segment");
+  ASSERT_OK(queue_->Flush());
+}
+
+TEST_F(HttpUploadQueueTest, BlocksWritersWhenFull) {
+  options_.max_queued_bytes = 10;
+  block_segment_ = true;
+  CreateQueue();
+  queue_->Upload(kSegmentUrl, "segment");
+
+  absl::Notification queued;
+  std::thread writer([this, &queued]() {
+    queue_->Upload(kNextSegmentUrl, "next segment");
+    queued.Notify();
+  });
+  EXPECT_FALSE(queued.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+
+  release_segment_.Notify();
+  writer.join();
+  ASSERT_OK(queue_->Flush());
+  EXPECT_EQ(1u, queue_->GetStats().writer_waits);
+  EXPECT_EQ(2u, uploads().size());
+}
+
+TEST_F(HttpUploadQueueTest, QueuedUploadFile) {
+  CreateQueue();
+  std::unique_ptr<File, FileCloser> file(
+      new QueuedUploadFile(kSegmentUrl, queue_.get()));
+  const std::string data = "0123456789";
+  ASSERT_EQ(static_cast<int64_t>(data.size()),
+            file->Write(data.data(), data.size()));
+  ASSERT_TRUE(file->Seek(2));
+  ASSERT_EQ(2, file->Write("ab", 2));
+  uint64_t position = 0;
+  ASSERT_TRUE(file->Tell(&position));
+  EXPECT_EQ(4u, position);
+  EXPECT_EQ(10, file->Size());
+  ASSERT_TRUE(file.release()->Close());
+
+  ASSERT_OK(queue_->Flush());
+  EXPECT_THAT(uploads(),
+              testing::ElementsAre(testing::Pair(kSegmentUrl, "01ab456789")));
+}
+
+}  // namespace shaka
@@ -18,13 +18,12 @@ namespace shaka {
 
 IoCache::IoCache(uint64_t cache_size)
     : cache_size_(cache_size),
-      // Make the buffer one byte larger than the cache so that when the
-      // condition r_ptr == w_ptr is unambiguous (buffer empty).
-      circular_buffer_(cache_size + 1),
-      end_ptr_(&circular_buffer_[0] + cache_size + 1),
-      r_ptr_(circular_buffer_.data()),
-      w_ptr_(circular_buffer_.data()),
-      closed_(false) {}
+      circular_buffer_(cache_size),
+      closed_(false),
+      read_pos_(0),
+      write_pos_(0),
+      reader_waiting_(false),
+      writer_waiting_(false) {}
 
 IoCache::~IoCache() {
   Close();
@@ -33,27 +32,21 @@ IoCache::~IoCache() {
 uint64_t IoCache::Read(void* buffer, uint64_t size) {
   DCHECK(buffer);
 
-  absl::MutexLock lock(&mutex_);
-  while (!closed_ && (BytesCachedInternal() == 0)) {
-    write_event_.Wait(&mutex_);
-  }
+  WaitForData();
 
-  size = std::min(size, BytesCachedInternal());
-  uint64_t first_chunk_size(
-      std::min(size, static_cast<uint64_t>(end_ptr_ - r_ptr_)));
-  memcpy(buffer, r_ptr_, first_chunk_size);
-  r_ptr_ += first_chunk_size;
-  DCHECK_GE(end_ptr_, r_ptr_);
-  if (r_ptr_ == end_ptr_)
-    r_ptr_ = &circular_buffer_[0];
-  uint64_t second_chunk_size(size - first_chunk_size);
-  if (second_chunk_size) {
-    memcpy(static_cast<uint8_t*>(buffer) + first_chunk_size, r_ptr_,
-           second_chunk_size);
-    r_ptr_ += second_chunk_size;
-    DCHECK_GT(end_ptr_, r_ptr_);
+  const uint64_t read_pos = read_pos_.load(std::memory_order_relaxed);
+  size = std::min(size, write_pos_.load(std::memory_order_acquire) - read_pos);
+  if (size == 0)
+    return 0;
+
+  const uint64_t offset = read_pos % cache_size_;
+  const uint64_t first_chunk_size = std::min(size, cache_size_ - offset);
+  memcpy(buffer, &circular_buffer_[offset], first_chunk_size);
+  if (size > first_chunk_size) {
+    memcpy(static_cast<uint8_t*>(buffer) + first_chunk_size,
+           circular_buffer_.data(), size - first_chunk_size);
   }
-  read_event_.Signal();
+  CommitRead(size);
   return size;
 }
 
@@ -63,83 +56,154 @@ uint64_t IoCache::Write(const void* buffer, uint64_t size) {
   const uint8_t* r_ptr(static_cast<const uint8_t*>(buffer));
   uint64_t bytes_left(size);
   while (bytes_left) {
-    absl::MutexLock lock(&mutex_);
-    while (!closed_ && (BytesFreeInternal() == 0)) {
-      VLOG(1) << "Circular buffer is full, which can happen if data arrives "
-                 "faster than being consumed by packager. Ignore if it is not "
-                 "live packaging. Otherwise, try increasing --io_cache_size.";
-      read_event_.Wait(&mutex_);
-    }
-    if (closed_)
+    WaitForSpace();
+    if (closed())
       return 0;
 
-    uint64_t write_size(std::min(bytes_left, BytesFreeInternal()));
-    uint64_t first_chunk_size(
-        std::min(write_size, static_cast<uint64_t>(end_ptr_ - w_ptr_)));
-    memcpy(w_ptr_, r_ptr, first_chunk_size);
-    w_ptr_ += first_chunk_size;
-    DCHECK_GE(end_ptr_, w_ptr_);
-    if (w_ptr_ == end_ptr_)
-      w_ptr_ = &circular_buffer_[0];
-    r_ptr += first_chunk_size;
-    uint64_t second_chunk_size(write_size - first_chunk_size);
-    if (second_chunk_size) {
-      memcpy(w_ptr_, r_ptr, second_chunk_size);
-      w_ptr_ += second_chunk_size;
-      DCHECK_GT(end_ptr_, w_ptr_);
-      r_ptr += second_chunk_size;
+    const uint64_t write_pos = write_pos_.load(std::memory_order_relaxed);
+    const uint64_t bytes_free =
+        cache_size_ - (write_pos - read_pos_.load(std::memory_order_acquire));
+    const uint64_t write_size = std::min(bytes_left, bytes_free);
+    const uint64_t offset = write_pos % cache_size_;
+    const uint64_t first_chunk_size =
+        std::min(write_size, cache_size_ - offset);
+    memcpy(&circular_buffer_[offset], r_ptr, first_chunk_size);
+    if (write_size > first_chunk_size) {
+      memcpy(circular_buffer_.data(), r_ptr + first_chunk_size,
+             write_size - first_chunk_size);
     }
+    r_ptr += write_size;
     bytes_left -= write_size;
-    write_event_.Signal();
+    CommitWrite(write_size);
   }
   return size;
 }
 
+const uint8_t* IoCache::ReserveRead(uint64_t max_size, uint64_t* size) {
+  DCHECK(size);
+
+  WaitForData();
+
+  const uint64_t read_pos = read_pos_.load(std::memory_order_relaxed);
+  const uint64_t offset = read_pos % cache_size_;
+  *size = std::min({max_size,
+                    write_pos_.load(std::memory_order_acquire) - read_pos,
+                    cache_size_ - offset});
+  return *size > 0 ? &circular_buffer_[offset] : nullptr;
+}
+
+void IoCache::CommitRead(uint64_t size) {
+  if (size == 0)
+    return;
+  const uint64_t read_pos = read_pos_.load(std::memory_order_relaxed);
+  DCHECK_LE(read_pos + size, write_pos_.load(std::memory_order_acquire));
+  read_pos_.store(read_pos + size, std::memory_order_release);
+  // Let the writer know that there is room in the cache.
+  Wake(&writer_waiting_, &read_event_);
+}
+
+uint8_t* IoCache::ReserveWrite(uint64_t max_size, uint64_t* size) {
+  DCHECK(size);
+
+  *size = 0;
+  WaitForSpace();
+  if (closed())
+    return nullptr;
+
+  const uint64_t write_pos = write_pos_.load(std::memory_order_relaxed);
+  const uint64_t offset = write_pos % cache_size_;
+  *size = std::min(
+      {max_size,
+       cache_size_ - (write_pos - read_pos_.load(std::memory_order_acquire)),
+       cache_size_ - offset});
+  return &circular_buffer_[offset];
+}
+
+void IoCache::CommitWrite(uint64_t size) {
+  if (size == 0)
+    return;
+  const uint64_t write_pos = write_pos_.load(std::memory_order_relaxed);
+  DCHECK_LE(write_pos + size,
+            read_pos_.load(std::memory_order_acquire) + cache_size_);
+  write_pos_.store(write_pos + size, std::memory_order_release);
+  // Let the reader know that there is data in the cache.
+  Wake(&reader_waiting_, &write_event_);
+}
+
 void IoCache::Clear() {
-  absl::MutexLock lock(&mutex_);
-  r_ptr_ = w_ptr_ = circular_buffer_.data();
+  read_pos_.store(write_pos_.load(std::memory_order_acquire),
+                  std::memory_order_release);
   // Let any writers know that there is room in the cache.
-  read_event_.Signal();
+  Wake(&writer_waiting_, &read_event_);
 }
 
 void IoCache::Close() {
   absl::MutexLock lock(&mutex_);
-  closed_ = true;
-  read_event_.Signal();
-  write_event_.Signal();
+  closed_.store(true, std::memory_order_release);
+  read_event_.SignalAll();
+  write_event_.SignalAll();
 }
 
 void IoCache::Reopen() {
   absl::MutexLock lock(&mutex_);
-  CHECK(closed_);
-  r_ptr_ = w_ptr_ = circular_buffer_.data();
-  closed_ = false;
+  CHECK(closed());
+  read_pos_.store(0, std::memory_order_relaxed);
+  write_pos_.store(0, std::memory_order_relaxed);
+  closed_.store(false, std::memory_order_release);
 }
 
 uint64_t IoCache::BytesCached() {
-  absl::MutexLock lock(&mutex_);
-  return BytesCachedInternal();
+  // Load the read position first, so that the result can not be negative.
+  const uint64_t read_pos = read_pos_.load(std::memory_order_acquire);
+  return write_pos_.load(std::memory_order_acquire) - read_pos;
 }
 
 uint64_t IoCache::BytesFree() {
-  absl::MutexLock lock(&mutex_);
-  return BytesFreeInternal();
+  return cache_size_ - BytesCached();
 }
 
-uint64_t IoCache::BytesCachedInternal() {
-  return (r_ptr_ <= w_ptr_)
-             ? w_ptr_ - r_ptr_
-             : (end_ptr_ - r_ptr_) + (w_ptr_ - circular_buffer_.data());
+void IoCache::WaitUntilEmptyOrClosed() {
+  Park(&writer_waiting_, &read_event_, [this]() { return BytesCached() == 0; });
 }
 
-uint64_t IoCache::BytesFreeInternal() {
-  return cache_size_ - BytesCachedInternal();
+void IoCache::WaitForData() {
+  Park(&reader_waiting_, &write_event_, [this]() { return BytesCached() > 0; });
 }
 
-void IoCache::WaitUntilEmptyOrClosed() {
+void IoCache::WaitForSpace() {
+  Park(&writer_waiting_, &read_event_, [this]() {
+    if (BytesFree() > 0)
+      return true;
+    VLOG(1) << "Circular buffer is full, which can happen if data arrives "
+               "faster than being consumed by packager. Ignore if it is not "
+               "live packaging. Otherwise, try increasing --io_cache_size.";
+    return false;
+  });
+}
+
+template <typename Ready>
+void IoCache::Park(std::atomic<bool>* waiting,
+                   absl::CondVar* event,
+                   Ready ready) {
+  // Fast path, without touching the mutex.
+  if (ready() || closed())
+    return;
+
   absl::MutexLock lock(&mutex_);
-  while (!closed_ && BytesCachedInternal()) {
-    read_event_.Wait(&mutex_);
+  waiting->store(true, std::memory_order_relaxed);
+  // Pairs with the fence in Wake(): either the other side sees |waiting| and
+  // signals under the mutex, or the check below sees its update.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  while (!ready() && !closed())
+    event->Wait(&mutex_);
+  waiting->store(false, std::memory_order_relaxed);
+}
+
+void IoCache::Wake(std::atomic<bool>* waiting, absl::CondVar* event) {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting->load(std::memory_order_relaxed)) {
+    absl::MutexLock lock(&mutex_);
+    event->Signal();
   }
 }
 
@@ -7,6 +7,7 @@
 #ifndef PACKAGER_FILE_IO_CACHE_H_
 #define PACKAGER_FILE_IO_CACHE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <vector>
 
@@ -16,7 +17,14 @@
 
 namespace shaka {
 
-/// Declaration of class which implements a thread-safe circular buffer.
+/// Declaration of class which implements a circular buffer shared by a single
+/// producer thread and a single consumer thread. Data is exchanged without
+/// locking; a thread only parks on a mutex when the cache is empty (reader) or
+/// full (writer).
+///
+/// Read, ReserveRead, CommitRead and Clear must only be called by the consumer.
+/// Write, ReserveWrite, CommitWrite and WaitUntilEmptyOrClosed must only be
+/// called by the producer. Close may be called by either.
 class IoCache {
  public:
   explicit IoCache(uint64_t cache_size);
@@ -39,6 +47,33 @@ class IoCache {
   ///         closed.
   uint64_t Write(const void* buffer, uint64_t size);
 
+  /// Get the contiguous cached data at the read position without copying it.
+  /// This function may block until there is data in the cache. The data stays
+  /// valid until CommitRead is called.
+  /// @param max_size is the maximum number of bytes to return.
+  /// @param[out] size is set to the number of bytes available at the returned
+  ///             pointer, which may be less than what is cached if the data
+  ///             wraps around the end of the buffer.
+  /// @return a pointer to the data, or nullptr if the call unblocked because
+  ///         the cache has been closed and is empty.
+  const uint8_t* ReserveRead(uint64_t max_size, uint64_t* size);
+
+  /// Release @a size bytes returned by the last ReserveRead to the writer.
+  void CommitRead(uint64_t size);
+
+  /// Get contiguous free space at the write position, so that it can be filled
+  /// in place. This function may block until there is room in the cache.
+  /// @param max_size is the maximum number of bytes to return.
+  /// @param[out] size is set to the number of bytes which may be written at
+  ///             the returned pointer.
+  /// @return a pointer to the free space, or nullptr if the call unblocked
+  ///         because the cache has been closed.
+  uint8_t* ReserveWrite(uint64_t max_size, uint64_t* size);
+
+  /// Publish @a size bytes written to the space returned by the last
+  /// ReserveWrite to the reader.
+  void CommitWrite(uint64_t size);
+
   /// Empties the cache.
   void Clear();
 
@@ -47,9 +82,10 @@ class IoCache {
   void Close();
 
   /// @return true if the cache is closed, false otherwise.
-  bool closed() { return closed_; }
+  bool closed() { return closed_.load(std::memory_order_acquire); }
 
-  /// Reopens the cache. Any data still in the cache will be lost.
+  /// Reopens the cache. Any data still in the cache will be lost. Neither the
+  /// reader nor the writer may be using the cache at the same time.
   void Reopen();
 
   /// Returns the number of bytes in the cache.
@@ -64,18 +100,34 @@ class IoCache {
   void WaitUntilEmptyOrClosed();
 
  private:
-  uint64_t BytesCachedInternal();
-  uint64_t BytesFreeInternal();
+  // Blocks until there is data in the cache or the cache is closed.
+  void WaitForData();
+  // Blocks until there is room in the cache or the cache is closed.
+  void WaitForSpace();
+  // Parks the calling thread on |event| until |ready| returns true or the
+  // cache is closed. |waiting| is set while parked so that the other side
+  // knows to signal.
+  template <typename Ready>
+  void Park(std::atomic<bool>* waiting, absl::CondVar* event, Ready ready);
+  // Signals |event| if the other side is parked on it.
+  void Wake(std::atomic<bool>* waiting, absl::CondVar* event);
 
   const uint64_t cache_size_;
-  absl::Mutex mutex_;
-  absl::CondVar read_event_ ABSL_GUARDED_BY(mutex_);
-  absl::CondVar write_event_ ABSL_GUARDED_BY(mutex_);
-  std::vector<uint8_t> circular_buffer_ ABSL_GUARDED_BY(mutex_);
-  const uint8_t* end_ptr_ ABSL_GUARDED_BY(mutex_);
-  uint8_t* r_ptr_ ABSL_GUARDED_BY(mutex_);
-  uint8_t* w_ptr_ ABSL_GUARDED_BY(mutex_);
-  bool closed_ ABSL_GUARDED_BY(mutex_);
+  std::vector<uint8_t> circular_buffer_;
+  std::atomic<bool> closed_;
+
+  // Total number of bytes ever read and written. The positions in
+  // |circular_buffer_| are these modulo |cache_size_|. They are kept on
+  // separate cache lines as each one is only written by one side.
+  alignas(64) std::atomic<uint64_t> read_pos_;
+  alignas(64) std::atomic<uint64_t> write_pos_;
+
+  // Only used to park a thread when the cache is empty or full.
+  alignas(64) absl::Mutex mutex_;
+  absl::CondVar read_event_;
+  absl::CondVar write_event_;
+  std::atomic<bool> reader_waiting_;
+  std::atomic<bool> writer_waiting_;
 
   DISALLOW_COPY_AND_ASSIGN(IoCache);
 };
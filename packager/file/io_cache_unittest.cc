@@ -253,4 +253,64 @@ TEST_F(IoCacheTest, LargeRead) {
   cache_->Close();
 }
 
+TEST_F(IoCacheTest, ReserveAndCommit) {
+  const uint64_t kTestBytes(kBlockSize + 10);
+
+  // Move the positions close to the end of the buffer so that the data wraps.
+  std::vector<uint8_t> padding(kCacheSize - kBlockSize);
+  EXPECT_EQ(padding.size(), cache_->Write(padding.data(), padding.size()));
+  EXPECT_EQ(padding.size(), cache_->Read(padding.data(), padding.size()));
+
+  std::vector<uint8_t> write_buffer;
+  GenerateTestBuffer(kTestBytes, &write_buffer);
+  uint64_t written = 0;
+  while (written < kTestBytes) {
+    uint64_t size = 0;
+    uint8_t* data = cache_->ReserveWrite(kTestBytes - written, &size);
+    ASSERT_TRUE(data);
+    ASSERT_NE(0u, size);
+    memcpy(data, &write_buffer[written], size);
+    cache_->CommitWrite(size);
+    written += size;
+  }
+  EXPECT_EQ(kTestBytes, cache_->BytesCached());
+
+  // The first reservation stops at the end of the buffer.
+  uint64_t size = 0;
+  const uint8_t* data = cache_->ReserveRead(kTestBytes, &size);
+  ASSERT_TRUE(data);
+  EXPECT_EQ(kBlockSize, size);
+  EXPECT_FALSE(memcmp(write_buffer.data(), data, size));
+  cache_->CommitRead(size);
+
+  data = cache_->ReserveRead(kTestBytes, &size);
+  ASSERT_TRUE(data);
+  EXPECT_EQ(kTestBytes - kBlockSize, size);
+  EXPECT_FALSE(memcmp(&write_buffer[kBlockSize], data, size));
+  cache_->CommitRead(size);
+  EXPECT_EQ(0u, cache_->BytesCached());
+
+  cache_->Close();
+  EXPECT_FALSE(cache_->ReserveRead(kTestBytes, &size));
+  EXPECT_FALSE(cache_->ReserveWrite(kTestBytes, &size));
+}
+
+TEST_F(IoCacheTest, ReserveReadWaitsForWriter) {
+  const uint64_t kNumWrites(kCacheSize * 100 / kBlockSize);
+
+  std::vector<uint8_t> write_buffer;
+  GenerateTestBuffer(kBlockSize, &write_buffer);
+  WriteToCacheThreaded(write_buffer, kNumWrites, 0, true);
+
+  uint64_t bytes_read = 0;
+  uint64_t size = 0;
+  while (const uint8_t* data = cache_->ReserveRead(kCacheSize, &size)) {
+    for (uint64_t i = 0; i < size; ++i)
+      ASSERT_EQ(write_buffer[(bytes_read + i) % kBlockSize], data[i]);
+    cache_->CommitRead(size);
+    bytes_read += size;
+  }
+  EXPECT_EQ(kNumWrites * kBlockSize, bytes_read);
+}
+
 }  // namespace shaka
@@ -10,14 +10,21 @@
 #include <windows.h>
 #else
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #endif  // defined(OS_WIN)
 
+#include <algorithm>
+#include <cerrno>
+#include <climits>
 #include <cstdio>
 #include <filesystem>
+#include <vector>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
+#include <packager/file/file_mapping.h>
 #include <packager/macros/logging.h>
 
 namespace shaka {
@@ -65,6 +72,81 @@ int64_t LocalFile::Write(const void* buffer, uint64_t length) {
   return bytes_written;
 }
 
+int64_t LocalFile::WriteV(const IoVec* iov, size_t iov_count) {
+#if defined(OS_WIN)
+  return File::WriteV(iov, iov_count);
+#else
+  DCHECK(internal_file_ != NULL);
+  // The blocks are written straight to the file descriptor, so anything
+  // buffered by stdio has to go first.
+  if (!Flush())
+    return -1;
+  const int fd = fileno(internal_file_);
+
+  std::vector<struct iovec> batch;
+  batch.reserve(std::min<size_t>(iov_count, IOV_MAX));
+  int64_t total_written = 0;
+  // Position of the first byte not written yet.
+  size_t index = 0;
+  uint64_t offset = 0;
+  while (true) {
+    batch.clear();
+    for (size_t i = index; i < iov_count && batch.size() < IOV_MAX; ++i) {
+      const uint64_t skip = i == index ? offset : 0;
+      if (iov[i].length == skip)
+        continue;
+      struct iovec vec;
+      vec.iov_base = const_cast<uint8_t*>(
+          static_cast<const uint8_t*>(iov[i].data) + skip);
+      vec.iov_len = iov[i].length - skip;
+      batch.push_back(vec);
+    }
+    if (batch.empty())
+      break;
+
+    const ssize_t bytes_written =
+        writev(fd, batch.data(), static_cast<int>(batch.size()));
+    VLOG(2) << "WriteV " << batch.size() << " blocks return " << bytes_written
+            << " error " << errno;
+    if (bytes_written < 0) {
+      if (errno == EINTR)
+        continue;
+      if (total_written == 0)
+        return -1;
+      break;
+    }
+    total_written += bytes_written;
+
+    uint64_t remaining = static_cast<uint64_t>(bytes_written);
+    while (remaining > 0) {
+      const uint64_t left_in_block = iov[index].length - offset;
+      if (remaining < left_in_block) {
+        offset += remaining;
+        break;
+      }
+      remaining -= left_in_block;
+      ++index;
+      offset = 0;
+    }
+  }
+
+  // Let stdio know about the new file position.
+  const off_t position = lseek(fd, 0, SEEK_CUR);
+  if (position < 0 || fseeko(internal_file_, position, SEEK_SET) < 0)
+    return -1;
+  return total_written;
+#endif  // defined(OS_WIN)
+}
+
+std::shared_ptr<FileMapping> LocalFile::MapForReading() {
+  DCHECK(internal_file_ != NULL);
+#if defined(OS_WIN)
+  return FileMapping::Map(_fileno(internal_file_));
+#else
+  return FileMapping::Map(fileno(internal_file_));
+#endif  // defined(OS_WIN)
+}
+
 void LocalFile::CloseForWriting() {}
 
 int64_t LocalFile::Size() {
@@ -28,6 +28,8 @@ class LocalFile : public File {
   bool Close() override;
   int64_t Read(void* buffer, uint64_t length) override;
   int64_t Write(const void* buffer, uint64_t length) override;
+  int64_t WriteV(const IoVec* iov, size_t iov_count) override;
+  std::shared_ptr<FileMapping> MapForReading() override;
   void CloseForWriting() override;
   int64_t Size() override;
   bool Flush() override;
@@ -6,25 +6,43 @@
 
 #include <packager/file/threaded_io_file.h>
 
+#include <algorithm>
+#include <cstring>
+
 #include <absl/log/check.h>
+#include <absl/log/log.h>
 
-#include <packager/file/thread_pool.h>
+#include <packager/file/work_stealing_executor.h>
+#include <packager/utils/telemetry.h>
 
 namespace shaka {
 
+namespace {
+// Maximum number of blocks moved by a step before letting the steps of other
+// files run.
+const int kMaxBlocksPerStep = 16;
+}  // namespace
+
 ThreadedIoFile::ThreadedIoFile(std::unique_ptr<File, FileCloser> internal_file,
                                Mode mode,
                                uint64_t io_cache_size,
-                               uint64_t io_block_size)
+                               uint64_t io_block_size,
+                               bool blocking_io)
     : File(internal_file->file_name()),
       internal_file_(std::move(internal_file)),
       mode_(mode),
       cache_(io_cache_size),
-      io_buffer_(io_block_size),
+      io_block_size_(io_block_size),
+      min_free_bytes_(std::min(io_cache_size, io_block_size)),
+      blocking_io_(blocking_io),
+      // Only used when there is not enough contiguous room in the cache to
+      // read a whole block in place.
+      io_buffer_(mode == kInputMode ? io_block_size : 0),
       position_(0),
       size_(0),
       eof_(false),
       internal_file_error_(0),
+      step_scheduled_(false),
       flushing_(false),
       flush_complete_(false),
       task_exited_(false) {
@@ -42,7 +60,10 @@ bool ThreadedIoFile::Open() {
   position_ = 0;
   size_ = internal_file_->Size();
 
-  ThreadPool::instance.PostTask(std::bind(&ThreadedIoFile::TaskHandler, this));
+  if (!StartTask()) {
+    internal_file_.release()->Close();
+    return false;
+  }
   return true;
 }
 
@@ -54,6 +75,7 @@ bool ThreadedIoFile::Close() {
     result = Flush();
 
   cache_.Close();
+  ScheduleStep();
   WaitForSignal(&task_exited_mutex_, &task_exited_);
 
   result &= internal_file_.release()->Close();
@@ -73,6 +95,7 @@ int64_t ThreadedIoFile::Read(void* buffer, uint64_t length) {
 
   uint64_t bytes_read = cache_.Read(buffer, length);
   position_ += bytes_read;
+  ScheduleStep();
 
   return bytes_read;
 }
@@ -84,7 +107,21 @@ int64_t ThreadedIoFile::Write(const void* buffer, uint64_t length) {
   if (internal_file_error_.load(std::memory_order_relaxed))
     return internal_file_error_.load(std::memory_order_relaxed);
 
-  uint64_t bytes_written = cache_.Write(buffer, length);
+  // Copy the data in place so that the task can be resumed as soon as part of
+  // it is cached. The cache may not have room for all of it until then.
+  const uint8_t* data = static_cast<const uint8_t*>(buffer);
+  uint64_t bytes_written = 0;
+  while (bytes_written < length) {
+    uint64_t size = 0;
+    uint8_t* cache_buffer =
+        cache_.ReserveWrite(length - bytes_written, &size);
+    if (!cache_buffer)
+      return 0;
+    memcpy(cache_buffer, data + bytes_written, size);
+    cache_.CommitWrite(size);
+    bytes_written += size;
+    ScheduleStep();
+  }
   position_ += bytes_written;
   if (position_ > size_)
     size_ = position_;
@@ -113,6 +150,7 @@ bool ThreadedIoFile::Flush() {
     flush_complete_ = false;
   }
   cache_.Close();
+  ScheduleStep();
 
   WaitForSignal(&flush_mutex_, &flush_complete_);
 
@@ -127,9 +165,10 @@ bool ThreadedIoFile::Seek(uint64_t position) {
     if (!internal_file_->Seek(position))
       return false;
   } else {
-    // Reading. Close cache, wait for thread task to exit, seek, and re-post
+    // Reading. Close cache, wait for thread task to exit, seek, and restart
     // the task.
     cache_.Close();
+    ScheduleStep();
     WaitForSignal(&task_exited_mutex_, &task_exited_);
 
     bool result = internal_file_->Seek(position);
@@ -142,8 +181,8 @@ bool ThreadedIoFile::Seek(uint64_t position) {
     cache_.Reopen();
     eof_ = false;
 
-    ThreadPool::instance.PostTask(
-        std::bind(&ThreadedIoFile::TaskHandler, this));
+    if (!StartTask())
+      return false;
     if (!result)
       return false;
   }
@@ -158,77 +197,174 @@ bool ThreadedIoFile::Tell(uint64_t* position) {
   return true;
 }
 
-void ThreadedIoFile::TaskHandler() {
+bool ThreadedIoFile::StartTask() {
   {
     absl::MutexLock lock(&task_exited_mutex_);
     task_exited_ = false;
   }
 
-  if (mode_ == kInputMode)
-    RunInInputMode();
-  else
-    RunInOutputMode();
+  if (blocking_io_) {
+    if (WorkStealingExecutor::Io()->PostBlockingTask(
+            std::bind(&ThreadedIoFile::TaskHandler, this))) {
+      return true;
+    }
+    LOG(ERROR) << "Failed to start the I/O task of " << file_name()
+               << ". Increase --num_io_threads.";
+    // Leave the file closed, as if the task had exited.
+    cache_.Close();
+    OnTaskExited();
+    return false;
+  }
 
-  {
-    absl::MutexLock lock(&task_exited_mutex_);
-    task_exited_ = true;
+  // Not scheduled through ScheduleStep(), as |step_scheduled_| stays set after
+  // the previous task exits.
+  step_scheduled_.store(true);
+  PostStep();
+  return true;
+}
+
+void ThreadedIoFile::TaskHandler() {
+  while (RunBlock(true) == BlockResult::kContinue) {
   }
+  OnTaskExited();
 }
 
-void ThreadedIoFile::RunInInputMode() {
+void ThreadedIoFile::ScheduleStep() {
+  if (blocking_io_)
+    return;
+
+  // Pairs with the fence in RunStep(): either the step sees the update to the
+  // cache made before this call, or it is rescheduled here.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!step_scheduled_.load(std::memory_order_relaxed) && CanResume() &&
+      !step_scheduled_.exchange(true)) {
+    PostStep();
+  }
+}
+
+void ThreadedIoFile::PostStep() {
+  WorkStealingExecutor::Io()->PostTask(
+      std::bind(&ThreadedIoFile::RunStep, this));
+}
+
+void ThreadedIoFile::RunStep() {
+  for (int i = 0; i < kMaxBlocksPerStep; ++i) {
+    switch (RunBlock(false)) {
+      case BlockResult::kContinue:
+        break;
+      case BlockResult::kWouldBlock:
+        step_scheduled_.store(false);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // The cache may have changed before |step_scheduled_| was cleared, in
+        // which case ScheduleStep() did not post a step.
+        if (!CanResume() || step_scheduled_.exchange(true))
+          return;
+        break;
+      case BlockResult::kDone:
+        // |step_scheduled_| stays set so that no more steps are posted.
+        OnTaskExited();
+        return;
+    }
+  }
+  // Let the steps of the other files run.
+  PostStep();
+}
+
+bool ThreadedIoFile::CanResume() {
+  if (cache_.closed())
+    return true;
+  // An input block is only read once the cache has room for all of it.
+  return mode_ == kInputMode ? cache_.BytesFree() >= min_free_bytes_
+                             : cache_.BytesCached() > 0;
+}
+
+void ThreadedIoFile::OnTaskExited() {
+  absl::MutexLock lock(&task_exited_mutex_);
+  task_exited_ = true;
+}
+
+ThreadedIoFile::BlockResult ThreadedIoFile::RunBlock(bool wait) {
+  if (!wait && !CanResume())
+    return BlockResult::kWouldBlock;
+  return mode_ == kInputMode ? ReadBlock() : WriteBlock();
+}
+
+ThreadedIoFile::BlockResult ThreadedIoFile::ReadBlock() {
   DCHECK(internal_file_);
   DCHECK_EQ(kInputMode, mode_);
 
-  while (true) {
-    int64_t read_result =
-        internal_file_->Read(&io_buffer_[0], io_buffer_.size());
-    if (read_result <= 0) {
-      eof_.store(read_result == 0, std::memory_order_relaxed);
-      internal_file_error_.store(read_result, std::memory_order_relaxed);
-      cache_.Close();
-      return;
-    }
-    if (cache_.Write(&io_buffer_[0], read_result) == 0) {
-      return;
-    }
+  static const uint32_t telemetry_id =
+      Telemetry::Register(Telemetry::Category::kFile, "ThreadedIoFile read");
+  // Read straight into the cache when a whole block fits. A datagram must not
+  // be split across reads, so fall back to |io_buffer_| otherwise.
+  uint64_t size = 0;
+  uint8_t* cache_buffer = cache_.ReserveWrite(io_block_size_, &size);
+  if (!cache_buffer)
+    return BlockResult::kDone;
+  const bool in_place = size == io_block_size_;
+  int64_t read_result = 0;
+  {
+    ScopedTelemetry telemetry(telemetry_id, 1, 0);
+    read_result = internal_file_->Read(
+        in_place ? cache_buffer : io_buffer_.data(), io_block_size_);
+    telemetry.set_bytes(std::max<int64_t>(read_result, 0));
   }
+  Telemetry::RecordQueueDepth(telemetry_id, cache_.BytesCached());
+  if (read_result <= 0) {
+    eof_.store(read_result == 0, std::memory_order_relaxed);
+    internal_file_error_.store(read_result, std::memory_order_relaxed);
+    cache_.Close();
+    return BlockResult::kDone;
+  }
+  if (in_place) {
+    cache_.CommitWrite(read_result);
+  } else if (cache_.Write(io_buffer_.data(), read_result) == 0) {
+    return BlockResult::kDone;
+  }
+  return BlockResult::kContinue;
 }
 
-void ThreadedIoFile::RunInOutputMode() {
+ThreadedIoFile::BlockResult ThreadedIoFile::WriteBlock() {
   DCHECK(internal_file_);
   DCHECK_EQ(kOutputMode, mode_);
 
-  while (true) {
-    uint64_t write_bytes = cache_.Read(&io_buffer_[0], io_buffer_.size());
-    if (write_bytes == 0) {
+  static const uint32_t telemetry_id =
+      Telemetry::Register(Telemetry::Category::kFile, "ThreadedIoFile write");
+  // Write straight from the cache, releasing the space once it is written.
+  uint64_t write_bytes = 0;
+  const uint8_t* cache_buffer =
+      cache_.ReserveRead(io_block_size_, &write_bytes);
+  if (!cache_buffer) {
+    absl::MutexLock lock(&flush_mutex_);
+    if (!flushing_)
+      return BlockResult::kDone;
+    cache_.Reopen();
+    flushing_ = false;
+    flush_complete_ = true;
+    return BlockResult::kContinue;
+  }
+
+  Telemetry::RecordQueueDepth(telemetry_id, cache_.BytesCached());
+  ScopedTelemetry telemetry(telemetry_id, 1, write_bytes);
+  uint64_t bytes_written(0);
+  while (bytes_written < write_bytes) {
+    int64_t write_result = internal_file_->Write(
+        cache_buffer + bytes_written, write_bytes - bytes_written);
+    if (write_result < 0) {
+      internal_file_error_.store(write_result, std::memory_order_relaxed);
+      cache_.Close();
+
       absl::MutexLock lock(&flush_mutex_);
       if (flushing_) {
-        cache_.Reopen();
         flushing_ = false;
         flush_complete_ = true;
-      } else {
-        return;
-      }
-    } else {
-      uint64_t bytes_written(0);
-      while (bytes_written < write_bytes) {
-        int64_t write_result = internal_file_->Write(
-            &io_buffer_[bytes_written], write_bytes - bytes_written);
-        if (write_result < 0) {
-          internal_file_error_.store(write_result, std::memory_order_relaxed);
-          cache_.Close();
-
-          absl::MutexLock lock(&flush_mutex_);
-          if (flushing_) {
-            flushing_ = false;
-            flush_complete_ = true;
-          }
-          return;
-        }
-        bytes_written += write_result;
       }
+      return BlockResult::kDone;
     }
+    bytes_written += write_result;
   }
+  cache_.CommitRead(write_bytes);
+  return BlockResult::kContinue;
 }
 
 void ThreadedIoFile::WaitForSignal(absl::Mutex* mutex, bool* condition) {
@@ -21,14 +21,23 @@
 namespace shaka {
 
 /// Declaration of class which implements a thread-safe circular buffer.
+///
+/// The internal file is read or written by the I/O executor, in steps of a few
+/// blocks which are resumed when the cache has room (input) or data (output).
+/// So the I/O of any number of files shares the fixed I/O workers. Internal
+/// files which may block indefinitely, such as UDP inputs, take a blocking
+/// thread of the executor instead.
 class ThreadedIoFile : public File {
  public:
   enum Mode { kInputMode, kOutputMode };
 
+  /// @param blocking_io is set if the calls to @a internal_file may block
+  ///        indefinitely.
   ThreadedIoFile(std::unique_ptr<File, FileCloser> internal_file,
                  Mode mode,
                  uint64_t io_cache_size,
-                 uint64_t io_block_size);
+                 uint64_t io_block_size,
+                 bool blocking_io);
 
   /// @name File implementation overrides.
   /// @{
@@ -48,21 +57,42 @@ class ThreadedIoFile : public File {
   bool Open() override;
 
  private:
-  // Internal task handler implementation. Will dispatch to either
-  // |RunInInputMode| or |RunInOutputMode| depending on |mode_|.
+  enum class BlockResult { kContinue, kWouldBlock, kDone };
+
+  // Start the task reading or writing |internal_file_|.
+  bool StartTask();
+  // Internal task handler implementation for |blocking_io_|.
   void TaskHandler();
-  void RunInInputMode();
-  void RunInOutputMode();
+  // Run a step of the task unless one is already scheduled or running. Called
+  // whenever the cache may have room (input) or data (output) again.
+  void ScheduleStep();
+  void PostStep();
+  void RunStep();
+  // @return true if the task can make progress without blocking on the cache.
+  bool CanResume();
+  void OnTaskExited();
+  // Move a block between the cache and |internal_file_|. Will dispatch to
+  // either |ReadBlock| or |WriteBlock| depending on |mode_|. Blocks on the
+  // cache only if |wait| is set.
+  BlockResult RunBlock(bool wait);
+  BlockResult ReadBlock();
+  BlockResult WriteBlock();
   void WaitForSignal(absl::Mutex* mutex, bool* condition);
 
   std::unique_ptr<File, FileCloser> internal_file_;
   const Mode mode_;
   IoCache cache_;
+  const uint64_t io_block_size_;
+  // Room needed in the cache to resume reading.
+  const uint64_t min_free_bytes_;
+  const bool blocking_io_;
   std::vector<uint8_t> io_buffer_;
   uint64_t position_;
   uint64_t size_;
   std::atomic<bool> eof_;
   std::atomic<int64_t> internal_file_error_;
+  // Set while a step is posted or running, and after the task exits.
+  std::atomic<bool> step_scheduled_;
 
   absl::Mutex flush_mutex_;
   bool flushing_ ABSL_GUARDED_BY(flush_mutex_);
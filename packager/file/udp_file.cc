@@ -14,9 +14,11 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 #define INVALID_SOCKET -1
 #define EINTR_CODE EINTR
@@ -27,20 +29,34 @@
 #endif
 #endif  // defined(OS_WIN)
 
+#include <algorithm>
 #include <limits>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
+#include <absl/time/clock.h>
 
+#include <packager/file/io_cache.h>
 #include <packager/file/udp_options.h>
+#include <packager/file/work_stealing_executor.h>
 #include <packager/macros/classes.h>
 #include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
+#include <packager/utils/telemetry.h>
 
 namespace shaka {
 
 namespace {
 
+// Largest possible UDP payload, so that no datagram is ever truncated. The
+// receive slots are not touched beyond the size of the datagrams received.
+const size_t kMaxDatagramSize = 65536;
+// Maximum number of datagrams received per system call.
+const size_t kReceiveBatchSize = 64;
+// The receiver checks whether it is stopped at least this often, as closing or
+// shutting down a UDP socket does not wake up a blocked receive everywhere.
+const int kReceivePollIntervalMs = 100;
+
 bool IsIpv4MulticastAddress(const struct in_addr& addr) {
   return (ntohl(addr.s_addr) & 0xf0000000) == 0xe0000000;
 }
@@ -53,14 +69,39 @@ int GetSocketErrorCode() {
 #endif
 }
 
+// @return 1 if |socket| becomes readable within |timeout_ms|, 0 on timeout and
+//         -1 on error.
+int WaitForReadable(SOCKET socket, int timeout_ms) {
+#if defined(OS_WIN)
+  WSAPOLLFD poll_fd = {};
+  poll_fd.fd = socket;
+  poll_fd.events = POLLRDNORM;
+  const int result = WSAPoll(&poll_fd, 1, timeout_ms);
+  return result == SOCKET_ERROR ? -1 : result;
+#else
+  struct pollfd poll_fd = {};
+  poll_fd.fd = socket;
+  poll_fd.events = POLLIN;
+  int result;
+  do {
+    result = poll(&poll_fd, 1, timeout_ms);
+  } while (result < 0 && errno == EINTR);
+  return result;
+#endif  // defined(OS_WIN)
+}
+
 }  // anonymous namespace
 
 UdpFile::UdpFile(const char* file_name)
-    : File(file_name), socket_(INVALID_SOCKET) {}
+    : File(file_name),
+      socket_(INVALID_SOCKET),
+      telemetry_id_(Telemetry::kInvalidId) {}
 
 UdpFile::~UdpFile() {}
 
 bool UdpFile::Close() {
+  if (ring_)
+    StopReceiver();
   if (socket_ != INVALID_SOCKET) {
     close(socket_);
     socket_ = INVALID_SOCKET;
@@ -78,6 +119,14 @@ int64_t UdpFile::Read(void* buffer, uint64_t length) {
   DCHECK_GE(length, 65535u)
       << "Buffer may be too small to read entire datagram.";
 
+  if (ring_) {
+    const uint64_t size = ring_->Read(buffer, length);
+    if (size > 0)
+      return size;
+    // The ring is only closed when the receiver stops.
+    return receive_error_.load(std::memory_order_acquire);
+  }
+
   if (socket_ == INVALID_SOCKET)
     return -1;
 
@@ -129,6 +178,198 @@ bool UdpFile::Tell(uint64_t* position) {
   return false;
 }
 
+UdpFile::Stats UdpFile::GetStats() {
+  absl::MutexLock lock(&stats_mutex_);
+  return stats_;
+}
+
+void UdpFile::ReceiveLoop() {
+  const SOCKET socket = socket_;
+  std::unique_ptr<uint8_t[]> slots(
+      new uint8_t[kReceiveBatchSize * kMaxDatagramSize]);
+  int64_t error = 0;
+
+#if defined(__linux__)
+  // Room for the kernel drop counter and the receive timestamp.
+  const size_t kControlSize =
+      CMSG_SPACE(sizeof(uint32_t)) + CMSG_SPACE(sizeof(struct timespec));
+  struct mmsghdr messages[kReceiveBatchSize];
+  struct iovec iovecs[kReceiveBatchSize];
+  alignas(struct cmsghdr) uint8_t controls[kReceiveBatchSize][kControlSize];
+  memset(messages, 0, sizeof(messages));
+  for (size_t i = 0; i < kReceiveBatchSize; ++i) {
+    iovecs[i].iov_base = slots.get() + i * kMaxDatagramSize;
+    iovecs[i].iov_len = kMaxDatagramSize;
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  while (WaitForDatagrams(socket, &error)) {
+    for (size_t i = 0; i < kReceiveBatchSize; ++i) {
+      messages[i].msg_hdr.msg_control = controls[i];
+      messages[i].msg_hdr.msg_controllen = kControlSize;
+    }
+    // Take whatever is queued.
+    int num_messages;
+    do {
+      num_messages =
+          recvmmsg(socket, messages, kReceiveBatchSize, MSG_DONTWAIT, nullptr);
+    } while (num_messages < 0 && errno == EINTR);
+    if (num_messages < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      continue;
+    if (num_messages < 0) {
+      LOG(ERROR) << "Failed to receive from " << file_name() << ", error "
+                 << errno;
+      error = -1;
+      break;
+    }
+
+    {
+      absl::MutexLock lock(&stats_mutex_);
+      ++stats_.receive_calls;
+    }
+    ScopedTelemetry telemetry(telemetry_id_, num_messages, 0);
+    uint64_t batch_bytes = 0;
+    bool ring_closed = false;
+    for (int i = 0; i < num_messages; ++i) {
+      struct msghdr* header = &messages[i].msg_hdr;
+      int64_t receive_time_us = 0;
+      uint32_t drop_count = last_drop_count_;
+      for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(header); cmsg;
+           cmsg = CMSG_NXTHDR(header, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET)
+          continue;
+        if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+          memcpy(&drop_count, CMSG_DATA(cmsg), sizeof(drop_count));
+        } else if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+          struct timespec timestamp;
+          memcpy(&timestamp, CMSG_DATA(cmsg), sizeof(timestamp));
+          receive_time_us = static_cast<int64_t>(timestamp.tv_sec) * 1000000 +
+                            timestamp.tv_nsec / 1000;
+        }
+      }
+      if (receive_time_us == 0)
+        receive_time_us = absl::ToUnixMicros(absl::Now());
+      RecordDatagram(messages[i].msg_len, receive_time_us, drop_count);
+      batch_bytes += messages[i].msg_len;
+
+      if (messages[i].msg_len > 0 &&
+          ring_->Write(iovecs[i].iov_base, messages[i].msg_len) == 0) {
+        // The ring was closed by StopReceiver().
+        ring_closed = true;
+        break;
+      }
+    }
+    telemetry.set_bytes(batch_bytes);
+    Telemetry::RecordQueueDepth(telemetry_id_, ring_->BytesCached());
+    if (ring_closed)
+      break;
+  }
+#else
+  while (WaitForDatagrams(socket, &error)) {
+    int64_t result;
+    do {
+      result = recvfrom(socket, reinterpret_cast<char*>(slots.get()),
+                        static_cast<int>(kMaxDatagramSize), 0, NULL, 0);
+    } while (result == -1 && GetSocketErrorCode() == EINTR_CODE);
+    if (receiver_stopping_.load(std::memory_order_acquire))
+      break;
+    if (result < 0) {
+      LOG(ERROR) << "Failed to receive from " << file_name() << ", error "
+                 << GetSocketErrorCode();
+      error = -1;
+      break;
+    }
+    {
+      absl::MutexLock lock(&stats_mutex_);
+      ++stats_.receive_calls;
+    }
+    ScopedTelemetry telemetry(telemetry_id_, 1, result);
+    RecordDatagram(result, absl::ToUnixMicros(absl::Now()), 0);
+    if (result > 0 && ring_->Write(slots.get(), result) == 0)
+      break;
+    Telemetry::RecordQueueDepth(telemetry_id_, ring_->BytesCached());
+  }
+#endif  // defined(__linux__)
+
+  // Let the reader drain the ring, then see the error if there was one.
+  receive_error_.store(error, std::memory_order_release);
+  ring_->Close();
+  receiver_exited_->Notify();
+}
+
+bool UdpFile::WaitForDatagrams(SOCKET socket, int64_t* error) {
+  const absl::Time start = absl::Now();
+  while (!receiver_stopping_.load(std::memory_order_acquire)) {
+    const int result = WaitForReadable(socket, kReceivePollIntervalMs);
+    if (receiver_stopping_.load(std::memory_order_acquire))
+      break;
+    if (result > 0)
+      return true;
+    if (result < 0) {
+      LOG(ERROR) << "Failed to wait for datagrams from " << file_name()
+                 << ", error " << GetSocketErrorCode();
+      *error = -1;
+      return false;
+    }
+    if (timeout_us_ > 0 &&
+        absl::Now() - start >= absl::Microseconds(timeout_us_)) {
+      LOG(ERROR) << "Timed out receiving from " << file_name() << ".";
+      *error = -1;
+      return false;
+    }
+  }
+  return false;
+}
+
+void UdpFile::RecordDatagram(uint64_t size,
+                             int64_t receive_time_us,
+                             uint32_t drop_count) {
+  absl::MutexLock lock(&stats_mutex_);
+  ++stats_.datagrams_received;
+  stats_.bytes_received += size;
+  if (stats_.last_receive_time_us > 0) {
+    stats_.max_receive_interval_us =
+        std::max(stats_.max_receive_interval_us,
+                 receive_time_us - stats_.last_receive_time_us);
+  }
+  stats_.last_receive_time_us = receive_time_us;
+
+  // The kernel counter is cumulative, and wraps around.
+  const uint32_t num_dropped = drop_count - last_drop_count_;
+  last_drop_count_ = drop_count;
+  if (num_dropped > 0) {
+    Telemetry::RecordDropped(telemetry_id_, num_dropped);
+    stats_.datagrams_dropped += num_dropped;
+    ++stats_.num_gaps;
+    if (stats_.num_gaps == 1 || stats_.num_gaps % 100 == 0) {
+      LOG(WARNING) << "The kernel dropped " << num_dropped << " datagrams from "
+                   << file_name() << " (" << stats_.datagrams_dropped
+                   << " in " << stats_.num_gaps
+                   << " gaps so far). Try increasing buffer_size.";
+    }
+  }
+}
+
+void UdpFile::StopReceiver() {
+  receiver_stopping_.store(true, std::memory_order_release);
+#if !defined(OS_WIN)
+  // Wakes up the receiver right away on Linux. Elsewhere, it notices within
+  // kReceivePollIntervalMs.
+  shutdown(socket_, SHUT_RD);
+#endif  // !defined(OS_WIN)
+  ring_->Close();
+  receiver_exited_->WaitForNotification();
+
+  const Stats stats = GetStats();
+  VLOG(1) << "Received " << stats.datagrams_received << " datagrams ("
+          << stats.bytes_received << " bytes) from " << file_name() << " in "
+          << stats.receive_calls << " calls, " << stats.datagrams_dropped
+          << " dropped in " << stats.num_gaps
+          << " gaps, longest interval between datagrams "
+          << stats.max_receive_interval_us << " us.";
+}
+
 class ScopedSocket {
  public:
   explicit ScopedSocket(SOCKET sock_fd) : sock_fd_(sock_fd) {}
@@ -300,7 +541,46 @@ bool UdpFile::Open() {
     }
   }
 
+  if (options->ring_size() > 0) {
+#if defined(__linux__)
+    // Ask for the kernel drop counter and receive timestamps with each
+    // datagram. These are only used for stats, so failures are not fatal.
+    const int optval_one = 1;
+    if (setsockopt(new_socket.get(), SOL_SOCKET, SO_RXQ_OVFL, &optval_one,
+                   sizeof(optval_one)) < 0) {
+      LOG(WARNING) << "Failed to enable SO_RXQ_OVFL, error = "
+                   << GetSocketErrorCode();
+    }
+    if (setsockopt(new_socket.get(), SOL_SOCKET, SO_TIMESTAMPNS, &optval_one,
+                   sizeof(optval_one)) < 0) {
+      LOG(WARNING) << "Failed to enable SO_TIMESTAMPNS, error = "
+                   << GetSocketErrorCode();
+    }
+#endif  // defined(__linux__)
+    ring_.reset(new IoCache(options->ring_size()));
+    // The receiver polls and implements the timeout itself.
+    timeout_us_ = options->timeout_us();
+    // Entries are kept once the file is closed so that they are reported, and
+    // are shared if the same input is opened again.
+    telemetry_id_ = Telemetry::Register(Telemetry::Category::kFile,
+                                        "UdpFile receive " + file_name());
+  }
+
   socket_ = new_socket.release();
+
+  if (ring_) {
+    receiver_exited_.reset(new absl::Notification);
+    if (!WorkStealingExecutor::Io()->PostBlockingTask(
+            [this]() { ReceiveLoop(); })) {
+      LOG(ERROR) << "Failed to start the receiver of " << file_name()
+                 << ". Increase --num_io_threads.";
+      receiver_exited_.reset();
+      ring_.reset();
+      close(socket_);
+      socket_ = INVALID_SOCKET;
+      return false;
+    }
+  }
   return true;
 }
 
@@ -7,7 +7,9 @@
 #ifndef MEDIA_FILE_UDP_FILE_H_
 #define MEDIA_FILE_UDP_FILE_H_
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <string>
 
 #if defined(OS_WIN)
@@ -17,14 +19,39 @@
 typedef int SOCKET;
 #endif  // defined(OS_WIN)
 
+#include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
+
 #include <packager/file.h>
 #include <packager/macros/classes.h>
 
 namespace shaka {
 
+class IoCache;
+
 /// Implements UdpFile, which receives UDP unicast and multicast streams.
 class UdpFile : public File {
  public:
+  /// Statistics of the dedicated receive thread, which is used if the
+  /// ring_size UDP option is set.
+  struct Stats {
+    uint64_t datagrams_received = 0;
+    uint64_t bytes_received = 0;
+    /// Number of receive system calls. Several datagrams are received per
+    /// call with recvmmsg on Linux.
+    uint64_t receive_calls = 0;
+    /// Number of datagrams dropped by the kernel because the socket receive
+    /// buffer was full (SO_RXQ_OVFL). Only available on Linux.
+    uint64_t datagrams_dropped = 0;
+    /// Number of places in the stream where datagrams were dropped.
+    uint64_t num_gaps = 0;
+    /// Receive time of the last datagram, and the longest interval between two
+    /// consecutive datagrams, in microseconds. The kernel receive timestamps
+    /// are used on Linux.
+    int64_t last_receive_time_us = 0;
+    int64_t max_receive_interval_us = 0;
+  };
+
   /// @param file_name C string containing the address of the stream to receive.
   ///        It should be of the form "<ip_address>:<port>".
   explicit UdpFile(const char* address_and_port);
@@ -41,13 +68,42 @@ class UdpFile : public File {
   bool Tell(uint64_t* position) override;
   /// @}
 
+  /// @return The receive statistics. All zeros if the ring_size UDP option is
+  ///         not set. The datagrams, bytes and drops are also recorded in the
+  ///         pipeline telemetry, under "UdpFile receive" followed by the
+  ///         file name.
+  Stats GetStats();
+
  protected:
   ~UdpFile() override;
 
   bool Open() override;
 
  private:
+  // Drains the socket into |ring_| until stopped or a receive error occurs.
+  void ReceiveLoop();
+  // Waits for |socket| to be readable. Returns false if the receiver is
+  // stopped, or on error or timeout, in which case |error| is set.
+  bool WaitForDatagrams(SOCKET socket, int64_t* error);
+  void RecordDatagram(uint64_t size,
+                      int64_t receive_time_us,
+                      uint32_t drop_count);
+  void StopReceiver();
+
   SOCKET socket_;
+  std::unique_ptr<IoCache> ring_;
+  std::unique_ptr<absl::Notification> receiver_exited_;
+  std::atomic<bool> receiver_stopping_{false};
+  std::atomic<int64_t> receive_error_{0};
+  // Last value of the kernel drop counter. Only used by the receiver.
+  uint32_t last_drop_count_ = 0;
+  // Receive timeout of the receiver, 0 if none.
+  int64_t timeout_us_ = 0;
+  // The receiver records the datagrams, bytes and drops of this input in a
+  // telemetry entry of its own.
+  uint32_t telemetry_id_;
+  absl::Mutex stats_mutex_;
+  Stats stats_ ABSL_GUARDED_BY(stats_mutex_);
 #if defined(OS_WIN)
   // For Winsock in Windows.
   bool wsa_started_ = false;
@@ -0,0 +1,214 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/udp_file.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/flags/declare.h>
+#include <gtest/gtest.h>
+
+#include <packager/flag_saver.h>
+#include <packager/utils/telemetry.h>
+
+ABSL_DECLARE_FLAG(uint64_t, io_cache_size);
+
+namespace shaka {
+
+namespace {
+
+const char kLoopbackAddress[] = "127.0.0.1";
+const size_t kDatagramSize = 1000;
+const size_t kReadBufferSize = 65536;
+const std::chrono::milliseconds kReadTimeout(5000);
+
+// Sends datagrams to the loopback address.
+class UdpSender {
+ public:
+  UdpSender() : socket_(socket(AF_INET, SOCK_DGRAM, 0)) {}
+  ~UdpSender() { close(socket_); }
+
+  bool Send(uint16_t port, const std::string& datagram) {
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    inet_pton(AF_INET, kLoopbackAddress, &address.sin_addr);
+    return sendto(socket_, datagram.data(), datagram.size(), 0,
+                  reinterpret_cast<struct sockaddr*>(&address),
+                  sizeof(address)) == static_cast<ssize_t>(datagram.size());
+  }
+
+ private:
+  int socket_;
+};
+
+// @return A port which was free when called.
+uint16_t GetFreePort() {
+  const int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  inet_pton(AF_INET, kLoopbackAddress, &address.sin_addr);
+  bind(sock, reinterpret_cast<struct sockaddr*>(&address), sizeof(address));
+  socklen_t address_size = sizeof(address);
+  getsockname(sock, reinterpret_cast<struct sockaddr*>(&address),
+              &address_size);
+  close(sock);
+  return ntohs(address.sin_port);
+}
+
+}  // namespace
+
+class UdpFileTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    port_ = GetFreePort();
+
+    // Use UdpFile directly without ThreadedIoFile.
+    backup_io_cache_size_.reset(new FlagSaver<uint64_t>(&FLAGS_io_cache_size));
+    absl::SetFlag(&FLAGS_io_cache_size, 0);
+  }
+
+  void TearDown() override {
+    if (file_) {
+      ASSERT_TRUE(file_->Close());
+    }
+  }
+
+  void Open(const std::string& options) {
+    const std::string file_name =
+        "udp://" + std::string(kLoopbackAddress) + ":" +
+        std::to_string(port_) + "?" + options;
+    file_ = static_cast<UdpFile*>(File::Open(file_name.c_str(), "r"));
+    ASSERT_TRUE(file_);
+  }
+
+  // Reads the bytes of the datagrams received so far, until |done| returns
+  // true or |timeout| passed.
+  template <typename Predicate>
+  void ReadUntil(Predicate done,
+                 std::chrono::milliseconds timeout = kReadTimeout) {
+    std::vector<uint8_t> buffer(kReadBufferSize);
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+      const UdpFile::Stats stats = file_->GetStats();
+      // Never blocks, as the received datagrams are written to the ring.
+      if (bytes_read_ < stats.bytes_received) {
+        const int64_t result = file_->Read(buffer.data(), buffer.size());
+        if (result <= 0)
+          break;
+        bytes_read_ += result;
+      } else if (done(stats)) {
+        break;
+      } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+  }
+
+  std::unique_ptr<FlagSaver<uint64_t>> backup_io_cache_size_;
+  uint16_t port_ = 0;
+  uint64_t bytes_read_ = 0;
+  UdpFile* file_ = nullptr;
+  UdpSender sender_;
+};
+
+TEST_F(UdpFileTest, ReceivesOnRing) {
+  ASSERT_NO_FATAL_FAILURE(Open("ring_size=100000"));
+
+  const size_t kNumDatagrams = 10;
+  for (size_t i = 0; i < kNumDatagrams; ++i) {
+    ASSERT_TRUE(sender_.Send(port_, std::string(kDatagramSize, 'a' + i)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  ReadUntil([](const UdpFile::Stats& stats) {
+    return stats.datagrams_received == kNumDatagrams;
+  });
+
+  const UdpFile::Stats stats = file_->GetStats();
+  EXPECT_EQ(kNumDatagrams * kDatagramSize, bytes_read_);
+  EXPECT_EQ(kNumDatagrams, stats.datagrams_received);
+  EXPECT_EQ(kNumDatagrams * kDatagramSize, stats.bytes_received);
+  EXPECT_GE(stats.receive_calls, 1u);
+  EXPECT_LE(stats.receive_calls, kNumDatagrams);
+  EXPECT_EQ(0u, stats.datagrams_dropped);
+  EXPECT_EQ(0u, stats.num_gaps);
+  EXPECT_GT(stats.last_receive_time_us, 0);
+  EXPECT_GE(stats.max_receive_interval_us, 1000);
+}
+
+TEST_F(UdpFileTest, RecordsTelemetryPerInput) {
+  Telemetry::Enable();
+  ASSERT_NO_FATAL_FAILURE(Open("ring_size=100000"));
+
+  ASSERT_TRUE(sender_.Send(port_, std::string(kDatagramSize, 'a')));
+  ReadUntil([](const UdpFile::Stats& stats) {
+    return stats.datagrams_received == 1;
+  });
+
+  // The entry is named after the input, so that inputs are reported apart.
+  const std::string name = "UdpFile receive " + file_->file_name();
+  uint64_t bytes = 0;
+  for (const PipelineStats::Entry& entry : Telemetry::GetStats().entries) {
+    if (entry.name == name)
+      bytes += entry.bytes;
+  }
+  EXPECT_EQ(kDatagramSize, bytes);
+}
+
+#if defined(__linux__)
+TEST_F(UdpFileTest, CountsKernelDrops) {
+  // The ring holds a couple of datagrams and the socket buffer a few more, so
+  // the kernel drops datagrams until the ring is read.
+  ASSERT_NO_FATAL_FAILURE(Open("ring_size=2048&buffer_size=8192"));
+
+  const size_t kNumDatagrams = 200;
+  for (size_t i = 0; i < kNumDatagrams; ++i)
+    ASSERT_TRUE(sender_.Send(port_, std::string(kDatagramSize, 'x')));
+  // Drain the socket. The drops are only reported with the next datagram
+  // received.
+  ReadUntil([](const UdpFile::Stats&) { return false; },
+            std::chrono::milliseconds(300));
+  ASSERT_TRUE(sender_.Send(port_, std::string(kDatagramSize, 'y')));
+  ReadUntil([](const UdpFile::Stats& stats) {
+    return stats.datagrams_received + stats.datagrams_dropped >
+           kNumDatagrams;
+  });
+
+  const UdpFile::Stats stats = file_->GetStats();
+  EXPECT_GT(stats.datagrams_dropped, 0u);
+  EXPECT_GE(stats.num_gaps, 1u);
+  EXPECT_LE(stats.num_gaps, stats.datagrams_dropped);
+  EXPECT_EQ(kNumDatagrams + 1, stats.datagrams_received +
+                                   stats.datagrams_dropped);
+}
+#endif  // defined(__linux__)
+
+TEST_F(UdpFileTest, CloseWakesUpReceiver) {
+  ASSERT_NO_FATAL_FAILURE(Open("ring_size=100000"));
+
+  const auto start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(file_->Close());
+  file_ = nullptr;
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+}
+
+TEST_F(UdpFileTest, TimesOutOnRing) {
+  ASSERT_NO_FATAL_FAILURE(Open("ring_size=100000&timeout=50000"));
+
+  std::vector<uint8_t> buffer(kReadBufferSize);
+  EXPECT_EQ(-1, file_->Read(buffer.data(), buffer.size()));
+}
+
+}  // namespace shaka
@@ -32,6 +32,7 @@ enum FieldType {
   kInterfaceAddressField,
   kMulticastSourceField,
   kReuseField,
+  kRingSizeField,
   kTimeoutField,
 };
 
@@ -44,6 +45,7 @@ const FieldNameToTypeMapping kFieldNameTypeMappings[] = {
     {"buffer_size", kBufferSizeField},
     {"interface", kInterfaceAddressField},
     {"reuse", kReuseField},
+    {"ring_size", kRingSizeField},
     {"source", kMulticastSourceField},
     {"timeout", kTimeoutField},
 };
@@ -117,6 +119,13 @@ std::unique_ptr<UdpOptions> UdpOptions::ParseFromString(
           options->reuse_ = reuse_value > 0;
           break;
         }
+        case kRingSizeField:
+          if (!absl::SimpleAtoi(pair.second, &options->ring_size_)) {
+            LOG(ERROR) << "Invalid udp option for ring_size field "
+                       << pair.second;
+            return nullptr;
+          }
+          break;
         case kTimeoutField:
           if (!absl::SimpleAtoi(pair.second, &options->timeout_us_)) {
             LOG(ERROR) << "Invalid udp option for timeout field "
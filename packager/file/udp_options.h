@@ -30,6 +30,7 @@ class UdpOptions {
     return is_source_specific_multicast_;
   }
   int buffer_size() const { return buffer_size_; }
+  uint64_t ring_size() const { return ring_size_; }
 
  private:
   UdpOptions() = default;
@@ -51,6 +52,9 @@ class UdpOptions {
   // by the underlying operating system ('sysctl net.core.rmem_max' on Linux
   // returns the maximum receive memory size).
   int buffer_size_ = 0;
+  // Size in bytes of the ring into which a dedicated thread drains the socket.
+  // 0 to receive on the reading thread instead.
+  uint64_t ring_size_ = 0;
 };
 
 }  // namespace shaka
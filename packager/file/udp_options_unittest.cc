@@ -130,4 +130,15 @@ TEST_F(UdpOptionsTest, BufferSize) {
   EXPECT_EQ(1234, options->buffer_size());
 }
 
+TEST_F(UdpOptionsTest, RingSize) {
+  auto options =
+      UdpOptions::ParseFromString("224.1.2.30:88?ring_size=67108864");
+  ASSERT_TRUE(options);
+  EXPECT_EQ(67108864u, options->ring_size());
+}
+
+TEST_F(UdpOptionsTest, InvalidRingSize) {
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?ring_size=-1"));
+}
+
 }  // namespace shaka
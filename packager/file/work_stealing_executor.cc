@@ -0,0 +1,276 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/work_stealing_executor.h>
+
+#include <algorithm>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/time/time.h>
+
+namespace shaka {
+
+namespace {
+
+const absl::Duration kMaxThreadIdleTime = absl::Minutes(10);
+
+std::atomic<size_t> g_num_cpu_workers{0};
+std::atomic<size_t> g_num_io_workers{0};
+
+// The executor and worker index of the current thread, if it is a worker.
+thread_local const WorkStealingExecutor* t_executor = nullptr;
+thread_local size_t t_worker_index = 0;
+
+size_t DefaultNumWorkers() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+}  // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(size_t num_workers,
+                                           size_t max_blocking_threads)
+    : num_workers_(num_workers > 0 ? num_workers : DefaultNumWorkers()),
+      max_blocking_threads_limit_(max_blocking_threads) {}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  {
+    absl::MutexLock lock(&idle_mutex_);
+    stopping_ = true;
+    task_available_.SignalAll();
+  }
+  for (auto& worker : workers_)
+    worker->thread.join();
+
+  absl::MutexLock lock(&blocking_mutex_);
+  blocking_terminated_ = true;
+  while (!blocking_tasks_.empty())
+    blocking_tasks_.pop();
+  blocking_task_available_.SignalAll();
+  while (num_blocking_threads_ > 0)
+    blocking_thread_exited_.Wait(&blocking_mutex_);
+}
+
+void WorkStealingExecutor::PostTask(Task task) {
+  // An empty task is used internally to signal the thread to terminate.  This
+  // should never be sent on input.
+  if (!task) {
+    DLOG(ERROR) << "Should not post an empty task!";
+    return;
+  }
+
+  std::call_once(start_workers_once_, &WorkStealingExecutor::StartWorkers,
+                 this);
+
+  // Tasks posted from a worker stay on that worker unless they are stolen.
+  const size_t index = t_executor == this
+                           ? t_worker_index
+                           : next_worker_.fetch_add(1) % num_workers_;
+  {
+    absl::MutexLock lock(&workers_[index]->mutex);
+    workers_[index]->tasks.push_back(std::move(task));
+  }
+
+  absl::MutexLock lock(&idle_mutex_);
+  ++num_queued_tasks_;
+  if (num_idle_workers_ > 0)
+    task_available_.Signal();
+}
+
+bool WorkStealingExecutor::PostBlockingTask(Task task) {
+  absl::MutexLock lock(&blocking_mutex_);
+
+  DCHECK(!blocking_terminated_) << "Should not post after destruction!";
+  if (blocking_terminated_)
+    return false;
+
+  if (!task) {
+    DLOG(ERROR) << "Should not post an empty task!";
+    return false;
+  }
+
+  if (num_idle_blocking_threads_ > blocking_tasks_.size()) {
+    // We have enough threads available.
+    blocking_tasks_.push(std::move(task));
+    blocking_task_available_.Signal();
+  } else {
+    // We need to start an additional thread.
+    if (max_blocking_threads_limit_ > 0 &&
+        num_blocking_threads_ >= max_blocking_threads_limit_) {
+      VLOG(1) << "All " << max_blocking_threads_limit_
+              << " blocking threads are busy.";
+      return false;
+    }
+    blocking_tasks_.push(std::move(task));
+    ++num_blocking_threads_;
+    max_blocking_threads_ = std::max(max_blocking_threads_,
+                                     num_blocking_threads_);
+    std::thread thread(&WorkStealingExecutor::BlockingThreadMain, this);
+    thread.detach();
+  }
+  return true;
+}
+
+void WorkStealingExecutor::ReserveBlockingThreads(size_t num_threads) {
+  absl::MutexLock lock(&blocking_mutex_);
+  if (max_blocking_threads_limit_ == 0)
+    return;
+  // The idle threads which are not about to pick up a queued task are free.
+  const size_t num_free_threads =
+      num_idle_blocking_threads_ > blocking_tasks_.size()
+          ? num_idle_blocking_threads_ - blocking_tasks_.size()
+          : 0;
+  const size_t num_busy_threads = num_blocking_threads_ - num_free_threads;
+  if (max_blocking_threads_limit_ < num_busy_threads + num_threads) {
+    VLOG(1) << "Raising the limit on blocking threads from "
+            << max_blocking_threads_limit_ << " to "
+            << num_busy_threads + num_threads << ".";
+    max_blocking_threads_limit_ = num_busy_threads + num_threads;
+  }
+}
+
+WorkStealingExecutor::Stats WorkStealingExecutor::GetStats() const {
+  Stats stats;
+  stats.num_workers = num_workers_;
+  stats.tasks_run = tasks_run_.load();
+  stats.tasks_stolen = tasks_stolen_.load();
+  {
+    absl::MutexLock lock(&idle_mutex_);
+    stats.queue_depth = num_queued_tasks_;
+  }
+  absl::MutexLock lock(&blocking_mutex_);
+  stats.num_blocking_threads = num_blocking_threads_;
+  stats.max_blocking_threads = max_blocking_threads_;
+  stats.blocking_tasks_run = blocking_tasks_run_;
+  return stats;
+}
+
+// static
+void WorkStealingExecutor::SetDefaultNumWorkers(size_t num_cpu_workers,
+                                                size_t num_io_workers) {
+  g_num_cpu_workers = num_cpu_workers;
+  g_num_io_workers = num_io_workers;
+}
+
+// The process-wide executors are never destroyed, as their detached blocking
+// threads may still be running during static destruction.
+
+// static
+WorkStealingExecutor* WorkStealingExecutor::Cpu() {
+  static WorkStealingExecutor* executor =
+      new WorkStealingExecutor(g_num_cpu_workers, g_num_cpu_workers);
+  return executor;
+}
+
+// static
+WorkStealingExecutor* WorkStealingExecutor::Io() {
+  static WorkStealingExecutor* executor =
+      new WorkStealingExecutor(g_num_io_workers, g_num_io_workers);
+  return executor;
+}
+
+void WorkStealingExecutor::StartWorkers() {
+  workers_.reserve(num_workers_);
+  for (size_t i = 0; i < num_workers_; ++i)
+    workers_.emplace_back(new Worker);
+  for (size_t i = 0; i < num_workers_; ++i) {
+    workers_[i]->thread =
+        std::thread(&WorkStealingExecutor::WorkerMain, this, i);
+  }
+}
+
+void WorkStealingExecutor::WorkerMain(size_t index) {
+  t_executor = this;
+  t_worker_index = index;
+
+  while (true) {
+    {
+      absl::MutexLock lock(&idle_mutex_);
+      while (num_queued_tasks_ == 0 && !stopping_) {
+        ++num_idle_workers_;
+        task_available_.Wait(&idle_mutex_);
+        --num_idle_workers_;
+      }
+      // Queued tasks are run before stopping.
+      if (num_queued_tasks_ == 0)
+        return;
+      // Claim one of the queued tasks. It is pushed to a deque before being
+      // counted, so there is always one for each claim.
+      --num_queued_tasks_;
+    }
+
+    Task task;
+    while (!TakeTask(index, &task))
+      std::this_thread::yield();
+    task();
+    ++tasks_run_;
+  }
+}
+
+bool WorkStealingExecutor::TakeTask(size_t index, Task* task) {
+  {
+    Worker* worker = workers_[index].get();
+    absl::MutexLock lock(&worker->mutex);
+    if (!worker->tasks.empty()) {
+      *task = std::move(worker->tasks.back());
+      worker->tasks.pop_back();
+      return true;
+    }
+  }
+  for (size_t i = 1; i < num_workers_; ++i) {
+    Worker* victim = workers_[(index + i) % num_workers_].get();
+    absl::MutexLock lock(&victim->mutex);
+    if (!victim->tasks.empty()) {
+      *task = std::move(victim->tasks.front());
+      victim->tasks.pop_front();
+      ++tasks_stolen_;
+      return true;
+    }
+  }
+  return false;
+}
+
+WorkStealingExecutor::Task WorkStealingExecutor::WaitForBlockingTask() {
+  absl::MutexLock lock(&blocking_mutex_);
+
+  // Wait for a task, up to the maximum idle time.
+  const absl::Time deadline = absl::Now() + kMaxThreadIdleTime;
+  ++num_idle_blocking_threads_;
+  while (blocking_tasks_.empty() && !blocking_terminated_) {
+    if (blocking_task_available_.WaitWithDeadline(&blocking_mutex_, deadline))
+      break;
+  }
+  --num_idle_blocking_threads_;
+
+  if (blocking_terminated_ || blocking_tasks_.empty()) {
+    // The executor is terminated or there was no work before the timeout.
+    // Terminate this thread.
+    --num_blocking_threads_;
+    blocking_thread_exited_.SignalAll();
+    return Task();
+  }
+
+  // Get the next task from the queue.
+  Task task = std::move(blocking_tasks_.front());
+  blocking_tasks_.pop();
+  ++blocking_tasks_run_;
+  return task;
+}
+
+void WorkStealingExecutor::BlockingThreadMain() {
+  while (true) {
+    auto task = WaitForBlockingTask();
+    if (!task) {
+      // An empty task signals the thread to terminate.
+      return;
+    }
+
+    // Run the task, then loop to wait for another.
+    task();
+  }
+}
+
+}  // namespace shaka
@@ -0,0 +1,156 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_WORK_STEALING_EXECUTOR_H_
+#define PACKAGER_FILE_WORK_STEALING_EXECUTOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
+#include <packager/macros/classes.h>
+
+namespace shaka {
+
+/// An executor with two lanes:
+///
+/// - Short, non-blocking tasks posted with PostTask() run on a fixed number of
+///   workers. Each worker has its own deque. A worker runs the most recently
+///   posted task from its own deque first and, when it has nothing left,
+///   steals the oldest task from another worker. A task posted from a worker
+///   goes to that worker's deque, so related work stays on the same core.
+/// - Long-running tasks that may block on other tasks, such as a job running
+///   a whole pipeline or the receive loop of a UdpFile, are posted with
+///   PostBlockingTask(). They cannot share a fixed number of workers without
+///   risking a deadlock, so each one gets a thread of its own. The number of
+///   those threads is not limited unless a limit is given. Threads are reused between blocking tasks and exit when idle for too
+///   long.
+///
+/// The process-wide CPU and I/O executors are available through Cpu() and
+/// Io().
+class WorkStealingExecutor {
+ public:
+  typedef std::function<void()> Task;
+
+  struct Stats {
+    /// Number of workers for short tasks.
+    size_t num_workers = 0;
+    /// Number of short tasks waiting to be run.
+    size_t queue_depth = 0;
+    /// Number of short tasks run so far.
+    uint64_t tasks_run = 0;
+    /// Number of short tasks run by a worker other than the one they were
+    /// posted to.
+    uint64_t tasks_stolen = 0;
+    /// Number of threads currently owned by the blocking lane.
+    size_t num_blocking_threads = 0;
+    /// Highest value of |num_blocking_threads| so far.
+    size_t max_blocking_threads = 0;
+    /// Number of blocking tasks run so far.
+    uint64_t blocking_tasks_run = 0;
+  };
+
+  /// @param num_workers is the number of workers for short tasks. 0 means one
+  ///        per hardware thread. Workers are only started on the first call to
+  ///        PostTask().
+  /// @param max_blocking_threads is the maximum number of threads running
+  ///        blocking tasks. 0 means no limit.
+  WorkStealingExecutor(size_t num_workers, size_t max_blocking_threads);
+
+  /// Runs the remaining short tasks and waits for the blocking tasks to
+  /// return before returning.
+  ~WorkStealingExecutor();
+
+  /// Queue a short task which should not block on other tasks.
+  void PostTask(Task task);
+
+  /// Run a potentially long-running or blocking task on a thread of its own.
+  /// @return false if all the blocking threads are busy and no more can be
+  ///         started, in which case @a task is not run.
+  bool PostBlockingTask(Task task);
+
+  /// Raise the limit on the blocking threads, if any, so that
+  /// @a num_threads more blocking tasks can be started in addition to the
+  /// ones running or queued, e.g. for tasks which must all run at the same
+  /// time.
+  void ReserveBlockingThreads(size_t num_threads);
+
+  Stats GetStats() const;
+
+  size_t num_workers() const { return num_workers_; }
+
+  /// Set the number of workers of the process-wide executors. Only effective
+  /// if called before the first call to Cpu() or Io(). 0 keeps the default.
+  /// A number set here also limits the blocking threads of the executor.
+  /// With 0, the default, the blocking threads are not limited.
+  static void SetDefaultNumWorkers(size_t num_cpu_workers,
+                                   size_t num_io_workers);
+
+  /// @return The process-wide executor for CPU-bound work, such as jobs.
+  static WorkStealingExecutor* Cpu();
+
+  /// @return The process-wide executor for file and network I/O.
+  static WorkStealingExecutor* Io();
+
+ private:
+  struct Worker {
+    absl::Mutex mutex;
+    std::deque<Task> tasks ABSL_GUARDED_BY(mutex);
+    std::thread thread;
+  };
+
+  void StartWorkers();
+  void WorkerMain(size_t index);
+  // Pop a task from the back of the deque of worker |index|, or steal one from
+  // the front of another worker's deque.
+  bool TakeTask(size_t index, Task* task);
+
+  Task WaitForBlockingTask();
+  void BlockingThreadMain();
+
+  const size_t num_workers_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::once_flag start_workers_once_;
+  std::atomic<size_t> next_worker_{0};
+
+  // Wakes up idle workers. |num_queued_tasks_| is the sum of the sizes of all
+  // the worker deques.
+  mutable absl::Mutex idle_mutex_;
+  absl::CondVar task_available_;
+  size_t num_queued_tasks_ ABSL_GUARDED_BY(idle_mutex_) = 0;
+  size_t num_idle_workers_ ABSL_GUARDED_BY(idle_mutex_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(idle_mutex_) = false;
+
+  std::atomic<uint64_t> tasks_run_{0};
+  std::atomic<uint64_t> tasks_stolen_{0};
+
+  // Blocking lane.
+  mutable absl::Mutex blocking_mutex_;
+  absl::CondVar blocking_task_available_;
+  absl::CondVar blocking_thread_exited_;
+  std::queue<Task> blocking_tasks_ ABSL_GUARDED_BY(blocking_mutex_);
+  size_t num_idle_blocking_threads_ ABSL_GUARDED_BY(blocking_mutex_) = 0;
+  size_t num_blocking_threads_ ABSL_GUARDED_BY(blocking_mutex_) = 0;
+  size_t max_blocking_threads_ ABSL_GUARDED_BY(blocking_mutex_) = 0;
+  size_t max_blocking_threads_limit_ ABSL_GUARDED_BY(blocking_mutex_);
+  uint64_t blocking_tasks_run_ ABSL_GUARDED_BY(blocking_mutex_) = 0;
+  bool blocking_terminated_ ABSL_GUARDED_BY(blocking_mutex_) = false;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingExecutor);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_WORK_STEALING_EXECUTOR_H_
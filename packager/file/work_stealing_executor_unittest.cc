@@ -0,0 +1,160 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/work_stealing_executor.h>
+
+#include <atomic>
+
+#include <absl/synchronization/blocking_counter.h>
+#include <absl/synchronization/notification.h>
+#include <absl/time/clock.h>
+#include <gtest/gtest.h>
+
+namespace shaka {
+
+namespace {
+const size_t kNumWorkers = 4;
+const size_t kNoBlockingThreadLimit = 0;
+}  // namespace
+
+TEST(WorkStealingExecutorTest, RunsAllTasks) {
+  const int kNumTasks = 1000;
+  std::atomic<int> sum{0};
+  absl::BlockingCounter done(kNumTasks);
+
+  WorkStealingExecutor executor(kNumWorkers, kNoBlockingThreadLimit);
+  for (int i = 0; i < kNumTasks; ++i) {
+    executor.PostTask([i, &sum, &done]() {
+      sum += i;
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+
+  EXPECT_EQ(kNumTasks * (kNumTasks - 1) / 2, sum);
+  const WorkStealingExecutor::Stats stats = executor.GetStats();
+  EXPECT_EQ(kNumWorkers, stats.num_workers);
+  EXPECT_EQ(0u, stats.queue_depth);
+}
+
+TEST(WorkStealingExecutorTest, RunsQueuedTasksOnDestruction) {
+  const int kNumTasks = 100;
+  std::atomic<int> count{0};
+  {
+    WorkStealingExecutor executor(kNumWorkers, kNoBlockingThreadLimit);
+    for (int i = 0; i < kNumTasks; ++i)
+      executor.PostTask([&count]() { ++count; });
+  }
+  EXPECT_EQ(kNumTasks, count);
+}
+
+TEST(WorkStealingExecutorTest, IdleWorkersStealFromBusyWorker) {
+  const int kNumSubtasks = 64;
+  absl::BlockingCounter done(kNumSubtasks);
+  absl::Notification release;
+
+  WorkStealingExecutor executor(kNumWorkers, kNoBlockingThreadLimit);
+  // The subtasks are all posted to the deque of the worker running the parent
+  // task, which stays busy until they are done, so the others must steal.
+  executor.PostTask([&]() {
+    for (int i = 0; i < kNumSubtasks; ++i) {
+      executor.PostTask([&done]() { done.DecrementCount(); });
+    }
+    release.WaitForNotification();
+  });
+  done.Wait();
+  release.Notify();
+
+  // The parent task may have been stolen too.
+  EXPECT_GE(executor.GetStats().tasks_stolen,
+            static_cast<uint64_t>(kNumSubtasks));
+}
+
+TEST(WorkStealingExecutorTest, BlockingTasksDoNotStarveEachOther) {
+  // More mutually dependent tasks than workers.
+  const int kNumTasks = 3 * kNumWorkers;
+  std::atomic<int> num_started{0};
+  absl::Notification all_started;
+  absl::BlockingCounter done(kNumTasks);
+
+  WorkStealingExecutor executor(kNumWorkers, kNoBlockingThreadLimit);
+  for (int i = 0; i < kNumTasks; ++i) {
+    executor.PostBlockingTask([&]() {
+      if (++num_started == kNumTasks)
+        all_started.Notify();
+      all_started.WaitForNotification();
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+
+  const WorkStealingExecutor::Stats stats = executor.GetStats();
+  EXPECT_EQ(static_cast<uint64_t>(kNumTasks), stats.blocking_tasks_run);
+  EXPECT_EQ(static_cast<size_t>(kNumTasks), stats.max_blocking_threads);
+}
+
+TEST(WorkStealingExecutorTest, ReusesIdleBlockingThreads) {
+  const int kNumTasks = 10;
+  WorkStealingExecutor executor(kNumWorkers, kNoBlockingThreadLimit);
+  for (int i = 0; i < kNumTasks; ++i) {
+    absl::Notification done;
+    executor.PostBlockingTask([&done]() { done.Notify(); });
+    done.WaitForNotification();
+    // Give the thread time to be idle again.
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+  EXPECT_EQ(static_cast<uint64_t>(kNumTasks),
+            executor.GetStats().blocking_tasks_run);
+  EXPECT_EQ(1u, executor.GetStats().max_blocking_threads);
+}
+
+TEST(WorkStealingExecutorTest, FailsBlockingTasksOverLimit) {
+  const size_t kMaxBlockingThreads = 2;
+  absl::Notification release;
+  absl::BlockingCounter done(kMaxBlockingThreads);
+
+  WorkStealingExecutor executor(kNumWorkers, kMaxBlockingThreads);
+  for (size_t i = 0; i < kMaxBlockingThreads; ++i) {
+    EXPECT_TRUE(executor.PostBlockingTask([&]() {
+      release.WaitForNotification();
+      done.DecrementCount();
+    }));
+  }
+  EXPECT_FALSE(executor.PostBlockingTask([]() {}));
+  release.Notify();
+  done.Wait();
+
+  // The threads are reused once idle.
+  absl::SleepFor(absl::Milliseconds(10));
+  absl::Notification reused;
+  EXPECT_TRUE(executor.PostBlockingTask([&reused]() { reused.Notify(); }));
+  reused.WaitForNotification();
+  EXPECT_EQ(kMaxBlockingThreads, executor.GetStats().max_blocking_threads);
+}
+
+TEST(WorkStealingExecutorTest, ReservesBlockingThreads) {
+  const size_t kMaxBlockingThreads = 1;
+  const size_t kNumReservedThreads = 2;
+  absl::Notification release;
+  absl::BlockingCounter done(kMaxBlockingThreads + kNumReservedThreads);
+  auto task = [&]() {
+    release.WaitForNotification();
+    done.DecrementCount();
+  };
+
+  WorkStealingExecutor executor(kNumWorkers, kMaxBlockingThreads);
+  EXPECT_TRUE(executor.PostBlockingTask(task));
+  EXPECT_FALSE(executor.PostBlockingTask([]() {}));
+  // The reserved threads come in addition to the busy one.
+  executor.ReserveBlockingThreads(kNumReservedThreads);
+  for (size_t i = 0; i < kNumReservedThreads; ++i)
+    EXPECT_TRUE(executor.PostBlockingTask(task));
+  EXPECT_FALSE(executor.PostBlockingTask([]() {}));
+  release.Notify();
+  done.Wait();
+}
+
+}  // namespace shaka
@@ -22,6 +22,7 @@
 #include <packager/hls/base/media_playlist.h>
 #include <packager/hls/base/tag.h>
 #include <packager/macros/logging.h>
+#include <packager/utils/telemetry.h>
 #include <packager/version/version.h>
 
 #include "packager/kv_pairs/kv_pairs.h"
@@ -636,6 +637,9 @@ bool MasterPlaylist::WriteMasterPlaylist(
   if (content == written_playlist_)
     return true;
 
+  static const uint32_t telemetry_id = Telemetry::Register(
+      Telemetry::Category::kManifest, "HLS master playlist write");
+  ScopedTelemetry telemetry(telemetry_id, 1, content.size());
   auto file_path = std::filesystem::u8path(output_dir) / file_name_;
   if (!File::WriteFileAtomically(file_path.string().c_str(), content)) {
     LOG(ERROR) << "Failed to write master playlist to: " << file_path.string();
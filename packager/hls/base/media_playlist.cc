@@ -170,6 +170,14 @@ std::string CreatePlaylistHeader(
 HlsEntry::HlsEntry(HlsEntry::EntryType type) : type_(type) {}
 HlsEntry::~HlsEntry() {}
 
+const std::string& HlsEntry::GetCachedString() {
+  if (!cached_string_valid_) {
+    cached_string_ = ToString();
+    cached_string_valid_ = true;
+  }
+  return cached_string_;
+}
+
 class SegmentInfoEntry : public HlsEntry {
  public:
   // If |use_byte_range| true then this will append EXT-X-BYTERANGE
@@ -191,6 +199,7 @@ class SegmentInfoEntry : public HlsEntry {
   double duration_seconds() const { return duration_seconds_; }
   void set_duration_seconds(double duration_seconds) {
     duration_seconds_ = duration_seconds;
+    InvalidateCachedString();
   }
 
  private:
@@ -526,8 +535,10 @@ bool MediaPlaylist::WriteToFile(const std::filesystem::path& file_path,
       media_sequence_number_, discontinuity_sequence_number_,
       hls_params_.start_time_offset);
 
-  for (const auto& entry : entries_)
-    absl::StrAppendFormat(&content, "%s\n", entry->ToString().c_str());
+  for (const auto& entry : entries_) {
+    content.append(entry->GetCachedString());
+    content.append("\n");
+  }
 
   if (playlist_type == HlsPlaylistType::kVod) {
     content += "#EXT-X-ENDLIST\n";
@@ -40,11 +40,21 @@ class HlsEntry {
   EntryType type() const { return type_; }
   virtual std::string ToString() = 0;
 
+  /// @return The result of ToString(), which is cached until the entry is
+  ///         modified, so that live playlists only format their new entries
+  ///         when they are written again.
+  const std::string& GetCachedString();
+
  protected:
   explicit HlsEntry(EntryType type);
 
+  /// Must be called by subclasses when the result of ToString() changes.
+  void InvalidateCachedString() { cached_string_valid_ = false; }
+
  private:
   EntryType type_;
+  std::string cached_string_;
+  bool cached_string_valid_ = false;
 };
 
 /// Methods are virtual for mocking.
@@ -9,6 +9,7 @@
 #include <cmath>
 #include <filesystem>
 #include <optional>
+#include <utility>
 
 #include <absl/flags/flag.h>
 #include <absl/log/check.h>
@@ -17,11 +18,13 @@
 #include <absl/strings/numbers.h>
 
 #include <packager/file/file_util.h>
+#include <packager/file/work_stealing_executor.h>
 #include <packager/hls/base/master_playlist.h>
 #include <packager/media/base/protection_system_ids.h>
 #include <packager/media/base/protection_system_specific_info.h>
 #include <packager/media/base/proto_json_util.h>
 #include <packager/media/base/widevine_pssh_data.pb.h>
+#include <packager/utils/telemetry.h>
 
 ABSL_FLAG(bool,
           enable_legacy_widevine_hls_signaling,
@@ -42,6 +45,11 @@ const char kUriFairPlayPrefix[] = "skd://";
 const char kWidevineDashIfIopUUID[] =
     "urn:uuid:edef8ba9-79d6-4ace-a3c8-27dcd51d21ed";
 
+// How long the playlist writer waits after an update before writing, so that
+// the segments which all the streams produce at about the same time result in
+// a single write of the master playlist.
+const absl::Duration kPlaylistWriteDelay = absl::Milliseconds(50);
+
 bool IsWidevineSystemId(const std::vector<uint8_t>& system_id) {
   return system_id.size() == std::size(media::kWidevineSystemId) &&
          std::equal(system_id.begin(), system_id.end(),
@@ -251,6 +259,9 @@ bool WriteMediaPlaylist(const std::string& output_dir,
                         MediaPlaylist* playlist,
                         const bool event_to_vod_on_end_of_stream,
                         const bool end_stream) {
+  static const uint32_t telemetry_id = Telemetry::Register(
+      Telemetry::Category::kManifest, "HLS media playlist write");
+  ScopedTelemetry telemetry(telemetry_id, 1, 0);
   auto file_path = std::filesystem::u8path(output_dir) / playlist->file_name();
   if (!playlist->WriteToFile(file_path, event_to_vod_on_end_of_stream,
                              end_stream)) {
@@ -300,9 +311,31 @@ SimpleHlsNotifier::SimpleHlsNotifier(const HlsParams& hls_params)
       hls_params.is_independent_segments, hls_params.create_session_keys));
 }
 
-SimpleHlsNotifier::~SimpleHlsNotifier() {}
+SimpleHlsNotifier::~SimpleHlsNotifier() {
+  if (!playlist_writer_exited_)
+    return;
+  {
+    absl::MutexLock lock(&lock_);
+    stop_playlist_writer_ = true;
+    playlist_updated_.Signal();
+  }
+  // Pending updates are written before the writer exits.
+  playlist_writer_exited_->WaitForNotification();
+}
 
 bool SimpleHlsNotifier::Init() {
+  if (IsLive() && !playlist_writer_exited_) {
+    playlist_writer_exited_.reset(new absl::Notification);
+    if (!WorkStealingExecutor::Io()->PostBlockingTask([this]() {
+          PlaylistWriterLoop();
+          playlist_writer_exited_->Notify();
+        })) {
+      LOG(ERROR) << "Failed to start the playlist writer. Increase "
+                    "--num_io_threads.";
+      playlist_writer_exited_.reset();
+      return false;
+    }
+  }
   return true;
 }
 
@@ -371,6 +404,10 @@ bool SimpleHlsNotifier::NotifyNewSegment(uint32_t stream_id,
                                          uint64_t start_byte_offset,
                                          uint64_t size) {
   absl::MutexLock lock(&lock_);
+  if (playlist_write_failed_) {
+    LOG(ERROR) << "Failed to write playlists.";
+    return false;
+  }
   auto stream_iterator = stream_map_.find(stream_id);
   if (stream_iterator == stream_map_.end()) {
     LOG(ERROR) << "Cannot find stream with ID: " << stream_id;
@@ -392,29 +429,21 @@ bool SimpleHlsNotifier::NotifyNewSegment(uint32_t stream_id,
     target_duration_updated = true;
   }
 
-  // Update the playlists when there is new segments in live mode.
-  if (hls_params().playlist_type == HlsPlaylistType::kLive ||
-      hls_params().playlist_type == HlsPlaylistType::kEvent) {
+  // Update the playlists when there is new segments in live mode. They are
+  // written by PlaylistWriterLoop().
+  if (IsLive()) {
     // Update all playlists if target duration is updated.
     if (target_duration_updated) {
       for (MediaPlaylist* playlist : media_playlists_) {
         playlist->SetTargetDuration(target_duration_);
-        if (!WriteMediaPlaylist(master_playlist_dir_, playlist,
-                                hls_params().event_to_vod_on_end_of_stream,
-                                end_stream))
-          return false;
+        updated_playlists_.insert(playlist);
       }
     } else {
-      if (!WriteMediaPlaylist(master_playlist_dir_, media_playlist.get(),
-                              hls_params().event_to_vod_on_end_of_stream,
-                              end_stream))
-        return false;
-    }
-    if (!master_playlist_->WriteMasterPlaylist(
-            hls_params().base_url, master_playlist_dir_, media_playlists_)) {
-      LOG(ERROR) << "Failed to write master playlist.";
-      return false;
+      updated_playlists_.insert(media_playlist.get());
     }
+    master_playlist_updated_ = true;
+    ++num_playlist_updates_;
+    playlist_updated_.Signal();
   }
   return true;
 }
@@ -538,11 +567,14 @@ bool SimpleHlsNotifier::NotifyEncryptionUpdate(
 }
 
 bool SimpleHlsNotifier::NotifyEndOfStream() {
+  absl::MutexLock lock(&lock_);
   end_stream = true;
   return true;
 }
 
 bool SimpleHlsNotifier::Flush() {
+  WaitForPlaylistWrites();
+
   absl::MutexLock lock(&lock_);
   for (MediaPlaylist* playlist : media_playlists_) {
     if (hls_params().per_playlist_target_duration) {
@@ -564,5 +596,69 @@ bool SimpleHlsNotifier::Flush() {
   return true;
 }
 
+bool SimpleHlsNotifier::IsLive() const {
+  return hls_params().playlist_type == HlsPlaylistType::kLive ||
+         hls_params().playlist_type == HlsPlaylistType::kEvent;
+}
+
+void SimpleHlsNotifier::PlaylistWriterLoop() {
+  while (true) {
+    std::vector<MediaPlaylist*> playlists;
+    bool write_master_playlist = false;
+    uint64_t num_updates = 0;
+    {
+      absl::MutexLock lock(&lock_);
+      while (num_playlist_updates_ == num_playlist_updates_written_ &&
+             !stop_playlist_writer_) {
+        playlist_updated_.Wait(&lock_);
+      }
+      if (num_playlist_updates_ == num_playlist_updates_written_)
+        return;
+      // Let the updates of the other streams accumulate.
+      lock_.AwaitWithTimeout(absl::Condition(&stop_playlist_writer_),
+                             kPlaylistWriteDelay);
+      // Write in the order the streams were added.
+      for (MediaPlaylist* playlist : media_playlists_) {
+        if (updated_playlists_.count(playlist) > 0)
+          playlists.push_back(playlist);
+      }
+      updated_playlists_.clear();
+      std::swap(write_master_playlist, master_playlist_updated_);
+      num_updates = num_playlist_updates_;
+    }
+
+    // The lock is released between the playlists, so that the muxers are not
+    // blocked for the duration of all the writes.
+    bool success = true;
+    for (MediaPlaylist* playlist : playlists) {
+      absl::MutexLock lock(&lock_);
+      success &= WriteMediaPlaylist(master_playlist_dir_, playlist,
+                                    hls_params().event_to_vod_on_end_of_stream,
+                                    end_stream);
+    }
+
+    absl::MutexLock lock(&lock_);
+    if (write_master_playlist &&
+        !master_playlist_->WriteMasterPlaylist(
+            hls_params().base_url, master_playlist_dir_, media_playlists_)) {
+      LOG(ERROR) << "Failed to write master playlist.";
+      success = false;
+    }
+    if (!success)
+      playlist_write_failed_ = true;
+    num_playlist_updates_written_ = num_updates;
+    playlists_written_.SignalAll();
+  }
+}
+
+void SimpleHlsNotifier::WaitForPlaylistWrites() {
+  if (!playlist_writer_exited_)
+    return;
+  absl::MutexLock lock(&lock_);
+  const uint64_t num_updates = num_playlist_updates_;
+  while (num_playlist_updates_written_ < num_updates)
+    playlists_written_.Wait(&lock_);
+}
+
 }  // namespace hls
 }  // namespace shaka
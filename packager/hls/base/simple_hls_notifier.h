@@ -11,10 +11,12 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
 #include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
 
 #include <packager/hls/base/hls_notifier.h>
 #include <packager/hls/base/master_playlist.h>
@@ -37,6 +39,10 @@ class MediaPlaylistFactory {
 };
 
 /// This is thread safe.
+/// In live and event mode, the playlists are written by a background task
+/// rather than by the threads calling NotifyNewSegment(). Updates that arrive
+/// while a write is pending are coalesced, so each playlist is written once
+/// for any number of new segments.
 class SimpleHlsNotifier : public HlsNotifier {
  public:
   /// @param hls_params contains parameters for setting up the notifier.
@@ -87,6 +93,13 @@ class SimpleHlsNotifier : public HlsNotifier {
     MediaPlaylist::EncryptionMethod encryption_method;
   };
 
+  bool IsLive() const;
+  // Runs in the background in live and event mode, writing the playlists
+  // updated by NotifyNewSegment().
+  void PlaylistWriterLoop();
+  // Blocks until the playlist updates made so far have been written.
+  void WaitForPlaylistWrites();
+
   std::string master_playlist_dir_;
   int32_t target_duration_ = 0;
   bool end_stream = false;
@@ -103,6 +116,19 @@ class SimpleHlsNotifier : public HlsNotifier {
   absl::Mutex lock_;
   absl::Time reference_time_ = absl::InfinitePast();
 
+  // Playlist updates waiting to be written by PlaylistWriterLoop().
+  std::set<MediaPlaylist*> updated_playlists_;
+  bool master_playlist_updated_ = false;
+  // The number of updates made, and the number of updates written.
+  uint64_t num_playlist_updates_ = 0;
+  uint64_t num_playlist_updates_written_ = 0;
+  bool playlist_write_failed_ = false;
+  bool stop_playlist_writer_ = false;
+  absl::CondVar playlist_updated_;
+  absl::CondVar playlists_written_;
+  // Set if the playlist writer is started, and notified when it exits.
+  std::unique_ptr<absl::Notification> playlist_writer_exited_;
+
   DISALLOW_COPY_AND_ASSIGN(SimpleHlsNotifier);
 };
 
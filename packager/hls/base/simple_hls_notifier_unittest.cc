@@ -126,6 +126,10 @@ class SimpleHlsNotifierTest : public ::testing::Test {
     return notifier.stream_map_.size();
   }
 
+  void WaitForPlaylistWrites(SimpleHlsNotifier* notifier) {
+    notifier->WaitForPlaylistWrites();
+  }
+
   uint32_t SetupStream(const std::string& protection_scheme,
                        MockMediaPlaylist* mock_media_playlist,
                        SimpleHlsNotifier* notifier) {
@@ -680,6 +684,49 @@ TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegment) {
 
   EXPECT_TRUE(notifier.NotifyNewSegment(stream_id, segment_name, kStartTime,
                                         kDuration, 0, kSize));
+  WaitForPlaylistWrites(&notifier);
+}
+
+TEST_P(LiveOrEventSimpleHlsNotifierTest, PlaylistWriteFailure) {
+  std::unique_ptr<MockMasterPlaylist> mock_master_playlist(
+      new MockMasterPlaylist());
+  std::unique_ptr<MockMediaPlaylistFactory> factory(
+      new MockMediaPlaylistFactory());
+
+  // Pointer released by SimpleHlsNotifier.
+  MockMediaPlaylist* mock_media_playlist =
+      new MockMediaPlaylist("playlist.m3u8", "", "");
+
+  EXPECT_CALL(*mock_media_playlist, SetMediaInfo(_)).WillOnce(Return(true));
+  EXPECT_CALL(*factory, CreateMock(_, _, _, _))
+      .WillOnce(Return(mock_media_playlist));
+  EXPECT_CALL(*mock_media_playlist, AddSegment(_, _, _, _, _)).Times(1);
+  EXPECT_CALL(*mock_media_playlist, GetLongestSegmentDuration())
+      .WillOnce(Return(10.0));
+  EXPECT_CALL(*mock_media_playlist, SetTargetDuration(10)).Times(1);
+  EXPECT_CALL(*mock_media_playlist, WriteToFile(_, _, _))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*mock_master_playlist, WriteMasterPlaylist(_, _, _))
+      .WillOnce(Return(true));
+
+  hls_params_.playlist_type = GetParam();
+  SimpleHlsNotifier notifier(hls_params_);
+  InjectMasterPlaylist(std::move(mock_master_playlist), &notifier);
+  InjectMediaPlaylistFactory(std::move(factory), &notifier);
+  EXPECT_TRUE(notifier.Init());
+  MediaInfo media_info;
+  uint32_t stream_id;
+  EXPECT_TRUE(notifier.NotifyNewStream(media_info, "playlist.m3u8", "name",
+                                       "groupid", &stream_id));
+
+  EXPECT_TRUE(notifier.NotifyNewSegment(stream_id, "segment_name",
+                                        kAnyStartTime, kAnyDuration, 0,
+                                        kAnySize));
+  WaitForPlaylistWrites(&notifier);
+  // The failure is reported on the next segment.
+  EXPECT_FALSE(notifier.NotifyNewSegment(stream_id, "segment_name",
+                                         kAnyStartTime + kAnyDuration,
+                                         kAnyDuration, 0, kAnySize));
 }
 
 TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegmentsWithMultipleStreams) {
@@ -731,13 +778,13 @@ TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegmentsWithMultipleStreams) {
   // SetTargetDuration and update all playlists as target duration is updated.
   EXPECT_CALL(*mock_media_playlist1, SetTargetDuration(kTargetDuration))
       .Times(1);
+  EXPECT_CALL(*mock_media_playlist2, SetTargetDuration(kTargetDuration))
+      .Times(1);
   EXPECT_CALL(*mock_media_playlist1,
               WriteToFile(Eq((std::filesystem::u8path(kAnyOutputDir) /
                               "playlist1.m3u8")),
                           Eq(false), Eq(false)))
       .WillOnce(Return(true));
-  EXPECT_CALL(*mock_media_playlist2, SetTargetDuration(kTargetDuration))
-      .Times(1);
   EXPECT_CALL(*mock_media_playlist2,
               WriteToFile(Eq((std::filesystem::u8path(kAnyOutputDir) /
                               "playlist2.m3u8")),
@@ -750,6 +797,7 @@ TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegmentsWithMultipleStreams) {
       .WillOnce(Return(true));
   EXPECT_TRUE(notifier.NotifyNewSegment(stream_id1, "segment_name", kStartTime,
                                         kDuration, 0, kSize));
+  WaitForPlaylistWrites(&notifier);
 
   EXPECT_CALL(*mock_media_playlist2, AddSegment(_, _, _, _, _)).Times(1);
   EXPECT_CALL(*mock_media_playlist2, GetLongestSegmentDuration())
@@ -764,6 +812,7 @@ TEST_P(LiveOrEventSimpleHlsNotifierTest, NotifyNewSegmentsWithMultipleStreams) {
       .WillOnce(Return(true));
   EXPECT_TRUE(notifier.NotifyNewSegment(stream_id2, "segment_name", kStartTime,
                                         kDuration, 0, kSize));
+  WaitForPlaylistWrites(&notifier);
 }
 
 INSTANTIATE_TEST_CASE_P(PlaylistTypes,
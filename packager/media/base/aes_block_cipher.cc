@@ -0,0 +1,156 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/aes_block_cipher.h>
+
+#include <cstring>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <mbedtls/aes.h>
+
+#include <packager/macros/classes.h>
+#include <packager/macros/crypto.h>
+#include <packager/media/base/aes_block_cipher_internal.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const uint8_t kSbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b,
+    0xfe, 0xd7, 0xab, 0x76, 0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
+    0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0, 0xb7, 0xfd, 0x93, 0x26,
+    0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2,
+    0xeb, 0x27, 0xb2, 0x75, 0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0,
+    0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84, 0x53, 0xd1, 0x00, 0xed,
+    0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f,
+    0x50, 0x3c, 0x9f, 0xa8, 0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5,
+    0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2, 0xcd, 0x0c, 0x13, 0xec,
+    0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14,
+    0xde, 0x5e, 0x0b, 0xdb, 0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c,
+    0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79, 0xe7, 0xc8, 0x37, 0x6d,
+    0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f,
+    0x4b, 0xbd, 0x8b, 0x8a, 0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e,
+    0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e, 0xe1, 0xf8, 0x98, 0x11,
+    0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f,
+    0xb0, 0x54, 0xbb, 0x16};
+
+// Portable implementation on top of mbedtls.
+class MbedtlsBlockCipher : public AesBlockCipher {
+ public:
+  MbedtlsBlockCipher() { mbedtls_aes_init(&aes_ctx_); }
+  ~MbedtlsBlockCipher() override { mbedtls_aes_free(&aes_ctx_); }
+
+  Backend backend() const override { return kMbedtlsBackend; }
+
+  bool SetKey(const uint8_t* key,
+              size_t key_size,
+              Direction direction) override {
+    const unsigned int key_bits = static_cast<unsigned int>(8 * key_size);
+    const int result =
+        direction == kEncrypt
+            ? mbedtls_aes_setkey_enc(&aes_ctx_, key, key_bits)
+            : mbedtls_aes_setkey_dec(&aes_ctx_, key, key_bits);
+    if (result != 0)
+      return false;
+    mode_ = direction == kEncrypt ? MBEDTLS_AES_ENCRYPT : MBEDTLS_AES_DECRYPT;
+    return true;
+  }
+
+  void CryptBlocks(const uint8_t* input,
+                   size_t num_blocks,
+                   uint8_t* output) override {
+    for (size_t i = 0; i < num_blocks; ++i) {
+      CHECK_EQ(mbedtls_aes_crypt_ecb(&aes_ctx_, mode_, input, output), 0);
+      input += AES_BLOCK_SIZE;
+      output += AES_BLOCK_SIZE;
+    }
+  }
+
+  void CbcCryptBlocks(const uint8_t* input,
+                      size_t num_blocks,
+                      uint8_t* output,
+                      uint8_t* iv) override {
+    CHECK_EQ(mbedtls_aes_crypt_cbc(&aes_ctx_, mode_,
+                                   num_blocks * AES_BLOCK_SIZE, iv, input,
+                                   output),
+             0);
+  }
+
+ private:
+  mbedtls_aes_context aes_ctx_;
+  int mode_ = MBEDTLS_AES_ENCRYPT;
+
+  DISALLOW_COPY_AND_ASSIGN(MbedtlsBlockCipher);
+};
+
+}  // namespace
+
+namespace internal {
+
+int ExpandAesKey(const uint8_t* key, size_t key_size, uint8_t* round_keys) {
+  if (key_size != 16 && key_size != 24 && key_size != 32)
+    return 0;
+
+  const size_t key_words = key_size / 4;
+  const int num_rounds = static_cast<int>(key_words) + 6;
+  const size_t total_words = 4 * (num_rounds + 1);
+
+  memcpy(round_keys, key, key_size);
+  uint8_t rcon = 1;
+  for (size_t i = key_words; i < total_words; ++i) {
+    uint8_t temp[4];
+    memcpy(temp, round_keys + 4 * (i - 1), sizeof(temp));
+    if (i % key_words == 0) {
+      // RotWord, SubWord and Rcon.
+      const uint8_t first = temp[0];
+      temp[0] = kSbox[temp[1]] ^ rcon;
+      temp[1] = kSbox[temp[2]];
+      temp[2] = kSbox[temp[3]];
+      temp[3] = kSbox[first];
+      rcon = static_cast<uint8_t>((rcon << 1) ^ ((rcon & 0x80) ? 0x1b : 0));
+    } else if (key_words > 6 && i % key_words == 4) {
+      for (uint8_t& byte : temp)
+        byte = kSbox[byte];
+    }
+    for (size_t j = 0; j < 4; ++j) {
+      round_keys[4 * i + j] = round_keys[4 * (i - key_words) + j] ^ temp[j];
+    }
+  }
+  return num_rounds;
+}
+
+}  // namespace internal
+
+std::unique_ptr<AesBlockCipher> AesBlockCipher::Create(Backend backend) {
+  switch (backend) {
+    case kAutoBackend: {
+      std::unique_ptr<AesBlockCipher> cipher =
+          internal::CreateAesNiBlockCipher();
+      if (!cipher)
+        cipher = internal::CreateArmv8BlockCipher();
+      if (!cipher)
+        cipher.reset(new MbedtlsBlockCipher);
+      return cipher;
+    }
+    case kMbedtlsBackend:
+      return std::unique_ptr<AesBlockCipher>(new MbedtlsBlockCipher);
+    case kAesNiBackend:
+      return internal::CreateAesNiBlockCipher();
+    case kArmv8Backend:
+      return internal::CreateArmv8BlockCipher();
+  }
+  return nullptr;
+}
+
+}  // namespace media
+}  // namespace shaka
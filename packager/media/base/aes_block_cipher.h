@@ -0,0 +1,74 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_AES_BLOCK_CIPHER_H_
+#define PACKAGER_MEDIA_BASE_AES_BLOCK_CIPHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace shaka {
+namespace media {
+
+/// Raw AES block cipher used by the AesCryptor implementations. The backend is
+/// selected at runtime based on CPU features: AES-NI on x86-64 and the ARMv8
+/// Cryptography Extensions on arm64, with mbedtls as the portable fallback.
+class AesBlockCipher {
+ public:
+  enum Direction {
+    kEncrypt,
+    kDecrypt,
+  };
+
+  enum Backend {
+    /// Pick the fastest backend supported by the running CPU.
+    kAutoBackend,
+    kMbedtlsBackend,
+    kAesNiBackend,
+    kArmv8Backend,
+  };
+
+  virtual ~AesBlockCipher() = default;
+
+  /// Create a block cipher.
+  /// @param backend specifies the implementation to use.
+  /// @return the block cipher, or nullptr if @a backend is not supported in
+  ///         this build or on the running CPU.
+  static std::unique_ptr<AesBlockCipher> Create(Backend backend);
+
+  /// @return The backend that implements this cipher.
+  virtual Backend backend() const = 0;
+
+  /// Set the key for subsequent operations.
+  /// @param key_size is the key size in bytes: 16, 24 or 32.
+  /// @param direction indicates whether the cipher encrypts or decrypts.
+  /// @return true on success, false if the key size is invalid.
+  virtual bool SetKey(const uint8_t* key,
+                      size_t key_size,
+                      Direction direction) = 0;
+
+  /// Encrypt or decrypt, depending on the key direction, @a num_blocks
+  /// independent 16-byte blocks, i.e. in ECB mode. @a input and @a output can
+  /// point to the same address.
+  virtual void CryptBlocks(const uint8_t* input,
+                           size_t num_blocks,
+                           uint8_t* output) = 0;
+
+  /// Encrypt or decrypt, depending on the key direction, @a num_blocks 16-byte
+  /// blocks in CBC mode. @a input and @a output can point to the same address.
+  /// @param iv points to the 16-byte chaining value. It is updated to the last
+  ///        ciphertext block so the chain continues in the next call.
+  virtual void CbcCryptBlocks(const uint8_t* input,
+                              size_t num_blocks,
+                              uint8_t* output,
+                              uint8_t* iv) = 0;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_AES_BLOCK_CIPHER_H_
@@ -0,0 +1,219 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// ARMv8 Cryptography Extensions implementation of AesBlockCipher. This file is
+// compiled with -march=armv8-a+crypto on arm64 (see CMakeLists.txt). Nothing
+// in here runs unless the OS reports AES support.
+
+#include <packager/media/base/aes_block_cipher_internal.h>
+
+#if (defined(__aarch64__) || defined(_M_ARM64)) &&                     \
+    (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES) || \
+     defined(_MSC_VER))
+#define AES_BLOCK_CIPHER_ARMV8 1
+#endif
+
+#if defined(AES_BLOCK_CIPHER_ARMV8)
+
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#elif defined(OS_WIN)
+#include <windows.h>
+#endif
+
+#include <packager/macros/classes.h>
+#include <packager/macros/crypto.h>
+
+namespace shaka {
+namespace media {
+namespace internal {
+namespace {
+
+// Number of independent blocks in flight in the parallelizable modes, to hide
+// the latency of the AES round instructions.
+const size_t kParallelBlocks = 4;
+
+bool CpuHasArmv8Aes() {
+#if defined(__linux__)
+  // HWCAP_AES from <asm/hwcap.h>, which is not available on all toolchains.
+  const unsigned long kHwcapAes = 1 << 3;
+  return (getauxval(AT_HWCAP) & kHwcapAes) != 0;
+#elif defined(__APPLE__)
+  // All Apple arm64 CPUs support the Crypto Extensions.
+  return true;
+#elif defined(OS_WIN)
+  return IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE);
+#else
+  return false;
+#endif
+}
+
+class Armv8BlockCipher : public AesBlockCipher {
+ public:
+  Armv8BlockCipher() = default;
+
+  Backend backend() const override { return kArmv8Backend; }
+
+  bool SetKey(const uint8_t* key,
+              size_t key_size,
+              Direction direction) override {
+    uint8_t round_keys[(kMaxAesRounds + 1) * AES_BLOCK_SIZE];
+    num_rounds_ = ExpandAesKey(key, key_size, round_keys);
+    if (num_rounds_ == 0)
+      return false;
+    direction_ = direction;
+
+    for (int i = 0; i <= num_rounds_; ++i) {
+      const uint8x16_t round_key = vld1q_u8(round_keys + i * AES_BLOCK_SIZE);
+      if (direction == kEncrypt) {
+        round_keys_[i] = round_key;
+      } else if (i == 0 || i == num_rounds_) {
+        // Equivalent inverse cipher (FIPS-197 section 5.3.5): the round keys
+        // are used in reverse order, with InvMixColumns applied to all but
+        // the first and last.
+        round_keys_[num_rounds_ - i] = round_key;
+      } else {
+        round_keys_[num_rounds_ - i] = vaesimcq_u8(round_key);
+      }
+    }
+    return true;
+  }
+
+  void CryptBlocks(const uint8_t* input,
+                   size_t num_blocks,
+                   uint8_t* output) override {
+    for (; num_blocks >= kParallelBlocks; num_blocks -= kParallelBlocks) {
+      uint8x16_t blocks[kParallelBlocks];
+      for (size_t i = 0; i < kParallelBlocks; ++i)
+        blocks[i] = vld1q_u8(input + i * AES_BLOCK_SIZE);
+      CryptParallel(blocks);
+      for (size_t i = 0; i < kParallelBlocks; ++i)
+        vst1q_u8(output + i * AES_BLOCK_SIZE, blocks[i]);
+      input += kParallelBlocks * AES_BLOCK_SIZE;
+      output += kParallelBlocks * AES_BLOCK_SIZE;
+    }
+    for (; num_blocks > 0; --num_blocks) {
+      vst1q_u8(output, CryptBlock(vld1q_u8(input)));
+      input += AES_BLOCK_SIZE;
+      output += AES_BLOCK_SIZE;
+    }
+  }
+
+  void CbcCryptBlocks(const uint8_t* input,
+                      size_t num_blocks,
+                      uint8_t* output,
+                      uint8_t* iv) override {
+    uint8x16_t chain = vld1q_u8(iv);
+    if (direction_ == kEncrypt) {
+      // CBC encryption is inherently serial.
+      for (; num_blocks > 0; --num_blocks) {
+        chain = CryptBlock(veorq_u8(vld1q_u8(input), chain));
+        vst1q_u8(output, chain);
+        input += AES_BLOCK_SIZE;
+        output += AES_BLOCK_SIZE;
+      }
+    } else {
+      // CBC decryption is parallelizable. All the ciphertext blocks are loaded
+      // before storing, so in-place decryption works.
+      for (; num_blocks >= kParallelBlocks; num_blocks -= kParallelBlocks) {
+        uint8x16_t ciphertext[kParallelBlocks];
+        uint8x16_t blocks[kParallelBlocks];
+        for (size_t i = 0; i < kParallelBlocks; ++i)
+          blocks[i] = ciphertext[i] = vld1q_u8(input + i * AES_BLOCK_SIZE);
+        CryptParallel(blocks);
+        vst1q_u8(output, veorq_u8(blocks[0], chain));
+        for (size_t i = 1; i < kParallelBlocks; ++i) {
+          vst1q_u8(output + i * AES_BLOCK_SIZE,
+                   veorq_u8(blocks[i], ciphertext[i - 1]));
+        }
+        chain = ciphertext[kParallelBlocks - 1];
+        input += kParallelBlocks * AES_BLOCK_SIZE;
+        output += kParallelBlocks * AES_BLOCK_SIZE;
+      }
+      for (; num_blocks > 0; --num_blocks) {
+        const uint8x16_t ciphertext = vld1q_u8(input);
+        vst1q_u8(output, veorq_u8(CryptBlock(ciphertext), chain));
+        chain = ciphertext;
+        input += AES_BLOCK_SIZE;
+        output += AES_BLOCK_SIZE;
+      }
+    }
+    vst1q_u8(iv, chain);
+  }
+
+ private:
+  // AESE/AESD perform AddRoundKey before SubBytes/ShiftRows, so the round keys
+  // are applied one step earlier than in the AES-NI formulation, with the last
+  // round key XORed in at the end.
+  uint8x16_t CryptBlock(uint8x16_t block) const {
+    if (direction_ == kEncrypt) {
+      for (int round = 0; round < num_rounds_ - 1; ++round)
+        block = vaesmcq_u8(vaeseq_u8(block, round_keys_[round]));
+      block = vaeseq_u8(block, round_keys_[num_rounds_ - 1]);
+    } else {
+      for (int round = 0; round < num_rounds_ - 1; ++round)
+        block = vaesimcq_u8(vaesdq_u8(block, round_keys_[round]));
+      block = vaesdq_u8(block, round_keys_[num_rounds_ - 1]);
+    }
+    return veorq_u8(block, round_keys_[num_rounds_]);
+  }
+
+  void CryptParallel(uint8x16_t* blocks) const {
+    if (direction_ == kEncrypt) {
+      for (int round = 0; round < num_rounds_ - 1; ++round) {
+        for (size_t i = 0; i < kParallelBlocks; ++i)
+          blocks[i] = vaesmcq_u8(vaeseq_u8(blocks[i], round_keys_[round]));
+      }
+      for (size_t i = 0; i < kParallelBlocks; ++i)
+        blocks[i] = vaeseq_u8(blocks[i], round_keys_[num_rounds_ - 1]);
+    } else {
+      for (int round = 0; round < num_rounds_ - 1; ++round) {
+        for (size_t i = 0; i < kParallelBlocks; ++i)
+          blocks[i] = vaesimcq_u8(vaesdq_u8(blocks[i], round_keys_[round]));
+      }
+      for (size_t i = 0; i < kParallelBlocks; ++i)
+        blocks[i] = vaesdq_u8(blocks[i], round_keys_[num_rounds_ - 1]);
+    }
+    for (size_t i = 0; i < kParallelBlocks; ++i)
+      blocks[i] = veorq_u8(blocks[i], round_keys_[num_rounds_]);
+  }
+
+  uint8x16_t round_keys_[kMaxAesRounds + 1];
+  int num_rounds_ = 0;
+  Direction direction_ = kEncrypt;
+
+  DISALLOW_COPY_AND_ASSIGN(Armv8BlockCipher);
+};
+
+}  // namespace
+
+std::unique_ptr<AesBlockCipher> CreateArmv8BlockCipher() {
+  static const bool supported = CpuHasArmv8Aes();
+  if (!supported)
+    return nullptr;
+  return std::unique_ptr<AesBlockCipher>(new Armv8BlockCipher);
+}
+
+}  // namespace internal
+}  // namespace media
+}  // namespace shaka
+
+#else  // !defined(AES_BLOCK_CIPHER_ARMV8)
+
+namespace shaka {
+namespace media {
+namespace internal {
+
+std::unique_ptr<AesBlockCipher> CreateArmv8BlockCipher() {
+  return nullptr;
+}
+
+}  // namespace internal
+}  // namespace media
+}  // namespace shaka
+
+#endif  // defined(AES_BLOCK_CIPHER_ARMV8)
@@ -0,0 +1,44 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// Internal interfaces shared by the AesBlockCipher backends.
+
+#ifndef PACKAGER_MEDIA_BASE_AES_BLOCK_CIPHER_INTERNAL_H_
+#define PACKAGER_MEDIA_BASE_AES_BLOCK_CIPHER_INTERNAL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <packager/media/base/aes_block_cipher.h>
+
+namespace shaka {
+namespace media {
+namespace internal {
+
+/// Maximum number of AES rounds, used with 256-bit keys.
+const int kMaxAesRounds = 14;
+
+/// Run the AES key schedule (FIPS-197 section 5.2).
+/// @param round_keys receives (number of rounds + 1) 16-byte encryption round
+///        keys, in the byte order expected by AES-NI and the ARMv8 Crypto
+///        Extensions. It must hold at least (kMaxAesRounds + 1) * 16 bytes.
+/// @return The number of rounds, or 0 if @a key_size is invalid.
+int ExpandAesKey(const uint8_t* key, size_t key_size, uint8_t* round_keys);
+
+/// @return An AES-NI backed cipher, or nullptr if not supported in this build
+///         or on the running CPU.
+std::unique_ptr<AesBlockCipher> CreateAesNiBlockCipher();
+
+/// @return An ARMv8 Crypto Extensions backed cipher, or nullptr if not
+///         supported in this build or on the running CPU.
+std::unique_ptr<AesBlockCipher> CreateArmv8BlockCipher();
+
+}  // namespace internal
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_AES_BLOCK_CIPHER_INTERNAL_H_
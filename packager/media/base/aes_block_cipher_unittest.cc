@@ -0,0 +1,201 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/aes_block_cipher.h>
+
+#include <string>
+#include <vector>
+
+#include <absl/strings/escaping.h>
+#include <gtest/gtest.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const char kFipsPlaintextHex[] = "00112233445566778899aabbccddeeff";
+
+// FIPS-197 Appendix C example vectors.
+struct EcbTestCase {
+  const char* key_hex;
+  const char* ciphertext_hex;
+};
+
+const EcbTestCase kEcbTestCases[] = {
+    {"000102030405060708090a0b0c0d0e0f", "69c4e0d86a7b0430d8cdb78070b4c55a"},
+    {"000102030405060708090a0b0c0d0e0f1011121314151617",
+     "dda97ca4864cdfe06eaf70a0ec0d7191"},
+    {"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+     "8ea2b7ca516745bfeafc49904b496089"},
+};
+
+// NIST SP 800-38A F.2.1 CBC-AES128.Encrypt.
+const char kCbcKeyHex[] = "2b7e151628aed2a6abf7158809cf4f3c";
+const char kCbcIvHex[] = "000102030405060708090a0b0c0d0e0f";
+const char kCbcPlaintextHex[] =
+    "6bc1bee22e409f96e93d7e117393172a"
+    "ae2d8a571e03ac9c9eb76fac45af8e51"
+    "30c81c46a35ce411e5fbc1191a0a52ef"
+    "f69f2445df4f9b17ad2b417be66c3710";
+const char kCbcCiphertextHex[] =
+    "7649abac8119b246cee98e9b12e9197d"
+    "5086cb9b507219ee95db113a917678b2"
+    "73bed6b8e3c1743b7116e69e22229516"
+    "3ff1caa1681fac09120eca307586e1a7";
+
+const size_t kBlockSize = 16;
+
+std::vector<uint8_t> HexToBytes(const std::string& hex) {
+  const std::string bytes = absl::HexStringToBytes(hex);
+  return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+
+}  // namespace
+
+class AesBlockCipherTest
+    : public ::testing::TestWithParam<AesBlockCipher::Backend> {
+ public:
+  void SetUp() override {
+    cipher_ = AesBlockCipher::Create(GetParam());
+    if (!cipher_)
+      GTEST_SKIP() << "Backend not supported on this CPU.";
+  }
+
+ protected:
+  std::unique_ptr<AesBlockCipher> cipher_;
+};
+
+TEST_P(AesBlockCipherTest, Backend) {
+  if (GetParam() != AesBlockCipher::kAutoBackend) {
+    EXPECT_EQ(GetParam(), cipher_->backend());
+  }
+}
+
+TEST_P(AesBlockCipherTest, EcbFipsVectors) {
+  const std::vector<uint8_t> plaintext = HexToBytes(kFipsPlaintextHex);
+  for (const EcbTestCase& test_case : kEcbTestCases) {
+    const std::vector<uint8_t> key = HexToBytes(test_case.key_hex);
+    const std::vector<uint8_t> ciphertext =
+        HexToBytes(test_case.ciphertext_hex);
+
+    std::vector<uint8_t> output(kBlockSize);
+    ASSERT_TRUE(
+        cipher_->SetKey(key.data(), key.size(), AesBlockCipher::kEncrypt));
+    cipher_->CryptBlocks(plaintext.data(), 1, output.data());
+    EXPECT_EQ(ciphertext, output) << "key size " << key.size();
+
+    ASSERT_TRUE(
+        cipher_->SetKey(key.data(), key.size(), AesBlockCipher::kDecrypt));
+    cipher_->CryptBlocks(ciphertext.data(), 1, output.data());
+    EXPECT_EQ(plaintext, output) << "key size " << key.size();
+  }
+}
+
+TEST_P(AesBlockCipherTest, EcbMultipleBlocksInPlace) {
+  // An odd number of blocks exercises both the parallel and the serial paths.
+  const size_t kNumBlocks = 7;
+  const std::vector<uint8_t> key = HexToBytes(kEcbTestCases[0].key_hex);
+  const std::vector<uint8_t> ciphertext_block =
+      HexToBytes(kEcbTestCases[0].ciphertext_hex);
+
+  std::vector<uint8_t> text;
+  for (size_t i = 0; i < kNumBlocks; ++i) {
+    const std::vector<uint8_t> block = HexToBytes(kFipsPlaintextHex);
+    text.insert(text.end(), block.begin(), block.end());
+  }
+
+  ASSERT_TRUE(
+      cipher_->SetKey(key.data(), key.size(), AesBlockCipher::kEncrypt));
+  cipher_->CryptBlocks(text.data(), kNumBlocks, text.data());
+  for (size_t i = 0; i < kNumBlocks; ++i) {
+    EXPECT_EQ(ciphertext_block,
+              std::vector<uint8_t>(text.begin() + i * kBlockSize,
+                                   text.begin() + (i + 1) * kBlockSize));
+  }
+}
+
+TEST_P(AesBlockCipherTest, CbcNistVectors) {
+  const std::vector<uint8_t> key = HexToBytes(kCbcKeyHex);
+  const std::vector<uint8_t> plaintext = HexToBytes(kCbcPlaintextHex);
+  const std::vector<uint8_t> ciphertext = HexToBytes(kCbcCiphertextHex);
+  const size_t num_blocks = plaintext.size() / kBlockSize;
+
+  std::vector<uint8_t> iv = HexToBytes(kCbcIvHex);
+  std::vector<uint8_t> output(plaintext.size());
+  ASSERT_TRUE(
+      cipher_->SetKey(key.data(), key.size(), AesBlockCipher::kEncrypt));
+  cipher_->CbcCryptBlocks(plaintext.data(), num_blocks, output.data(),
+                          iv.data());
+  EXPECT_EQ(ciphertext, output);
+  // The chaining value is the last ciphertext block.
+  EXPECT_EQ(std::vector<uint8_t>(ciphertext.end() - kBlockSize,
+                                 ciphertext.end()),
+            iv);
+
+  // Decrypt in place, in two calls to verify chaining across calls.
+  iv = HexToBytes(kCbcIvHex);
+  output = ciphertext;
+  ASSERT_TRUE(
+      cipher_->SetKey(key.data(), key.size(), AesBlockCipher::kDecrypt));
+  cipher_->CbcCryptBlocks(output.data(), 1, output.data(), iv.data());
+  cipher_->CbcCryptBlocks(output.data() + kBlockSize, num_blocks - 1,
+                          output.data() + kBlockSize, iv.data());
+  EXPECT_EQ(plaintext, output);
+}
+
+TEST_P(AesBlockCipherTest, MatchesMbedtls) {
+  const size_t kNumBlocks = 37;
+  std::unique_ptr<AesBlockCipher> reference =
+      AesBlockCipher::Create(AesBlockCipher::kMbedtlsBackend);
+  ASSERT_TRUE(reference);
+
+  std::vector<uint8_t> input(kNumBlocks * kBlockSize);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<uint8_t>(i * 31 + 7);
+
+  for (size_t key_size : {16, 24, 32}) {
+    std::vector<uint8_t> key(key_size);
+    for (size_t i = 0; i < key_size; ++i)
+      key[i] = static_cast<uint8_t>(0xa5 ^ i);
+
+    for (AesBlockCipher::Direction direction :
+         {AesBlockCipher::kEncrypt, AesBlockCipher::kDecrypt}) {
+      ASSERT_TRUE(cipher_->SetKey(key.data(), key.size(), direction));
+      ASSERT_TRUE(reference->SetKey(key.data(), key.size(), direction));
+
+      std::vector<uint8_t> output(input.size());
+      std::vector<uint8_t> expected(input.size());
+      cipher_->CryptBlocks(input.data(), kNumBlocks, output.data());
+      reference->CryptBlocks(input.data(), kNumBlocks, expected.data());
+      EXPECT_EQ(expected, output);
+
+      std::vector<uint8_t> iv(kBlockSize, 0x3c);
+      std::vector<uint8_t> expected_iv(kBlockSize, 0x3c);
+      cipher_->CbcCryptBlocks(input.data(), kNumBlocks, output.data(),
+                              iv.data());
+      reference->CbcCryptBlocks(input.data(), kNumBlocks, expected.data(),
+                                expected_iv.data());
+      EXPECT_EQ(expected, output);
+      EXPECT_EQ(expected_iv, iv);
+    }
+  }
+}
+
+TEST_P(AesBlockCipherTest, InvalidKeySize) {
+  const std::vector<uint8_t> key(15);
+  EXPECT_FALSE(
+      cipher_->SetKey(key.data(), key.size(), AesBlockCipher::kEncrypt));
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends,
+                         AesBlockCipherTest,
+                         ::testing::Values(AesBlockCipher::kAutoBackend,
+                                           AesBlockCipher::kMbedtlsBackend,
+                                           AesBlockCipher::kAesNiBackend,
+                                           AesBlockCipher::kArmv8Backend));
+
+}  // namespace media
+}  // namespace shaka
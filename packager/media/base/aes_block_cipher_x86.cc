@@ -0,0 +1,223 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// AES-NI implementation of AesBlockCipher. This file is compiled with -maes
+// on x86-64 (see CMakeLists.txt). Nothing in here runs unless CPUID reports
+// AES-NI support.
+
+#include <packager/media/base/aes_block_cipher_internal.h>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && \
+    (defined(__AES__) || defined(_MSC_VER))
+#define AES_BLOCK_CIPHER_X86 1
+#endif
+
+#if defined(AES_BLOCK_CIPHER_X86)
+
+#include <wmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#include <packager/macros/classes.h>
+#include <packager/macros/crypto.h>
+
+namespace shaka {
+namespace media {
+namespace internal {
+namespace {
+
+// Number of independent blocks in flight in the parallelizable modes, to hide
+// the latency of the AES round instructions.
+const size_t kParallelBlocks = 4;
+
+bool CpuHasAesNi() {
+  // CPUID leaf 1, ECX bit 25.
+  const unsigned int kAesNiBit = 1u << 25;
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return (static_cast<unsigned int>(info[2]) & kAesNiBit) != 0;
+#else
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return false;
+  return (ecx & kAesNiBit) != 0;
+#endif
+}
+
+class AesNiBlockCipher : public AesBlockCipher {
+ public:
+  AesNiBlockCipher() = default;
+
+  Backend backend() const override { return kAesNiBackend; }
+
+  bool SetKey(const uint8_t* key,
+              size_t key_size,
+              Direction direction) override {
+    alignas(16) uint8_t round_keys[(kMaxAesRounds + 1) * AES_BLOCK_SIZE];
+    num_rounds_ = ExpandAesKey(key, key_size, round_keys);
+    if (num_rounds_ == 0)
+      return false;
+    direction_ = direction;
+
+    for (int i = 0; i <= num_rounds_; ++i) {
+      const __m128i round_key = _mm_load_si128(
+          reinterpret_cast<const __m128i*>(round_keys + i * AES_BLOCK_SIZE));
+      if (direction == kEncrypt) {
+        round_keys_[i] = round_key;
+      } else if (i == 0 || i == num_rounds_) {
+        // Equivalent inverse cipher (FIPS-197 section 5.3.5): the round keys
+        // are used in reverse order, with InvMixColumns applied to all but
+        // the first and last.
+        round_keys_[num_rounds_ - i] = round_key;
+      } else {
+        round_keys_[num_rounds_ - i] = _mm_aesimc_si128(round_key);
+      }
+    }
+    return true;
+  }
+
+  void CryptBlocks(const uint8_t* input,
+                   size_t num_blocks,
+                   uint8_t* output) override {
+    for (; num_blocks >= kParallelBlocks; num_blocks -= kParallelBlocks) {
+      __m128i blocks[kParallelBlocks];
+      for (size_t i = 0; i < kParallelBlocks; ++i)
+        blocks[i] = Load(input + i * AES_BLOCK_SIZE);
+      CryptParallel(blocks);
+      for (size_t i = 0; i < kParallelBlocks; ++i)
+        Store(blocks[i], output + i * AES_BLOCK_SIZE);
+      input += kParallelBlocks * AES_BLOCK_SIZE;
+      output += kParallelBlocks * AES_BLOCK_SIZE;
+    }
+    for (; num_blocks > 0; --num_blocks) {
+      Store(CryptBlock(Load(input)), output);
+      input += AES_BLOCK_SIZE;
+      output += AES_BLOCK_SIZE;
+    }
+  }
+
+  void CbcCryptBlocks(const uint8_t* input,
+                      size_t num_blocks,
+                      uint8_t* output,
+                      uint8_t* iv) override {
+    __m128i chain = Load(iv);
+    if (direction_ == kEncrypt) {
+      // CBC encryption is inherently serial.
+      for (; num_blocks > 0; --num_blocks) {
+        chain = CryptBlock(_mm_xor_si128(Load(input), chain));
+        Store(chain, output);
+        input += AES_BLOCK_SIZE;
+        output += AES_BLOCK_SIZE;
+      }
+    } else {
+      // CBC decryption is parallelizable. All the ciphertext blocks are loaded
+      // before storing, so in-place decryption works.
+      for (; num_blocks >= kParallelBlocks; num_blocks -= kParallelBlocks) {
+        __m128i ciphertext[kParallelBlocks];
+        __m128i blocks[kParallelBlocks];
+        for (size_t i = 0; i < kParallelBlocks; ++i)
+          blocks[i] = ciphertext[i] = Load(input + i * AES_BLOCK_SIZE);
+        CryptParallel(blocks);
+        Store(_mm_xor_si128(blocks[0], chain), output);
+        for (size_t i = 1; i < kParallelBlocks; ++i) {
+          Store(_mm_xor_si128(blocks[i], ciphertext[i - 1]),
+                output + i * AES_BLOCK_SIZE);
+        }
+        chain = ciphertext[kParallelBlocks - 1];
+        input += kParallelBlocks * AES_BLOCK_SIZE;
+        output += kParallelBlocks * AES_BLOCK_SIZE;
+      }
+      for (; num_blocks > 0; --num_blocks) {
+        const __m128i ciphertext = Load(input);
+        Store(_mm_xor_si128(CryptBlock(ciphertext), chain), output);
+        chain = ciphertext;
+        input += AES_BLOCK_SIZE;
+        output += AES_BLOCK_SIZE;
+      }
+    }
+    Store(chain, iv);
+  }
+
+ private:
+  static __m128i Load(const uint8_t* data) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  }
+
+  static void Store(__m128i block, uint8_t* data) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), block);
+  }
+
+  __m128i CryptBlock(__m128i block) const {
+    block = _mm_xor_si128(block, round_keys_[0]);
+    if (direction_ == kEncrypt) {
+      for (int round = 1; round < num_rounds_; ++round)
+        block = _mm_aesenc_si128(block, round_keys_[round]);
+      return _mm_aesenclast_si128(block, round_keys_[num_rounds_]);
+    }
+    for (int round = 1; round < num_rounds_; ++round)
+      block = _mm_aesdec_si128(block, round_keys_[round]);
+    return _mm_aesdeclast_si128(block, round_keys_[num_rounds_]);
+  }
+
+  void CryptParallel(__m128i* blocks) const {
+    for (size_t i = 0; i < kParallelBlocks; ++i)
+      blocks[i] = _mm_xor_si128(blocks[i], round_keys_[0]);
+    if (direction_ == kEncrypt) {
+      for (int round = 1; round < num_rounds_; ++round) {
+        for (size_t i = 0; i < kParallelBlocks; ++i)
+          blocks[i] = _mm_aesenc_si128(blocks[i], round_keys_[round]);
+      }
+      for (size_t i = 0; i < kParallelBlocks; ++i)
+        blocks[i] = _mm_aesenclast_si128(blocks[i], round_keys_[num_rounds_]);
+    } else {
+      for (int round = 1; round < num_rounds_; ++round) {
+        for (size_t i = 0; i < kParallelBlocks; ++i)
+          blocks[i] = _mm_aesdec_si128(blocks[i], round_keys_[round]);
+      }
+      for (size_t i = 0; i < kParallelBlocks; ++i)
+        blocks[i] = _mm_aesdeclast_si128(blocks[i], round_keys_[num_rounds_]);
+    }
+  }
+
+  __m128i round_keys_[kMaxAesRounds + 1];
+  int num_rounds_ = 0;
+  Direction direction_ = kEncrypt;
+
+  DISALLOW_COPY_AND_ASSIGN(AesNiBlockCipher);
+};
+
+}  // namespace
+
+std::unique_ptr<AesBlockCipher> CreateAesNiBlockCipher() {
+  static const bool supported = CpuHasAesNi();
+  if (!supported)
+    return nullptr;
+  return std::unique_ptr<AesBlockCipher>(new AesNiBlockCipher);
+}
+
+}  // namespace internal
+}  // namespace media
+}  // namespace shaka
+
+#else  // !defined(AES_BLOCK_CIPHER_X86)
+
+namespace shaka {
+namespace media {
+namespace internal {
+
+std::unique_ptr<AesBlockCipher> CreateAesNiBlockCipher() {
+  return nullptr;
+}
+
+}  // namespace internal
+}  // namespace media
+}  // namespace shaka
+
+#endif  // defined(AES_BLOCK_CIPHER_X86)
@@ -30,13 +30,9 @@ namespace shaka {
 namespace media {
 
 AesCryptor::AesCryptor(ConstantIvFlag constant_iv_flag)
-    : constant_iv_flag_(constant_iv_flag), num_crypt_bytes_(0) {
-  mbedtls_cipher_init(&cipher_ctx_);
-}
+    : constant_iv_flag_(constant_iv_flag), num_crypt_bytes_(0) {}
 
-AesCryptor::~AesCryptor() {
-  mbedtls_cipher_free(&cipher_ctx_);
-}
+AesCryptor::~AesCryptor() {}
 
 bool AesCryptor::Crypt(const std::vector<uint8_t>& text,
                        std::vector<uint8_t>* crypt_text) {
@@ -137,50 +133,26 @@ size_t AesCryptor::NumPaddingBytes(size_t size) const {
   return 0;
 }
 
-bool AesCryptor::SetupCipher(size_t key_size, CipherMode mode) {
-  mbedtls_cipher_type_t type;
-
+bool AesCryptor::SetupCipher(const std::vector<uint8_t>& key,
+                             AesBlockCipher::Direction direction) {
   // AES defines three key sizes: 128, 192 and 256 bits.
-  // NOTE: Because we use ECB mode in the CTR cryptors, this returns ECB
-  // instead of CTR.  Counters and block offsets are managed internally.
-  switch (key_size) {
-    case 16:
-      type = mode == kCtrMode ? MBEDTLS_CIPHER_AES_128_ECB
-                              : MBEDTLS_CIPHER_AES_128_CBC;
-      break;
-    case 24:
-      type = mode == kCtrMode ? MBEDTLS_CIPHER_AES_192_ECB
-                              : MBEDTLS_CIPHER_AES_192_CBC;
-      break;
-    case 32:
-      type = mode == kCtrMode ? MBEDTLS_CIPHER_AES_256_ECB
-                              : MBEDTLS_CIPHER_AES_256_CBC;
-      break;
-    default:
-      LOG(ERROR) << "Invalid AES key size: " << key_size;
-      return false;
-  }
-
-  const mbedtls_cipher_info_t* cipher_info =
-      mbedtls_cipher_info_from_type(type);
-  CHECK(cipher_info);
-
-  if (mbedtls_cipher_setup(&cipher_ctx_, cipher_info) != 0) {
-    LOG(ERROR) << "Cipher setup failed";
+  if (key.size() != 16 && key.size() != 24 && key.size() != 32) {
+    LOG(ERROR) << "Invalid AES key size: " << key.size();
     return false;
   }
 
-  // Padding mode only applies to CBC.
-  if (mode == kCbcMode) {
-    // We handle padding ourselves.  Don't let mbedtls mess with it.
-    mbedtls_cipher_padding_t cipher_padding = MBEDTLS_PADDING_NONE;
-
-    if (mbedtls_cipher_set_padding_mode(&cipher_ctx_, cipher_padding) != 0) {
-      LOG(ERROR) << "Failed to set CBC padding mode";
-      return false;
-    }
+  if (!cipher_) {
+    cipher_ = AesBlockCipher::Create(AesBlockCipher::kAutoBackend);
+    CHECK(cipher_);
   }
 
+  if (!cipher_->SetKey(key.data(), key.size(), direction)) {
+    LOG(ERROR) << "Failed to set AES "
+               << (direction == AesBlockCipher::kEncrypt ? "encryption"
+                                                         : "decryption")
+               << " key";
+    return false;
+  }
   return true;
 }
 
@@ -12,9 +12,8 @@
 #include <string>
 #include <vector>
 
-#include <mbedtls/cipher.h>
-
 #include <packager/macros/classes.h>
+#include <packager/media/base/aes_block_cipher.h>
 #include <packager/media/base/fourccs.h>
 
 namespace shaka {
@@ -82,6 +81,15 @@ class AesCryptor {
   /// This is used by encryptors only. It is a NOP if using kUseConstantIv.
   void UpdateIv();
 
+  /// Account for @a size bytes crypted with the current iv by another cryptor,
+  /// as if they were crypted by this one, so that UpdateIv() moves to the iv
+  /// following them. This is used to compute the ivs of samples crypted in
+  /// parallel. It is a NOP if using kUseConstantIv.
+  void CountCryptBytes(size_t size) {
+    if (constant_iv_flag_ != kUseConstantIv)
+      num_crypt_bytes_ += size;
+  }
+
   /// @return The current iv.
   const std::vector<uint8_t>& iv() const { return iv_; }
 
@@ -96,15 +104,14 @@ class AesCryptor {
                                std::vector<uint8_t>* iv);
 
  protected:
-  enum CipherMode {
-    kCtrMode,
-    kCbcMode,
-  };
-
-  // mbedTLS cipher context.
-  mbedtls_cipher_context_t cipher_ctx_;
-
-  bool SetupCipher(size_t key_size, CipherMode mode);
+  // Sets up |cipher_| with |key| for encryption or decryption.
+  // Return false if the key size is invalid.
+  bool SetupCipher(const std::vector<uint8_t>& key,
+                   AesBlockCipher::Direction direction);
+
+  // AES block cipher, backed by the fastest implementation supported by the
+  // running CPU. Created in SetupCipher().
+  std::unique_ptr<AesBlockCipher> cipher_;
 
  private:
   // Internal implementation of crypt function.
@@ -7,6 +7,8 @@
 #include <packager/media/base/aes_decryptor.h>
 #include <packager/media/base/aes_encryptor.h>
 
+#include <algorithm>
+#include <chrono>
 #include <iterator>
 #include <memory>
 
@@ -218,6 +220,37 @@ TEST_F(AesCtrEncryptorTest, UnsupportedIV) {
   ASSERT_FALSE(encryptor_.InitializeWithIv(key_, iv));
 }
 
+TEST_F(AesCtrEncryptorTest, LargeTextMatchesChunkedEncryption) {
+  // Large enough to span several keystream batches, with a partial block at
+  // the end.
+  const size_t kLargeTextSize = 5000;
+  const size_t kChunkSizes[] = {1, 15, 17, 1023, 16, 2049, 3};
+
+  std::vector<uint8_t> plaintext(kLargeTextSize);
+  for (size_t i = 0; i < plaintext.size(); ++i)
+    plaintext[i] = static_cast<uint8_t>(i * 7);
+
+  std::vector<uint8_t> encrypted;
+  ASSERT_TRUE(encryptor_.Crypt(plaintext, &encrypted));
+
+  ASSERT_TRUE(encryptor_.SetIv(iv_));
+  std::vector<uint8_t> encrypted_in_chunks(plaintext.size());
+  size_t offset = 0;
+  for (size_t i = 0; offset < plaintext.size(); ++i) {
+    const size_t len = std::min(kChunkSizes[i % std::size(kChunkSizes)],
+                                plaintext.size() - offset);
+    ASSERT_TRUE(encryptor_.Crypt(&plaintext[offset], len,
+                                 &encrypted_in_chunks[offset]));
+    offset += len;
+    EXPECT_EQ(offset % kAesBlockSize, encryptor_.block_offset());
+  }
+  EXPECT_EQ(encrypted, encrypted_in_chunks);
+
+  std::vector<uint8_t> decrypted;
+  ASSERT_TRUE(decryptor_.Crypt(encrypted, &decrypted));
+  EXPECT_EQ(plaintext, decrypted);
+}
+
 // Subsample test cases.
 struct SubsampleTestCase {
   const uint8_t* subsample_sizes;
@@ -664,6 +697,23 @@ class AesPerformanceTest : public ::testing::Test {
   }
 
  protected:
+  // Runs |cryptor| over |plaintext_| |kIterations| times and logs the
+  // throughput.
+  void MeasureThroughput(const std::string& name, AesCryptor* cryptor) {
+    const int kIterations = 0x100;
+    std::vector<uint8_t> encrypted;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++)
+      ASSERT_TRUE(cryptor->Crypt(plaintext_, &encrypted));
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    const double total_bytes =
+        static_cast<double>(plaintext_.size()) * kIterations;
+    LOG(INFO) << name << ": " << total_bytes / elapsed.count() / 1e9
+              << " GB/s";
+  }
+
   AesCbcEncryptor cbc_encryptor_;
   AesCtrEncryptor ctr_encryptor_;
   std::vector<uint8_t> key_;
@@ -673,16 +723,20 @@ class AesPerformanceTest : public ::testing::Test {
 
 TEST_F(AesPerformanceTest, AesCbc) {
   ASSERT_TRUE(cbc_encryptor_.InitializeWithIv(key_, iv_));
-  std::vector<uint8_t> encrypted;
-  for (int i = 0; i < 0x100; i++)
-    ASSERT_TRUE(cbc_encryptor_.Crypt(plaintext_, &encrypted));
+  MeasureThroughput("AES-CBC", &cbc_encryptor_);
 }
 
 TEST_F(AesPerformanceTest, AesCtr) {
   ASSERT_TRUE(ctr_encryptor_.InitializeWithIv(key_, iv_));
-  std::vector<uint8_t> encrypted;
-  for (int i = 0; i < 0x100; i++)
-    ASSERT_TRUE(ctr_encryptor_.Crypt(plaintext_, &encrypted));
+  MeasureThroughput("AES-CTR", &ctr_encryptor_);
+}
+
+TEST_F(AesPerformanceTest, AesCtrUnaligned) {
+  // Sample sizes are rarely a multiple of the block size. Exercise the
+  // partial leading and trailing blocks on every call.
+  plaintext_.resize(plaintext_.size() - 5);
+  ASSERT_TRUE(ctr_encryptor_.InitializeWithIv(key_, iv_));
+  MeasureThroughput("AES-CTR (unaligned)", &ctr_encryptor_);
 }
 
 }  // namespace media
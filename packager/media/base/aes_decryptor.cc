@@ -33,14 +33,7 @@ AesCbcDecryptor::~AesCbcDecryptor() {}
 
 bool AesCbcDecryptor::InitializeWithIv(const std::vector<uint8_t>& key,
                                        const std::vector<uint8_t>& iv) {
-  if (!SetupCipher(key.size(), kCbcMode)) {
-    return false;
-  }
-
-  if (mbedtls_cipher_setkey(&cipher_ctx_, key.data(),
-                            static_cast<int>(8 * key.size()),
-                            MBEDTLS_DECRYPT) != 0) {
-    LOG(ERROR) << "Failed to set CBC decryption key";
+  if (!SetupCipher(key, AesBlockCipher::kDecrypt)) {
     return false;
   }
 
@@ -168,18 +161,10 @@ void AesCbcDecryptor::CbcDecryptBlocks(const uint8_t* ciphertext,
   CHECK_EQ(ciphertext_size % AES_BLOCK_SIZE, 0u);
   CHECK_GT(ciphertext_size, 0u);
 
-  // Copy the final block of ciphertext before decryption, since we could be
-  // decrypting in-place.
-  const uint8_t* last_block = ciphertext + ciphertext_size - AES_BLOCK_SIZE;
-  std::vector<uint8_t> next_iv(last_block, last_block + AES_BLOCK_SIZE);
-
-  size_t output_size = 0;
-  CHECK_EQ(mbedtls_cipher_crypt(&cipher_ctx_, iv, AES_BLOCK_SIZE, ciphertext,
-                                ciphertext_size, plaintext, &output_size),
-           0);
-  DCHECK_EQ(output_size % AES_BLOCK_SIZE, 0u);
-
-  memcpy(iv, next_iv.data(), next_iv.size());
+  // |iv| is updated to the last ciphertext block, which the backend reads
+  // before decrypting in place.
+  cipher_->CbcCryptBlocks(ciphertext, ciphertext_size / AES_BLOCK_SIZE,
+                          plaintext, iv);
 }
 
 }  // namespace media
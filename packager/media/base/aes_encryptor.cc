@@ -6,6 +6,9 @@
 
 #include <packager/media/base/aes_encryptor.h>
 
+#include <algorithm>
+#include <cstring>
+
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
@@ -13,6 +16,11 @@
 
 namespace {
 
+// Number of counter blocks encrypted per keystream batch. 64 blocks (1KB) is
+// large enough to amortize the per-batch overhead while keeping the keystream
+// hot in L1 cache.
+const size_t kCtrBatchBlocks = 64;
+
 // Increment an 8-byte counter by 1. Return true if overflowed.
 bool Increment64(uint8_t* counter) {
   DCHECK(counter);
@@ -23,6 +31,25 @@ bool Increment64(uint8_t* counter) {
   return true;
 }
 
+// XOR |size| bytes of |input| with |keystream| into |output|, a word at a time.
+// |size| must be a multiple of AES_BLOCK_SIZE. |input| and |output| can point
+// to the same address. The loop is simple enough for the compiler to
+// vectorize.
+void XorKeystream(const uint8_t* input,
+                  const uint8_t* keystream,
+                  size_t size,
+                  uint8_t* output) {
+  DCHECK_EQ(size % AES_BLOCK_SIZE, 0u);
+  for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+    uint64_t text_word;
+    uint64_t keystream_word;
+    memcpy(&text_word, input + i, sizeof(text_word));
+    memcpy(&keystream_word, keystream + i, sizeof(keystream_word));
+    text_word ^= keystream_word;
+    memcpy(output + i, &text_word, sizeof(text_word));
+  }
+}
+
 }  // namespace
 
 namespace shaka {
@@ -33,20 +60,14 @@ namespace media {
 AesCtrEncryptor::AesCtrEncryptor()
     : AesCryptor(kDontUseConstantIv),
       block_offset_(0),
-      encrypted_counter_(AES_BLOCK_SIZE, 0) {}
+      keystream_(kCtrBatchBlocks * AES_BLOCK_SIZE, 0) {}
 
 AesCtrEncryptor::~AesCtrEncryptor() {}
 
 bool AesCtrEncryptor::InitializeWithIv(const std::vector<uint8_t>& key,
                                        const std::vector<uint8_t>& iv) {
-  if (!SetupCipher(key.size(), kCtrMode)) {
-    return false;
-  }
-
-  if (mbedtls_cipher_setkey(&cipher_ctx_, key.data(),
-                            static_cast<int>(8 * key.size()),
-                            MBEDTLS_ENCRYPT) != 0) {
-    LOG(ERROR) << "Failed to set CTR encryption key";
+  // Counter mode only ever encrypts the counter blocks.
+  if (!SetupCipher(key, AesBlockCipher::kEncrypt)) {
     return false;
   }
 
@@ -68,24 +89,35 @@ bool AesCtrEncryptor::CryptInternal(const uint8_t* plaintext,
   }
   *ciphertext_size = plaintext_size;
 
-  for (size_t i = 0; i < plaintext_size; ++i) {
-    if (block_offset_ == 0) {
-      size_t ignored_output_size;
-      CHECK_EQ(
-          mbedtls_cipher_crypt(&cipher_ctx_, /* iv= */ NULL, /* iv_len= */ 0,
-                               &counter_[0], AES_BLOCK_SIZE,
-                               &encrypted_counter_[0], &ignored_output_size),
-          0);
-
-      // As mentioned in ISO/IEC 23001-7:2016 CENC spec, of the 16 byte counter
-      // block, bytes 8 to 15 (i.e. the least significant bytes) are used as a
-      // simple 64 bit unsigned integer that is incremented by one for each
-      // subsequent block of sample data processed and is kept in network byte
-      // order.
-      Increment64(&counter_[8]);
-    }
-    ciphertext[i] = plaintext[i] ^ encrypted_counter_[block_offset_];
+  size_t offset = 0;
+
+  // Use up the keystream left over from a partial block in the previous call.
+  while (block_offset_ != 0 && offset < plaintext_size) {
+    ciphertext[offset] = plaintext[offset] ^ keystream_[block_offset_];
     block_offset_ = (block_offset_ + 1) % AES_BLOCK_SIZE;
+    ++offset;
+  }
+
+  // Process full blocks in batches.
+  while (plaintext_size - offset >= AES_BLOCK_SIZE) {
+    const size_t num_blocks = std::min(
+        (plaintext_size - offset) / AES_BLOCK_SIZE, kCtrBatchBlocks);
+    GenerateKeystream(num_blocks);
+    XorKeystream(plaintext + offset, keystream_.data(),
+                 num_blocks * AES_BLOCK_SIZE, ciphertext + offset);
+    offset += num_blocks * AES_BLOCK_SIZE;
+  }
+
+  // Trailing partial block. The rest of its keystream is kept for the next
+  // call.
+  if (offset < plaintext_size) {
+    GenerateKeystream(1);
+    while (offset < plaintext_size) {
+      ciphertext[offset] = plaintext[offset] ^ keystream_[block_offset_];
+      ++block_offset_;
+      ++offset;
+    }
+    DCHECK_LT(block_offset_, static_cast<uint32_t>(AES_BLOCK_SIZE));
   }
   return true;
 }
@@ -96,6 +128,25 @@ void AesCtrEncryptor::SetIvInternal() {
   counter_.resize(AES_BLOCK_SIZE, 0);
 }
 
+void AesCtrEncryptor::GenerateKeystream(size_t num_blocks) {
+  DCHECK_LE(num_blocks, kCtrBatchBlocks);
+
+  uint8_t* block = keystream_.data();
+  for (size_t i = 0; i < num_blocks; ++i, block += AES_BLOCK_SIZE) {
+    memcpy(block, counter_.data(), AES_BLOCK_SIZE);
+    // As mentioned in ISO/IEC 23001-7:2016 CENC spec, of the 16 byte counter
+    // block, bytes 8 to 15 (i.e. the least significant bytes) are used as a
+    // simple 64 bit unsigned integer that is incremented by one for each
+    // subsequent block of sample data processed and is kept in network byte
+    // order.
+    Increment64(&counter_[8]);
+  }
+
+  // Encrypt the counters in place, as a batch so that the backend can keep
+  // several blocks in flight.
+  cipher_->CryptBlocks(keystream_.data(), num_blocks, keystream_.data());
+}
+
 AesCbcEncryptor::AesCbcEncryptor(CbcPaddingScheme padding_scheme)
     : AesCbcEncryptor(padding_scheme, kDontUseConstantIv) {}
 
@@ -113,14 +164,7 @@ AesCbcEncryptor::~AesCbcEncryptor() {}
 
 bool AesCbcEncryptor::InitializeWithIv(const std::vector<uint8_t>& key,
                                        const std::vector<uint8_t>& iv) {
-  if (!SetupCipher(key.size(), kCbcMode)) {
-    return false;
-  }
-
-  if (mbedtls_cipher_setkey(&cipher_ctx_, key.data(),
-                            static_cast<int>(8 * key.size()),
-                            MBEDTLS_ENCRYPT) != 0) {
-    LOG(ERROR) << "Failed to set CBC encryption key";
+  if (!SetupCipher(key, AesBlockCipher::kEncrypt)) {
     return false;
   }
 
@@ -218,17 +262,11 @@ void AesCbcEncryptor::CbcEncryptBlocks(const uint8_t* plaintext,
                                        uint8_t* ciphertext,
                                        uint8_t* iv) {
   CHECK_EQ(plaintext_size % AES_BLOCK_SIZE, 0u);
+  CHECK_GT(plaintext_size, 0u);
 
-  size_t output_size = 0;
-  CHECK_EQ(mbedtls_cipher_crypt(&cipher_ctx_, iv, AES_BLOCK_SIZE, plaintext,
-                                plaintext_size, ciphertext, &output_size),
-           0);
-
-  CHECK_EQ(output_size % AES_BLOCK_SIZE, 0u);
-  CHECK_GT(output_size, 0u);
-
-  uint8_t* last_block = ciphertext + output_size - AES_BLOCK_SIZE;
-  memcpy(iv, last_block, AES_BLOCK_SIZE);
+  // |iv| is updated to the last ciphertext block.
+  cipher_->CbcCryptBlocks(plaintext, plaintext_size / AES_BLOCK_SIZE,
+                          ciphertext, iv);
 }
 
 }  // namespace media
@@ -4,7 +4,7 @@
 // license that can be found in the LICENSE file or at
 // https://developers.google.com/open-source/licenses/bsd
 //
-// AES Encryptor implementation using mbedtls.
+// AES Encryptor implementation.
 
 #ifndef PACKAGER_MEDIA_BASE_AES_ENCRYPTOR_H_
 #define PACKAGER_MEDIA_BASE_AES_ENCRYPTOR_H_
@@ -39,12 +39,18 @@ class AesCtrEncryptor : public AesCryptor {
                      size_t* ciphertext_size) override;
   void SetIvInternal() override;
 
+  // Fills the first |num_blocks| blocks of |keystream_| with the encrypted
+  // values of consecutive counters, starting from |counter_|, and advances
+  // |counter_| past them.
+  void GenerateKeystream(size_t num_blocks);
+
   // Current block offset.
   uint32_t block_offset_;
   // Current AES-CTR counter.
   std::vector<uint8_t> counter_;
-  // Encrypted counter.
-  std::vector<uint8_t> encrypted_counter_;
+  // Keystream for a batch of counters. When |block_offset_| is non-zero, the
+  // first block holds the encrypted counter of the partially consumed block.
+  std::vector<uint8_t> keystream_;
 
   DISALLOW_COPY_AND_ASSIGN(AesCtrEncryptor);
 };
@@ -0,0 +1,76 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/buffer_chain.h>
+
+#include <absl/log/check.h>
+
+#include <packager/file.h>
+#include <packager/media/base/buffer_writer.h>
+
+namespace shaka {
+namespace media {
+
+BufferChain::BufferChain() = default;
+BufferChain::~BufferChain() = default;
+
+void BufferChain::TakeBuffer(BufferWriter* buffer) {
+  DCHECK(buffer);
+  if (buffer->Size() == 0)
+    return;
+  auto data = std::make_shared<std::vector<uint8_t>>();
+  buffer->SwapBuffer(data.get());
+  const uint8_t* bytes = data->data();
+  const size_t size = data->size();
+  AppendReference(std::move(data), bytes, size);
+}
+
+void BufferChain::AppendReference(std::shared_ptr<const void> owner,
+                                  const uint8_t* data,
+                                  size_t size) {
+  if (size == 0)
+    return;
+  DCHECK(owner);
+  DCHECK(data);
+  pieces_.push_back({std::move(owner), data, size});
+  size_ += size;
+}
+
+void BufferChain::AppendChain(const BufferChain& chain) {
+  pieces_.insert(pieces_.end(), chain.pieces_.begin(), chain.pieces_.end());
+  size_ += chain.size_;
+}
+
+void BufferChain::CopyTo(BufferWriter* buffer) const {
+  DCHECK(buffer);
+  for (const Piece& piece : pieces_)
+    buffer->AppendArray(piece.data, piece.size);
+}
+
+void BufferChain::Clear() {
+  pieces_.clear();
+  size_ = 0;
+}
+
+Status BufferChain::WriteToFile(File* file) {
+  DCHECK(file);
+  DCHECK(!pieces_.empty());
+
+  std::vector<File::IoVec> iov;
+  iov.reserve(pieces_.size());
+  for (const Piece& piece : pieces_)
+    iov.push_back({piece.data, piece.size});
+
+  const int64_t size_written = file->WriteV(iov.data(), iov.size());
+  if (size_written < 0 || static_cast<uint64_t>(size_written) != size_) {
+    return Status(error::FILE_FAILURE, "Fail to write to file in BufferChain");
+  }
+  Clear();
+  return Status::OK;
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,74 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_BUFFER_CHAIN_H_
+#define PACKAGER_MEDIA_BASE_BUFFER_CHAIN_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <packager/macros/classes.h>
+#include <packager/status.h>
+
+namespace shaka {
+
+class File;
+
+namespace media {
+
+class BufferWriter;
+
+/// A sequence of byte ranges which are referenced rather than copied, and
+/// written out with a single vectored write. It is used to assemble media
+/// segments from box headers and sample data without copying the samples.
+class BufferChain {
+ public:
+  BufferChain();
+  ~BufferChain();
+
+  /// Append the content of @a buffer without copying it. @a buffer is left
+  /// empty.
+  void TakeBuffer(BufferWriter* buffer);
+
+  /// Append @a size bytes at @a data without copying them.
+  /// @param owner keeps @a data alive for as long as it is referenced.
+  void AppendReference(std::shared_ptr<const void> owner,
+                       const uint8_t* data,
+                       size_t size);
+
+  /// Append the content of @a chain without copying it.
+  void AppendChain(const BufferChain& chain);
+
+  /// Copy the content to @a buffer.
+  void CopyTo(BufferWriter* buffer) const;
+
+  /// Release all the references.
+  void Clear();
+
+  /// @return The total number of bytes in the chain.
+  size_t Size() const { return size_; }
+
+  /// Write the content of the chain to @a file and clear it.
+  Status WriteToFile(File* file);
+
+ private:
+  struct Piece {
+    std::shared_ptr<const void> owner;
+    const uint8_t* data;
+    size_t size;
+  };
+
+  std::vector<Piece> pieces_;
+  size_t size_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(BufferChain);
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_BUFFER_CHAIN_H_
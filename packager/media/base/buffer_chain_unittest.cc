@@ -0,0 +1,110 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/buffer_chain.h>
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+#include <packager/file/file_test_util.h>
+#include <packager/media/base/buffer_writer.h>
+#include <packager/status/status_test_util.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const uint8_t kHeader[] = {1, 2, 3};
+const uint8_t kPayload[] = {10, 11, 12, 13, 14};
+
+std::shared_ptr<const std::vector<uint8_t>> MakePayload() {
+  return std::make_shared<const std::vector<uint8_t>>(
+      kPayload, kPayload + sizeof(kPayload));
+}
+
+std::vector<uint8_t> Expected() {
+  std::vector<uint8_t> expected(kHeader, kHeader + sizeof(kHeader));
+  expected.insert(expected.end(), kPayload, kPayload + sizeof(kPayload));
+  return expected;
+}
+
+}  // namespace
+
+TEST(BufferChainTest, ReferencesWithoutCopying) {
+  BufferWriter header;
+  header.AppendArray(kHeader, sizeof(kHeader));
+  auto payload = MakePayload();
+
+  BufferChain chain;
+  chain.TakeBuffer(&header);
+  EXPECT_EQ(0u, header.Size());
+  chain.AppendReference(payload, payload->data(), payload->size());
+  EXPECT_EQ(sizeof(kHeader) + sizeof(kPayload), chain.Size());
+  // The chain shares ownership of the payload.
+  EXPECT_EQ(2, payload.use_count());
+
+  BufferWriter output;
+  chain.CopyTo(&output);
+  EXPECT_EQ(Expected(),
+            std::vector<uint8_t>(output.Buffer(),
+                                 output.Buffer() + output.Size()));
+
+  chain.Clear();
+  EXPECT_EQ(0u, chain.Size());
+  EXPECT_EQ(1, payload.use_count());
+}
+
+TEST(BufferChainTest, AppendChain) {
+  auto payload = MakePayload();
+  BufferChain fragment;
+  fragment.AppendReference(payload, payload->data(), payload->size());
+  // Empty references are ignored.
+  fragment.AppendReference(payload, payload->data(), 0);
+
+  BufferWriter header;
+  header.AppendArray(kHeader, sizeof(kHeader));
+  BufferChain segment;
+  segment.TakeBuffer(&header);
+  segment.AppendChain(fragment);
+  EXPECT_EQ(fragment.Size() + sizeof(kHeader), segment.Size());
+  EXPECT_EQ(3, payload.use_count());
+
+  // The references outlive |fragment|.
+  fragment.Clear();
+  BufferWriter output;
+  segment.CopyTo(&output);
+  EXPECT_EQ(Expected(),
+            std::vector<uint8_t>(output.Buffer(),
+                                 output.Buffer() + output.Size()));
+}
+
+TEST(BufferChainTest, WriteToFile) {
+  TempFile temp_file;
+  BufferWriter header;
+  header.AppendArray(kHeader, sizeof(kHeader));
+  auto payload = MakePayload();
+
+  BufferChain chain;
+  chain.TakeBuffer(&header);
+  chain.AppendReference(payload, payload->data(), payload->size());
+
+  File* const output_file = File::Open(temp_file.path().c_str(), "w");
+  ASSERT_TRUE(output_file != NULL);
+  ASSERT_OK(chain.WriteToFile(output_file));
+  EXPECT_EQ(0u, chain.Size());
+  ASSERT_TRUE(output_file->Close());
+
+  std::string data_read;
+  ASSERT_TRUE(File::ReadFileToString(temp_file.path().c_str(), &data_read));
+  EXPECT_EQ(Expected(),
+            std::vector<uint8_t>(data_read.begin(), data_read.end()));
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -69,6 +69,12 @@ void BufferWriter::AppendBuffer(const BufferWriter& buffer) {
   buf_.insert(buf_.end(), buffer.buf_.begin(), buffer.buf_.end());
 }
 
+uint8_t* BufferWriter::Extend(size_t size) {
+  const size_t offset = buf_.size();
+  buf_.resize(offset + size);
+  return buf_.data() + offset;
+}
+
 Status BufferWriter::WriteToFile(File* file) {
   DCHECK(file);
   DCHECK(!buf_.empty());
@@ -53,6 +53,12 @@ class BufferWriter {
   void AppendArray(const uint8_t* buf, size_t size);
   void AppendBuffer(const BufferWriter& buffer);
 
+  /// Append @a size bytes to be filled in by the caller, e.g. when the layout
+  /// of the data is known ahead and is faster to write in place.
+  /// @return A pointer to the appended bytes. It is invalidated by the next
+  ///         append.
+  uint8_t* Extend(size_t size);
+
   void Swap(BufferWriter* buffer) { buf_.swap(buffer->buf_); }
   void SwapBuffer(std::vector<uint8_t>* buffer) { buf_.swap(*buffer); }
 
@@ -6,6 +6,7 @@
 
 #include <packager/media/base/buffer_writer.h>
 
+#include <cstring>
 #include <filesystem>
 #include <limits>
 #include <memory>
@@ -166,6 +167,24 @@ TEST_F(BufferWriterTest, AppendBufferWriter) {
   ASSERT_NO_FATAL_FAILURE(ReadAndExpect(kuint32));
 }
 
+TEST_F(BufferWriterTest, Extend) {
+  writer_->AppendInt(kuint8);
+  uint8_t* data = writer_->Extend(sizeof(kuint8Array));
+  memcpy(data, kuint8Array, sizeof(kuint8Array));
+  writer_->AppendInt(kuint16);
+  ASSERT_EQ(sizeof(kuint8) + sizeof(kuint8Array) + sizeof(kuint16),
+            writer_->Size());
+
+  CreateReader();
+  ASSERT_NO_FATAL_FAILURE(ReadAndExpect(kuint8));
+  std::vector<uint8_t> data_read;
+  ASSERT_TRUE(reader_->ReadToVector(&data_read, sizeof(kuint8Array)));
+  EXPECT_EQ(
+      std::vector<uint8_t>(std::begin(kuint8Array), std::end(kuint8Array)),
+      data_read);
+  ASSERT_NO_FATAL_FAILURE(ReadAndExpect(kuint16));
+}
+
 TEST_F(BufferWriterTest, Swap) {
   BufferWriter local_writer;
   local_writer.AppendInt(kuint16);
@@ -24,11 +24,15 @@ ByteQueue::~ByteQueue() {}
 void ByteQueue::Reset() {
   offset_ = 0;
   used_ = 0;
+  view_ = nullptr;
 }
 
 void ByteQueue::Push(const uint8_t* data, int size) {
   DCHECK(data);
 
+  if (view_)
+    CopyView();
+
   size_t size_needed = used_ + size;
 
   // Check to see if we need a bigger buffer.
@@ -55,7 +59,20 @@ void ByteQueue::Push(const uint8_t* data, int size) {
     offset_ = 0;
   }
 
-  memcpy(front() + used_, data, size);
+  memcpy(buffer_.get() + offset_ + used_, data, size);
+  used_ += size;
+}
+
+void ByteQueue::PushView(const uint8_t* data, int size) {
+  DCHECK(data);
+
+  if (used_ == 0) {
+    view_ = data;
+    offset_ = 0;
+  } else if (!view_ || view_ + used_ != data) {
+    Push(data, size);
+    return;
+  }
   used_ += size;
 }
 
@@ -69,6 +86,14 @@ void ByteQueue::Peek(const uint8_t** data, int* size) const {
 void ByteQueue::Pop(int count) {
   DCHECK_LE(count, used_);
 
+  if (view_) {
+    view_ += count;
+    used_ -= count;
+    if (used_ == 0)
+      view_ = nullptr;
+    return;
+  }
+
   offset_ += count;
   used_ -= count;
 
@@ -79,8 +104,18 @@ void ByteQueue::Pop(int count) {
   }
 }
 
-uint8_t* ByteQueue::front() const {
-  return buffer_.get() + offset_;
+const uint8_t* ByteQueue::front() const {
+  return view_ ? view_ : buffer_.get() + offset_;
+}
+
+void ByteQueue::CopyView() {
+  DCHECK(view_);
+  const uint8_t* view = view_;
+  const int size = used_;
+  view_ = nullptr;
+  offset_ = 0;
+  used_ = 0;
+  Push(view, size);
 }
 
 }  // namespace media
@@ -29,6 +29,12 @@ class ByteQueue {
   /// Append new bytes to the end of the queue.
   void Push(const uint8_t* data, int size);
 
+  /// Append new bytes to the end of the queue. The bytes must stay valid, and
+  /// unchanged, until they are popped or the queue is reset. They are
+  /// referenced instead of copied if the queue is empty or only contains
+  /// referenced bytes which end where @a data starts.
+  void PushView(const uint8_t* data, int size);
+
   /// Get a pointer to the front of the queue and the queue size.
   /// These values are only valid until the next Push() or Pop() call.
   void Peek(const uint8_t** data, int* size) const;
@@ -39,7 +45,10 @@ class ByteQueue {
 
  private:
   // Returns a pointer to the front of the queue.
-  uint8_t* front() const;
+  const uint8_t* front() const;
+
+  // Copies the referenced bytes into |buffer_|.
+  void CopyView();
 
   std::unique_ptr<uint8_t[]> buffer_;
 
@@ -52,6 +61,10 @@ class ByteQueue {
   // Number of bytes stored in the queue.
   int used_;
 
+  // Front of the referenced bytes if the queue content is referenced rather
+  // than stored in |buffer_|, null otherwise.
+  const uint8_t* view_ = nullptr;
+
   DISALLOW_COPY_AND_ASSIGN(ByteQueue);
 };
 
@@ -7,6 +7,8 @@
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
+#include <packager/media/base/sample_pool.h>
+
 namespace shaka {
 namespace media {
 
@@ -32,6 +34,16 @@ DecryptConfig::DecryptConfig(const std::vector<uint8_t>& key_id,
 
 DecryptConfig::~DecryptConfig() {}
 
+// static
+void* DecryptConfig::operator new(size_t size) {
+  return SamplePool::Allocate(size);
+}
+
+// static
+void DecryptConfig::operator delete(void* ptr) {
+  SamplePool::Free(ptr);
+}
+
 size_t DecryptConfig::GetTotalSizeOfSubsamples() const {
   size_t size = 0;
   for (const SubsampleEntry& subsample : subsamples_)
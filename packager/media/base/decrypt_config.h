@@ -71,6 +71,10 @@ class DecryptConfig {
 
   ~DecryptConfig();
 
+  /// Decrypt configs are allocated from the current SamplePool, if any.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
   /// @param clear_bytes is the size of clear bytes in the subsample to be
   ///        added.
   /// @param cipher_bytes is the size of cipher bytes in the subsample to be
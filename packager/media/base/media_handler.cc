@@ -6,10 +6,47 @@
 
 #include <packager/media/base/media_handler.h>
 
+#include <cstdlib>
+#include <typeinfo>
+#if !defined(_MSC_VER)
+#include <cxxabi.h>
+#endif
+
 #include <packager/macros/status.h>
+#include <packager/utils/telemetry.h>
 
 namespace shaka {
 namespace media {
+namespace {
+
+// The unqualified class name of |type|, e.g. "ChunkingHandler".
+std::string GetClassName(const std::type_info& type) {
+#if defined(_MSC_VER)
+  std::string name = type.name();
+#else
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+  std::string name = status == 0 ? demangled : type.name();
+  free(demangled);
+#endif
+  const size_t separator = name.rfind("::");
+  return separator == std::string::npos ? name : name.substr(separator + 2);
+}
+
+void GetSampleCountAndBytes(const StreamData& stream_data,
+                            uint64_t* count,
+                            uint64_t* bytes) {
+  *count = 0;
+  *bytes = 0;
+  if (stream_data.media_sample) {
+    *count = 1;
+    *bytes = stream_data.media_sample->data_size();
+  } else if (stream_data.text_sample) {
+    *count = 1;
+  }
+}
+
+}  // namespace
 
 std::string StreamDataTypeToString(StreamDataType type) {
   switch (type) {
@@ -31,6 +68,13 @@ std::string StreamDataTypeToString(StreamDataType type) {
   return "unknown";
 }
 
+MediaHandler::~MediaHandler() {
+  for (uint32_t telemetry_id : telemetry_ids_)
+    Telemetry::Release(telemetry_id);
+  if (!telemetry_name_.empty())
+    Telemetry::ReleaseUniqueName(telemetry_name_);
+}
+
 Status MediaHandler::SetHandler(size_t output_stream_index,
                                 std::shared_ptr<MediaHandler> handler) {
   if (output_handlers_.find(output_stream_index) != output_handlers_.end()) {
@@ -49,6 +93,15 @@ Status MediaHandler::Initialize() {
   Status status = InitializeInternal();
   if (!status.ok())
     return status;
+  if (Telemetry::enabled()) {
+    telemetry_name_ = Telemetry::UniqueName(GetClassName(typeid(*this)));
+    telemetry_ids_.resize(num_input_streams_);
+    for (size_t i = 0; i < num_input_streams_; ++i) {
+      telemetry_ids_[i] =
+          Telemetry::Register(Telemetry::Category::kHandler, telemetry_name_,
+                              static_cast<int32_t>(i));
+    }
+  }
   for (auto& pair : output_handlers_) {
     if (!ValidateOutputStreamIndex(pair.first))
       return Status(error::INVALID_ARGUMENT, "Invalid output stream index");
@@ -98,8 +151,18 @@ Status MediaHandler::Dispatch(std::unique_ptr<StreamData> stream_data) const {
     return Status(error::NOT_FOUND,
                   "No output handler exist at the specified index.");
   }
-  stream_data->stream_index = handler_it->second.second;
-  return handler_it->second.first->Process(std::move(stream_data));
+  MediaHandler* handler = handler_it->second.first.get();
+  const size_t input_stream_index = handler_it->second.second;
+  stream_data->stream_index = input_stream_index;
+  if (!Telemetry::enabled())
+    return handler->Process(std::move(stream_data));
+
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+  GetSampleCountAndBytes(*stream_data, &count, &bytes);
+  ScopedTelemetry telemetry(handler->telemetry_id(input_stream_index), count,
+                            bytes);
+  return handler->Process(std::move(stream_data));
 }
 
 Status MediaHandler::FlushDownstream(size_t output_stream_index) {
@@ -108,17 +171,32 @@ Status MediaHandler::FlushDownstream(size_t output_stream_index) {
     return Status(error::NOT_FOUND,
                   "No output handler exist at the specified index.");
   }
-  return handler_it->second.first->OnFlushRequest(handler_it->second.second);
+  MediaHandler* handler = handler_it->second.first.get();
+  const size_t input_stream_index = handler_it->second.second;
+  ScopedTelemetry telemetry(handler->telemetry_id(input_stream_index), 0, 0,
+                            ScopedTelemetry::kFlush);
+  return handler->OnFlushRequest(input_stream_index);
 }
 
 Status MediaHandler::FlushAllDownstreams() {
   for (const auto& pair : output_handlers_) {
-    Status status = pair.second.first->OnFlushRequest(pair.second.second);
+    MediaHandler* handler = pair.second.first.get();
+    const size_t input_stream_index = pair.second.second;
+    ScopedTelemetry telemetry(handler->telemetry_id(input_stream_index), 0, 0,
+                              ScopedTelemetry::kFlush);
+    Status status = handler->OnFlushRequest(input_stream_index);
     if (!status.ok()) {
       return status;
     }
   }
   return Status::OK;
 }
+
+uint32_t MediaHandler::telemetry_id(size_t input_stream_index) const {
+  return input_stream_index < telemetry_ids_.size()
+             ? telemetry_ids_[input_stream_index]
+             : Telemetry::kInvalidId;
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -10,8 +10,10 @@
 #include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include <packager/media/base/media_sample.h>
+#include <packager/media/base/sample_pool.h>
 #include <packager/media/base/stream_info.h>
 #include <packager/media/base/text_sample.h>
 #include <packager/status.h>
@@ -78,6 +80,10 @@ struct StreamData {
   std::shared_ptr<const Scte35Event> scte35_event;
   std::shared_ptr<const CueEvent> cue_event;
 
+  /// Stream data is allocated from the current SamplePool, if any.
+  static void* operator new(size_t size) { return SamplePool::Allocate(size); }
+  static void operator delete(void* ptr) { SamplePool::Free(ptr); }
+
   static std::unique_ptr<StreamData> FromStreamInfo(
       size_t stream_index,
       std::shared_ptr<const StreamInfo> stream_info) {
@@ -157,7 +163,7 @@ struct StreamData {
 class MediaHandler {
  public:
   MediaHandler() = default;
-  virtual ~MediaHandler() = default;
+  virtual ~MediaHandler();
 
   /// Connect downstream handler at the specified output stream index.
   Status SetHandler(size_t output_stream_index,
@@ -260,6 +266,11 @@ class MediaHandler {
     return output_handlers_;
   }
 
+  /// @return The telemetry entry of the specified input stream, or
+  ///         Telemetry::kInvalidId if telemetry was disabled on
+  ///         initialization.
+  uint32_t telemetry_id(size_t input_stream_index) const;
+
  private:
   MediaHandler(const MediaHandler&) = delete;
   MediaHandler& operator=(const MediaHandler&) = delete;
@@ -273,6 +284,10 @@ class MediaHandler {
   // map.
   std::map<size_t, std::pair<std::shared_ptr<MediaHandler>, size_t>>
       output_handlers_;
+  // Telemetry entries, indexed by input stream index, released on
+  // destruction.
+  std::string telemetry_name_;
+  std::vector<uint32_t> telemetry_ids_;
 };
 
 }  // namespace media
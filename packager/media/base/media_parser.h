@@ -9,11 +9,13 @@
 
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include <packager/macros/classes.h>
+#include <packager/macros/compiler.h>
 #include <packager/media/base/container_names.h>
 
 namespace shaka {
@@ -24,6 +26,28 @@ class MediaSample;
 class StreamInfo;
 class TextSample;
 
+/// Timing of a sample, as indexed by the container of the input.
+struct SampleTiming {
+  int64_t dts = 0;
+  int64_t pts = 0;
+  int64_t duration = 0;
+  bool is_key_frame = false;
+};
+
+/// The samples of a stream, in decode order, as indexed by the container of
+/// the input.
+struct StreamTimeline {
+  uint32_t track_id = 0;
+  std::shared_ptr<const StreamInfo> stream_info;
+  std::vector<SampleTiming> samples;
+};
+
+/// A range of samples of a track, counted in decode order.
+struct SampleRange {
+  uint64_t begin = 0;
+  uint64_t end = 0;
+};
+
 class MediaParser {
  public:
   MediaParser() {}
@@ -78,6 +102,57 @@ class MediaParser {
   /// @return true if successful.
   [[nodiscard]] virtual bool Parse(const uint8_t* buf, int size) = 0;
 
+  /// Same as Parse(), for data which stays valid, and unchanged, for as long
+  /// as @a owner is referenced, e.g. a memory mapped file. Consecutive calls
+  /// pass consecutive ranges of the input. Parsers may then reference the
+  /// data instead of copying it. The default implementation calls Parse().
+  /// @return true if successful.
+  [[nodiscard]] virtual bool ParseMapped(std::shared_ptr<const void> owner,
+                                         const uint8_t* buf,
+                                         int size) {
+    UNUSED(owner);
+    return Parse(buf, size);
+  }
+
+  /// Get the timing of every sample from the index of the input, e.g. the
+  /// sample tables of an MP4 'moov' box, without parsing the media data. Only
+  /// valid once the init callback has been called.
+  /// @param timings receives the samples of each track, in decode order, keyed
+  ///        by track id.
+  /// @return false if the input does not index its samples. The default
+  ///         implementation returns false.
+  virtual bool GetSampleTimings(
+      std::map<uint32_t, std::vector<SampleTiming>>* timings) {
+    UNUSED(timings);
+    return false;
+  }
+
+  /// Only emit a range of the samples of each track, e.g. to demux a
+  /// partition of the input. The samples outside the ranges are skipped
+  /// before their data is copied or decrypted. Must be called before the
+  /// input is parsed.
+  /// @param ranges is keyed by track id. The samples of the tracks without a
+  ///        range are all skipped.
+  /// @return false if the parser cannot skip samples, in which case it emits
+  ///         every sample. The default implementation returns false.
+  virtual bool SetSampleRanges(const std::map<uint32_t, SampleRange>& ranges) {
+    UNUSED(ranges);
+    return false;
+  }
+
+  /// Skip ahead to the data of the first sample in the ranges set with
+  /// SetSampleRanges(), using the index of the input. Only valid once the
+  /// init callback has been called.
+  /// @param offset receives the offset of the input to continue parsing from.
+  ///        The next call to Parse() must pass the data at that offset.
+  /// @return false if the parser cannot skip ahead, in which case parsing
+  ///         continues with the data following the data already parsed. The
+  ///         default implementation returns false.
+  virtual bool SeekToSampleRanges(int64_t* offset) {
+    UNUSED(offset);
+    return false;
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(MediaParser);
 };
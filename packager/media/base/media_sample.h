@@ -68,6 +68,10 @@ class MediaSample {
 
   virtual ~MediaSample();
 
+  /// Samples are allocated from the current SamplePool, if any.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
   /// Clone the object and return a new MediaSample.
   std::shared_ptr<MediaSample> Clone() const;
 
@@ -76,6 +80,11 @@ class MediaSample {
   /// @param data_size is the size of the data to be transferred.
   void TransferData(std::shared_ptr<uint8_t> data, size_t data_size);
 
+  /// Set the sample data without copying it.
+  /// @param data must not be changed for as long as it is referenced.
+  /// @param data_size is the size of the data to be referenced.
+  void ShareData(std::shared_ptr<const uint8_t> data, size_t data_size);
+
   /// Set the data in this media sample. Note that this method involves data
   /// copying.
   /// @param data points to the data to be copied.
@@ -123,6 +132,13 @@ class MediaSample {
     return data_.get();
   }
 
+  /// @return The buffer holding data(), which can be retained to reference
+  ///         the data without copying it.
+  std::shared_ptr<const uint8_t> shared_data() const {
+    DCHECK(!end_of_stream());
+    return data_;
+  }
+
   size_t data_size() const {
     DCHECK(!end_of_stream());
     return data_size_;
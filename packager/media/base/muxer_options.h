@@ -8,6 +8,7 @@
 #define PACKAGER_MEDIA_BASE_MUXER_OPTIONS_H_
 
 #include <cstdint>
+#include <optional>
 #include <string>
 
 #include <packager/mp4_output_params.h>
@@ -41,9 +42,31 @@ struct MuxerOptions {
   /// Specify temporary directory for intermediate files.
   std::string temp_dir;
 
+  /// Write single-segment WebM output directly to the output file, patching
+  /// the header in place, instead of going through a file in temp_dir.
+  bool webm_single_pass_on_demand = false;
+
   /// User-specified bit rate for the media stream. If zero, the muxer will
   /// attempt to estimate.
   uint32_t bandwidth = 0;
+
+  /// Describes the part of the output written by a muxer which produces a
+  /// partition of the segments, while the muxers of the other partitions of
+  /// the timeline run in parallel. Only multi-segment MP4 output supports it.
+  struct Partition {
+    /// The muxer of the first partition writes the init segment.
+    bool is_first = true;
+    /// Sequence number of the first fragment of the partition.
+    uint32_t first_fragment_sequence_number = 1;
+    /// Timestamps of the first sample of the whole output, which determine
+    /// its edit list.
+    int64_t first_pts = 0;
+    int64_t first_dts = 0;
+    /// Duration of the whole output, in stream time scale.
+    int64_t duration = 0;
+  };
+  /// Set if the muxer only writes a partition of the output.
+  std::optional<Partition> partition;
 };
 
 }  // namespace media
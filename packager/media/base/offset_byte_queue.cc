@@ -23,12 +23,23 @@ void OffsetByteQueue::Reset() {
   head_ = 0;
 }
 
+void OffsetByteQueue::ResetTo(int64_t offset) {
+  Reset();
+  head_ = offset;
+}
+
 void OffsetByteQueue::Push(const uint8_t* buf, int size) {
   queue_.Push(buf, size);
   Sync();
   DVLOG(4) << "Buffer pushed. head=" << head() << " tail=" << tail();
 }
 
+void OffsetByteQueue::PushView(const uint8_t* buf, int size) {
+  queue_.PushView(buf, size);
+  Sync();
+  DVLOG(4) << "Buffer pushed. head=" << head() << " tail=" << tail();
+}
+
 void OffsetByteQueue::Peek(const uint8_t** buf, int* size) {
   *buf = size_ > 0 ? buf_ : NULL;
   *size = size_;
@@ -26,10 +26,15 @@ class OffsetByteQueue {
   /// @{
   void Reset();
   void Push(const uint8_t* buf, int size);
+  void PushView(const uint8_t* buf, int size);
   void Peek(const uint8_t** buf, int* size);
   void Pop(int count);
   /// @}
 
+  /// Discard the buffered bytes and continue at @a offset, e.g. after the
+  /// input is seeked. The bytes pushed next are at @a offset.
+  void ResetTo(int64_t offset);
+
   /// Set @a buf to point at the first buffered byte corresponding to @a offset,
   /// and @a size to the number of bytes available starting from that offset.
   ///
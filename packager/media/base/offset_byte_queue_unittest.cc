@@ -91,5 +91,45 @@ TEST_F(OffsetByteQueueTest, Trim) {
   EXPECT_TRUE(queue_->Trim(512));
 }
 
+TEST(OffsetByteQueueViewTest, PushView) {
+  uint8_t data[512];
+  for (int i = 0; i < 512; i++)
+    data[i] = i % 256;
+
+  OffsetByteQueue queue;
+  queue.PushView(data, 256);
+  queue.Pop(100);
+  // Contiguous views are referenced.
+  queue.PushView(data + 256, 128);
+
+  const uint8_t* buf;
+  int size;
+  queue.Peek(&buf, &size);
+  EXPECT_EQ(data + 100, buf);
+  EXPECT_EQ(284, size);
+
+  // Non-contiguous bytes are copied along with the referenced bytes.
+  queue.PushView(data, 10);
+  queue.Peek(&buf, &size);
+  EXPECT_NE(data + 100, buf);
+  ASSERT_EQ(294, size);
+  EXPECT_EQ(0, memcmp(data + 100, buf, 284));
+  EXPECT_EQ(0, memcmp(data, buf + 284, 10));
+  EXPECT_EQ(100, queue.head());
+  EXPECT_EQ(394, queue.tail());
+
+  // The queue references bytes again once it is empty.
+  queue.Pop(size);
+  queue.PushView(data + 384, 128);
+  queue.Peek(&buf, &size);
+  EXPECT_EQ(data + 384, buf);
+  EXPECT_EQ(128, size);
+  queue.Push(data, 1);
+  queue.Peek(&buf, &size);
+  ASSERT_EQ(129, size);
+  EXPECT_EQ(0, memcmp(data + 384, buf, 128));
+  EXPECT_EQ(0, buf[128]);
+}
+
 }  // namespace media
 }  // namespace shaka
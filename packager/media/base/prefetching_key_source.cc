@@ -0,0 +1,194 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/prefetching_key_source.h>
+
+#include <algorithm>
+
+#include <absl/log/check.h>
+
+namespace shaka {
+namespace media {
+
+PrefetchingKeySource::PrefetchingKeySource(
+    std::unique_ptr<KeySource> key_source,
+    const Options& options)
+    : key_source_(std::move(key_source)), options_(options) {
+  DCHECK(key_source_);
+  // Otherwise prefetched keys may be dropped before being requested.
+  DCHECK_GT(options_.max_cached_keys, options_.prefetch_count);
+  fetch_thread_ = std::thread(&PrefetchingKeySource::FetchThreadMain, this);
+}
+
+PrefetchingKeySource::~PrefetchingKeySource() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+    fetch_queued_.SignalAll();
+  }
+  fetch_thread_.join();
+}
+
+Status PrefetchingKeySource::FetchKeys(EmeInitDataType init_data_type,
+                                       const std::vector<uint8_t>& init_data) {
+  return key_source_->FetchKeys(init_data_type, init_data);
+}
+
+Status PrefetchingKeySource::GetKey(const std::string& stream_label,
+                                    EncryptionKey* key) {
+  return key_source_->GetKey(stream_label, key);
+}
+
+Status PrefetchingKeySource::GetKey(const std::vector<uint8_t>& key_id,
+                                    EncryptionKey* key) {
+  return key_source_->GetKey(key_id, key);
+}
+
+Status PrefetchingKeySource::GetCryptoPeriodKey(
+    uint32_t crypto_period_index,
+    int32_t crypto_period_duration_in_seconds,
+    const std::string& stream_label,
+    EncryptionKey* key) {
+  DCHECK(key);
+  absl::MutexLock lock(&mutex_);
+  if (crypto_period_duration_in_seconds_ == 0) {
+    crypto_period_duration_in_seconds_ = crypto_period_duration_in_seconds;
+  } else if (crypto_period_duration_in_seconds_ !=
+             crypto_period_duration_in_seconds) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Crypto period duration should not change.");
+  }
+
+  ++stats_.keys_requested;
+  ScheduleFetch(stream_label, crypto_period_index, true);
+  CachedKeyMap& cached_keys = cached_keys_[stream_label];
+  CachedKey& cached_key = cached_keys[crypto_period_index];
+  if (cached_key.fetched) {
+    ++stats_.keys_prefetched;
+  } else {
+    ++stats_.stalls;
+    ++cached_key.num_waiters;
+    const absl::Time start = absl::Now();
+    while (!cached_key.fetched)
+      key_fetched_.Wait(&mutex_);
+    stats_.stall_time += absl::Now() - start;
+    --cached_key.num_waiters;
+  }
+  const Status status = cached_key.status;
+  if (status.ok())
+    *key = cached_key.key;
+
+  for (uint32_t i = 1; i <= options_.prefetch_count; ++i)
+    ScheduleFetch(stream_label, crypto_period_index + i, false);
+  EvictKeys(&cached_keys);
+  return status;
+}
+
+PrefetchingKeySource::Stats PrefetchingKeySource::GetStats() {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+void PrefetchingKeySource::FetchThreadMain() {
+  while (true) {
+    FetchRequest request;
+    int32_t crypto_period_duration_in_seconds = 0;
+    {
+      absl::MutexLock lock(&mutex_);
+      while (!shutdown_ && fetch_queue_.empty())
+        fetch_queued_.Wait(&mutex_);
+      if (shutdown_)
+        return;
+      request = std::move(fetch_queue_.front());
+      fetch_queue_.pop_front();
+      crypto_period_duration_in_seconds = crypto_period_duration_in_seconds_;
+    }
+
+    EncryptionKey key;
+    Status status = key_source_->GetCryptoPeriodKey(
+        request.crypto_period_index, crypto_period_duration_in_seconds,
+        request.stream_label, &key);
+
+    absl::MutexLock lock(&mutex_);
+    ++stats_.keys_fetched;
+    // Keys are not evicted before being fetched.
+    CachedKeyMap& cached_keys = cached_keys_[request.stream_label];
+    CachedKey& cached_key = cached_keys[request.crypto_period_index];
+    if (!status.ok() && !request.requested) {
+      // The failure may be transient, so it is not returned to the requests
+      // to come: the key is fetched again when requested, right away if a
+      // request is waiting for it already.
+      ++stats_.prefetches_failed;
+      if (cached_key.num_waiters == 0) {
+        cached_keys.erase(request.crypto_period_index);
+      } else {
+        request.requested = true;
+        fetch_queue_.push_front(std::move(request));
+      }
+      continue;
+    }
+    cached_key.fetched = true;
+    cached_key.status = std::move(status);
+    cached_key.key = std::move(key);
+    EvictKeys(&cached_keys);
+    key_fetched_.SignalAll();
+  }
+}
+
+void PrefetchingKeySource::ScheduleFetch(const std::string& stream_label,
+                                         uint32_t crypto_period_index,
+                                         bool requested) {
+  CachedKeyMap& cached_keys = cached_keys_[stream_label];
+  auto iter = cached_keys.find(crypto_period_index);
+  if (iter != cached_keys.end()) {
+    if (iter->second.fetched || !requested)
+      return;
+    // Move the prefetch up, as the key is needed now.
+    auto request = std::find_if(
+        fetch_queue_.begin(), fetch_queue_.end(),
+        [&stream_label, crypto_period_index](const FetchRequest& request) {
+          return request.crypto_period_index == crypto_period_index &&
+                 request.stream_label == stream_label;
+        });
+    // Not found if the fetch is in progress already.
+    if (request != fetch_queue_.end()) {
+      request->requested = true;
+      if (request != fetch_queue_.begin()) {
+        FetchRequest moved = std::move(*request);
+        fetch_queue_.erase(request);
+        fetch_queue_.push_front(std::move(moved));
+      }
+    }
+    return;
+  }
+
+  cached_keys[crypto_period_index];
+  FetchRequest request;
+  request.stream_label = stream_label;
+  request.crypto_period_index = crypto_period_index;
+  request.requested = requested;
+  if (requested)
+    fetch_queue_.push_front(std::move(request));
+  else
+    fetch_queue_.push_back(std::move(request));
+  fetch_queued_.Signal();
+}
+
+void PrefetchingKeySource::EvictKeys(CachedKeyMap* cached_keys) {
+  auto iter = cached_keys->begin();
+  while (cached_keys->size() > options_.max_cached_keys &&
+         iter != cached_keys->end()) {
+    if (iter->second.fetched && iter->second.num_waiters == 0) {
+      iter = cached_keys->erase(iter);
+      ++stats_.keys_evicted;
+    } else {
+      ++iter;
+    }
+  }
+}
+
+}  // namespace media
+}  // namespace shaka
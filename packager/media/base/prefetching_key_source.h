@@ -0,0 +1,136 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_PREFETCHING_KEY_SOURCE_H_
+#define PACKAGER_MEDIA_BASE_PREFETCHING_KEY_SOURCE_H_
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
+
+#include <packager/media/base/key_source.h>
+
+namespace shaka {
+namespace media {
+
+/// Wraps a KeySource to fetch the keys of the next crypto periods in the
+/// background, so that key rotation does not block the pipeline on the key
+/// server.
+///
+/// When the key of a crypto period is requested, the keys of the following
+/// periods of the same stream label are fetched ahead on a background thread.
+/// The keys are cached per stream label, so the streams sharing a label share
+/// the fetches. The number of keys cached per label is bounded, the oldest
+/// ones being dropped first. A failed prefetch is not cached, so the key is
+/// fetched again when it is requested.
+class PrefetchingKeySource : public KeySource {
+ public:
+  struct Options {
+    /// Number of crypto periods to fetch the keys of ahead of the requested
+    /// one.
+    uint32_t prefetch_count = 2;
+    /// Maximum number of keys cached per stream label. Keys being waited for
+    /// are not dropped, even above it.
+    size_t max_cached_keys = 8;
+  };
+
+  struct Stats {
+    uint64_t keys_requested = 0;
+    /// Number of keys requested which were already fetched.
+    uint64_t keys_prefetched = 0;
+    uint64_t keys_fetched = 0;
+    /// Number of keys dropped from the cache.
+    uint64_t keys_evicted = 0;
+    /// Number of prefetches which failed, and were fetched again on request.
+    uint64_t prefetches_failed = 0;
+    /// Number of requests which waited for their key to be fetched, and the
+    /// total time waited.
+    uint64_t stalls = 0;
+    absl::Duration stall_time;
+  };
+
+  /// @param key_source fetches the keys. Its GetCryptoPeriodKey() is called
+  ///        from the background thread.
+  PrefetchingKeySource(std::unique_ptr<KeySource> key_source,
+                       const Options& options);
+  /// Waits for the fetch in progress, if any, to complete.
+  ~PrefetchingKeySource() override;
+
+  /// @name KeySource implementation overrides.
+  /// @{
+  Status FetchKeys(EmeInitDataType init_data_type,
+                   const std::vector<uint8_t>& init_data) override;
+  Status GetKey(const std::string& stream_label, EncryptionKey* key) override;
+  Status GetKey(const std::vector<uint8_t>& key_id,
+                EncryptionKey* key) override;
+  Status GetCryptoPeriodKey(uint32_t crypto_period_index,
+                            int32_t crypto_period_duration_in_seconds,
+                            const std::string& stream_label,
+                            EncryptionKey* key) override;
+  /// @}
+
+  Stats GetStats();
+
+ private:
+  struct CachedKey {
+    bool fetched = false;
+    // Number of requests waiting for the key.
+    int num_waiters = 0;
+    Status status;
+    EncryptionKey key;
+  };
+  // Cached keys of a stream label, by crypto period index.
+  typedef std::map<uint32_t, CachedKey> CachedKeyMap;
+
+  struct FetchRequest {
+    std::string stream_label;
+    uint32_t crypto_period_index = 0;
+    // Whether the key was requested before the fetch started, as opposed to
+    // only prefetched.
+    bool requested = false;
+  };
+
+  PrefetchingKeySource(const PrefetchingKeySource&) = delete;
+  PrefetchingKeySource& operator=(const PrefetchingKeySource&) = delete;
+
+  void FetchThreadMain();
+  // Queues the fetch of a key unless it is cached already. Requested keys are
+  // fetched before prefetched ones.
+  void ScheduleFetch(const std::string& stream_label,
+                     uint32_t crypto_period_index,
+                     bool requested) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Drops the oldest keys of |cached_keys| above Options::max_cached_keys.
+  void EvictKeys(CachedKeyMap* cached_keys)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const std::unique_ptr<KeySource> key_source_;
+  const Options options_;
+
+  absl::Mutex mutex_;
+  // Signaled when a fetch is queued, or on shutdown.
+  absl::CondVar fetch_queued_;
+  // Signaled when a key is fetched.
+  absl::CondVar key_fetched_;
+  std::map<std::string, CachedKeyMap> cached_keys_ ABSL_GUARDED_BY(mutex_);
+  std::deque<FetchRequest> fetch_queue_ ABSL_GUARDED_BY(mutex_);
+  int32_t crypto_period_duration_in_seconds_ ABSL_GUARDED_BY(mutex_) = 0;
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::thread fetch_thread_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_PREFETCHING_KEY_SOURCE_H_
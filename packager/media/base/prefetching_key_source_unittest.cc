@@ -0,0 +1,270 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/prefetching_key_source.h>
+
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <absl/synchronization/notification.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <packager/status/status_test_util.h>
+
+namespace shaka {
+namespace media {
+
+namespace {
+
+const int32_t kCryptoPeriodDurationInSeconds = 2;
+const char kSdLabel[] = "SD";
+const char kAudioLabel[] = "AUDIO";
+
+typedef std::pair<std::string, uint32_t> FetchedKey;
+
+// Stands in for a key server, generating a key per stream label and crypto
+// period, and recording the fetches.
+class FakeKeyServer : public KeySource {
+ public:
+  Status FetchKeys(EmeInitDataType, const std::vector<uint8_t>&) override {
+    return Status::OK;
+  }
+  Status GetKey(const std::string&, EncryptionKey*) override {
+    return Status(error::UNIMPLEMENTED, "");
+  }
+  Status GetKey(const std::vector<uint8_t>&, EncryptionKey*) override {
+    return Status(error::UNIMPLEMENTED, "");
+  }
+  Status GetCryptoPeriodKey(uint32_t crypto_period_index,
+                            int32_t crypto_period_duration_in_seconds,
+                            const std::string& stream_label,
+                            EncryptionKey* key) override {
+    EXPECT_EQ(kCryptoPeriodDurationInSeconds,
+              crypto_period_duration_in_seconds);
+    if (crypto_period_index == blocked_index_ && !blocked_.HasBeenNotified()) {
+      blocked_.Notify();
+      release_.WaitForNotification();
+    }
+
+    absl::MutexLock lock(&mutex_);
+    fetched_keys_.emplace_back(stream_label, crypto_period_index);
+    if (failed_indexes_.count(crypto_period_index) > 0 ||
+        failed_once_indexes_.erase(crypto_period_index) > 0) {
+      return Status(error::SERVER_ERROR, "Key server unavailable.");
+    }
+    *key = MakeKey(stream_label, crypto_period_index);
+    return Status::OK;
+  }
+
+  static EncryptionKey MakeKey(const std::string& stream_label,
+                               uint32_t crypto_period_index) {
+    EncryptionKey key;
+    key.key_id.assign(stream_label.begin(), stream_label.end());
+    key.key_id.push_back(static_cast<uint8_t>(crypto_period_index));
+    key.key.assign(16, static_cast<uint8_t>(crypto_period_index));
+    return key;
+  }
+
+  void FailOnce(uint32_t crypto_period_index) {
+    absl::MutexLock lock(&mutex_);
+    failed_once_indexes_.insert(crypto_period_index);
+  }
+
+  std::vector<FetchedKey> fetched_keys() {
+    absl::MutexLock lock(&mutex_);
+    return fetched_keys_;
+  }
+
+  // Set before the fetches start.
+  uint32_t blocked_index_ = UINT32_MAX;
+  // Notified when the first fetch of |blocked_index_| starts.
+  absl::Notification blocked_;
+  absl::Notification release_;
+  std::set<uint32_t> failed_indexes_;
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<FetchedKey> fetched_keys_ ABSL_GUARDED_BY(mutex_);
+  // Only the first fetch of these fails.
+  std::set<uint32_t> failed_once_indexes_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
+class PrefetchingKeySourceTest : public testing::Test {
+ protected:
+  PrefetchingKeySourceTest() : key_server_(new FakeKeyServer) {}
+
+  void CreateKeySource() {
+    key_source_.reset(new PrefetchingKeySource(
+        std::unique_ptr<KeySource>(key_server_), options_));
+  }
+
+  Status GetKey(const std::string& stream_label,
+                uint32_t crypto_period_index,
+                EncryptionKey* key) {
+    return key_source_->GetCryptoPeriodKey(crypto_period_index,
+                                           kCryptoPeriodDurationInSeconds,
+                                           stream_label, key);
+  }
+
+  void ExpectKey(const std::string& stream_label,
+                 uint32_t crypto_period_index) {
+    EncryptionKey key;
+    ASSERT_OK(GetKey(stream_label, crypto_period_index, &key));
+    const EncryptionKey expected_key =
+        FakeKeyServer::MakeKey(stream_label, crypto_period_index);
+    EXPECT_EQ(expected_key.key_id, key.key_id);
+    EXPECT_EQ(expected_key.key, key.key);
+  }
+
+  void WaitForFetchedKeys(uint64_t num_keys) {
+    while (key_source_->GetStats().keys_fetched < num_keys)
+      absl::SleepFor(absl::Milliseconds(1));
+  }
+
+  PrefetchingKeySource::Options options_;
+  // Owned by |key_source_|.
+  FakeKeyServer* key_server_;
+  std::unique_ptr<PrefetchingKeySource> key_source_;
+};
+
+TEST_F(PrefetchingKeySourceTest, PrefetchesKeys) {
+  options_.prefetch_count = 2;
+  CreateKeySource();
+
+  ExpectKey(kSdLabel, 0);
+  WaitForFetchedKeys(3);
+  EXPECT_THAT(key_server_->fetched_keys(),
+              testing::ElementsAre(FetchedKey(kSdLabel, 0),
+                                   FetchedKey(kSdLabel, 1),
+                                   FetchedKey(kSdLabel, 2)));
+
+  ExpectKey(kSdLabel, 1);
+  ExpectKey(kSdLabel, 2);
+  WaitForFetchedKeys(5);
+
+  const PrefetchingKeySource::Stats stats = key_source_->GetStats();
+  EXPECT_EQ(3u, stats.keys_requested);
+  EXPECT_EQ(2u, stats.keys_prefetched);
+  EXPECT_EQ(1u, stats.stalls);
+}
+
+TEST_F(PrefetchingKeySourceTest, SharesKeysBetweenStreamsOfALabel) {
+  options_.prefetch_count = 1;
+  CreateKeySource();
+
+  ExpectKey(kSdLabel, 0);
+  ExpectKey(kAudioLabel, 0);
+  ExpectKey(kSdLabel, 0);
+  WaitForFetchedKeys(4);
+  ExpectKey(kSdLabel, 1);
+  ExpectKey(kSdLabel, 1);
+  WaitForFetchedKeys(5);
+
+  EXPECT_THAT(key_server_->fetched_keys(),
+              testing::UnorderedElementsAre(
+                  FetchedKey(kSdLabel, 0), FetchedKey(kSdLabel, 1),
+                  FetchedKey(kSdLabel, 2), FetchedKey(kAudioLabel, 0),
+                  FetchedKey(kAudioLabel, 1)));
+}
+
+TEST_F(PrefetchingKeySourceTest, WaitsForKeysBeingFetched) {
+  options_.prefetch_count = 1;
+  key_server_->blocked_index_ = 1;
+  CreateKeySource();
+
+  ExpectKey(kSdLabel, 0);
+  absl::Notification got_key;
+  std::thread stream([this, &got_key]() {
+    ExpectKey(kSdLabel, 1);
+    got_key.Notify();
+  });
+  EXPECT_FALSE(got_key.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+
+  key_server_->release_.Notify();
+  stream.join();
+  const PrefetchingKeySource::Stats stats = key_source_->GetStats();
+  EXPECT_EQ(2u, stats.stalls);
+  EXPECT_GE(stats.stall_time, absl::Milliseconds(50));
+}
+
+TEST_F(PrefetchingKeySourceTest, ReturnsFetchFailures) {
+  options_.prefetch_count = 1;
+  key_server_->failed_indexes_.insert(1);
+  CreateKeySource();
+
+  ExpectKey(kSdLabel, 0);
+  EncryptionKey key;
+  EXPECT_EQ(error::SERVER_ERROR, GetKey(kSdLabel, 1, &key).error_code());
+  ExpectKey(kSdLabel, 2);
+}
+
+TEST_F(PrefetchingKeySourceTest, FetchesKeysAgainAfterFailedPrefetches) {
+  options_.prefetch_count = 1;
+  key_server_->FailOnce(1);
+  CreateKeySource();
+
+  ExpectKey(kSdLabel, 0);
+  WaitForFetchedKeys(2);
+  // The failed prefetch is not returned.
+  ExpectKey(kSdLabel, 1);
+  EXPECT_THAT(key_server_->fetched_keys(),
+              testing::Contains(FetchedKey(kSdLabel, 1)).Times(2));
+  EXPECT_EQ(1u, key_source_->GetStats().prefetches_failed);
+}
+
+TEST_F(PrefetchingKeySourceTest, FetchesKeysAgainForRequestsWaitingOnPrefetch) {
+  options_.prefetch_count = 1;
+  key_server_->blocked_index_ = 1;
+  key_server_->FailOnce(1);
+  CreateKeySource();
+
+  ExpectKey(kSdLabel, 0);
+  key_server_->blocked_.WaitForNotification();
+  std::thread stream([this]() { ExpectKey(kSdLabel, 1); });
+  // Fail the prefetch once the request waits for it.
+  while (key_source_->GetStats().stalls < 2)
+    absl::SleepFor(absl::Milliseconds(1));
+  key_server_->release_.Notify();
+  stream.join();
+
+  EXPECT_THAT(key_server_->fetched_keys(),
+              testing::Contains(FetchedKey(kSdLabel, 1)).Times(2));
+  EXPECT_EQ(1u, key_source_->GetStats().prefetches_failed);
+}
+
+TEST_F(PrefetchingKeySourceTest, EvictsOldestKeys) {
+  options_.prefetch_count = 1;
+  options_.max_cached_keys = 3;
+  CreateKeySource();
+
+  for (uint32_t i = 0; i < 6; ++i)
+    ExpectKey(kSdLabel, i);
+  EXPECT_GE(key_source_->GetStats().keys_evicted, 3u);
+
+  // Dropped keys are fetched again.
+  ExpectKey(kSdLabel, 0);
+  EXPECT_THAT(key_server_->fetched_keys(),
+              testing::Contains(FetchedKey(kSdLabel, 0)).Times(2));
+}
+
+TEST_F(PrefetchingKeySourceTest, RejectsCryptoPeriodDurationChange) {
+  CreateKeySource();
+  ExpectKey(kSdLabel, 0);
+  EncryptionKey key;
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            key_source_
+                ->GetCryptoPeriodKey(1, kCryptoPeriodDurationInSeconds + 1,
+                                     kSdLabel, &key)
+                .error_code());
+}
+
+}  // namespace media
+}  // namespace shaka
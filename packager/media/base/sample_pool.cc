@@ -0,0 +1,210 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/sample_pool.h>
+
+#include <new>
+
+#include <absl/log/check.h>
+#include <absl/numeric/bits.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// Every block starts with a header recording where it came from. It is
+// 16 bytes so that the memory handed out keeps the alignment of operator new.
+struct BlockHeader {
+  // Null for blocks that do not belong to a pool.
+  SamplePool* pool;
+  uint32_t size_class;
+  uint32_t unused;
+};
+static_assert(sizeof(BlockHeader) == 16, "BlockHeader must be 16 bytes.");
+
+// Size classes go up in quarters of a power of two, which wastes at most 25% of
+// an allocation: 64, 80, 96, 112, 128, 160, 192, ... up to kMaxPooledSize.
+const size_t kMinClassSize = 64;
+const int kMinClassSizeLog2 = 6;
+const int kClassesPerPowerOfTwo = 4;
+
+uint32_t GetSizeClass(size_t size) {
+  if (size <= kMinClassSize)
+    return 0;
+  // 2^log2 < size <= 2^(log2 + 1).
+  const int log2 = absl::bit_width(size - 1) - 1;
+  const size_t step = (size_t{1} << log2) / kClassesPerPowerOfTwo;
+  const size_t steps = (size - (size_t{1} << log2) + step - 1) / step;
+  return static_cast<uint32_t>((log2 - kMinClassSizeLog2) *
+                                   kClassesPerPowerOfTwo +
+                               steps);
+}
+
+size_t GetClassSize(uint32_t size_class) {
+  if (size_class == 0)
+    return kMinClassSize;
+  const int log2 = static_cast<int>((size_class - 1) / kClassesPerPowerOfTwo) +
+                   kMinClassSizeLog2;
+  const size_t steps = (size_class - 1) % kClassesPerPowerOfTwo + 1;
+  return (size_t{1} << log2) +
+         steps * ((size_t{1} << log2) / kClassesPerPowerOfTwo);
+}
+
+const uint32_t kNumSizeClasses = GetSizeClass(SamplePool::kMaxPooledSize) + 1;
+
+void* AllocateHeapBlock(size_t size, SamplePool* pool, uint32_t size_class) {
+  BlockHeader* header =
+      static_cast<BlockHeader*>(::operator new(sizeof(BlockHeader) + size));
+  header->pool = pool;
+  header->size_class = size_class;
+  return header;
+}
+
+void* GetUserData(void* block) {
+  return static_cast<BlockHeader*>(block) + 1;
+}
+
+BlockHeader* GetHeader(void* ptr) {
+  return static_cast<BlockHeader*>(ptr) - 1;
+}
+
+thread_local SamplePool* g_current_pool = nullptr;
+
+}  // namespace
+
+// static
+std::shared_ptr<SamplePool> SamplePool::Create(size_t max_cached_bytes) {
+  return std::shared_ptr<SamplePool>(
+      new SamplePool(max_cached_bytes),
+      [](SamplePool* pool) { pool->ReleaseOwner(); });
+}
+
+// static
+SamplePool* SamplePool::Current() {
+  return g_current_pool;
+}
+
+// static
+void* SamplePool::Allocate(size_t size) {
+  SamplePool* pool = g_current_pool;
+  if (pool && size <= kMaxPooledSize)
+    return pool->AllocateBlock(size);
+  if (pool) {
+    absl::MutexLock lock(&pool->mutex_);
+    ++pool->stats_.oversized_allocations;
+  }
+  return GetUserData(AllocateHeapBlock(size, nullptr, 0));
+}
+
+// static
+void SamplePool::Free(void* ptr) {
+  if (!ptr)
+    return;
+  BlockHeader* header = GetHeader(ptr);
+  if (header->pool)
+    header->pool->FreeBlock(header, header->size_class);
+  else
+    ::operator delete(header);
+}
+
+// static
+std::shared_ptr<uint8_t> SamplePool::AllocateBuffer(size_t size) {
+  return std::shared_ptr<uint8_t>(static_cast<uint8_t*>(Allocate(size)),
+                                  [](uint8_t* buffer) { Free(buffer); },
+                                  SamplePoolAllocator<uint8_t>());
+}
+
+SamplePool::Stats SamplePool::GetStats() const {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+SamplePool::SamplePool(size_t max_cached_bytes)
+    : max_cached_bytes_(max_cached_bytes), free_lists_(kNumSizeClasses) {}
+
+SamplePool::~SamplePool() {
+  DCHECK_EQ(stats_.blocks_in_use, 0u);
+  for (std::vector<void*>& free_list : free_lists_) {
+    for (void* block : free_list)
+      ::operator delete(block);
+  }
+}
+
+void* SamplePool::AllocateBlock(size_t size) {
+  const uint32_t size_class = GetSizeClass(size);
+  DCHECK_LT(size_class, kNumSizeClasses);
+  ref_count_.fetch_add(1, std::memory_order_relaxed);
+
+  void* block = nullptr;
+  {
+    absl::MutexLock lock(&mutex_);
+    ++stats_.allocations;
+    ++stats_.blocks_in_use;
+    std::vector<void*>& free_list = free_lists_[size_class];
+    if (!free_list.empty()) {
+      block = free_list.back();
+      free_list.pop_back();
+      stats_.cached_bytes -= GetClassSize(size_class);
+    } else {
+      ++stats_.heap_allocations;
+    }
+  }
+  if (!block)
+    block = AllocateHeapBlock(GetClassSize(size_class), this, size_class);
+  return GetUserData(block);
+}
+
+void SamplePool::FreeBlock(void* block, uint32_t size_class) {
+  DCHECK_LT(size_class, kNumSizeClasses);
+  bool cached = false;
+  {
+    absl::MutexLock lock(&mutex_);
+    --stats_.blocks_in_use;
+    const size_t class_size = GetClassSize(size_class);
+    if (!owner_released_ &&
+        stats_.cached_bytes + class_size <= max_cached_bytes_) {
+      free_lists_[size_class].push_back(block);
+      stats_.cached_bytes += class_size;
+      cached = true;
+    }
+  }
+  if (!cached)
+    ::operator delete(block);
+  Unref();
+}
+
+void SamplePool::ReleaseOwner() {
+  std::vector<std::vector<void*>> free_lists(kNumSizeClasses);
+  {
+    absl::MutexLock lock(&mutex_);
+    owner_released_ = true;
+    free_lists.swap(free_lists_);
+    stats_.cached_bytes = 0;
+  }
+  for (std::vector<void*>& free_list : free_lists) {
+    for (void* block : free_list)
+      ::operator delete(block);
+  }
+  Unref();
+}
+
+void SamplePool::Unref() {
+  if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    delete this;
+}
+
+ScopedSamplePool::ScopedSamplePool(std::shared_ptr<SamplePool> pool)
+    : pool_(std::move(pool)), previous_pool_(g_current_pool) {
+  g_current_pool = pool_.get();
+}
+
+ScopedSamplePool::~ScopedSamplePool() {
+  DCHECK_EQ(g_current_pool, pool_.get());
+  g_current_pool = previous_pool_;
+}
+
+}  // namespace media
+}  // namespace shaka
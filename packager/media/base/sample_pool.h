@@ -0,0 +1,147 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_SAMPLE_POOL_H_
+#define PACKAGER_MEDIA_BASE_SAMPLE_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
+#include <packager/macros/classes.h>
+
+namespace shaka {
+namespace media {
+
+/// Recycles the memory allocated for every sample flowing through a pipeline:
+/// MediaSample, StreamData and DecryptConfig objects, their shared_ptr control
+/// blocks and the sample payload buffers.
+///
+/// Allocations are served by the pool installed on the calling thread with
+/// ScopedSamplePool, normally the thread running the pipeline, or by the heap
+/// if there is none. Blocks are grouped in size classes and go back to the
+/// free list of the pool they came from when released, from any thread, so a
+/// pipeline in steady state stops allocating from the heap once its free lists
+/// cover the samples in flight. Pipelines do not share pools, so they do not
+/// contend with each other.
+class SamplePool {
+ public:
+  /// Allocation statistics of a pool.
+  struct Stats {
+    /// Allocations served by the pool.
+    uint64_t allocations = 0;
+    /// Allocations which could not reuse a cached block and went to the heap.
+    uint64_t heap_allocations = 0;
+    /// Allocations too large to be pooled. These always go to the heap, and
+    /// are not included in |allocations|.
+    uint64_t oversized_allocations = 0;
+    /// Blocks currently allocated from the pool.
+    uint64_t blocks_in_use = 0;
+    /// Bytes currently cached in the free lists.
+    uint64_t cached_bytes = 0;
+  };
+
+  /// Allocations larger than this are not pooled.
+  static constexpr size_t kMaxPooledSize = 16 << 20;
+  /// Default upper bound on the bytes kept in the free lists of a pool.
+  static constexpr size_t kDefaultMaxCachedBytes = 64 << 20;
+
+  /// Create a pool. It is released when the last reference is dropped and
+  /// every block allocated from it has been freed.
+  /// @param max_cached_bytes bounds the memory held in the free lists; freed
+  ///        blocks beyond it are returned to the heap.
+  static std::shared_ptr<SamplePool> Create(
+      size_t max_cached_bytes = kDefaultMaxCachedBytes);
+
+  /// @return The pool installed on the calling thread, or nullptr.
+  static SamplePool* Current();
+
+  /// Allocate @a size bytes from the current pool, or from the heap if there
+  /// is none. The memory is suitably aligned for any fundamental type.
+  static void* Allocate(size_t size);
+
+  /// Free memory returned by Allocate(). Can be called from any thread.
+  static void Free(void* ptr);
+
+  /// Allocate a payload buffer of @a size bytes, which goes back to its pool
+  /// when the last reference is dropped.
+  static std::shared_ptr<uint8_t> AllocateBuffer(size_t size);
+
+  /// @return The current statistics of this pool.
+  Stats GetStats() const;
+
+ private:
+  friend class ScopedSamplePool;
+
+  explicit SamplePool(size_t max_cached_bytes);
+  ~SamplePool();
+
+  void* AllocateBlock(size_t size);
+  void FreeBlock(void* block, uint32_t size_class);
+  // Called when the shared_ptr returned by Create() goes away.
+  void ReleaseOwner();
+  void Unref();
+
+  const size_t max_cached_bytes_;
+  // One for the owner plus one per block in use.
+  std::atomic<int64_t> ref_count_{1};
+
+  mutable absl::Mutex mutex_;
+  std::vector<std::vector<void*>> free_lists_ ABSL_GUARDED_BY(mutex_);
+  bool owner_released_ ABSL_GUARDED_BY(mutex_) = false;
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+
+  DISALLOW_COPY_AND_ASSIGN(SamplePool);
+};
+
+/// Installs a pool on the current thread for the lifetime of this object.
+class ScopedSamplePool {
+ public:
+  explicit ScopedSamplePool(std::shared_ptr<SamplePool> pool);
+  ~ScopedSamplePool();
+
+ private:
+  std::shared_ptr<SamplePool> pool_;
+  SamplePool* previous_pool_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedSamplePool);
+};
+
+/// A standard allocator on top of SamplePool, e.g. for the control blocks of
+/// the shared_ptrs holding samples.
+template <typename T>
+class SamplePoolAllocator {
+ public:
+  typedef T value_type;
+
+  SamplePoolAllocator() = default;
+  template <typename U>
+  SamplePoolAllocator(const SamplePoolAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(SamplePool::Allocate(n * sizeof(T)));
+  }
+  void deallocate(T* ptr, size_t) { SamplePool::Free(ptr); }
+
+  template <typename U>
+  bool operator==(const SamplePoolAllocator<U>&) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const SamplePoolAllocator<U>&) const {
+    return false;
+  }
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_SAMPLE_POOL_H_
@@ -0,0 +1,136 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/sample_pool.h>
+
+#include <cstring>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <packager/media/base/media_handler.h>
+#include <packager/media/base/media_sample.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const uint8_t kData[] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+}  // namespace
+
+TEST(SamplePoolTest, NoPool) {
+  EXPECT_EQ(nullptr, SamplePool::Current());
+  void* ptr = SamplePool::Allocate(100);
+  ASSERT_TRUE(ptr);
+  memset(ptr, 0, 100);
+  SamplePool::Free(ptr);
+  SamplePool::Free(nullptr);
+
+  std::shared_ptr<MediaSample> sample =
+      MediaSample::CopyFrom(kData, sizeof(kData), true);
+  EXPECT_EQ(0, memcmp(kData, sample->data(), sizeof(kData)));
+}
+
+TEST(SamplePoolTest, ReusesFreedBlocks) {
+  std::shared_ptr<SamplePool> pool = SamplePool::Create();
+  ScopedSamplePool scoped_pool(pool);
+  EXPECT_EQ(pool.get(), SamplePool::Current());
+
+  void* ptr = SamplePool::Allocate(1000);
+  SamplePool::Free(ptr);
+  // Sizes in the same size class share blocks.
+  void* reused_ptr = SamplePool::Allocate(990);
+  EXPECT_EQ(ptr, reused_ptr);
+  SamplePool::Free(reused_ptr);
+
+  SamplePool::Stats stats = pool->GetStats();
+  EXPECT_EQ(2u, stats.allocations);
+  EXPECT_EQ(1u, stats.heap_allocations);
+  EXPECT_EQ(0u, stats.blocks_in_use);
+  EXPECT_GE(stats.cached_bytes, 1000u);
+}
+
+TEST(SamplePoolTest, SteadyStateSamplesDoNotHitTheHeap) {
+  std::shared_ptr<SamplePool> pool = SamplePool::Create();
+  ScopedSamplePool scoped_pool(pool);
+
+  uint64_t heap_allocations = 0;
+  for (int i = 0; i < 10; ++i) {
+    std::shared_ptr<MediaSample> sample =
+        MediaSample::CopyFrom(kData, sizeof(kData), true);
+    sample->set_decrypt_config(std::unique_ptr<DecryptConfig>(
+        new DecryptConfig(std::vector<uint8_t>(16, 1),
+                          std::vector<uint8_t>(16, 2),
+                          std::vector<SubsampleEntry>())));
+    std::unique_ptr<StreamData> stream_data =
+        StreamData::FromMediaSample(0, sample->Clone());
+    EXPECT_EQ(0, memcmp(kData, stream_data->media_sample->data(),
+                        sizeof(kData)));
+    if (i == 0)
+      heap_allocations = pool->GetStats().heap_allocations;
+  }
+  EXPECT_EQ(heap_allocations, pool->GetStats().heap_allocations);
+  EXPECT_EQ(0u, pool->GetStats().blocks_in_use);
+}
+
+TEST(SamplePoolTest, FreeOnAnotherThread) {
+  std::shared_ptr<SamplePool> pool = SamplePool::Create();
+  std::shared_ptr<MediaSample> sample;
+  {
+    ScopedSamplePool scoped_pool(pool);
+    sample = MediaSample::CopyFrom(kData, sizeof(kData), true);
+  }
+  EXPECT_EQ(nullptr, SamplePool::Current());
+  EXPECT_NE(0u, pool->GetStats().blocks_in_use);
+
+  std::thread thread([&sample]() { sample.reset(); });
+  thread.join();
+  EXPECT_EQ(0u, pool->GetStats().blocks_in_use);
+}
+
+TEST(SamplePoolTest, BlocksOutliveThePool) {
+  std::shared_ptr<MediaSample> sample;
+  {
+    std::shared_ptr<SamplePool> pool = SamplePool::Create();
+    ScopedSamplePool scoped_pool(pool);
+    sample = MediaSample::CopyFrom(kData, sizeof(kData), true);
+  }
+  // The pool is kept alive until its last block is freed.
+  EXPECT_EQ(0, memcmp(kData, sample->data(), sizeof(kData)));
+  sample.reset();
+}
+
+TEST(SamplePoolTest, OversizedAllocations) {
+  std::shared_ptr<SamplePool> pool = SamplePool::Create();
+  ScopedSamplePool scoped_pool(pool);
+
+  std::shared_ptr<uint8_t> buffer =
+      SamplePool::AllocateBuffer(SamplePool::kMaxPooledSize + 1);
+  buffer.get()[SamplePool::kMaxPooledSize] = 1;
+  buffer.reset();
+
+  SamplePool::Stats stats = pool->GetStats();
+  EXPECT_EQ(1u, stats.oversized_allocations);
+  EXPECT_EQ(0u, stats.blocks_in_use);
+  EXPECT_LT(stats.cached_bytes, SamplePool::kMaxPooledSize);
+}
+
+TEST(SamplePoolTest, CachedBytesAreBounded) {
+  const size_t kMaxCachedBytes = 4096;
+  std::shared_ptr<SamplePool> pool = SamplePool::Create(kMaxCachedBytes);
+  ScopedSamplePool scoped_pool(pool);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 10; ++i)
+    ptrs.push_back(SamplePool::Allocate(1024));
+  for (void* ptr : ptrs)
+    SamplePool::Free(ptr);
+  EXPECT_LE(pool->GetStats().cached_bytes, kMaxCachedBytes);
+}
+
+}  // namespace media
+}  // namespace shaka
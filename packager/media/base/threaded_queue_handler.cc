@@ -0,0 +1,143 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/threaded_queue_handler.h>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+
+#include <packager/file/work_stealing_executor.h>
+#include <packager/macros/status.h>
+#include <packager/utils/telemetry.h>
+
+namespace shaka {
+namespace media {
+namespace {
+const size_t kStreamIndex = 0;
+}  // namespace
+
+ThreadedQueueHandler::ThreadedQueueHandler(size_t queue_capacity)
+    : queue_capacity_(queue_capacity) {
+  DCHECK_GT(queue_capacity, 0u);
+}
+
+ThreadedQueueHandler::~ThreadedQueueHandler() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stopped_ = true;
+    queue_not_empty_.SignalAll();
+    queue_not_full_.SignalAll();
+    flush_done_.SignalAll();
+  }
+  if (worker_exited_)
+    worker_exited_->WaitForNotification();
+}
+
+Status ThreadedQueueHandler::InitializeInternal() {
+  if (num_input_streams() != 1 || next_output_stream_index() != 1) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Expects exactly one input and one output.");
+  }
+  if (!worker_exited_) {
+    worker_exited_.reset(new absl::Notification);
+    if (!WorkStealingExecutor::Cpu()->PostBlockingTask([this]() {
+          WorkerLoop();
+          worker_exited_->Notify();
+        })) {
+      LOG(WARNING) << "No thread is available for the output queue, so the "
+                      "output is processed on the input thread. Increase "
+                      "--num_cpu_threads to process it in parallel.";
+      worker_exited_.reset();
+    }
+  }
+  return Status::OK;
+}
+
+Status ThreadedQueueHandler::Process(std::unique_ptr<StreamData> stream_data) {
+  DCHECK(stream_data);
+  DCHECK_EQ(stream_data->stream_index, kStreamIndex);
+  if (!worker_exited_)
+    return Dispatch(std::move(stream_data));
+  return Push(std::move(stream_data));
+}
+
+Status ThreadedQueueHandler::OnFlushRequest(size_t input_stream_index) {
+  DCHECK_EQ(input_stream_index, kStreamIndex);
+  if (!worker_exited_)
+    return FlushDownstream(kStreamIndex);
+  RETURN_IF_ERROR(Push(nullptr));
+
+  absl::MutexLock lock(&mutex_);
+  const size_t flush_id = flushes_requested_;
+  while (flushes_completed_ < flush_id && !stopped_)
+    flush_done_.Wait(&mutex_);
+  if (flushes_completed_ < flush_id)
+    return Status(error::CANCELLED, "Handler stopped before flushing.");
+  return worker_status_;
+}
+
+Status ThreadedQueueHandler::Push(std::unique_ptr<StreamData> stream_data) {
+  absl::MutexLock lock(&mutex_);
+  while (queue_.size() >= queue_capacity_ && worker_status_.ok() && !stopped_)
+    queue_not_full_.Wait(&mutex_);
+  if (!worker_status_.ok())
+    return worker_status_;
+  if (stopped_)
+    return Status(error::CANCELLED, "Handler stopped.");
+
+  if (!stream_data)
+    ++flushes_requested_;
+  queue_.push_back(std::move(stream_data));
+  Telemetry::RecordQueueDepth(telemetry_id(kStreamIndex), queue_.size());
+  queue_not_empty_.Signal();
+  return Status::OK;
+}
+
+void ThreadedQueueHandler::WorkerLoop() {
+  while (true) {
+    std::unique_ptr<StreamData> stream_data;
+    bool is_flush = false;
+    {
+      absl::MutexLock lock(&mutex_);
+      while (queue_.empty() && !stopped_)
+        queue_not_empty_.Wait(&mutex_);
+      if (stopped_)
+        return;
+      stream_data = std::move(queue_.front());
+      queue_.pop_front();
+      is_flush = !stream_data;
+      queue_not_full_.Signal();
+
+      // Once downstream has failed, the remaining stream data is dropped. The
+      // error is reported to upstream on its next call.
+      if (!worker_status_.ok()) {
+        if (is_flush) {
+          ++flushes_completed_;
+          flush_done_.SignalAll();
+        }
+        continue;
+      }
+    }
+
+    // Dispatch without holding the lock, so upstream can keep queueing.
+    Status status = is_flush ? FlushDownstream(kStreamIndex)
+                             : Dispatch(std::move(stream_data));
+
+    absl::MutexLock lock(&mutex_);
+    if (!status.ok()) {
+      worker_status_ = status;
+      // Wake up upstream if it is waiting for space in the queue.
+      queue_not_full_.SignalAll();
+    }
+    if (is_flush) {
+      ++flushes_completed_;
+      flush_done_.SignalAll();
+    }
+  }
+}
+
+}  // namespace media
+}  // namespace shaka
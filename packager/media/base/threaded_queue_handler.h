@@ -0,0 +1,81 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_THREADED_QUEUE_HANDLER_H_
+#define PACKAGER_MEDIA_BASE_THREADED_QUEUE_HANDLER_H_
+
+#include <deque>
+#include <memory>
+
+#include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
+
+#include <packager/media/base/media_handler.h>
+
+namespace shaka {
+namespace media {
+
+/// A single input single output pass-through handler which decouples its
+/// upstream and downstream handlers with a bounded queue. Stream data is
+/// pushed to the queue by the upstream thread and dispatched downstream, in
+/// order, by a worker running on a blocking thread of the CPU executor, so the
+/// downstream part of the graph runs in parallel with the upstream part. If
+/// the executor has no thread left, stream data is dispatched directly by the
+/// upstream thread instead.
+///
+/// Process() blocks while the queue is full, which throttles the upstream
+/// handlers to the rate of the downstream handlers. OnFlushRequest() blocks
+/// until everything queued before it has been dispatched and the downstream
+/// handlers have been flushed, so flush semantics are the same as for a
+/// directly connected graph. An error returned by a downstream handler is
+/// returned by the next call to Process() or OnFlushRequest().
+class ThreadedQueueHandler : public MediaHandler {
+ public:
+  /// @param queue_capacity is the maximum number of stream data queued before
+  ///        Process() blocks. Must be positive.
+  explicit ThreadedQueueHandler(size_t queue_capacity);
+  ~ThreadedQueueHandler() override;
+
+ protected:
+  /// @name MediaHandler implementation overrides.
+  /// @{
+  Status InitializeInternal() override;
+  Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status OnFlushRequest(size_t input_stream_index) override;
+  /// @}
+
+ private:
+  ThreadedQueueHandler(const ThreadedQueueHandler&) = delete;
+  ThreadedQueueHandler& operator=(const ThreadedQueueHandler&) = delete;
+
+  // Pushes |stream_data| to the queue, waiting for space if needed. A null
+  // |stream_data| is a flush request.
+  Status Push(std::unique_ptr<StreamData> stream_data);
+  void WorkerLoop();
+
+  const size_t queue_capacity_;
+
+  absl::Mutex mutex_;
+  absl::CondVar queue_not_empty_;
+  absl::CondVar queue_not_full_;
+  absl::CondVar flush_done_;
+  std::deque<std::unique_ptr<StreamData>> queue_ ABSL_GUARDED_BY(mutex_);
+  // Number of flush requests queued and completed by the worker so far.
+  size_t flushes_requested_ ABSL_GUARDED_BY(mutex_) = 0;
+  size_t flushes_completed_ ABSL_GUARDED_BY(mutex_) = 0;
+  // First error returned by the downstream handlers.
+  Status worker_status_ ABSL_GUARDED_BY(mutex_);
+  bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+
+  // Notified when the worker exits. Null if there is no worker, in which case
+  // stream data is dispatched directly.
+  std::unique_ptr<absl::Notification> worker_exited_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_THREADED_QUEUE_HANDLER_H_
@@ -0,0 +1,160 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/threaded_queue_handler.h>
+
+#include <thread>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
+#include <gtest/gtest.h>
+
+#include <packager/media/base/media_handler_test_base.h>
+#include <packager/status/status_test_util.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const size_t kStreamIndex = 0;
+const size_t kQueueCapacity = 2;
+const int64_t kDuration = 100;
+
+// Records the timestamps of the samples it receives. It can be blocked to
+// simulate a slow output, and can fail on a specific sample.
+class RecordingHandler : public MediaHandler {
+ public:
+  void Block() { unblocked_.reset(new absl::Notification); }
+  void Unblock() { unblocked_->Notify(); }
+  void FailAt(int64_t timestamp) { fail_at_ = timestamp; }
+
+  std::vector<int64_t> timestamps() {
+    absl::MutexLock lock(&mutex_);
+    return timestamps_;
+  }
+  int num_flushes() {
+    absl::MutexLock lock(&mutex_);
+    return num_flushes_;
+  }
+  std::thread::id thread_id() {
+    absl::MutexLock lock(&mutex_);
+    return thread_id_;
+  }
+
+ private:
+  Status InitializeInternal() override { return Status::OK; }
+
+  Status Process(std::unique_ptr<StreamData> stream_data) override {
+    if (unblocked_)
+      unblocked_->WaitForNotification();
+    const int64_t timestamp = stream_data->media_sample->dts();
+    if (timestamp == fail_at_)
+      return Status(error::MUXER_FAILURE, "Failed.");
+
+    absl::MutexLock lock(&mutex_);
+    timestamps_.push_back(timestamp);
+    thread_id_ = std::this_thread::get_id();
+    return Status::OK;
+  }
+
+  Status OnFlushRequest(size_t /* input_stream_index */) override {
+    absl::MutexLock lock(&mutex_);
+    ++num_flushes_;
+    return Status::OK;
+  }
+
+  std::unique_ptr<absl::Notification> unblocked_;
+  int64_t fail_at_ = -1;
+
+  absl::Mutex mutex_;
+  std::vector<int64_t> timestamps_ ABSL_GUARDED_BY(mutex_);
+  int num_flushes_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::thread::id thread_id_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
+class ThreadedQueueHandlerTest : public MediaHandlerTestBase {
+ protected:
+  void SetUp() override {
+    input_ = std::make_shared<FakeInputMediaHandler>();
+    queue_handler_ = std::make_shared<ThreadedQueueHandler>(kQueueCapacity);
+    output_ = std::make_shared<RecordingHandler>();
+    ASSERT_OK(MediaHandler::Chain({input_, queue_handler_, output_}));
+    ASSERT_OK(input_->Initialize());
+  }
+
+  Status DispatchSample(int64_t timestamp) {
+    return input_->Dispatch(StreamData::FromMediaSample(
+        kStreamIndex, GetMediaSample(timestamp, kDuration, true)));
+  }
+
+  std::shared_ptr<FakeInputMediaHandler> input_;
+  std::shared_ptr<ThreadedQueueHandler> queue_handler_;
+  std::shared_ptr<RecordingHandler> output_;
+};
+
+TEST_F(ThreadedQueueHandlerTest, PreservesOrderAndFlushes) {
+  const int kNumSamples = 100;
+  std::vector<int64_t> expected;
+  for (int i = 0; i < kNumSamples; ++i) {
+    ASSERT_OK(DispatchSample(i * kDuration));
+    expected.push_back(i * kDuration);
+  }
+  ASSERT_OK(input_->FlushAllDownstreams());
+
+  // Everything is delivered by the time the flush returns.
+  EXPECT_EQ(expected, output_->timestamps());
+  EXPECT_EQ(1, output_->num_flushes());
+  EXPECT_NE(std::this_thread::get_id(), output_->thread_id());
+}
+
+TEST_F(ThreadedQueueHandlerTest, BlocksWhenQueueIsFull) {
+  output_->Block();
+
+  absl::Notification done;
+  std::thread producer([this, &done]() {
+    // One sample held by the blocked output, kQueueCapacity queued, and one
+    // more that has to wait for space.
+    for (size_t i = 0; i < kQueueCapacity + 2; ++i)
+      EXPECT_OK(DispatchSample(i * kDuration));
+    done.Notify();
+  });
+
+  EXPECT_FALSE(done.WaitForNotificationWithTimeout(absl::Milliseconds(100)));
+  output_->Unblock();
+  producer.join();
+
+  ASSERT_OK(input_->FlushAllDownstreams());
+  EXPECT_EQ(kQueueCapacity + 2, output_->timestamps().size());
+}
+
+TEST_F(ThreadedQueueHandlerTest, PropagatesDownstreamError) {
+  output_->FailAt(kDuration);
+
+  ASSERT_OK(DispatchSample(0));
+  ASSERT_OK(DispatchSample(kDuration));
+
+  // The failure is asynchronous. It is reported no later than the flush.
+  Status status;
+  for (int i = 2; i < 10 && status.ok(); ++i)
+    status = DispatchSample(i * kDuration);
+  if (status.ok())
+    status = input_->FlushAllDownstreams();
+  EXPECT_EQ(error::MUXER_FAILURE, status.error_code());
+  EXPECT_EQ(std::vector<int64_t>{0}, output_->timestamps());
+}
+
+TEST_F(ThreadedQueueHandlerTest, RequiresOneInputAndOneOutput) {
+  auto handler = std::make_shared<ThreadedQueueHandler>(kQueueCapacity);
+  auto input = std::make_shared<FakeInputMediaHandler>();
+  ASSERT_OK(input->AddHandler(handler));
+  EXPECT_EQ(error::INVALID_ARGUMENT, input->Initialize().error_code());
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -12,6 +12,7 @@
 
 #include <packager/macros/logging.h>
 #include <packager/macros/status.h>
+#include <packager/utils/telemetry.h>
 
 namespace shaka {
 namespace media {
@@ -63,6 +64,30 @@ double TextEndTimeInSeconds(const StreamInfo& info, const StreamData& data) {
   return static_cast<double>(scaled_time) / time_scale;
 }
 
+size_t TextFragmentSize(const TextFragment& fragment) {
+  size_t size = fragment.body.size() + fragment.image.size();
+  for (const TextFragment& sub_fragment : fragment.sub_fragments)
+    size += TextFragmentSize(sub_fragment);
+  return size;
+}
+
+uint64_t PayloadBytes(const StreamData& data) {
+  DCHECK(data.text_sample || data.media_sample);
+
+  if (data.text_sample)
+    return TextFragmentSize(data.text_sample->body());
+  return data.media_sample->data_size() + data.media_sample->side_data_size();
+}
+
+double BufferedDurationInSeconds(
+    const StreamInfo& info,
+    const std::list<std::unique_ptr<StreamData>>& samples) {
+  if (samples.empty())
+    return 0;
+  return TimeInSeconds(info, *samples.back()) -
+         TimeInSeconds(info, *samples.front());
+}
+
 Status GetNextCue(double hint,
                   SyncPointQueue* sync_points,
                   std::shared_ptr<const CueEvent>* out_cue) {
@@ -77,12 +102,22 @@ Status GetNextCue(double hint,
 }
 }  // namespace
 
-CueAlignmentHandler::CueAlignmentHandler(SyncPointQueue* sync_points)
-    : sync_points_(sync_points) {}
+CueAlignmentHandler::CueAlignmentHandler(SyncPointQueue* sync_points,
+                                         const AdCueGeneratorParams& params)
+    : sync_points_(sync_points), params_(params) {}
+
+std::vector<CueAlignmentHandler::StreamStats> CueAlignmentHandler::GetStats() {
+  absl::MutexLock lock(&stats_mutex_);
+  return stats_;
+}
 
 Status CueAlignmentHandler::InitializeInternal() {
   sync_points_->AddThread();
   stream_states_.resize(num_input_streams());
+  {
+    absl::MutexLock lock(&stats_mutex_);
+    stats_.resize(num_input_streams());
+  }
 
   // Get the first hint for the stream. Use a negative hint so that if there is
   // suppose to be a sync point at zero, we will still respect it.
@@ -96,8 +131,12 @@ Status CueAlignmentHandler::Process(std::unique_ptr<StreamData> data) {
     case StreamDataType::kStreamInfo:
       return OnStreamInfo(std::move(data));
     case StreamDataType::kTextSample:
-    case StreamDataType::kMediaSample:
-      return OnSample(std::move(data));
+    case StreamDataType::kMediaSample: {
+      const size_t stream_index = data->stream_index;
+      Status status = OnSample(std::move(data));
+      UpdateStats(stream_index);
+      return status;
+    }
     default:
       VLOG(3) << "Dropping unsupported data type "
               << static_cast<int>(data->stream_data_type);
@@ -165,6 +204,18 @@ Status CueAlignmentHandler::OnFlushRequest(size_t stream_index) {
     stream.cues.clear();
   }
 
+  for (size_t i = 0; i < stream_states_.size(); ++i) {
+    EndDropRun(i);
+    UpdateStats(i);
+
+    const StreamStats& stats = stream_states_[i].stats;
+    VLOG(1) << "Stream " << i << " buffered up to "
+            << stats.max_buffered_duration_seconds << "s for cue alignment, "
+            << stats.overflows << " overflows, " << stats.samples_dropped
+            << " samples dropped, " << stats.cues_promoted
+            << " cues promoted, blocked for " << stats.blocked_time << ".";
+  }
+
   return FlushAllDownstreams();
 }
 
@@ -270,6 +321,8 @@ Status CueAlignmentHandler::UseNewSyncPoint(
     stream.cues.push_back(StreamData::FromCueEvent(stream_index, new_sync));
 
     RETURN_IF_ERROR(RunThroughSamples(&stream));
+    EndDropRun(stream_index);
+    UpdateStats(stream_index);
   }
 
   return Status::OK;
@@ -294,6 +347,7 @@ Status CueAlignmentHandler::AcceptSample(std::unique_ptr<StreamData> sample,
   // the sample to the queue.
   const size_t stream_index = sample->stream_index;
 
+  stream->buffered_bytes += PayloadBytes(*sample);
   stream->samples.push_back(std::move(sample));
 
   if (stream->samples.size() > kMaxBufferSize) {
@@ -304,7 +358,12 @@ Status CueAlignmentHandler::AcceptSample(std::unique_ptr<StreamData> sample,
                   "Streams are not properly multiplexed.");
   }
 
-  return RunThroughSamples(stream);
+  RETURN_IF_ERROR(RunThroughSamples(stream));
+  stream->stats.max_buffered_duration_seconds =
+      std::max(stream->stats.max_buffered_duration_seconds,
+               BufferedDurationInSeconds(*stream->info, stream->samples));
+  return ExceedsBufferLimits(*stream) ? OnBufferOverflow(stream_index)
+                                      : Status::OK;
 }
 
 Status CueAlignmentHandler::RunThroughSamples(StreamState* stream) {
@@ -316,8 +375,7 @@ Status CueAlignmentHandler::RunThroughSamples(StreamState* stream) {
         TimeInSeconds(*stream->info, *stream->samples.front());
 
     if (sample_time < cue_time) {
-      RETURN_IF_ERROR(Dispatch(std::move(stream->samples.front())));
-      stream->samples.pop_front();
+      RETURN_IF_ERROR(Dispatch(PopSample(stream)));
     } else {
       RETURN_IF_ERROR(Dispatch(std::move(stream->cues.front())));
       stream->cues.pop_front();
@@ -329,11 +387,115 @@ Status CueAlignmentHandler::RunThroughSamples(StreamState* stream) {
   // downstream.
   while (stream->samples.size() &&
          TimeInSeconds(*stream->info, *stream->samples.front()) < hint_) {
-    RETURN_IF_ERROR(Dispatch(std::move(stream->samples.front())));
-    stream->samples.pop_front();
+    RETURN_IF_ERROR(Dispatch(PopSample(stream)));
+  }
+
+  return Status::OK;
+}
+
+std::unique_ptr<StreamData> CueAlignmentHandler::PopSample(
+    StreamState* stream) {
+  DCHECK(!stream->samples.empty());
+
+  std::unique_ptr<StreamData> sample = std::move(stream->samples.front());
+  stream->samples.pop_front();
+  stream->buffered_bytes -= PayloadBytes(*sample);
+  return sample;
+}
+
+bool CueAlignmentHandler::ExceedsBufferLimits(const StreamState& stream) const {
+  if (params_.max_buffered_bytes > 0 &&
+      stream.buffered_bytes > params_.max_buffered_bytes) {
+    return true;
+  }
+  return params_.max_buffered_duration_in_seconds > 0 &&
+         BufferedDurationInSeconds(*stream.info, stream.samples) >
+             params_.max_buffered_duration_in_seconds;
+}
+
+Status CueAlignmentHandler::OnBufferOverflow(size_t stream_index) {
+  typedef AdCueGeneratorParams::BufferOverflowPolicy BufferOverflowPolicy;
+
+  StreamState* stream = &stream_states_[stream_index];
+  ++stream->stats.overflows;
+  // The samples of a demuxer with video are released by the video stream
+  // reaching the cue, which cannot happen while this thread is blocked.
+  const BufferOverflowPolicy policy =
+      HasVideoStream() ? BufferOverflowPolicy::kDrop
+                       : params_.buffer_overflow_policy;
+
+  if (policy == BufferOverflowPolicy::kDrop) {
+    size_t num_dropped = 0;
+    // Keep the last sample, even if larger than the limit by itself.
+    while (stream->samples.size() > 1 && ExceedsBufferLimits(*stream)) {
+      PopSample(stream);
+      ++num_dropped;
+    }
+    stream->stats.samples_dropped += num_dropped;
+    // With a duration limit, every new sample overflows once the limit is
+    // reached, so log only the start of the run here and its total when it
+    // ends.
+    if (stream->samples_dropped_in_run == 0 && num_dropped > 0) {
+      LOG(WARNING) << "Stream " << stream_index
+                   << " exceeded the cue alignment buffer limits waiting for "
+                      "the cue at "
+                   << hint_ << "s. Dropping samples.";
+    }
+    stream->samples_dropped_in_run += num_dropped;
+    return Status::OK;
   }
 
+  // New sync points release the samples up to the next hint, which may still
+  // be before the buffered samples.
+  while (ExceedsBufferLimits(*stream)) {
+    std::shared_ptr<const CueEvent> next_sync;
+    if (policy == BufferOverflowPolicy::kPromoteCue) {
+      // Fails if the cue has been promoted by another thread meanwhile, in
+      // which case it is returned by GetNextCue() without blocking. The video
+      // streams of other threads pick up the cue at their next key frame.
+      next_sync = sync_points_->PromoteEarly(hint_);
+      if (next_sync)
+        ++stream->stats.cues_promoted;
+    }
+    if (!next_sync) {
+      const absl::Time start = absl::Now();
+      RETURN_IF_ERROR(GetNextCue(hint_, sync_points_, &next_sync));
+      stream->stats.blocked_time += absl::Now() - start;
+    }
+    RETURN_IF_ERROR(UseNewSyncPoint(std::move(next_sync)));
+  }
   return Status::OK;
 }
+
+bool CueAlignmentHandler::HasVideoStream() const {
+  for (const StreamState& stream_state : stream_states_) {
+    if (stream_state.info && stream_state.info->stream_type() == kStreamVideo)
+      return true;
+  }
+  return false;
+}
+
+void CueAlignmentHandler::EndDropRun(size_t stream_index) {
+  StreamState& stream = stream_states_[stream_index];
+  if (stream.samples_dropped_in_run == 0)
+    return;
+  LOG(WARNING) << "Dropped " << stream.samples_dropped_in_run
+               << " samples of stream " << stream_index
+               << " waiting for a cue.";
+  stream.samples_dropped_in_run = 0;
+}
+
+void CueAlignmentHandler::UpdateStats(size_t stream_index) {
+  StreamState& stream = stream_states_[stream_index];
+  stream.stats.buffered_samples = stream.samples.size();
+  stream.stats.buffered_bytes = stream.buffered_bytes;
+  stream.stats.buffered_duration_seconds =
+      stream.info ? BufferedDurationInSeconds(*stream.info, stream.samples) : 0;
+  Telemetry::RecordQueueDepth(telemetry_id(stream_index),
+                              stream.samples.size());
+
+  absl::MutexLock lock(&stats_mutex_);
+  stats_[stream_index] = stream.stats;
+}
 }  // namespace media
 }  // namespace shaka
@@ -9,7 +9,13 @@
 
 #include <deque>
 #include <list>
+#include <vector>
 
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
+
+#include <packager/ad_cue_generator_params.h>
 #include <packager/media/base/media_handler.h>
 #include <packager/media/chunking/sync_point_queue.h>
 
@@ -23,11 +29,39 @@ namespace media {
 /// There should be a cue alignment handler per demuxer/thread and not per
 /// stream. A cue alignment handler must be one per thread in order to properly
 /// manage blocking.
+///
+/// The samples of a non-video stream which get ahead of the next cue are
+/// buffered until all the streams reach it. The buffers can be bounded with
+/// AdCueGeneratorParams, which also sets what to do when they overflow.
 class CueAlignmentHandler : public MediaHandler {
  public:
-  explicit CueAlignmentHandler(SyncPointQueue* sync_points);
+  struct StreamStats {
+    /// Samples currently buffered, their payload bytes and the time span they
+    /// cover.
+    size_t buffered_samples = 0;
+    uint64_t buffered_bytes = 0;
+    double buffered_duration_seconds = 0;
+    /// Largest time span buffered.
+    double max_buffered_duration_seconds = 0;
+    /// Number of times the buffer limits were exceeded.
+    uint64_t overflows = 0;
+    uint64_t samples_dropped = 0;
+    /// Number of cues promoted on overflow, and the time blocked on overflow.
+    uint64_t cues_promoted = 0;
+    absl::Duration blocked_time;
+  };
+
+  /// @param params provides the buffer limits. The cue points are taken from
+  ///        @a sync_points instead.
+  explicit CueAlignmentHandler(
+      SyncPointQueue* sync_points,
+      const AdCueGeneratorParams& params = AdCueGeneratorParams());
   ~CueAlignmentHandler() = default;
 
+  /// @return The statistics of each input stream. Can be called from any
+  ///         thread.
+  std::vector<StreamStats> GetStats();
+
  private:
   CueAlignmentHandler(const CueAlignmentHandler&) = delete;
   CueAlignmentHandler& operator=(const CueAlignmentHandler&) = delete;
@@ -38,6 +72,13 @@ class CueAlignmentHandler : public MediaHandler {
     // Cached samples that cannot be dispatched. All the samples should be at or
     // after |hint|.
     std::list<std::unique_ptr<StreamData>> samples;
+    // Payload bytes of |samples|.
+    uint64_t buffered_bytes = 0;
+    // Only updated on the handler thread; copied to |stats_| for GetStats().
+    StreamStats stats;
+    // Samples dropped since the stream started overflowing, logged when a new
+    // sync point ends the overflow.
+    uint64_t samples_dropped_in_run = 0;
     // If set, the stream is pending to be flushed.
     bool to_be_flushed = false;
     // Only set for text stream.
@@ -73,9 +114,23 @@ class CueAlignmentHandler : public MediaHandler {
   // Dispatch all samples and cues (in the correct order) for the given stream.
   Status RunThroughSamples(StreamState* stream);
 
+  std::unique_ptr<StreamData> PopSample(StreamState* stream);
+  bool ExceedsBufferLimits(const StreamState& stream) const;
+  // Apply the overflow policy until the stream is within the buffer limits.
+  Status OnBufferOverflow(size_t stream_index);
+  bool HasVideoStream() const;
+  // Log the samples dropped since the stream started overflowing, if any.
+  void EndDropRun(size_t stream_index);
+  // Publish the statistics of the stream for GetStats().
+  void UpdateStats(size_t stream_index);
+
   SyncPointQueue* const sync_points_ = nullptr;
+  const AdCueGeneratorParams params_;
   std::deque<StreamState> stream_states_;
 
+  absl::Mutex stats_mutex_;
+  std::vector<StreamStats> stats_ ABSL_GUARDED_BY(stats_mutex_);
+
   // A common hint used by all streams. When a new cue is given to all streams,
   // the hint will be updated. The hint will always be larger than any cue. The
   // hint represents the min time in seconds for the next cue appear. The hints
@@ -6,6 +6,9 @@
 
 #include <packager/media/chunking/cue_alignment_handler.h>
 
+#include <thread>
+
+#include <absl/synchronization/notification.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -25,6 +28,9 @@ namespace {
 const size_t kOneInput = 1;
 const size_t kOneOutput = 1;
 
+const size_t kTwoInputs = 2;
+const size_t kTwoOutputs = 2;
+
 const size_t kThreeInputs = 3;
 const size_t kThreeOutputs = 3;
 
@@ -33,6 +39,10 @@ const bool kKeyFrame = true;
 const int32_t kMsTimeScale = 1000;
 
 const size_t kStreamIndex = 0;
+
+const size_t kSparseTextStream = 0;
+const size_t kDenseAudioStream = 1;
+const int64_t kAudioSampleDuration = 1000;
 }  // namespace
 
 class CueAlignmentHandlerTest : public MediaHandlerTestBase {
@@ -94,6 +104,21 @@ class CueAlignmentHandlerTest : public MediaHandlerTestBase {
     return Input(input_index)->Dispatch(std::move(data));
   }
 
+  // Dispatches an audio sample every second while the text stream has a single
+  // text sample at the start, so the audio samples after the first cue are
+  // buffered waiting for the text stream.
+  Status DispatchSparseTextWithAudio(int num_audio_samples) {
+    RETURN_IF_ERROR(DispatchTextInfo(kSparseTextStream));
+    RETURN_IF_ERROR(DispatchAudioInfo(kDenseAudioStream));
+    RETURN_IF_ERROR(DispatchTextSample(kSparseTextStream, 0, 500));
+    for (int i = 0; i < num_audio_samples; ++i) {
+      RETURN_IF_ERROR(DispatchMediaSample(kDenseAudioStream,
+                                          i * kAudioSampleDuration,
+                                          kAudioSampleDuration, kKeyFrame));
+    }
+    return Status::OK;
+  }
+
   Status FlushAll(std::initializer_list<size_t> inputs) {
     for (auto& input : inputs) {
       RETURN_IF_ERROR(Input(input)->FlushAllDownstreams());
@@ -609,6 +634,179 @@ TEST_F(CueAlignmentHandlerTest, TextAudioVideoInputWithCues) {
   ASSERT_OK(FlushAll({kTextStream, kAudioStream, kVideoStream}));
 }
 
+TEST_F(CueAlignmentHandlerTest, DropsSamplesOverBufferLimit) {
+  AdCueGeneratorParams params;
+  params.max_buffered_duration_in_seconds = 1.5;
+  params.buffer_overflow_policy =
+      AdCueGeneratorParams::BufferOverflowPolicy::kDrop;
+
+  auto sync_points = CreateSyncPoints({1});
+  auto handler =
+      std::make_shared<CueAlignmentHandler>(sync_points.get(), params);
+  ASSERT_OK(SetUpAndInitializeGraph(handler, kTwoInputs, kTwoOutputs));
+
+  {
+    testing::InSequence s;
+
+    EXPECT_CALL(*Output(kDenseAudioStream),
+                OnProcess(IsStreamInfo(_, kMsTimeScale, _, _)));
+    EXPECT_CALL(*Output(kDenseAudioStream),
+                OnProcess(IsMediaSample(_, 0, kAudioSampleDuration, _, _)));
+    EXPECT_CALL(*Output(kDenseAudioStream), OnProcess(IsCueEvent(_, 1)));
+    EXPECT_CALL(*Output(kDenseAudioStream),
+                OnProcess(IsMediaSample(_, 3000, kAudioSampleDuration, _, _)));
+    EXPECT_CALL(*Output(kDenseAudioStream),
+                OnProcess(IsMediaSample(_, 4000, kAudioSampleDuration, _, _)));
+    EXPECT_CALL(*Output(kDenseAudioStream), OnFlush(_));
+  }
+
+  ASSERT_OK(DispatchSparseTextWithAudio(5));
+
+  const CueAlignmentHandler::StreamStats stats =
+      handler->GetStats()[kDenseAudioStream];
+  EXPECT_EQ(2u, stats.buffered_samples);
+  EXPECT_DOUBLE_EQ(1, stats.buffered_duration_seconds);
+  EXPECT_DOUBLE_EQ(2, stats.max_buffered_duration_seconds);
+  EXPECT_EQ(2u, stats.overflows);
+  EXPECT_EQ(2u, stats.samples_dropped);
+  EXPECT_EQ(0u, stats.cues_promoted);
+
+  ASSERT_OK(FlushAll({kSparseTextStream, kDenseAudioStream}));
+  EXPECT_EQ(0u, handler->GetStats()[kDenseAudioStream].buffered_samples);
+}
+
+TEST_F(CueAlignmentHandlerTest, PromotesCueOnBufferOverflow) {
+  AdCueGeneratorParams params;
+  params.max_buffered_duration_in_seconds = 1.5;
+  params.buffer_overflow_policy =
+      AdCueGeneratorParams::BufferOverflowPolicy::kPromoteCue;
+
+  auto sync_points = CreateSyncPoints({1});
+  auto handler =
+      std::make_shared<CueAlignmentHandler>(sync_points.get(), params);
+  ASSERT_OK(SetUpAndInitializeGraph(handler, kTwoInputs, kTwoOutputs));
+
+  {
+    testing::InSequence s;
+
+    EXPECT_CALL(*Output(kDenseAudioStream),
+                OnProcess(IsStreamInfo(_, kMsTimeScale, _, _)));
+    EXPECT_CALL(*Output(kDenseAudioStream),
+                OnProcess(IsMediaSample(_, 0, kAudioSampleDuration, _, _)));
+    EXPECT_CALL(*Output(kDenseAudioStream), OnProcess(IsCueEvent(_, 1)));
+    for (int64_t start = 1000; start < 5000; start += kAudioSampleDuration) {
+      EXPECT_CALL(
+          *Output(kDenseAudioStream),
+          OnProcess(IsMediaSample(_, start, kAudioSampleDuration, _, _)));
+    }
+    EXPECT_CALL(*Output(kDenseAudioStream), OnFlush(_));
+  }
+
+  ASSERT_OK(DispatchSparseTextWithAudio(5));
+
+  const CueAlignmentHandler::StreamStats stats =
+      handler->GetStats()[kDenseAudioStream];
+  EXPECT_EQ(0u, stats.buffered_samples);
+  EXPECT_DOUBLE_EQ(2, stats.max_buffered_duration_seconds);
+  EXPECT_EQ(1u, stats.overflows);
+  EXPECT_EQ(0u, stats.samples_dropped);
+  EXPECT_EQ(1u, stats.cues_promoted);
+
+  ASSERT_OK(FlushAll({kSparseTextStream, kDenseAudioStream}));
+}
+
+// The cue promoted by an overflowing audio stream on one thread must still be
+// accepted by the video stream of another thread at its next key frame.
+TEST_F(CueAlignmentHandlerTest, PromotesCueOnBufferOverflowWithVideoThread) {
+  AdCueGeneratorParams params;
+  params.max_buffered_duration_in_seconds = 1.5;
+  params.buffer_overflow_policy =
+      AdCueGeneratorParams::BufferOverflowPolicy::kPromoteCue;
+
+  auto sync_points = CreateSyncPoints({1});
+
+  // The text and audio streams are demuxed on one thread.
+  auto audio_handler =
+      std::make_shared<CueAlignmentHandler>(sync_points.get(), params);
+  auto text_input = std::make_shared<FakeInputMediaHandler>();
+  auto audio_input = std::make_shared<FakeInputMediaHandler>();
+  auto audio_output = std::make_shared<CachingMediaHandler>();
+  ASSERT_OK(text_input->AddHandler(audio_handler));
+  ASSERT_OK(audio_input->AddHandler(audio_handler));
+  ASSERT_OK(audio_handler->AddHandler(std::make_shared<CachingMediaHandler>()));
+  ASSERT_OK(audio_handler->AddHandler(audio_output));
+  ASSERT_OK(text_input->Initialize());
+
+  // The video stream is demuxed on another thread.
+  auto video_handler =
+      std::make_shared<CueAlignmentHandler>(sync_points.get(), params);
+  auto video_input = std::make_shared<FakeInputMediaHandler>();
+  auto video_output = std::make_shared<CachingMediaHandler>();
+  ASSERT_OK(video_input->AddHandler(video_handler));
+  ASSERT_OK(video_handler->AddHandler(video_output));
+  ASSERT_OK(video_input->Initialize());
+
+  // The audio thread runs to the end first so that the cue is promoted before
+  // the video stream reaches a key frame after it.
+  absl::Notification audio_done;
+  Status audio_status;
+  std::thread audio_thread([&]() {
+    audio_status = [&]() {
+      RETURN_IF_ERROR(text_input->Dispatch(StreamData::FromStreamInfo(
+          kStreamIndex, GetTextStreamInfo(kMsTimeScale))));
+      RETURN_IF_ERROR(audio_input->Dispatch(StreamData::FromStreamInfo(
+          kStreamIndex, GetAudioStreamInfo(kMsTimeScale))));
+      RETURN_IF_ERROR(text_input->Dispatch(StreamData::FromTextSample(
+          kStreamIndex, GetTextSample("", 0, 500, ""))));
+      for (int64_t start = 0; start < 5000; start += kAudioSampleDuration) {
+        RETURN_IF_ERROR(audio_input->Dispatch(StreamData::FromMediaSample(
+            kStreamIndex,
+            GetMediaSample(start, kAudioSampleDuration, kKeyFrame))));
+      }
+      RETURN_IF_ERROR(text_input->FlushAllDownstreams());
+      return audio_input->FlushAllDownstreams();
+    }();
+    audio_done.Notify();
+  });
+
+  const int64_t kVideoSampleDuration = 500;
+  Status video_status;
+  std::thread video_thread([&]() {
+    audio_done.WaitForNotification();
+    video_status = [&]() {
+      RETURN_IF_ERROR(video_input->Dispatch(StreamData::FromStreamInfo(
+          kStreamIndex, GetVideoStreamInfo(kMsTimeScale))));
+      for (int64_t start = 0; start < 2500; start += kVideoSampleDuration) {
+        const bool is_key_frame = start == 0 || start == 1500;
+        RETURN_IF_ERROR(video_input->Dispatch(StreamData::FromMediaSample(
+            kStreamIndex,
+            GetMediaSample(start, kVideoSampleDuration, is_key_frame))));
+      }
+      return video_input->FlushAllDownstreams();
+    }();
+  });
+
+  audio_thread.join();
+  video_thread.join();
+  ASSERT_OK(audio_status);
+  ASSERT_OK(video_status);
+
+  EXPECT_EQ(1u, audio_handler->GetStats()[kDenseAudioStream].cues_promoted);
+
+  const auto& audio_data = audio_output->Cache();
+  ASSERT_EQ(7u, audio_data.size());
+  EXPECT_THAT(audio_data[2].get(), IsCueEvent(_, 1));
+
+  // The video stream gets the cue at its promoted time, before the key frame.
+  const auto& video_data = video_output->Cache();
+  ASSERT_EQ(7u, video_data.size());
+  EXPECT_THAT(video_data[3].get(),
+              IsMediaSample(_, 1000, kVideoSampleDuration, _, _));
+  EXPECT_THAT(video_data[4].get(), IsCueEvent(_, 1));
+  EXPECT_THAT(video_data[5].get(),
+              IsMediaSample(_, 1500, kVideoSampleDuration, _, _));
+}
+
 // TODO(kqyang): Add more tests, in particular, multi-thread tests.
 
 }  // namespace media
@@ -0,0 +1,275 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/chunking/segment_partitioner.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <absl/log/check.h>
+
+#include <packager/macros/status.h>
+#include <packager/media/base/media_handler.h>
+#include <packager/media/base/media_sample.h>
+#include <packager/media/base/stream_info.h>
+#include <packager/media/chunking/chunking_handler.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const size_t kStreamIndex = 0;
+
+struct Segment {
+  uint64_t first_sample = 0;
+  uint32_t fragments_before = 0;
+  int64_t duration = 0;
+};
+
+// The output of ChunkingHandler for a stream.
+struct ChunkedStream {
+  int32_t time_scale = 0;
+  bool has_samples = false;
+  int64_t first_pts = 0;
+  int64_t first_dts = 0;
+  int64_t duration = 0;
+  std::vector<Segment> segments;
+};
+
+// Dispatches the samples of a timeline, without payload.
+class TimelineSource : public MediaHandler {
+ public:
+  TimelineSource() = default;
+
+  Status Run(const StreamTimeline& timeline, uint64_t* sample_index) {
+    RETURN_IF_ERROR(DispatchStreamInfo(kStreamIndex, timeline.stream_info));
+    for (*sample_index = 0; *sample_index < timeline.samples.size();
+         ++*sample_index) {
+      const SampleTiming& timing = timeline.samples[*sample_index];
+      std::shared_ptr<MediaSample> sample =
+          MediaSample::CreateEmptyMediaSample();
+      sample->set_dts(timing.dts);
+      sample->set_pts(timing.pts);
+      sample->set_duration(timing.duration);
+      sample->set_is_key_frame(timing.is_key_frame);
+      RETURN_IF_ERROR(DispatchMediaSample(kStreamIndex, std::move(sample)));
+    }
+    return FlushDownstream(kStreamIndex);
+  }
+
+ protected:
+  Status InitializeInternal() override { return Status::OK; }
+  Status Process(std::unique_ptr<StreamData> /*stream_data*/) override {
+    return Status(error::INTERNAL_ERROR, "TimelineSource has no input.");
+  }
+  bool ValidateOutputStreamIndex(size_t stream_index) const override {
+    return stream_index == kStreamIndex;
+  }
+
+ private:
+  TimelineSource(const TimelineSource&) = delete;
+  TimelineSource& operator=(const TimelineSource&) = delete;
+};
+
+// Records the segments of the stream. Samples are dispatched synchronously, so
+// |sample_index| is the index of the sample being processed.
+class SegmentRecorder : public MediaHandler {
+ public:
+  SegmentRecorder(const uint64_t* sample_index, ChunkedStream* stream)
+      : sample_index_(sample_index), stream_(stream) {}
+
+ protected:
+  Status InitializeInternal() override { return Status::OK; }
+
+  Status Process(std::unique_ptr<StreamData> stream_data) override {
+    switch (stream_data->stream_data_type) {
+      case StreamDataType::kStreamInfo:
+        stream_->time_scale = stream_data->stream_info->time_scale();
+        break;
+      case StreamDataType::kMediaSample: {
+        const MediaSample& sample = *stream_data->media_sample;
+        if (new_segment_) {
+          Segment segment;
+          segment.first_sample = *sample_index_;
+          segment.fragments_before = num_fragments_;
+          stream_->segments.push_back(segment);
+          new_segment_ = false;
+        }
+        if (!stream_->has_samples) {
+          stream_->has_samples = true;
+          stream_->first_pts = sample.pts();
+          stream_->first_dts = sample.dts();
+        }
+        stream_->duration += sample.duration();
+        break;
+      }
+      case StreamDataType::kSegmentInfo: {
+        const SegmentInfo& info = *stream_data->segment_info;
+        ++num_fragments_;
+        if (!info.is_subsegment) {
+          DCHECK(!stream_->segments.empty());
+          stream_->segments.back().duration = info.duration;
+          new_segment_ = true;
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    return Status::OK;
+  }
+
+  Status OnFlushRequest(size_t /*input_stream_index*/) override {
+    return Status::OK;
+  }
+
+ private:
+  SegmentRecorder(const SegmentRecorder&) = delete;
+  SegmentRecorder& operator=(const SegmentRecorder&) = delete;
+
+  const uint64_t* const sample_index_;
+  ChunkedStream* const stream_;
+  uint32_t num_fragments_ = 0;
+  bool new_segment_ = true;
+};
+
+Status ChunkTimeline(const StreamTimeline& timeline,
+                     const ChunkingParams& chunking_params,
+                     ChunkedStream* stream) {
+  uint64_t sample_index = 0;
+  auto source = std::make_shared<TimelineSource>();
+  RETURN_IF_ERROR(MediaHandler::Chain(
+      {source, std::make_shared<ChunkingHandler>(chunking_params),
+       std::make_shared<SegmentRecorder>(&sample_index, stream)}));
+  RETURN_IF_ERROR(source->Initialize());
+  return source->Run(timeline, &sample_index);
+}
+
+// Returns the presentation time of the first sample of a segment. The start
+// time of the segment reported by ChunkingHandler is unwrapped, so it is not
+// comparable between streams.
+double GetSegmentStartInSeconds(const StreamTimeline& timeline,
+                                const ChunkedStream& stream,
+                                size_t segment_index) {
+  const Segment& segment = stream.segments[segment_index];
+  return static_cast<double>(timeline.samples[segment.first_sample].pts) /
+         stream.time_scale;
+}
+
+// Returns the index of the segment starting the closest to |time_in_seconds|.
+size_t FindNearestSegment(const StreamTimeline& timeline,
+                          const ChunkedStream& stream,
+                          double time_in_seconds) {
+  size_t nearest = 0;
+  double nearest_distance = INFINITY;
+  for (size_t i = 0; i < stream.segments.size(); ++i) {
+    const double distance =
+        std::abs(GetSegmentStartInSeconds(timeline, stream, i) -
+                 time_in_seconds);
+    if (distance < nearest_distance) {
+      nearest = i;
+      nearest_distance = distance;
+    }
+  }
+  return nearest;
+}
+
+int64_t DurationBefore(const ChunkedStream& stream, size_t segment_index) {
+  int64_t duration = 0;
+  for (size_t i = 0; i < segment_index; ++i)
+    duration += stream.segments[i].duration;
+  return duration;
+}
+
+}  // namespace
+
+Status PartitionSegments(const std::vector<StreamTimeline>& timelines,
+                         const ChunkingParams& chunking_params,
+                         size_t max_partitions,
+                         double min_first_partition_seconds,
+                         SegmentPartitionPlan* plan) {
+  DCHECK(plan);
+  plan->streams.clear();
+  if (timelines.empty())
+    return Status::OK;
+
+  std::vector<ChunkedStream> streams(timelines.size());
+  size_t reference = 0;
+  for (size_t i = 0; i < timelines.size(); ++i) {
+    RETURN_IF_ERROR(ChunkTimeline(timelines[i], chunking_params, &streams[i]));
+    if (timelines[i].stream_info->stream_type() == kStreamVideo &&
+        timelines[reference].stream_info->stream_type() != kStreamVideo) {
+      reference = i;
+    }
+  }
+
+  // Partitions are balanced on the segments of the reference stream. The
+  // other streams are split on their segments the closest in time.
+  const ChunkedStream& reference_stream = streams[reference];
+  const size_t num_segments = reference_stream.segments.size();
+  const size_t num_partitions =
+      std::max<size_t>(1, std::min(max_partitions, num_segments));
+
+  // Index of the first segment of each partition after the first one, per
+  // stream.
+  std::vector<std::vector<size_t>> boundaries;
+  for (size_t p = 1; p < num_partitions; ++p) {
+    const double boundary_in_seconds = GetSegmentStartInSeconds(
+        timelines[reference], reference_stream,
+        p * num_segments / num_partitions);
+
+    std::vector<size_t> boundary(streams.size());
+    bool usable = true;
+    for (size_t i = 0; i < streams.size() && usable; ++i) {
+      boundary[i] =
+          FindNearestSegment(timelines[i], streams[i], boundary_in_seconds);
+      const size_t previous = boundaries.empty() ? 0 : boundaries.back()[i];
+      // Partitions must not be empty.
+      if (boundary[i] <= previous)
+        usable = false;
+      // Encryption of the first partition must not end in the clear lead.
+      const int64_t clear_lead =
+          min_first_partition_seconds * streams[i].time_scale;
+      if (boundaries.empty() && DurationBefore(streams[i], boundary[i]) <
+                                    clear_lead) {
+        usable = false;
+      }
+    }
+    if (usable)
+      boundaries.push_back(boundary);
+  }
+
+  for (size_t i = 0; i < streams.size(); ++i) {
+    const ChunkedStream& stream = streams[i];
+    SegmentPartitionPlan::Stream plan_stream;
+    plan_stream.track_id = timelines[i].track_id;
+    plan_stream.first_pts = stream.first_pts;
+    plan_stream.first_dts = stream.first_dts;
+    plan_stream.duration = stream.duration;
+
+    for (size_t p = 0; p <= boundaries.size(); ++p) {
+      const size_t first_segment = p == 0 ? 0 : boundaries[p - 1][i];
+      StreamPartition partition;
+      partition.start_segment_number =
+          chunking_params.start_segment_number + first_segment;
+      if (p > 0) {
+        partition.first_sample = stream.segments[first_segment].first_sample;
+        partition.fragments_before =
+            stream.segments[first_segment].fragments_before;
+      }
+      partition.end_sample =
+          p == boundaries.size()
+              ? timelines[i].samples.size()
+              : stream.segments[boundaries[p][i]].first_sample;
+      plan_stream.partitions.push_back(partition);
+    }
+    plan->streams.push_back(std::move(plan_stream));
+  }
+  return Status::OK;
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,69 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_CHUNKING_SEGMENT_PARTITIONER_H_
+#define PACKAGER_MEDIA_CHUNKING_SEGMENT_PARTITIONER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <packager/chunking_params.h>
+#include <packager/media/base/media_parser.h>
+#include <packager/status.h>
+
+namespace shaka {
+namespace media {
+
+/// The samples of a stream packaged by one partition.
+struct StreamPartition {
+  /// Range of sample indexes, in decoding order: [first_sample, end_sample).
+  uint64_t first_sample = 0;
+  uint64_t end_sample = 0;
+  /// Number of the first segment of the partition.
+  int64_t start_segment_number = 1;
+  /// Number of segments and subsegments of the stream before the partition.
+  uint32_t fragments_before = 0;
+};
+
+/// Split of the streams of an input into partitions that can be packaged
+/// independently, and still produce the same segments as packaging the whole
+/// input at once.
+struct SegmentPartitionPlan {
+  struct Stream {
+    uint32_t track_id = 0;
+    /// Timestamps of the first sample of the output.
+    int64_t first_pts = 0;
+    int64_t first_dts = 0;
+    /// Sum of the durations of the samples of the output.
+    int64_t duration = 0;
+    /// One entry per partition, in presentation order.
+    std::vector<StreamPartition> partitions;
+  };
+
+  size_t num_partitions() const {
+    return streams.empty() ? 0 : streams[0].partitions.size();
+  }
+
+  std::vector<Stream> streams;
+};
+
+/// Plan up to @a max_partitions partitions of the streams in @a timelines.
+/// Partitions start on segment boundaries, computed exactly as
+/// ChunkingHandler does with @a chunking_params, and are balanced by
+/// presentation time. The first partition covers at least
+/// @a min_first_partition_seconds, so that a clear lead never spans
+/// partitions. The plan may have fewer partitions than requested, down to
+/// a single one.
+Status PartitionSegments(const std::vector<StreamTimeline>& timelines,
+                         const ChunkingParams& chunking_params,
+                         size_t max_partitions,
+                         double min_first_partition_seconds,
+                         SegmentPartitionPlan* plan);
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_CHUNKING_SEGMENT_PARTITIONER_H_
@@ -0,0 +1,142 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/chunking/segment_partitioner.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <packager/media/base/media_handler_test_base.h>
+#include <packager/status/status_test_util.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const int32_t kTimeScale = 1000;
+const uint32_t kVideoTrackId = 1;
+const uint32_t kAudioTrackId = 2;
+
+MATCHER_P4(IsStreamPartition,
+           first_sample,
+           end_sample,
+           start_segment_number,
+           fragments_before,
+           "") {
+  return arg.first_sample == first_sample && arg.end_sample == end_sample &&
+         arg.start_segment_number == start_segment_number &&
+         arg.fragments_before == fragments_before;
+}
+
+}  // namespace
+
+class SegmentPartitionerTest : public MediaHandlerTestBase {
+ protected:
+  void SetUp() override {
+    chunking_params_.segment_duration_in_seconds = 2;
+
+    // 10 seconds of video, with a key frame every second.
+    StreamTimeline video;
+    video.track_id = kVideoTrackId;
+    video.stream_info = GetVideoStreamInfo(kTimeScale);
+    for (int i = 0; i < 100; ++i)
+      video.samples.push_back({i * 100, i * 100, 100, i % 10 == 0});
+
+    // 10 seconds of audio.
+    StreamTimeline audio;
+    audio.track_id = kAudioTrackId;
+    audio.stream_info = GetAudioStreamInfo(kTimeScale);
+    for (int i = 0; i < 50; ++i)
+      audio.samples.push_back({i * 200, i * 200, 200, true});
+
+    timelines_.push_back(std::move(audio));
+    timelines_.push_back(std::move(video));
+  }
+
+  ChunkingParams chunking_params_;
+  std::vector<StreamTimeline> timelines_;
+};
+
+TEST_F(SegmentPartitionerTest, BalancesPartitionsOnVideoSegments) {
+  SegmentPartitionPlan plan;
+  ASSERT_OK(PartitionSegments(timelines_, chunking_params_, 3, 0, &plan));
+
+  ASSERT_EQ(3u, plan.num_partitions());
+  ASSERT_EQ(2u, plan.streams.size());
+
+  const SegmentPartitionPlan::Stream& audio = plan.streams[0];
+  EXPECT_EQ(kAudioTrackId, audio.track_id);
+  EXPECT_EQ(10000, audio.duration);
+  EXPECT_THAT(audio.partitions,
+              ::testing::ElementsAre(IsStreamPartition(0u, 10u, 1, 0u),
+                                     IsStreamPartition(10u, 30u, 2, 1u),
+                                     IsStreamPartition(30u, 50u, 4, 3u)));
+
+  const SegmentPartitionPlan::Stream& video = plan.streams[1];
+  EXPECT_EQ(kVideoTrackId, video.track_id);
+  EXPECT_EQ(0, video.first_pts);
+  EXPECT_EQ(0, video.first_dts);
+  EXPECT_EQ(10000, video.duration);
+  EXPECT_THAT(video.partitions,
+              ::testing::ElementsAre(IsStreamPartition(0u, 20u, 1, 0u),
+                                     IsStreamPartition(20u, 60u, 2, 1u),
+                                     IsStreamPartition(60u, 100u, 4, 3u)));
+}
+
+TEST_F(SegmentPartitionerTest, CountsSubsegments) {
+  chunking_params_.subsegment_duration_in_seconds = 1;
+  chunking_params_.start_segment_number = 0;
+
+  SegmentPartitionPlan plan;
+  ASSERT_OK(PartitionSegments(timelines_, chunking_params_, 3, 0, &plan));
+
+  ASSERT_EQ(3u, plan.num_partitions());
+  EXPECT_THAT(plan.streams[1].partitions,
+              ::testing::ElementsAre(IsStreamPartition(0u, 20u, 0, 0u),
+                                     IsStreamPartition(20u, 60u, 1, 2u),
+                                     IsStreamPartition(60u, 100u, 3, 6u)));
+}
+
+TEST_F(SegmentPartitionerTest, FirstPartitionCoversClearLead) {
+  SegmentPartitionPlan plan;
+  ASSERT_OK(PartitionSegments(timelines_, chunking_params_, 3, 3, &plan));
+
+  ASSERT_EQ(2u, plan.num_partitions());
+  EXPECT_THAT(plan.streams[1].partitions,
+              ::testing::ElementsAre(IsStreamPartition(0u, 60u, 1, 0u),
+                                     IsStreamPartition(60u, 100u, 4, 3u)));
+}
+
+TEST_F(SegmentPartitionerTest, AtMostOnePartitionPerSegment) {
+  SegmentPartitionPlan plan;
+  ASSERT_OK(PartitionSegments(timelines_, chunking_params_, 16, 0, &plan));
+  EXPECT_EQ(5u, plan.num_partitions());
+  EXPECT_EQ(80u, plan.streams[1].partitions.back().first_sample);
+
+  ASSERT_OK(PartitionSegments(timelines_, chunking_params_, 1, 0, &plan));
+  ASSERT_EQ(1u, plan.num_partitions());
+  EXPECT_THAT(plan.streams[1].partitions,
+              ::testing::ElementsAre(IsStreamPartition(0u, 100u, 1, 0u)));
+}
+
+TEST_F(SegmentPartitionerTest, SkipsSamplesBeforeTheFirstKeyFrame) {
+  timelines_[1].samples[0].is_key_frame = false;
+
+  SegmentPartitionPlan plan;
+  ASSERT_OK(PartitionSegments(timelines_, chunking_params_, 2, 0, &plan));
+
+  ASSERT_EQ(2u, plan.num_partitions());
+  const SegmentPartitionPlan::Stream& video = plan.streams[1];
+  EXPECT_EQ(1000, video.first_pts);
+  EXPECT_EQ(9000, video.duration);
+  // The first segment is one second long, so there are still five segments.
+  EXPECT_THAT(video.partitions,
+              ::testing::ElementsAre(IsStreamPartition(0u, 40u, 1, 0u),
+                                     IsStreamPartition(40u, 100u, 3, 2u)));
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -86,7 +86,31 @@ std::shared_ptr<const CueEvent> SyncPointQueue::GetNext(
 std::shared_ptr<const CueEvent> SyncPointQueue::PromoteAt(
     double time_in_seconds) {
   absl::MutexLock lock(&mutex_);
-  return PromoteAtNoLocking(time_in_seconds);
+  std::shared_ptr<const CueEvent> cue = PromoteAtNoLocking(time_in_seconds);
+  if (cue)
+    return cue;
+
+  // The cue may have been promoted early, i.e. before |time_in_seconds|, which
+  // is then the last promoted cue not greater than |time_in_seconds|.
+  auto iter = promoted_.upper_bound(time_in_seconds);
+  if (iter != promoted_.begin() &&
+      promoted_early_.count(std::prev(iter)->first) > 0) {
+    return std::prev(iter)->second;
+  }
+  return nullptr;
+}
+
+std::shared_ptr<const CueEvent> SyncPointQueue::PromoteEarly(
+    double hint_in_seconds) {
+  absl::MutexLock lock(&mutex_);
+  auto iter = promoted_.find(hint_in_seconds);
+  if (iter != promoted_.end())
+    return iter->second;
+
+  std::shared_ptr<const CueEvent> cue = PromoteAtNoLocking(hint_in_seconds);
+  if (cue)
+    promoted_early_.insert(hint_in_seconds);
+  return cue;
 }
 
 bool SyncPointQueue::HasMore(double hint_in_seconds) const {
@@ -109,7 +133,8 @@ std::shared_ptr<const CueEvent> SyncPointQueue::PromoteAtNoLocking(
   iter = unpromoted_.upper_bound(time_in_seconds);
   // The first cue in |unpromoted_| should not be greater than
   // |time_in_seconds|. It could happen only if it has been promoted at a
-  // different timestamp, which can only be the result of unaligned GOPs.
+  // different timestamp, which can only be the result of unaligned GOPs or of
+  // PromoteEarly().
   if (iter == unpromoted_.begin())
     return nullptr;
   auto prev_iter = std::prev(iter);
@@ -6,6 +6,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 
 #include <absl/synchronization/mutex.h>
 
@@ -44,9 +45,19 @@ class SyncPointQueue {
   std::shared_ptr<const CueEvent> GetNext(double hint_in_seconds);
 
   /// Promote the first cue that is not greater than @a time_in_seconds. All
-  /// unpromoted cues before the cue will be discarded.
+  /// unpromoted cues before the cue will be discarded. If the cue has already
+  /// been promoted early, see PromoteEarly(), it is returned at its promoted
+  /// time.
   std::shared_ptr<const CueEvent> PromoteAt(double time_in_seconds);
 
+  /// Promote the cue at @a hint_in_seconds without waiting for a video key
+  /// frame, e.g. when a non-video stream has buffered too much waiting for it.
+  /// The video streams reaching the cue afterwards use it at
+  /// @a hint_in_seconds.
+  /// @return The promoted cue, or nullptr if the cue has already been promoted
+  ///         at a different time, in which case GetNext() returns it.
+  std::shared_ptr<const CueEvent> PromoteEarly(double hint_in_seconds);
+
   /// @return True if there are more cues after the given hint. The hint must
   ///         be a hint returned from |GetHint|. Using any other value results
   ///         in undefined behavior.
@@ -68,6 +79,8 @@ class SyncPointQueue {
 
   std::map<double, std::shared_ptr<CueEvent>> unpromoted_;
   std::map<double, std::shared_ptr<CueEvent>> promoted_;
+  // Times of the cues in |promoted_| which were promoted by PromoteEarly().
+  std::set<double> promoted_early_;
 };
 
 }  // namespace media
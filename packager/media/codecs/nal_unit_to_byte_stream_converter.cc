@@ -16,6 +16,7 @@
 #include <packager/media/base/buffer_reader.h>
 #include <packager/media/base/buffer_writer.h>
 #include <packager/media/codecs/nalu_reader.h>
+#include <packager/media/codecs/start_code_scanner.h>
 
 namespace shaka {
 namespace media {
@@ -63,38 +64,27 @@ void AddAccessUnitDelimiter(BufferWriter* buffer_writer) {
 void EscapeNalByteSequence(const uint8_t* input,
                            size_t input_size,
                            BufferWriter* output_writer) {
-  // Keep track of consecutive zeros that it has seen (not including the current
-  // byte), so that the algorithm doesn't need to go back to check the same
-  // bytes.
-  int consecutive_zero_count = 0;
-  for (size_t i = 0; i < input_size; ++i) {
-    if (consecutive_zero_count <= 1) {
-      output_writer->AppendInt(input[i]);
-    } else if (consecutive_zero_count == 2) {
-      if (input[i] == 0 || input[i] == 1 || input[i] == 2 || input[i] == 3) {
-        // Must be escaped.
-        output_writer->AppendInt(kEmulationPreventionByte);
-      }
-
-      output_writer->AppendInt(input[i]);
-      // Note that input[i] can be 0.
-      // 00 00 00 00 00 00 should become
-      // 00 00 03 00 00 03 00 00 03
-      // So consecutive_zero_count is reset here and incremented below if
-      // input[i] is 0.
-      consecutive_zero_count = 0;
+  // Copy everything up to each 00 00 0x (x <= 3) sequence in bulk, then insert
+  // the emulation prevention byte before x. x itself is the first byte of the
+  // next run, so that 00 00 00 00 00 00 becomes 00 00 03 00 00 03 00 00 03.
+  size_t i = 0;
+  while (i < input_size) {
+    const size_t sequence_offset =
+        FindEmulationPreventionSequence(input + i, input_size - i);
+    if (sequence_offset == input_size - i) {
+      output_writer->AppendArray(input + i, input_size - i);
+      break;
     }
-
-    consecutive_zero_count = input[i] == 0 ? consecutive_zero_count + 1 : 0;
+    // Include the two zero bytes.
+    output_writer->AppendArray(input + i, sequence_offset + 2);
+    output_writer->AppendInt(kEmulationPreventionByte);
+    i += sequence_offset + 2;
   }
 
   // ISO 14496-10 Section 7.4.1.1 mentions that if the last byte is 0 (which
   // only happens if RBSP has cabac_zero_word), 0x03 must be appended.
-  if (consecutive_zero_count > 0) {
-    DCHECK_GT(input_size, 0u);
-    DCHECK_EQ(input[input_size - 1], 0u);
+  if (input_size > 0 && input[input_size - 1] == 0)
     output_writer->AppendInt(kEmulationPreventionByte);
-  }
 }
 
 // This functions creates a new subsample entry (|clear_bytes|, |cipher_bytes|)
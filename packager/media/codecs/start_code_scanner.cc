@@ -0,0 +1,153 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/codecs/start_code_scanner.h>
+
+#include <absl/numeric/bits.h>
+
+#include <packager/media/codecs/start_code_scanner_internal.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define START_CODE_SCANNER_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define START_CODE_SCANNER_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace shaka {
+namespace media {
+namespace internal {
+
+size_t ScanZeroZeroSequence(const uint8_t* data,
+                            size_t size,
+                            uint8_t min_third_byte,
+                            uint8_t max_third_byte) {
+  size_t i = 0;
+  while (i + 2 < size) {
+    const uint8_t third_byte = data[i + 2];
+    // A sequence starting at i, i + 1 or i + 2 needs data[i + 2] to be either
+    // zero or in range, so none of them can match otherwise.
+    if (third_byte != 0 &&
+        (third_byte < min_third_byte || third_byte > max_third_byte)) {
+      i += 3;
+      continue;
+    }
+    // Same for data[i + 1] and the sequences starting at i or i + 1.
+    if (data[i + 1] != 0) {
+      i += 2;
+      continue;
+    }
+    if (data[i] == 0 && third_byte >= min_third_byte &&
+        third_byte <= max_third_byte) {
+      return i;
+    }
+    ++i;
+  }
+  return size;
+}
+
+namespace {
+
+#if defined(START_CODE_SCANNER_SSE2)
+
+size_t ScanZeroZeroSequenceSse2(const uint8_t* data,
+                                size_t size,
+                                uint8_t min_third_byte,
+                                uint8_t max_third_byte) {
+  const size_t kBlockSize = 16;
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i min = _mm_set1_epi8(static_cast<char>(min_third_byte));
+  const __m128i max = _mm_set1_epi8(static_cast<char>(max_third_byte));
+
+  size_t i = 0;
+  // Each block checks the sequences starting at its 16 bytes, which needs two
+  // more bytes to be readable.
+  for (; i + kBlockSize + 2 <= size; i += kBlockSize) {
+    const __m128i first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    const __m128i second =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+    const __m128i third =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 2));
+    const __m128i zeros = _mm_and_si128(_mm_cmpeq_epi8(first, zero),
+                                        _mm_cmpeq_epi8(second, zero));
+    // Unsigned min <= third <= max.
+    const __m128i in_range = _mm_cmpeq_epi8(
+        _mm_min_epu8(_mm_max_epu8(third, min), max), third);
+    const int mask = _mm_movemask_epi8(_mm_and_si128(zeros, in_range));
+    if (mask != 0)
+      return i + absl::countr_zero(static_cast<uint32_t>(mask));
+  }
+  return i + ScanZeroZeroSequence(data + i, size - i, min_third_byte,
+                                  max_third_byte);
+}
+
+#elif defined(START_CODE_SCANNER_NEON)
+
+size_t ScanZeroZeroSequenceNeon(const uint8_t* data,
+                                size_t size,
+                                uint8_t min_third_byte,
+                                uint8_t max_third_byte) {
+  const size_t kBlockSize = 16;
+  const uint8x16_t min = vdupq_n_u8(min_third_byte);
+  const uint8x16_t max = vdupq_n_u8(max_third_byte);
+
+  size_t i = 0;
+  // Each block checks the sequences starting at its 16 bytes, which needs two
+  // more bytes to be readable.
+  for (; i + kBlockSize + 2 <= size; i += kBlockSize) {
+    const uint8x16_t first = vld1q_u8(data + i);
+    const uint8x16_t second = vld1q_u8(data + i + 1);
+    const uint8x16_t third = vld1q_u8(data + i + 2);
+    const uint8x16_t matches =
+        vandq_u8(vandq_u8(vceqzq_u8(first), vceqzq_u8(second)),
+                 vandq_u8(vcgeq_u8(third, min), vcleq_u8(third, max)));
+    // Narrow to one nibble per byte, as there is no movemask on NEON.
+    const uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+    if (mask != 0)
+      return i + absl::countr_zero(mask) / 4;
+  }
+  return i + ScanZeroZeroSequence(data + i, size - i, min_third_byte,
+                                  max_third_byte);
+}
+
+#endif
+
+ZeroZeroSequenceScanner SelectScanner() {
+  if (ZeroZeroSequenceScanner scanner = GetAvx2Scanner())
+    return scanner;
+  if (ZeroZeroSequenceScanner scanner = GetSimdScanner())
+    return scanner;
+  return &ScanZeroZeroSequence;
+}
+
+}  // namespace
+
+ZeroZeroSequenceScanner GetSimdScanner() {
+#if defined(START_CODE_SCANNER_SSE2)
+  return &ScanZeroZeroSequenceSse2;
+#elif defined(START_CODE_SCANNER_NEON)
+  return &ScanZeroZeroSequenceNeon;
+#else
+  return nullptr;
+#endif
+}
+
+}  // namespace internal
+
+size_t FindZeroZeroSequence(const uint8_t* data,
+                            size_t size,
+                            uint8_t min_third_byte,
+                            uint8_t max_third_byte) {
+  static const internal::ZeroZeroSequenceScanner scanner =
+      internal::SelectScanner();
+  return scanner(data, size, min_third_byte, max_third_byte);
+}
+
+}  // namespace media
+}  // namespace shaka
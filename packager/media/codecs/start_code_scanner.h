@@ -0,0 +1,42 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_CODECS_START_CODE_SCANNER_H_
+#define PACKAGER_MEDIA_CODECS_START_CODE_SCANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace shaka {
+namespace media {
+
+/// Find the first three-byte sequence 00 00 xx in @a data, with
+/// @a min_third_byte <= xx <= @a max_third_byte. The search is vectorized
+/// with SSE2/AVX2 or NEON where available, chosen at runtime.
+/// @return The offset of the sequence, or @a size if there is none.
+size_t FindZeroZeroSequence(const uint8_t* data,
+                            size_t size,
+                            uint8_t min_third_byte,
+                            uint8_t max_third_byte);
+
+/// @return The offset of the first Annex B start code prefix (00 00 01) in
+///         @a data, or @a size if there is none.
+inline size_t FindStartCodePrefix(const uint8_t* data, size_t size) {
+  return FindZeroZeroSequence(data, size, 0x01, 0x01);
+}
+
+/// @return The offset of the first sequence 00 00 xx (xx <= 3) in @a data,
+///         which must be broken up with an emulation prevention byte, or
+///         @a size if there is none.
+inline size_t FindEmulationPreventionSequence(const uint8_t* data,
+                                              size_t size) {
+  return FindZeroZeroSequence(data, size, 0x00, 0x03);
+}
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_CODECS_START_CODE_SCANNER_H_
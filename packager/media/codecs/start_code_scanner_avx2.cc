@@ -0,0 +1,125 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+//
+// AVX2 implementation of FindZeroZeroSequence(). This file is compiled with
+// -mavx2 on x86-64 (see CMakeLists.txt). Nothing in here runs unless CPUID
+// reports AVX2 support.
+
+#include <packager/media/codecs/start_code_scanner_internal.h>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && \
+    (defined(__AVX2__) || defined(_MSC_VER))
+#define START_CODE_SCANNER_AVX2 1
+#endif
+
+#if defined(START_CODE_SCANNER_AVX2)
+
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+#include <absl/numeric/bits.h>
+
+namespace shaka {
+namespace media {
+namespace internal {
+namespace {
+
+bool CpuHasAvx2() {
+  // CPUID leaf 1, ECX bit 27 (OSXSAVE) and bit 28 (AVX); XCR0 bits 1 and 2
+  // (the OS saves SSE and AVX state); CPUID leaf 7, EBX bit 5 (AVX2).
+  const unsigned int kOsxsaveAndAvxBits = (1u << 27) | (1u << 28);
+  const unsigned int kAvx2Bit = 1u << 5;
+  const unsigned long long kXmmAndYmmState = 0x6;
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  if ((static_cast<unsigned int>(info[2]) & kOsxsaveAndAvxBits) !=
+      kOsxsaveAndAvxBits) {
+    return false;
+  }
+  if ((_xgetbv(0) & kXmmAndYmmState) != kXmmAndYmmState)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (static_cast<unsigned int>(info[1]) & kAvx2Bit) != 0;
+#else
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) ||
+      (ecx & kOsxsaveAndAvxBits) != kOsxsaveAndAvxBits) {
+    return false;
+  }
+  unsigned int xcr0_low, xcr0_high;
+  __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+  if ((xcr0_low & kXmmAndYmmState) != kXmmAndYmmState)
+    return false;
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+    return false;
+  return (ebx & kAvx2Bit) != 0;
+#endif
+}
+
+size_t ScanZeroZeroSequenceAvx2(const uint8_t* data,
+                                size_t size,
+                                uint8_t min_third_byte,
+                                uint8_t max_third_byte) {
+  const size_t kBlockSize = 32;
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i min = _mm256_set1_epi8(static_cast<char>(min_third_byte));
+  const __m256i max = _mm256_set1_epi8(static_cast<char>(max_third_byte));
+
+  size_t i = 0;
+  // Each block checks the sequences starting at its 32 bytes, which needs two
+  // more bytes to be readable.
+  for (; i + kBlockSize + 2 <= size; i += kBlockSize) {
+    const __m256i first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    const __m256i second =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 1));
+    const __m256i third =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 2));
+    const __m256i zeros = _mm256_and_si256(_mm256_cmpeq_epi8(first, zero),
+                                           _mm256_cmpeq_epi8(second, zero));
+    // Unsigned min <= third <= max.
+    const __m256i in_range = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(_mm256_max_epu8(third, min), max), third);
+    const uint32_t mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_and_si256(zeros, in_range)));
+    if (mask != 0)
+      return i + absl::countr_zero(mask);
+  }
+  return i + ScanZeroZeroSequence(data + i, size - i, min_third_byte,
+                                  max_third_byte);
+}
+
+}  // namespace
+
+ZeroZeroSequenceScanner GetAvx2Scanner() {
+  static const bool supported = CpuHasAvx2();
+  return supported ? &ScanZeroZeroSequenceAvx2 : nullptr;
+}
+
+}  // namespace internal
+}  // namespace media
+}  // namespace shaka
+
+#else  // !defined(START_CODE_SCANNER_AVX2)
+
+namespace shaka {
+namespace media {
+namespace internal {
+
+ZeroZeroSequenceScanner GetAvx2Scanner() {
+  return nullptr;
+}
+
+}  // namespace internal
+}  // namespace media
+}  // namespace shaka
+
+#endif  // defined(START_CODE_SCANNER_AVX2)
@@ -0,0 +1,43 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+// Internal interfaces shared by the start code scanner backends.
+
+#ifndef PACKAGER_MEDIA_CODECS_START_CODE_SCANNER_INTERNAL_H_
+#define PACKAGER_MEDIA_CODECS_START_CODE_SCANNER_INTERNAL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace shaka {
+namespace media {
+namespace internal {
+
+/// Signature shared by all the FindZeroZeroSequence() backends.
+typedef size_t (*ZeroZeroSequenceScanner)(const uint8_t* data,
+                                          size_t size,
+                                          uint8_t min_third_byte,
+                                          uint8_t max_third_byte);
+
+/// Portable implementation, also used for the tails of the vectorized ones.
+size_t ScanZeroZeroSequence(const uint8_t* data,
+                            size_t size,
+                            uint8_t min_third_byte,
+                            uint8_t max_third_byte);
+
+/// @return The SSE2 (x86-64) or NEON (arm64) scanner, which are part of the
+///         base instruction sets, or nullptr on other architectures.
+ZeroZeroSequenceScanner GetSimdScanner();
+
+/// @return The AVX2 scanner, or nullptr if not supported in this build or on
+///         the running CPU.
+ZeroZeroSequenceScanner GetAvx2Scanner();
+
+}  // namespace internal
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_CODECS_START_CODE_SCANNER_INTERNAL_H_
@@ -0,0 +1,101 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/codecs/start_code_scanner.h>
+
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <packager/media/codecs/start_code_scanner_internal.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// Straightforward reference implementation.
+size_t ReferenceScan(const uint8_t* data,
+                     size_t size,
+                     uint8_t min_third_byte,
+                     uint8_t max_third_byte) {
+  for (size_t i = 0; i + 2 < size; ++i) {
+    if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] >= min_third_byte &&
+        data[i + 2] <= max_third_byte) {
+      return i;
+    }
+  }
+  return size;
+}
+
+std::vector<internal::ZeroZeroSequenceScanner> AvailableScanners() {
+  std::vector<internal::ZeroZeroSequenceScanner> scanners = {
+      &internal::ScanZeroZeroSequence, &FindZeroZeroSequence};
+  if (internal::GetSimdScanner())
+    scanners.push_back(internal::GetSimdScanner());
+  if (internal::GetAvx2Scanner())
+    scanners.push_back(internal::GetAvx2Scanner());
+  return scanners;
+}
+
+}  // namespace
+
+TEST(StartCodeScannerTest, FindStartCodePrefix) {
+  const uint8_t kData[] = {0x01, 0x00, 0x00, 0x00, 0x02, 0x00,
+                           0x00, 0x00, 0x01, 0x65, 0x00, 0x00};
+  EXPECT_EQ(6u, FindStartCodePrefix(kData, sizeof(kData)));
+  EXPECT_EQ(1u, FindEmulationPreventionSequence(kData, sizeof(kData)));
+  // A partial sequence at the end is not a match.
+  EXPECT_EQ(3u, FindStartCodePrefix(kData + 9, 3));
+  EXPECT_EQ(0u, FindStartCodePrefix(kData, 0));
+}
+
+// Plants sequences at every position of buffers of various sizes, so that the
+// vector loops and their tails are all exercised, and compares the backends
+// with the reference implementation.
+TEST(StartCodeScannerTest, AllBackendsMatchReference) {
+  std::mt19937 random(1234);
+  std::uniform_int_distribution<int> byte(0, 255);
+  const uint8_t kRanges[][2] = {{1, 1}, {0, 3}, {3, 3}};
+
+  for (size_t size = 0; size < 100; ++size) {
+    for (size_t position = 0; position < size; ++position) {
+      // Mostly non-zero bytes, with a sprinkling of zeros.
+      std::vector<uint8_t> data(size);
+      for (uint8_t& value : data)
+        value = static_cast<uint8_t>(byte(random) % 8 == 0 ? 0 : byte(random));
+      const uint8_t kSequence[] = {0x00, 0x00,
+                                   static_cast<uint8_t>(byte(random) % 4)};
+      for (size_t i = 0; i < sizeof(kSequence) && position + i < size; ++i)
+        data[position + i] = kSequence[i];
+
+      for (const auto& range : kRanges) {
+        const size_t expected =
+            ReferenceScan(data.data(), size, range[0], range[1]);
+        for (internal::ZeroZeroSequenceScanner scanner : AvailableScanners()) {
+          ASSERT_EQ(expected, scanner(data.data(), size, range[0], range[1]))
+              << "size " << size << " position " << position << " range "
+              << static_cast<int>(range[0]) << "-"
+              << static_cast<int>(range[1]);
+        }
+      }
+    }
+  }
+}
+
+TEST(StartCodeScannerTest, LongZeroRuns) {
+  // 00 00 00 ... 00 01 only matches at the end for start codes, but at the
+  // very beginning for emulation prevention.
+  std::vector<uint8_t> data(200, 0);
+  data.push_back(0x01);
+  for (internal::ZeroZeroSequenceScanner scanner : AvailableScanners()) {
+    EXPECT_EQ(data.size() - 3, scanner(data.data(), data.size(), 1, 1));
+    EXPECT_EQ(0u, scanner(data.data(), data.size(), 0, 3));
+  }
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -7,11 +7,15 @@
 #include <packager/media/crypto/encryption_handler.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include <absl/log/check.h>
+#include <absl/synchronization/blocking_counter.h>
 
+#include <packager/file/work_stealing_executor.h>
 #include <packager/macros/logging.h>
 #include <packager/macros/status.h>
 #include <packager/media/base/aes_encryptor.h>
@@ -21,6 +25,7 @@
 #include <packager/media/base/media_sample.h>
 #include <packager/media/base/playready_pssh_generator.h>
 #include <packager/media/base/protection_system_ids.h>
+#include <packager/media/base/sample_pool.h>
 #include <packager/media/base/video_stream_info.h>
 #include <packager/media/base/widevine_pssh_generator.h>
 #include <packager/media/crypto/aes_encryptor_factory.h>
@@ -45,6 +50,13 @@ const uint8_t kKeyRotationDefaultIv[] = {
     0, 0, 0, 0, 0, 0, 0, 0,
 };
 
+// With parallel sample encryption, a task encrypts at least this many bytes, as
+// the overhead of smaller tasks outweighs their gain.
+const size_t kMinBytesPerEncryptionTask = 64 * 1024;
+// Samples are encrypted before the end of the segment past this many pending
+// bytes, to bound the memory held by very long segments.
+const size_t kMaxPendingBytes = 64 * 1024 * 1024;
+
 std::string GetStreamLabelForEncryption(
     const StreamInfo& stream_info,
     const std::function<std::string(
@@ -113,6 +125,52 @@ void FillPsshGenerators(
   }
 }
 
+// Encrypts |sample| into |dest|, leaving the clear bytes of |subsamples| in
+// the clear. The whole sample is encrypted if |subsamples| is empty.
+bool EncryptSampleData(const MediaSample& sample,
+                       const std::vector<SubsampleEntry>& subsamples,
+                       AesCryptor* encryptor,
+                       uint8_t* dest,
+                       size_t dest_size) {
+  DCHECK(encryptor);
+  const uint8_t* source = sample.data();
+  if (subsamples.empty())
+    return encryptor->Crypt(source, sample.data_size(), dest, &dest_size);
+
+  size_t total_size = 0;
+  for (const SubsampleEntry& subsample : subsamples) {
+    if (subsample.clear_bytes > 0) {
+      // clear_bytes is the number of bytes to leave in the clear
+      memcpy(dest, source, subsample.clear_bytes);
+      source += subsample.clear_bytes;
+      dest += subsample.clear_bytes;
+      total_size += subsample.clear_bytes;
+    }
+    if (subsample.cipher_bytes > 0) {
+      // cipher_bytes is the number of bytes we want to encrypt
+      size_t crypt_size = dest_size - total_size;
+      if (!encryptor->Crypt(source, subsample.cipher_bytes, dest, &crypt_size))
+        return false;
+      source += subsample.cipher_bytes;
+      dest += subsample.cipher_bytes;
+      total_size += subsample.cipher_bytes;
+    }
+  }
+  DCHECK_EQ(total_size, sample.data_size());
+  return true;
+}
+
+// @return The number of bytes of |sample| encrypted by EncryptSampleData().
+size_t GetCipherBytes(const MediaSample& sample,
+                      const std::vector<SubsampleEntry>& subsamples) {
+  if (subsamples.empty())
+    return sample.data_size();
+  size_t cipher_bytes = 0;
+  for (const SubsampleEntry& subsample : subsamples)
+    cipher_bytes += subsample.cipher_bytes;
+  return cipher_bytes;
+}
+
 void AddProtectionSystemIfNotExist(
     const ProtectionSystemSpecificInfo& pssh_info,
     EncryptionConfig* encryption_config) {
@@ -186,6 +244,11 @@ Status EncryptionHandler::InitializeInternal() {
 }
 
 Status EncryptionHandler::Process(std::unique_ptr<StreamData> stream_data) {
+  // The pending samples go before anything else, as they would have without
+  // parallel encryption.
+  if (stream_data->stream_data_type != StreamDataType::kMediaSample)
+    RETURN_IF_ERROR(EncryptPendingSamples());
+
   switch (stream_data->stream_data_type) {
     case StreamDataType::kStreamInfo:
       return ProcessStreamInfo(*stream_data->stream_info);
@@ -216,6 +279,11 @@ Status EncryptionHandler::Process(std::unique_ptr<StreamData> stream_data) {
   }
 }
 
+Status EncryptionHandler::OnFlushRequest(size_t input_stream_index) {
+  RETURN_IF_ERROR(EncryptPendingSamples());
+  return MediaHandler::OnFlushRequest(input_stream_index);
+}
+
 Status EncryptionHandler::ProcessStreamInfo(const StreamInfo& clear_info) {
   if (clear_info.is_encrypted()) {
     return Status(error::INVALID_ARGUMENT,
@@ -252,6 +320,8 @@ Status EncryptionHandler::ProcessStreamInfo(const StreamInfo& clear_info) {
                              std::end(kKeyRotationDefaultIv));
   } else {
     RETURN_IF_ERROR(key_source_->GetKey(stream_label_, &encryption_key));
+    if (iv_override_)
+      encryption_key.iv = *iv_override_;
   }
   if (!CreateEncryptor(encryption_key))
     return Status(error::ENCRYPTION_FAILURE, "Failed to create encryptor");
@@ -284,6 +354,8 @@ Status EncryptionHandler::ProcessMediaSample(
     const int32_t crypto_period_duration_in_seconds = static_cast<int32_t>(
         encryption_params_.crypto_period_duration_in_seconds);
     if (current_crypto_period_index != prev_crypto_period_index_) {
+      // The pending samples use the key of the previous crypto period.
+      RETURN_IF_ERROR(EncryptPendingSamples());
       EncryptionKey encryption_key;
       RETURN_IF_ERROR(key_source_->GetCryptoPeriodKey(
           current_crypto_period_index, crypto_period_duration_in_seconds,
@@ -304,32 +376,19 @@ Status EncryptionHandler::ProcessMediaSample(
   size_t ciphertext_size =
       encryptor_->RequiredOutputSize(clear_sample->data_size());
 
-  std::shared_ptr<uint8_t> cipher_sample_data(new uint8_t[ciphertext_size],
-                                              std::default_delete<uint8_t[]>());
-
-  const uint8_t* source = clear_sample->data();
-  uint8_t* dest = cipher_sample_data.get();
-  if (!subsamples.empty()) {
-    size_t total_size = 0;
-    for (const SubsampleEntry& subsample : subsamples) {
-      if (subsample.clear_bytes > 0) {
-        // clear_bytes is the number of bytes to leave in the clear
-        memcpy(dest, source, subsample.clear_bytes);
-        source += subsample.clear_bytes;
-        dest += subsample.clear_bytes;
-        total_size += subsample.clear_bytes;
-      }
-      if (subsample.cipher_bytes > 0) {
-        // cipher_bytes is the number of bytes we want to encrypt
-        EncryptBytes(source, subsample.cipher_bytes, dest, ciphertext_size);
-        source += subsample.cipher_bytes;
-        dest += subsample.cipher_bytes;
-        total_size += subsample.cipher_bytes;
-      }
-    }
-    DCHECK_EQ(total_size, clear_sample->data_size());
-  } else {
-    EncryptBytes(source, clear_sample->data_size(), dest, ciphertext_size);
+  std::shared_ptr<uint8_t> cipher_sample_data =
+      SamplePool::AllocateBuffer(ciphertext_size);
+  uint8_t* cipher_data = cipher_sample_data.get();
+
+  const bool parallel_encryption =
+      encryption_params_.parallel_sample_encryption;
+  if (parallel_encryption) {
+    // The sample is encrypted later by another encryptor, but the iv of the
+    // next sample still depends on it.
+    encryptor_->CountCryptBytes(GetCipherBytes(*clear_sample, subsamples));
+  } else if (!EncryptSampleData(*clear_sample, subsamples, encryptor_.get(),
+                                cipher_data, ciphertext_size)) {
+    return Status(error::ENCRYPTION_FAILURE, "Failed to encrypt sample.");
   }
 
   std::shared_ptr<MediaSample> cipher_sample(clear_sample->Clone());
@@ -347,7 +406,93 @@ Status EncryptionHandler::ProcessMediaSample(
 
   encryptor_->UpdateIv();
 
-  return DispatchMediaSample(kStreamIndex, std::move(cipher_sample));
+  if (!parallel_encryption)
+    return DispatchMediaSample(kStreamIndex, std::move(cipher_sample));
+
+  pending_bytes_ += clear_sample->data_size();
+  PendingSample pending_sample;
+  pending_sample.clear_sample = std::move(clear_sample);
+  pending_sample.cipher_sample = std::move(cipher_sample);
+  pending_sample.cipher_data = cipher_data;
+  pending_sample.cipher_data_size = ciphertext_size;
+  pending_samples_.push_back(std::move(pending_sample));
+  if (pending_bytes_ >= kMaxPendingBytes)
+    return EncryptPendingSamples();
+  return Status::OK;
+}
+
+Status EncryptionHandler::EncryptPendingSamples() {
+  if (pending_samples_.empty())
+    return Status::OK;
+
+  // Each task encrypts a run of consecutive samples of about the same size as
+  // the others.
+  WorkStealingExecutor* executor = WorkStealingExecutor::Cpu();
+  const size_t num_tasks = std::max<size_t>(
+      1, std::min({pending_samples_.size(), executor->num_workers(),
+                   pending_bytes_ / kMinBytesPerEncryptionTask}));
+  std::vector<size_t> task_ends;
+  size_t bytes = 0;
+  for (size_t i = 0; i < pending_samples_.size(); ++i) {
+    bytes += pending_samples_[i].clear_sample->data_size();
+    if (task_ends.size() < num_tasks &&
+        bytes * num_tasks >= pending_bytes_ * (task_ends.size() + 1)) {
+      task_ends.push_back(i + 1);
+    }
+  }
+  task_ends.back() = pending_samples_.size();
+
+  // This thread encrypts the first run while the others are encrypted on the
+  // executor.
+  std::atomic<bool> succeeded(true);
+  absl::BlockingCounter tasks_done(static_cast<int>(task_ends.size() - 1));
+  for (size_t i = 1; i < task_ends.size(); ++i) {
+    const size_t begin = task_ends[i - 1];
+    const size_t end = task_ends[i];
+    executor->PostTask([this, begin, end, &succeeded, &tasks_done]() {
+      if (!EncryptPendingSamples(begin, end))
+        succeeded = false;
+      tasks_done.DecrementCount();
+    });
+  }
+  if (!EncryptPendingSamples(0, task_ends[0]))
+    succeeded = false;
+  tasks_done.Wait();
+
+  std::vector<PendingSample> pending_samples;
+  pending_samples.swap(pending_samples_);
+  pending_bytes_ = 0;
+  if (!succeeded)
+    return Status(error::ENCRYPTION_FAILURE, "Failed to encrypt samples.");
+
+  for (PendingSample& pending_sample : pending_samples) {
+    RETURN_IF_ERROR(DispatchMediaSample(
+        kStreamIndex, std::move(pending_sample.cipher_sample)));
+  }
+  return Status::OK;
+}
+
+bool EncryptionHandler::EncryptPendingSamples(size_t begin, size_t end) {
+  DCHECK_LT(begin, end);
+  std::unique_ptr<AesCryptor> encryptor = encryptor_factory_->CreateEncryptor(
+      protection_scheme_, crypt_byte_block_, skip_byte_block_, codec_, key_,
+      pending_samples_[begin].cipher_sample->decrypt_config()->iv());
+  if (!encryptor)
+    return false;
+
+  for (size_t i = begin; i < end; ++i) {
+    const PendingSample& pending_sample = pending_samples_[i];
+    const DecryptConfig& decrypt_config =
+        *pending_sample.cipher_sample->decrypt_config();
+    if (!encryptor->SetIv(decrypt_config.iv()) ||
+        !EncryptSampleData(*pending_sample.clear_sample,
+                           decrypt_config.subsamples(), encryptor.get(),
+                           pending_sample.cipher_data,
+                           pending_sample.cipher_data_size)) {
+      return false;
+    }
+  }
+  return true;
 }
 
 void EncryptionHandler::SetupProtectionPattern(StreamType stream_type,
@@ -372,6 +517,7 @@ bool EncryptionHandler::CreateEncryptor(const EncryptionKey& encryption_key) {
   if (!encryptor)
     return false;
   encryptor_ = std::move(encryptor);
+  key_ = encryption_key.key;
 
   encryption_config_.reset(new EncryptionConfig);
   encryption_config_->protection_scheme = protection_scheme_;
@@ -392,16 +538,6 @@ bool EncryptionHandler::CreateEncryptor(const EncryptionKey& encryption_key) {
   return status.ok();
 }
 
-void EncryptionHandler::EncryptBytes(const uint8_t* source,
-                                     size_t source_size,
-                                     uint8_t* dest,
-                                     size_t dest_size) {
-  DCHECK(source);
-  DCHECK(dest);
-  DCHECK(encryptor_);
-  CHECK(encryptor_->Crypt(source, source_size, dest, &dest_size));
-}
-
 void EncryptionHandler::InjectSubsampleGeneratorForTesting(
     std::unique_ptr<SubsampleGenerator> generator) {
   subsample_generator_ = std::move(generator);
@@ -8,6 +8,9 @@
 #define PACKAGER_MEDIA_CRYPTO_ENCRYPTION_HANDLER_H_
 
 #include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
 
 #include <packager/crypto_params.h>
 #include <packager/media/base/key_source.h>
@@ -28,11 +31,18 @@ class EncryptionHandler : public MediaHandler {
 
   ~EncryptionHandler() override;
 
+  /// Encrypt with @a iv instead of the IV of the key, or with a random IV if
+  /// @a iv is empty. Used when the partitions of a stream are encrypted by
+  /// different handlers, which must share a constant IV but not per-sample
+  /// IVs. Not supported with key rotation.
+  void OverrideIv(std::vector<uint8_t> iv) { iv_override_ = std::move(iv); }
+
  protected:
   /// @name MediaHandler implementation overrides.
   /// @{
   Status InitializeInternal() override;
   Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status OnFlushRequest(size_t input_stream_index) override;
   /// @}
 
  private:
@@ -41,10 +51,24 @@ class EncryptionHandler : public MediaHandler {
   EncryptionHandler(const EncryptionHandler&) = delete;
   EncryptionHandler& operator=(const EncryptionHandler&) = delete;
 
+  // A sample waiting to be encrypted in parallel with the other samples of its
+  // segment.
+  struct PendingSample {
+    std::shared_ptr<const MediaSample> clear_sample;
+    // Has the decrypt config already, but not the encrypted data.
+    std::shared_ptr<MediaSample> cipher_sample;
+    uint8_t* cipher_data = nullptr;
+    size_t cipher_data_size = 0;
+  };
+
   // Processes |stream_info| and sets up stream specific variables.
   Status ProcessStreamInfo(const StreamInfo& stream_info);
   // Processes media sample and encrypts it if needed.
   Status ProcessMediaSample(std::shared_ptr<const MediaSample> clear_sample);
+  // Encrypts the pending samples in parallel and dispatches them.
+  Status EncryptPendingSamples();
+  // Encrypts the pending samples in [begin, end) with an encryptor of its own.
+  bool EncryptPendingSamples(size_t begin, size_t end);
 
   void SetupProtectionPattern(StreamType stream_type, Codec codec);
   bool CreateEncryptor(const EncryptionKey& encryption_key);
@@ -53,12 +77,6 @@ class EncryptionHandler : public MediaHandler {
   bool SampleAesEncryptEac3Frame(const uint8_t* source,
                                  size_t source_size,
                                  uint8_t* dest);
-  // Encrypt an array with size |source_size|. |dest| should have at
-  // least |source_size| bytes.
-  void EncryptBytes(const uint8_t* source,
-                    size_t source_size,
-                    uint8_t* dest,
-                    size_t dest_size);
 
   // An E-AC3 frame comprises of one or more syncframes. This function extracts
   // the syncframe sizes from the source bytes.
@@ -77,9 +95,12 @@ class EncryptionHandler : public MediaHandler {
   const FourCC protection_scheme_ = FOURCC_NULL;
   KeySource* key_source_ = nullptr;
   std::string stream_label_;
+  std::optional<std::vector<uint8_t>> iv_override_;
   // Current encryption config and encryptor.
   std::shared_ptr<EncryptionConfig> encryption_config_;
   std::unique_ptr<AesCryptor> encryptor_;
+  // Key of |encryptor_|, to create more encryptors for parallel encryption.
+  std::vector<uint8_t> key_;
   Codec codec_ = kUnknownCodec;
   // Remaining clear lead in the stream's time scale.
   int64_t remaining_clear_lead_ = 0;
@@ -95,6 +116,11 @@ class EncryptionHandler : public MediaHandler {
   uint8_t crypt_byte_block_ = 0;
   /// Number of unencrypted blocks (16-byte-block) in pattern based encryption.
   uint8_t skip_byte_block_ = 0;
+
+  // Samples of the current segment waiting to be encrypted, with
+  // EncryptionParams::parallel_sample_encryption.
+  std::vector<PendingSample> pending_samples_;
+  size_t pending_bytes_ = 0;
 };
 
 }  // namespace media
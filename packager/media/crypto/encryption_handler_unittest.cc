@@ -560,6 +560,104 @@ TEST_P(EncryptionHandlerSubsampleTest, SubsampleTest) {
   EXPECT_EQ(GetParam().subsamples, decrypt_config.subsamples());
 }
 
+namespace {
+
+const int kSamplesPerSegment = 20;
+const size_t kLargeSampleSize = 100000;
+// Block aligned, so that all the protection schemes encrypt the same bytes.
+const SubsampleEntry kLargeSampleSubsamples[] = {{100, 49984}, {924, 48992}};
+
+struct EncryptedSample {
+  std::vector<uint8_t> data;
+  std::vector<uint8_t> iv;
+};
+
+}  // namespace
+
+class EncryptionHandlerParallelEncryptionTest
+    : public EncryptionHandlerTest,
+      public WithParamInterface<FourCC> {
+ public:
+  void SetUp() override {}
+
+  // Encrypts two segments, and returns the encrypted samples in output order.
+  std::vector<EncryptedSample> EncryptSegments(bool parallel) {
+    EncryptionParams encryption_params;
+    encryption_params.protection_scheme = GetParam();
+    encryption_params.parallel_sample_encryption = parallel;
+    SetUpEncryptionHandler(encryption_params);
+    InjectSubsamples(std::vector<SubsampleEntry>(
+        std::begin(kLargeSampleSubsamples), std::end(kLargeSampleSubsamples)));
+    EXPECT_CALL(mock_key_source_, GetKey(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(GetMockEncryptionKey()),
+                        Return(Status::OK)));
+
+    std::vector<EncryptedSample> encrypted_samples;
+    EXPECT_OK(Process(StreamData::FromStreamInfo(
+        kStreamIndex, GetVideoStreamInfo(kTimeScale, kCodecH264))));
+    ClearOutputStreamDataVector();
+    for (int segment = 0; segment < 2; ++segment) {
+      const int64_t segment_start = segment * kSegmentDuration;
+      for (int i = 0; i < kSamplesPerSegment; ++i) {
+        std::vector<uint8_t> data(kLargeSampleSize);
+        for (size_t j = 0; j < data.size(); ++j)
+          data[j] = static_cast<uint8_t>(segment * 31 + i * 7 + j);
+        const int64_t duration = kSegmentDuration / kSamplesPerSegment;
+        EXPECT_OK(Process(StreamData::FromMediaSample(
+            kStreamIndex,
+            GetMediaSample(segment_start + i * duration, duration, kIsKeyFrame,
+                           data.data(), data.size()))));
+      }
+      // The encrypted samples are held back until the end of the segment.
+      if (parallel)
+        EXPECT_TRUE(GetOutputStreamDataVector().empty());
+      EXPECT_OK(Process(StreamData::FromSegmentInfo(
+          kStreamIndex, GetSegmentInfo(segment_start, kSegmentDuration,
+                                       !kIsSubsegment, segment))));
+
+      const auto& output_stream_data = GetOutputStreamDataVector();
+      EXPECT_EQ(static_cast<size_t>(kSamplesPerSegment + 1),
+                output_stream_data.size());
+      // The handler set up last is the second input of the output handler,
+      // so the stream index is not checked.
+      EXPECT_THAT(output_stream_data.back().get(),
+                  IsSegmentInfo(_, segment_start, kSegmentDuration,
+                                !kIsSubsegment, kEncrypted));
+      for (size_t i = 0; i + 1 < output_stream_data.size(); ++i) {
+        const MediaSample& sample = *output_stream_data[i]->media_sample;
+        EXPECT_EQ(segment_start + static_cast<int64_t>(i) *
+                                      (kSegmentDuration / kSamplesPerSegment),
+                  sample.dts());
+        encrypted_samples.push_back(
+            {std::vector<uint8_t>(sample.data(),
+                                  sample.data() + sample.data_size()),
+             sample.decrypt_config()->iv()});
+      }
+      ClearOutputStreamDataVector();
+    }
+    Mock::VerifyAndClearExpectations(&mock_key_source_);
+    return encrypted_samples;
+  }
+};
+
+TEST_P(EncryptionHandlerParallelEncryptionTest, MatchesSerialEncryption) {
+  const std::vector<EncryptedSample> serial_samples = EncryptSegments(false);
+  const std::vector<EncryptedSample> parallel_samples = EncryptSegments(true);
+  ASSERT_EQ(serial_samples.size(), parallel_samples.size());
+  for (size_t i = 0; i < serial_samples.size(); ++i) {
+    EXPECT_EQ(serial_samples[i].iv, parallel_samples[i].iv) << "Sample " << i;
+    EXPECT_EQ(serial_samples[i].data, parallel_samples[i].data)
+        << "Sample " << i;
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(ProtectionSchemes,
+                        EncryptionHandlerParallelEncryptionTest,
+                        Values(FOURCC_cenc,
+                               FOURCC_cens,
+                               FOURCC_cbc1,
+                               FOURCC_cbcs));
+
 class EncryptionHandlerTrackTypeTest : public EncryptionHandlerTest {};
 
 TEST_F(EncryptionHandlerTrackTypeTest, AudioTrackType) {
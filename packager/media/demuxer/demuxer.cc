@@ -16,6 +16,7 @@
 #include <absl/strings/str_format.h>
 
 #include <packager/file.h>
+#include <packager/file/file_mapping.h>
 #include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
 #include <packager/media/base/decryptor_source.h>
@@ -115,12 +116,15 @@ Status Demuxer::Run() {
     }
   }
 
-  while (!cancelled_ && status.ok())
+  if (has_sample_ranges_)
+    status.Update(SeekToSampleRanges());
+  while (!cancelled_ && status.ok() && !SampleRangesComplete())
     status.Update(Parse());
   if (cancelled_ && status.ok())
     return Status(error::CANCELLED, "Demuxer run cancelled");
 
-  if (status.error_code() == error::END_OF_STREAM) {
+  if (status.error_code() == error::END_OF_STREAM ||
+      (status.ok() && SampleRangesComplete())) {
     for (size_t stream_index : stream_indexes_) {
       status = FlushDownstream(stream_index);
       if (!status.ok())
@@ -144,6 +148,40 @@ Status Demuxer::SetHandler(const std::string& stream_label,
   return MediaHandler::SetHandler(stream_index, std::move(handler));
 }
 
+void Demuxer::SetSampleRanges(std::map<uint32_t, SampleRange> ranges) {
+  has_sample_ranges_ = true;
+  sample_ranges_ = std::move(ranges);
+  incomplete_sample_ranges_ = 0;
+  for (const auto& pair : sample_ranges_) {
+    if (pair.second.begin < pair.second.end)
+      ++incomplete_sample_ranges_;
+  }
+}
+
+Status Demuxer::ReadTimelines(std::vector<StreamTimeline>* timelines) {
+  DCHECK(timelines);
+  Status status = InitializeParser();
+  while (!all_streams_ready_ && status.ok())
+    status.Update(Parse());
+  if (!status.ok())
+    return status;
+
+  std::map<uint32_t, std::vector<SampleTiming>> timings;
+  if (!parser_->GetSampleTimings(&timings)) {
+    return Status(error::UNIMPLEMENTED,
+                  "Input '" + file_name_ + "' does not index its samples.");
+  }
+  timelines->clear();
+  for (const std::shared_ptr<StreamInfo>& stream_info : stream_infos_) {
+    StreamTimeline timeline;
+    timeline.track_id = stream_info->track_id();
+    timeline.stream_info = stream_info;
+    timeline.samples = std::move(timings[stream_info->track_id()]);
+    timelines->push_back(std::move(timeline));
+  }
+  return Status::OK;
+}
+
 void Demuxer::SetLanguageOverride(const std::string& stream_label,
                                   const std::string& language_override) {
   size_t stream_index = kInvalidStreamIndex;
@@ -158,15 +196,35 @@ Status Demuxer::InitializeParser() {
 
   LOG(INFO) << "Initialize Demuxer for file '" << file_name_ << "'.";
 
-  media_file_ = File::Open(file_name_.c_str(), "r");
-  if (!media_file_) {
-    return Status(error::FILE_FAILURE,
-                  "Cannot open file for reading " + file_name_);
+  if (map_input_ && File::IsLocalRegularFile(file_name_.c_str())) {
+    File* file = File::OpenWithNoBuffering(file_name_.c_str(), "r");
+    if (file) {
+      mapping_ = file->MapForReading();
+      file->Close();
+    }
+    LOG_IF(WARNING, !mapping_)
+        << "Cannot map file '" << file_name_ << "', reading it instead.";
+  }
+  if (!mapping_) {
+    media_file_ = File::Open(file_name_.c_str(), "r");
+    if (!media_file_) {
+      return Status(error::FILE_FAILURE,
+                    "Cannot open file for reading " + file_name_);
+    }
   }
 
+  const uint8_t* data = buffer_.get();
   int64_t bytes_read = 0;
   bool eof = false;
-  if (input_format_.empty()) {
+  if (mapping_) {
+    data = mapping_->data();
+    if (input_format_.empty())
+      bytes_read = std::min<uint64_t>(mapping_->size(), kInitBufSize);
+    mapped_offset_ = bytes_read;
+    container_name_ = input_format_.empty()
+                          ? DetermineContainer(data, bytes_read)
+                          : DetermineContainerFromFormatName(input_format_);
+  } else if (input_format_.empty()) {
     // Read enough bytes before detecting the container.
     while (static_cast<size_t>(bytes_read) < kInitBufSize) {
       int64_t read_result =
@@ -212,7 +270,7 @@ Status Demuxer::InitializeParser() {
       const int64_t kDumpSizeLimit = 512;
       LOG(ERROR) << "Failed to detect the container type from the buffer: "
                  << absl::BytesToHexString(absl::string_view(
-                        reinterpret_cast<const char*>(buffer_.get()),
+                        reinterpret_cast<const char*>(data),
                         std::min(bytes_read, kDumpSizeLimit)));
       return Status(error::INVALID_ARGUMENT,
                     "Failed to detect the container type.");
@@ -230,6 +288,12 @@ Status Demuxer::InitializeParser() {
       std::bind(&Demuxer::NewTextSampleEvent, this, std::placeholders::_1,
                 std::placeholders::_2),
       key_source_.get());
+  // Have the parser skip the samples outside of the sample ranges, if it can.
+  // It then only emits the samples in the ranges.
+  if (has_sample_ranges_ && parser_->SetSampleRanges(sample_ranges_)) {
+    for (const auto& pair : sample_ranges_)
+      sample_counts_[pair.first] = pair.second.begin;
+  }
 
   // Handle trailing 'moov'.
   if (container_name_ == CONTAINER_MOV &&
@@ -238,8 +302,10 @@ Status Demuxer::InitializeParser() {
     // descriptor |media_file_| instead of opening the same file again.
     static_cast<mp4::MP4MediaParser*>(parser_.get())->LoadMoov(file_name_);
   }
-  if (!parser_->Parse(buffer_.get(), bytes_read) ||
-      (eof && !parser_->Flush())) {
+  const bool parsed = mapping_
+                          ? parser_->ParseMapped(mapping_, data, bytes_read)
+                          : parser_->Parse(data, bytes_read);
+  if (!parsed || (eof && !parser_->Flush())) {
     return Status(error::PARSER_FAILURE,
                   "Cannot parse media file " + file_name_);
   }
@@ -248,6 +314,7 @@ Status Demuxer::InitializeParser() {
 
 void Demuxer::ParserInitEvent(
     const std::vector<std::shared_ptr<StreamInfo>>& stream_infos) {
+  stream_infos_ = stream_infos;
   if (dump_stream_info_) {
     printf("\nFile \"%s\":\n", file_name_.c_str());
     printf("Found %zu stream(s).\n", stream_infos.size());
@@ -363,8 +430,10 @@ bool Demuxer::PushMediaSample(uint32_t track_id,
     LOG(ERROR) << "Track " << track_id << " not found.";
     return false;
   }
-  if (stream_index_iter->second == kInvalidStreamIndex)
+  if (!IsInSampleRange(track_id) ||
+      stream_index_iter->second == kInvalidStreamIndex) {
     return true;
+  }
   Status status = DispatchMediaSample(stream_index_iter->second, sample);
   if (!status.ok()) {
     LOG(ERROR) << "Failed to process sample " << stream_index_iter->second
@@ -392,12 +461,43 @@ bool Demuxer::PushTextSample(uint32_t track_id,
   return true;
 }
 
+bool Demuxer::IsInSampleRange(uint32_t track_id) {
+  if (!has_sample_ranges_)
+    return true;
+  auto range_iter = sample_ranges_.find(track_id);
+  if (range_iter == sample_ranges_.end())
+    return false;
+  const SampleRange& range = range_iter->second;
+  const uint64_t sample_index = sample_counts_[track_id]++;
+  if (sample_index + 1 == range.end && range.begin < range.end)
+    --incomplete_sample_ranges_;
+  return sample_index >= range.begin && sample_index < range.end;
+}
+
+Status Demuxer::SeekToSampleRanges() {
+  // Only mapped inputs and local files are seeked.
+  if (!mapping_ && !File::IsLocalRegularFile(file_name_.c_str()))
+    return Status::OK;
+  int64_t offset = 0;
+  if (!parser_->SeekToSampleRanges(&offset))
+    return Status::OK;
+  if (mapping_) {
+    mapped_offset_ = offset;
+    return Status::OK;
+  }
+  if (!media_file_->Seek(offset))
+    return Status(error::FILE_FAILURE, "Cannot seek file " + file_name_);
+  return Status::OK;
+}
+
 Status Demuxer::Parse() {
-  DCHECK(media_file_);
+  DCHECK(media_file_ || mapping_);
   DCHECK(parser_);
   DCHECK(buffer_);
 
-  int64_t bytes_read = media_file_->Read(buffer_.get(), kBufSize);
+  int64_t bytes_read =
+      mapping_ ? std::min<uint64_t>(mapping_->size() - mapped_offset_, kBufSize)
+               : media_file_->Read(buffer_.get(), kBufSize);
   if (bytes_read == 0) {
     if (!parser_->Flush())
       return Status(error::PARSER_FAILURE, "Failed to flush.");
@@ -406,10 +506,19 @@ Status Demuxer::Parse() {
     return Status(error::FILE_FAILURE, "Cannot read file " + file_name_);
   }
 
-  return parser_->Parse(buffer_.get(), bytes_read)
-             ? Status::OK
-             : Status(error::PARSER_FAILURE,
-                      "Cannot parse media file " + file_name_);
+  bool parsed = false;
+  if (mapping_) {
+    const uint8_t* data = mapping_->data() + mapped_offset_;
+    mapped_offset_ += bytes_read;
+    // Have the next block read ahead while this one is parsed.
+    mapping_->WillNeed(mapped_offset_, kBufSize);
+    parsed = parser_->ParseMapped(mapping_, data, bytes_read);
+  } else {
+    parsed = parser_->Parse(buffer_.get(), bytes_read);
+  }
+  return parsed ? Status::OK
+                : Status(error::PARSER_FAILURE,
+                         "Cannot parse media file " + file_name_);
 }
 
 }  // namespace media
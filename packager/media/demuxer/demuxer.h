@@ -9,23 +9,25 @@
 
 #include <cstdint>
 #include <deque>
+#include <map>
 #include <memory>
 #include <vector>
 
 #include <packager/macros/classes.h>
 #include <packager/media/base/container_names.h>
+#include <packager/media/base/media_parser.h>
 #include <packager/media/origin/origin_handler.h>
 #include <packager/status.h>
 
 namespace shaka {
 
 class File;
+class FileMapping;
 
 namespace media {
 
 class Decryptor;
 class KeySource;
-class MediaParser;
 class MediaSample;
 class StreamInfo;
 
@@ -80,6 +82,27 @@ class Demuxer : public OriginHandler {
     input_format_ = input_format;
   }
 
+  /// Map the input into memory instead of reading it, if it is a local
+  /// regular file. The parser then references the input instead of copying
+  /// it. The file must not be modified while it is demuxed.
+  void set_map_input(bool map_input) { map_input_ = map_input; }
+
+  /// Only demux a range of the samples of each track, e.g. to package a
+  /// partition of the input. The samples of the tracks without a range are
+  /// dropped. Demuxing ends once every range is complete. If the input indexes
+  /// its samples, demuxing skips ahead to the data of the first sample in the
+  /// ranges.
+  /// @param ranges is keyed by track id.
+  void SetSampleRanges(std::map<uint32_t, SampleRange> ranges);
+
+  /// Read the index of the input, without demuxing its samples, instead of
+  /// running the demuxer.
+  /// @param timelines receives the sample timings of each stream, in stream
+  ///        order.
+  /// @return UNIMPLEMENTED if the input does not index its samples, e.g. if it
+  ///         is not an MP4 file with the sample tables in its 'moov' box.
+  Status ReadTimelines(std::vector<StreamTimeline>* timelines);
+
  protected:
   /// @name MediaHandler implementation overrides.
   /// @{
@@ -131,8 +154,22 @@ class Demuxer : public OriginHandler {
   // Read from the source and send it to the parser.
   Status Parse();
 
+  // Count the next sample of track |track_id|.
+  // @return true if the sample is to be demuxed, i.e. it is in the sample
+  //         range of the track, if there are sample ranges.
+  bool IsInSampleRange(uint32_t track_id);
+  // Skip the input to the data of the sample ranges, if the parser can.
+  Status SeekToSampleRanges();
+  bool SampleRangesComplete() const {
+    return has_sample_ranges_ && incomplete_sample_ranges_ == 0;
+  }
+
   std::string file_name_;
   File* media_file_ = nullptr;
+  // Used instead of |media_file_| if the input is mapped.
+  std::shared_ptr<FileMapping> mapping_;
+  // Offset of the first byte of |mapping_| not passed to the parser yet.
+  uint64_t mapped_offset_ = 0;
   // A stream is considered ready after receiving the stream info.
   bool all_streams_ready_ = false;
   // Queued samples received in NewSampleEvent() before ParserInitEvent().
@@ -146,6 +183,16 @@ class Demuxer : public OriginHandler {
   std::vector<size_t> stream_indexes_;
   // StreamIndex -> language_override map.
   std::map<size_t, std::string> language_overrides_;
+  // The stream info of every stream, as received from the parser.
+  std::vector<std::shared_ptr<StreamInfo>> stream_infos_;
+  // Whether only |sample_ranges_| are demuxed.
+  bool has_sample_ranges_ = false;
+  // TrackId -> SampleRange map.
+  std::map<uint32_t, SampleRange> sample_ranges_;
+  // TrackId -> number of samples received map.
+  std::map<uint32_t, uint64_t> sample_counts_;
+  // Number of |sample_ranges_| not complete yet.
+  size_t incomplete_sample_ranges_ = 0;
   MediaContainerName container_name_ = CONTAINER_UNKNOWN;
   std::unique_ptr<uint8_t[]> buffer_;
   std::unique_ptr<KeySource> key_source_;
@@ -155,6 +202,7 @@ class Demuxer : public OriginHandler {
   Status init_event_status_;
   // Explicitly defined input format, for avoiding autodetection.
   std::string input_format_;
+  bool map_input_ = false;
 };
 
 }  // namespace media
@@ -73,6 +73,56 @@ TEST_F(DemuxerTest, EncryptedContentWithKeySource) {
   EXPECT_OK(demuxer.Run());
 }
 
+TEST_F(DemuxerTest, ReadTimelines) {
+  Demuxer demuxer(GetTestDataFilePath("bear-640x360.mp4").string());
+  std::vector<StreamTimeline> timelines;
+  ASSERT_OK(demuxer.ReadTimelines(&timelines));
+
+  ASSERT_EQ(2u, timelines.size());
+  EXPECT_EQ(kStreamVideo, timelines[0].stream_info->stream_type());
+  ASSERT_EQ(82u, timelines[0].samples.size());
+  EXPECT_TRUE(timelines[0].samples[0].is_key_frame);
+  EXPECT_FALSE(timelines[0].samples[1].is_key_frame);
+  EXPECT_TRUE(timelines[0].samples[30].is_key_frame);
+  EXPECT_EQ(30030, timelines[0].samples[30].pts);
+  EXPECT_EQ(kStreamAudio, timelines[1].stream_info->stream_type());
+  EXPECT_EQ(119u, timelines[1].samples.size());
+}
+
+TEST_F(DemuxerTest, ReadTimelinesOfFragmentedInput) {
+  Demuxer demuxer(GetTestDataFilePath("bear-640x360-av_frag.mp4").string());
+  std::vector<StreamTimeline> timelines;
+  EXPECT_EQ(error::UNIMPLEMENTED,
+            demuxer.ReadTimelines(&timelines).error_code());
+}
+
+TEST_F(DemuxerTest, SampleRanges) {
+  Demuxer demuxer(GetTestDataFilePath("bear-640x360.mp4").string());
+  std::vector<StreamTimeline> timelines;
+  ASSERT_OK(demuxer.ReadTimelines(&timelines));
+
+  Demuxer partition_demuxer(GetTestDataFilePath("bear-640x360.mp4").string());
+  // Only the second GOP of the video.
+  partition_demuxer.SetSampleRanges({{timelines[0].track_id, {30, 60}},
+                                     {timelines[1].track_id, {0, 0}}});
+  auto video_handler = std::make_shared<CachingMediaHandler>();
+  auto audio_handler = std::make_shared<CachingMediaHandler>();
+  ASSERT_OK(partition_demuxer.SetHandler("video", video_handler));
+  ASSERT_OK(partition_demuxer.SetHandler("audio", audio_handler));
+  ASSERT_OK(partition_demuxer.Run());
+
+  std::vector<int64_t> video_pts;
+  for (const auto& stream_data : video_handler->Cache()) {
+    if (stream_data->stream_data_type == StreamDataType::kMediaSample)
+      video_pts.push_back(stream_data->media_sample->pts());
+  }
+  ASSERT_EQ(30u, video_pts.size());
+  EXPECT_EQ(timelines[0].samples[30].pts, video_pts.front());
+  EXPECT_EQ(timelines[0].samples[59].pts, video_pts.back());
+  for (const auto& stream_data : audio_handler->Cache())
+    EXPECT_NE(StreamDataType::kMediaSample, stream_data->stream_data_type);
+}
+
 // TODO(kqyang): Add more tests.
 
 }  // namespace media
@@ -212,7 +212,7 @@ void MpdNotifyMuxerListener::OnNewSegment(const std::string& file_name,
                                     duration, segment_file_size,
                                     segment_number);
     if (mpd_notifier_->mpd_type() == MpdType::kDynamic)
-      mpd_notifier_->Flush();
+      mpd_notifier_->RequestFlush();
   } else {
     EventInfo event_info;
     event_info.type = EventInfoType::kSegment;
@@ -28,11 +28,14 @@ const char kMediaInfoSuffix[] = ".media_info";
 
 std::unique_ptr<MuxerListener> CreateMediaInfoDumpListenerInternal(
     const std::string& output,
-    bool use_segment_list) {
+    bool use_segment_list,
+    bool binary_format) {
   DCHECK(!output.empty());
 
-  std::unique_ptr<MuxerListener> listener(new VodMediaInfoDumpMuxerListener(
-      output + kMediaInfoSuffix, use_segment_list));
+  std::unique_ptr<VodMediaInfoDumpMuxerListener> listener(
+      new VodMediaInfoDumpMuxerListener(output + kMediaInfoSuffix,
+                                        use_segment_list));
+  listener->set_binary_format(binary_format);
   return listener;
 }
 
@@ -87,10 +90,12 @@ std::list<std::unique_ptr<MuxerListener>> CreateHlsListenersInternal(
 }  // namespace
 
 MuxerListenerFactory::MuxerListenerFactory(bool output_media_info,
+                                           bool output_media_info_binary,
                                            bool use_segment_list,
                                            MpdNotifier* mpd_notifier,
                                            hls::HlsNotifier* hls_notifier)
     : output_media_info_(output_media_info),
+      output_media_info_binary_(output_media_info_binary),
       mpd_notifier_(mpd_notifier),
       hls_notifier_(hls_notifier),
       use_segment_list_(use_segment_list) {}
@@ -112,7 +117,8 @@ std::unique_ptr<MuxerListener> MuxerListenerFactory::CreateListener(
         new CombinedMuxerListener);
     if (output_media_info_) {
       combined_listener->AddListener(CreateMediaInfoDumpListenerInternal(
-          stream.media_info_output, use_segment_list_));
+          stream.media_info_output, use_segment_list_,
+          output_media_info_binary_));
     }
 
     if (mpd_notifier_ && !stream.hls_only) {
@@ -67,6 +67,8 @@ class MuxerListenerFactory {
   /// Create a new muxer listener.
   /// @param output_media_info must be true for the combined listener to include
   ///        a media info dump listener.
+  /// @param output_media_info_binary makes the media info dump listener write
+  ///        the protobuf binary format instead of the text format.
   /// @param use_segment_list is set when mpd_notifier_ is null and
   ///        --output_media_info is set. If mpd_notifer is non-null, this value
   ///        is the same as mpd_notifier->use_segment_list().
@@ -75,6 +77,7 @@ class MuxerListenerFactory {
   /// @param hls_notifier must be non-null for the combined listener to include
   ///        an HLS listener.
   MuxerListenerFactory(bool output_media_info,
+                       bool output_media_info_binary,
                        bool use_segment_list,
                        MpdNotifier* mpd_notifier,
                        hls::HlsNotifier* hls_notifier);
@@ -91,6 +94,7 @@ class MuxerListenerFactory {
   MuxerListenerFactory operator=(const MuxerListenerFactory&) = delete;
 
   bool output_media_info_;
+  bool output_media_info_binary_;
   MpdNotifier* mpd_notifier_;
   hls::HlsNotifier* hls_notifier_;
 
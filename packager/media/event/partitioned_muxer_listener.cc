@@ -0,0 +1,171 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/partitioned_muxer_listener.h>
+
+#include <absl/log/check.h>
+#include <absl/synchronization/mutex.h>
+
+namespace shaka {
+namespace media {
+
+struct PartitionedMuxerListener::Output {
+  std::unique_ptr<MuxerListener> listener;
+
+  absl::Mutex mutex;
+  // Buffered events, per partition.
+  std::vector<std::vector<Event>> events ABSL_GUARDED_BY(mutex);
+  size_t num_ended_partitions ABSL_GUARDED_BY(mutex) = 0;
+
+  // Only accessed by the first partition, then by the last partition to end.
+  bool encryption_started = false;
+  MediaRanges media_ranges;
+  float duration_seconds = 0;
+};
+
+std::vector<std::unique_ptr<MuxerListener>>
+PartitionedMuxerListener::CreatePartitionListeners(
+    std::unique_ptr<MuxerListener> listener,
+    size_t num_partitions) {
+  DCHECK(listener);
+  DCHECK_GT(num_partitions, 0u);
+  auto output = std::make_shared<Output>();
+  output->listener = std::move(listener);
+  {
+    absl::MutexLock lock(&output->mutex);
+    output->events.resize(num_partitions);
+  }
+
+  std::vector<std::unique_ptr<MuxerListener>> listeners;
+  for (size_t i = 0; i < num_partitions; ++i)
+    listeners.emplace_back(new PartitionedMuxerListener(output, i));
+  return listeners;
+}
+
+PartitionedMuxerListener::PartitionedMuxerListener(
+    std::shared_ptr<Output> output,
+    size_t index)
+    : output_(std::move(output)), index_(index) {}
+
+PartitionedMuxerListener::~PartitionedMuxerListener() = default;
+
+void PartitionedMuxerListener::OnEncryptionInfoReady(
+    bool is_initial_encryption_info,
+    FourCC protection_scheme,
+    const std::vector<uint8_t>& key_id,
+    const std::vector<uint8_t>& iv,
+    const std::vector<ProtectionSystemSpecificInfo>& key_system_info) {
+  if (index_ == 0) {
+    output_->listener->OnEncryptionInfoReady(is_initial_encryption_info,
+                                             protection_scheme, key_id, iv,
+                                             key_system_info);
+  }
+}
+
+void PartitionedMuxerListener::OnEncryptionStart() {
+  // The clear lead may end in any partition, and only the first encrypted
+  // segment starts the encryption.
+  Output* output = output_.get();
+  Add([output](MuxerListener* listener) {
+    if (output->encryption_started)
+      return;
+    output->encryption_started = true;
+    listener->OnEncryptionStart();
+  });
+}
+
+void PartitionedMuxerListener::OnMediaStart(const MuxerOptions& muxer_options,
+                                            const StreamInfo& stream_info,
+                                            int32_t time_scale,
+                                            ContainerType container_type) {
+  if (index_ == 0) {
+    output_->listener->OnMediaStart(muxer_options, stream_info, time_scale,
+                                    container_type);
+  }
+}
+
+void PartitionedMuxerListener::OnAvailabilityOffsetReady() {
+  if (index_ == 0)
+    output_->listener->OnAvailabilityOffsetReady();
+}
+
+void PartitionedMuxerListener::OnSampleDurationReady(int32_t sample_duration) {
+  if (index_ == 0)
+    output_->listener->OnSampleDurationReady(sample_duration);
+}
+
+void PartitionedMuxerListener::OnSegmentDurationReady() {
+  if (index_ == 0)
+    output_->listener->OnSegmentDurationReady();
+}
+
+void PartitionedMuxerListener::OnMediaEnd(const MediaRanges& media_ranges,
+                                          float duration_seconds) {
+  if (index_ == 0) {
+    // The muxer of the first partition reports the duration of the output.
+    output_->media_ranges = media_ranges;
+    output_->duration_seconds = duration_seconds;
+  }
+
+  std::vector<std::vector<Event>> events;
+  {
+    absl::MutexLock lock(&output_->mutex);
+    output_->events[index_] = std::move(events_);
+    if (++output_->num_ended_partitions < output_->events.size())
+      return;
+    events.swap(output_->events);
+  }
+
+  MuxerListener* listener = output_->listener.get();
+  for (const std::vector<Event>& partition_events : events) {
+    for (const Event& event : partition_events)
+      event(listener);
+  }
+  listener->OnMediaEnd(output_->media_ranges, output_->duration_seconds);
+}
+
+void PartitionedMuxerListener::OnNewSegment(const std::string& file_name,
+                                            int64_t start_time,
+                                            int64_t duration,
+                                            uint64_t segment_file_size,
+                                            int64_t segment_number) {
+  Add([=](MuxerListener* listener) {
+    listener->OnNewSegment(file_name, start_time, duration, segment_file_size,
+                           segment_number);
+  });
+}
+
+void PartitionedMuxerListener::OnCompletedSegment(int64_t duration,
+                                                  uint64_t segment_file_size) {
+  Add([=](MuxerListener* listener) {
+    listener->OnCompletedSegment(duration, segment_file_size);
+  });
+}
+
+void PartitionedMuxerListener::OnKeyFrame(int64_t timestamp,
+                                          uint64_t start_byte_offset,
+                                          uint64_t size) {
+  Add([=](MuxerListener* listener) {
+    listener->OnKeyFrame(timestamp, start_byte_offset, size);
+  });
+}
+
+void PartitionedMuxerListener::OnCueEvent(int64_t timestamp,
+                                          const std::string& cue_data) {
+  Add([=](MuxerListener* listener) {
+    listener->OnCueEvent(timestamp, cue_data);
+  });
+}
+
+void PartitionedMuxerListener::Add(Event event) {
+  if (index_ == 0)
+    event(output_->listener.get());
+  else
+    events_.push_back(std::move(event));
+}
+
+}  // namespace media
+}  // namespace shaka
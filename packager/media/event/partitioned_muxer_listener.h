@@ -0,0 +1,90 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_EVENT_PARTITIONED_MUXER_LISTENER_H_
+#define PACKAGER_MEDIA_EVENT_PARTITIONED_MUXER_LISTENER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <packager/media/event/muxer_listener.h>
+
+namespace shaka {
+namespace media {
+
+/// Listener of one of the muxers packaging the partitions of an output in
+/// parallel. The events of all the partitions are merged into the events of a
+/// single muxer packaging the whole output:
+///  - The events of the first partition are forwarded as they come, except
+///    OnMediaEnd().
+///  - The segment events of the other partitions are buffered, and forwarded
+///    in partition order once every partition has ended, followed by the
+///    OnMediaEnd() of the first partition.
+///  - The start and encryption events of the other partitions are dropped,
+///    they are duplicates of the events of the first partition.
+class PartitionedMuxerListener : public MuxerListener {
+ public:
+  /// @param listener is the listener of the output.
+  /// @return One listener per partition, in partition order.
+  static std::vector<std::unique_ptr<MuxerListener>> CreatePartitionListeners(
+      std::unique_ptr<MuxerListener> listener,
+      size_t num_partitions);
+
+  ~PartitionedMuxerListener() override;
+
+  /// @name MuxerListener implementation overrides.
+  /// @{
+  void OnEncryptionInfoReady(bool is_initial_encryption_info,
+                             FourCC protection_scheme,
+                             const std::vector<uint8_t>& key_id,
+                             const std::vector<uint8_t>& iv,
+                             const std::vector<ProtectionSystemSpecificInfo>&
+                                 key_system_info) override;
+  void OnEncryptionStart() override;
+  void OnMediaStart(const MuxerOptions& muxer_options,
+                    const StreamInfo& stream_info,
+                    int32_t time_scale,
+                    ContainerType container_type) override;
+  void OnAvailabilityOffsetReady() override;
+  void OnSampleDurationReady(int32_t sample_duration) override;
+  void OnSegmentDurationReady() override;
+  void OnMediaEnd(const MediaRanges& media_ranges,
+                  float duration_seconds) override;
+  void OnNewSegment(const std::string& file_name,
+                    int64_t start_time,
+                    int64_t duration,
+                    uint64_t segment_file_size,
+                    int64_t segment_number) override;
+  void OnCompletedSegment(int64_t duration,
+                          uint64_t segment_file_size) override;
+  void OnKeyFrame(int64_t timestamp,
+                  uint64_t start_byte_offset,
+                  uint64_t size) override;
+  void OnCueEvent(int64_t timestamp, const std::string& cue_data) override;
+  /// @}
+
+ private:
+  struct Output;
+  using Event = std::function<void(MuxerListener* listener)>;
+
+  PartitionedMuxerListener(std::shared_ptr<Output> output, size_t index);
+  PartitionedMuxerListener(const PartitionedMuxerListener&) = delete;
+  PartitionedMuxerListener& operator=(const PartitionedMuxerListener&) = delete;
+
+  // Forwards the event if this is the first partition, or buffers it.
+  void Add(Event event);
+
+  const std::shared_ptr<Output> output_;
+  const size_t index_;
+  std::vector<Event> events_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_EVENT_PARTITIONED_MUXER_LISTENER_H_
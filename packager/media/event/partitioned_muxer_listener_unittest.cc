@@ -0,0 +1,126 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/partitioned_muxer_listener.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <packager/media/base/muxer_options.h>
+#include <packager/media/event/mock_muxer_listener.h>
+#include <packager/media/event/muxer_listener_test_helper.h>
+
+namespace shaka {
+namespace media {
+
+using ::testing::_;
+using ::testing::InSequence;
+using ::testing::StrEq;
+using ::testing::StrictMock;
+
+namespace {
+
+const int32_t kTimescale = 90000;
+const int64_t kSegmentDuration = 180000;
+const uint64_t kSegmentSize = 1000;
+const float kDurationSeconds = 6;
+
+MuxerListener::ContainerType kContainer = MuxerListener::kContainerMp4;
+
+}  // namespace
+
+class PartitionedMuxerListenerTest : public ::testing::Test {
+ protected:
+  PartitionedMuxerListenerTest() {
+    std::unique_ptr<StrictMock<MockMuxerListener>> listener(
+        new StrictMock<MockMuxerListener>);
+    listener_ = listener.get();
+    partitions_ = PartitionedMuxerListener::CreatePartitionListeners(
+        std::move(listener), 3);
+
+    VideoStreamInfoParameters video_params = GetDefaultVideoStreamInfoParams();
+    video_stream_info_ = CreateVideoStreamInfo(video_params);
+  }
+
+  void OnNewSegment(size_t partition, int64_t segment_number) {
+    partitions_[partition]->OnNewSegment(
+        std::to_string(segment_number) + ".m4s",
+        (segment_number - 1) * kSegmentDuration, kSegmentDuration,
+        kSegmentSize, segment_number);
+  }
+
+  void ExpectNewSegment(int64_t segment_number) {
+    EXPECT_CALL(*listener_,
+                OnNewSegment(StrEq(std::to_string(segment_number) + ".m4s"),
+                             (segment_number - 1) * kSegmentDuration,
+                             kSegmentDuration, kSegmentSize, segment_number));
+  }
+
+  StrictMock<MockMuxerListener>* listener_;
+  std::vector<std::unique_ptr<MuxerListener>> partitions_;
+  MuxerOptions muxer_options_;
+  std::shared_ptr<StreamInfo> video_stream_info_;
+};
+
+TEST_F(PartitionedMuxerListenerTest, MergesPartitionsInOrder) {
+  MuxerListener::MediaRanges media_ranges;
+  {
+    InSequence s;
+    EXPECT_CALL(*listener_, OnMediaStart(_, _, kTimescale, kContainer));
+    ExpectNewSegment(1);
+  }
+
+  for (auto& partition : partitions_) {
+    partition->OnMediaStart(muxer_options_, *video_stream_info_, kTimescale,
+                            kContainer);
+  }
+  OnNewSegment(2, 3);
+  partitions_[2]->OnMediaEnd(media_ranges, 2);
+  partitions_[1]->OnKeyFrame(kSegmentDuration, 0, kSegmentSize);
+  OnNewSegment(1, 2);
+  OnNewSegment(0, 1);
+  partitions_[0]->OnMediaEnd(media_ranges, kDurationSeconds);
+  // The merged events are forwarded once every partition has ended.
+  ::testing::Mock::VerifyAndClearExpectations(listener_);
+
+  {
+    InSequence s;
+    EXPECT_CALL(*listener_, OnKeyFrame(kSegmentDuration, 0, kSegmentSize));
+    ExpectNewSegment(2);
+    ExpectNewSegment(3);
+    EXPECT_CALL(*listener_, OnMediaEndMock(false, 0, 0, false, 0, 0, false, _,
+                                           kDurationSeconds));
+  }
+  partitions_[1]->OnMediaEnd(media_ranges, 4);
+}
+
+TEST_F(PartitionedMuxerListenerTest, StartsEncryptionOnce) {
+  MuxerListener::MediaRanges media_ranges;
+  {
+    InSequence s;
+    EXPECT_CALL(*listener_, OnEncryptionInfoReady(true, _, _, _, _));
+    ExpectNewSegment(1);
+    ExpectNewSegment(2);
+    EXPECT_CALL(*listener_, OnEncryptionStart());
+    ExpectNewSegment(3);
+    EXPECT_CALL(*listener_, OnMediaEndMock(_, _, _, _, _, _, _, _, _));
+  }
+
+  // The clear lead ends in the second partition.
+  for (auto& partition : partitions_) {
+    partition->OnEncryptionInfoReady(true, FOURCC_cenc, {}, {}, {});
+  }
+  OnNewSegment(0, 1);
+  OnNewSegment(1, 2);
+  partitions_[1]->OnEncryptionStart();
+  OnNewSegment(1, 3);
+  partitions_[2]->OnEncryptionStart();
+  for (auto& partition : partitions_)
+    partition->OnMediaEnd(media_ranges, kDurationSeconds);
+}
+
+}  // namespace media
+}  // namespace shaka
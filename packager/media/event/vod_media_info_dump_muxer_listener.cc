@@ -87,7 +87,7 @@ void VodMediaInfoDumpMuxerListener::OnMediaEnd(const MediaRanges& media_ranges,
   }
   if (!media_info_->has_bandwidth())
     media_info_->set_bandwidth(max_bitrate_);
-  WriteMediaInfoToFile(*media_info_, output_file_name_);
+  WriteMediaInfoToFile(*media_info_, output_file_name_, binary_format_);
 }
 
 void VodMediaInfoDumpMuxerListener::OnNewSegment(const std::string& file_name,
@@ -124,10 +124,15 @@ void VodMediaInfoDumpMuxerListener::OnCueEvent(int64_t timestamp,
 // static
 bool VodMediaInfoDumpMuxerListener::WriteMediaInfoToFile(
     const MediaInfo& media_info,
-    const std::string& output_file_path) {
+    const std::string& output_file_path,
+    bool binary_format) {
   std::string output_string;
-  if (!google::protobuf::TextFormat::PrintToString(media_info,
-                                                   &output_string)) {
+  const bool serialized =
+      binary_format
+          ? media_info.SerializeToString(&output_string)
+          : google::protobuf::TextFormat::PrintToString(media_info,
+                                                        &output_string);
+  if (!serialized) {
     LOG(ERROR) << "Failed to serialize MediaInfo to string.";
     return false;
   }
@@ -59,16 +59,22 @@ class VodMediaInfoDumpMuxerListener : public MuxerListener {
   void OnCueEvent(int64_t timestamp, const std::string& cue_data) override;
   /// @}
 
-  /// Write @a media_info to @a output_file_path in human readable format.
+  /// Write @a media_info to @a output_file_path.
   /// @param media_info is the MediaInfo to write out.
   /// @param output_file_path is the path of the output file.
+  /// @param binary_format selects the protobuf binary (wire) format instead
+  ///        of the human readable text format.
   /// @return true on success, false otherwise.
   // TODO(rkuroiwa): Move this to muxer_listener_internal and rename
   // muxer_listener_internal to muxer_listener_util.
   static bool WriteMediaInfoToFile(const MediaInfo& media_info,
-                                   const std::string& output_file_path);
+                                   const std::string& output_file_path,
+                                   bool binary_format);
 
   void set_use_segment_list(bool value) { use_segment_list_ = value; }
+  /// Write the MediaInfo in the protobuf binary format, which is much faster
+  /// to parse than the text format for outputs with many subsegments.
+  void set_binary_format(bool value) { binary_format_ = value; }
 
  private:
   std::string output_file_name_;
@@ -82,6 +88,7 @@ class VodMediaInfoDumpMuxerListener : public MuxerListener {
   std::vector<ProtectionSystemSpecificInfo> key_system_info_;
 
   bool use_segment_list_ = false;
+  bool binary_format_ = false;
 
   DISALLOW_COPY_AND_ASSIGN(VodMediaInfoDumpMuxerListener);
 };
@@ -325,5 +325,51 @@ TEST_F(VodMediaInfoDumpMuxerListenerTest,
   EXPECT_THAT(temp_file_path_, FileContentEqualsProto(kExpectedProtobufOutput));
 }
 
+TEST_F(VodMediaInfoDumpMuxerListenerTest, BinaryFormat) {
+  listener_->set_binary_format(true);
+  std::shared_ptr<StreamInfo> stream_info =
+      CreateVideoStreamInfo(GetDefaultVideoStreamInfoParams());
+
+  FireOnMediaStartWithDefaultMuxerOptions(*stream_info, !kEnableEncryption);
+  OnMediaEndParameters media_end_param = GetDefaultOnMediaEndParams();
+  FireOnMediaEndWithParams(media_end_param);
+
+  const char kExpectedProtobufOutput[] =
+      "bandwidth: 0\n"
+      "video_info {\n"
+      "  codec: 'avc1.010101'\n"
+      "  width: 720\n"
+      "  height: 480\n"
+      "  time_scale: 10\n"
+      "  pixel_width: 1\n"
+      "  pixel_height: 1\n"
+      "  supplemental_codec: ''\n"
+      "  compatible_brand: 0\n"
+      "}\n"
+      "init_range {\n"
+      "  begin: 0\n"
+      "  end: 120\n"
+      "}\n"
+      "index_range {\n"
+      "  begin: 121\n"
+      "  end: 221\n"
+      "}\n"
+      "reference_time_scale: 1000\n"
+      "container_type: 1\n"
+      "media_file_name: 'test_output_file_name.mp4'\n"
+      "media_duration_seconds: 10.5\n";
+  MediaInfo expected_media_info;
+  ASSERT_TRUE(::google::protobuf::TextFormat::ParseFromString(
+      kExpectedProtobufOutput, &expected_media_info));
+
+  std::string file_content;
+  ASSERT_TRUE(File::ReadFileToString(temp_file_path_.c_str(), &file_content));
+  MediaInfo actual_media_info;
+  ASSERT_TRUE(actual_media_info.ParseFromString(file_content));
+  EXPECT_TRUE(::google::protobuf::util::MessageDifferencer::Equals(
+      actual_media_info, expected_media_info))
+      << actual_media_info.ShortDebugString();
+}
+
 }  // namespace media
 }  // namespace shaka
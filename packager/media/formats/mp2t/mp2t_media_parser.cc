@@ -9,6 +9,7 @@
 
 #include <absl/log/check.h>
 
+#include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
 #include <packager/media/base/media_sample.h>
 #include <packager/media/base/stream_info.h>
@@ -153,7 +154,11 @@ void PidState::ResetState() {
 }
 
 Mp2tMediaParser::Mp2tMediaParser()
-    : sbr_in_mimetype_(false), is_initialized_(false) {}
+    : sbr_in_mimetype_(false),
+      ts_packet_(new TsPacket),
+      is_initialized_(false) {
+  pid_table_.fill(nullptr);
+}
 
 Mp2tMediaParser::~Mp2tMediaParser() {}
 
@@ -183,6 +188,7 @@ bool Mp2tMediaParser::Flush() {
   }
   bool result = EmitRemainingSamples();
   pids_.clear();
+  pid_table_.fill(nullptr);
 
   // Remove any bytes left in the TS buffer.
   // (i.e. any partial TS packet => less than 188 bytes).
@@ -195,7 +201,21 @@ bool Mp2tMediaParser::Parse(const uint8_t* buf, int size) {
 
   // Add the data to the parser state.
   ts_byte_queue_.Push(buf, size);
+  return ParseTsPackets();
+}
+
+bool Mp2tMediaParser::ParseMapped(std::shared_ptr<const void> owner,
+                                  const uint8_t* buf,
+                                  int size) {
+  UNUSED(owner);
+  DVLOG(2) << "Mp2tMediaParser::ParseMapped size=" << size;
 
+  // The TS packets are parsed in place. The PES payloads are still copied.
+  ts_byte_queue_.PushView(buf, size);
+  return ParseTsPackets();
+}
+
+bool Mp2tMediaParser::ParseTsPackets() {
   while (true) {
     const uint8_t* ts_buffer;
     int ts_buffer_size;
@@ -204,54 +224,89 @@ bool Mp2tMediaParser::Parse(const uint8_t* buf, int size) {
       break;
 
     // Synchronization.
-    int skipped_bytes = TsPacket::Sync(ts_buffer, ts_buffer_size);
-    if (skipped_bytes > 0) {
+    const int num_synced_packets =
+        TsPacket::CountSyncedPackets(ts_buffer, ts_buffer_size);
+    if (num_synced_packets == 0) {
+      int skipped_bytes = TsPacket::Sync(ts_buffer, ts_buffer_size);
+      DCHECK_GT(skipped_bytes, 0);
       DVLOG(1) << "Packet not aligned on a TS syncword:"
                << " skipped_bytes=" << skipped_bytes;
       ts_byte_queue_.Pop(skipped_bytes);
       continue;
     }
 
-    // Parse the TS header, skipping 1 byte if the header is invalid.
-    std::unique_ptr<TsPacket> ts_packet(
-        TsPacket::Parse(ts_buffer, ts_buffer_size));
-    if (!ts_packet) {
-      DVLOG(1) << "Error: invalid TS packet";
-      ts_byte_queue_.Pop(1);
-      continue;
-    }
-    DVLOG(LOG_LEVEL_TS) << "Processing PID=" << ts_packet->pid()
-                        << " start_unit="
-                        << ts_packet->payload_unit_start_indicator()
-                        << " continuity_counter="
-                        << ts_packet->continuity_counter();
-    // Parse the section.
-    auto it = pids_.find(ts_packet->pid());
-    if (it == pids_.end() && ts_packet->pid() == TsSection::kPidPat) {
-      // Create the PAT state here if needed.
-      std::unique_ptr<TsSection> pat_section_parser(new TsSectionPat(
-          std::bind(&Mp2tMediaParser::RegisterPmt, this, std::placeholders::_1,
-                    std::placeholders::_2)));
-      std::unique_ptr<PidState> pat_pid_state(new PidState(
-          ts_packet->pid(), PidState::kPidPat, std::move(pat_section_parser)));
-      pat_pid_state->Enable();
-      it = pids_.emplace(ts_packet->pid(), std::move(pat_pid_state)).first;
+    // Parse the whole run of synchronized packets before popping them.
+    int num_parsed_packets = 0;
+    bool invalid_header = false;
+    for (; num_parsed_packets < num_synced_packets; ++num_parsed_packets) {
+      const int offset = num_parsed_packets * TsPacket::kPacketSize;
+      if (!ParseTsPacket(ts_buffer + offset, ts_buffer_size - offset,
+                         &invalid_header)) {
+        break;
+      }
     }
+    if (num_parsed_packets < num_synced_packets && !invalid_header)
+      return false;
+    ts_byte_queue_.Pop(num_parsed_packets * TsPacket::kPacketSize);
 
-    if (it != pids_.end()) {
-      RCHECK(it->second->PushTsPacket(*ts_packet));
-    } else {
-      DVLOG(LOG_LEVEL_TS) << "Ignoring TS packet for pid: " << ts_packet->pid();
+    // Skip 1 byte if the header is invalid.
+    if (invalid_header) {
+      DVLOG(1) << "Error: invalid TS packet";
+      ts_byte_queue_.Pop(1);
     }
-
-    // Go to the next packet.
-    ts_byte_queue_.Pop(TsPacket::kPacketSize);
   }
 
   // Emit the A/V buffers that kept accumulating during TS parsing.
   return EmitRemainingSamples();
 }
 
+bool Mp2tMediaParser::ParseTsPacket(const uint8_t* buf,
+                                    int size,
+                                    bool* invalid_header) {
+  // Parse the TS header.
+  if (!TsPacket::Parse(buf, size, ts_packet_.get())) {
+    *invalid_header = true;
+    return false;
+  }
+  const TsPacket& ts_packet = *ts_packet_;
+  DVLOG(LOG_LEVEL_TS) << "Processing PID=" << ts_packet.pid()
+                      << " start_unit="
+                      << ts_packet.payload_unit_start_indicator()
+                      << " continuity_counter="
+                      << ts_packet.continuity_counter();
+  // Parse the section.
+  PidState* pid_state = pid_table_[ts_packet.pid()];
+  if (!pid_state && ts_packet.pid() == TsSection::kPidPat) {
+    // Create the PAT state here if needed.
+    std::unique_ptr<TsSection> pat_section_parser(new TsSectionPat(
+        std::bind(&Mp2tMediaParser::RegisterPmt, this, std::placeholders::_1,
+                  std::placeholders::_2)));
+    std::unique_ptr<PidState> pat_pid_state(new PidState(
+        ts_packet.pid(), PidState::kPidPat, std::move(pat_section_parser)));
+    pat_pid_state->Enable();
+    pid_state = AddPidState(ts_packet.pid(), std::move(pat_pid_state));
+  }
+
+  if (pid_state) {
+    RCHECK(pid_state->PushTsPacket(ts_packet));
+  } else {
+    DVLOG(LOG_LEVEL_TS) << "Ignoring TS packet for pid: " << ts_packet.pid();
+  }
+  return true;
+}
+
+PidState* Mp2tMediaParser::AddPidState(int pid,
+                                       std::unique_ptr<PidState> pid_state) {
+  DCHECK_GE(pid, 0);
+  DCHECK_LT(static_cast<size_t>(pid), pid_table_.size());
+  PidState* pid_state_ptr = pid_state.get();
+  const bool inserted = pids_.emplace(pid, std::move(pid_state)).second;
+  DCHECK(inserted);
+  UNUSED(inserted);
+  pid_table_[pid] = pid_state_ptr;
+  return pid_state_ptr;
+}
+
 void Mp2tMediaParser::RegisterPmt(int program_number, int pmt_pid) {
   DVLOG(1) << "RegisterPmt:"
            << " program_number=" << program_number << " pmt_pid=" << pmt_pid;
@@ -276,7 +331,7 @@ void Mp2tMediaParser::RegisterPmt(int program_number, int pmt_pid) {
   std::unique_ptr<PidState> pmt_pid_state(
       new PidState(pmt_pid, PidState::kPidPmt, std::move(pmt_section_parser)));
   pmt_pid_state->Enable();
-  pids_.emplace(pmt_pid, std::move(pmt_pid_state));
+  AddPidState(pmt_pid, std::move(pmt_pid_state));
 }
 
 void Mp2tMediaParser::RegisterPes(int pmt_pid,
@@ -349,7 +404,7 @@ void Mp2tMediaParser::RegisterPes(int pmt_pid,
   std::unique_ptr<PidState> pes_pid_state(
       new PidState(pes_pid, pid_type, std::move(pes_section_parser)));
   pes_pid_state->Enable();
-  pids_.emplace(pes_pid, std::move(pes_pid_state));
+  AddPidState(pes_pid, std::move(pes_pid_state));
 
   // Store PES metadata.
   pes_metadata_.insert(
@@ -5,6 +5,7 @@
 #ifndef PACKAGER_MEDIA_FORMATS_MP2T_MP2T_MEDIA_PARSER_H_
 #define PACKAGER_MEDIA_FORMATS_MP2T_MP2T_MEDIA_PARSER_H_
 
+#include <array>
 #include <bitset>
 #include <cstdint>
 #include <deque>
@@ -50,9 +51,23 @@ class Mp2tMediaParser : public MediaParser {
             KeySource* decryption_key_source) override;
   [[nodiscard]] bool Flush() override;
   [[nodiscard]] bool Parse(const uint8_t* buf, int size) override;
+  [[nodiscard]] bool ParseMapped(std::shared_ptr<const void> owner,
+                                 const uint8_t* buf,
+                                 int size) override;
   /// @}
 
  private:
+  // Parses the TS packets in |ts_byte_queue_|.
+  bool ParseTsPackets();
+
+  // Parses a single synchronized TS packet, which may fail because of an
+  // invalid header (|*invalid_header| is set then) or because the section
+  // parser failed.
+  bool ParseTsPacket(const uint8_t* buf, int size, bool* invalid_header);
+
+  // Adds |pid_state| to |pids_| and to |pid_table_|.
+  PidState* AddPidState(int pid, std::unique_ptr<PidState> pid_state);
+
   // Callback invoked to register a Program Map Table.
   // Note: Does nothing if the PID is already registered.
   void RegisterPmt(int program_number, int pmt_pid);
@@ -111,6 +126,10 @@ class Mp2tMediaParser : public MediaParser {
   // Map of PIDs and their states.  Use an ordered map so manifest generation
   // has a deterministic order.
   std::map<int, std::unique_ptr<PidState>> pids_;
+  // The states in |pids_| indexed by PID, for the per packet lookup.
+  std::array<PidState*, 0x2000> pid_table_;
+  // Reused for every TS packet.
+  std::unique_ptr<TsPacket> ts_packet_;
 
   // Map of PIDs and their metadata.
   std::map<int, PesMetadata> pes_metadata_;
@@ -4,12 +4,12 @@
 
 #include <packager/media/formats/mp2t/ts_packet.h>
 
-#include <memory>
+#include <algorithm>
+#include <cstring>
 
 #include <absl/log/check.h>
 
 #include <packager/macros/logging.h>
-#include <packager/media/base/bit_reader.h>
 #include <packager/media/formats/mp2t/mp2t_common.h>
 
 namespace shaka {
@@ -17,15 +17,27 @@ namespace media {
 namespace mp2t {
 
 static const uint8_t kTsHeaderSyncword = 0x47;
+// Number of syncwords in a row required to be considered synchronized.
+static const int kSyncwordsInARow = 4;
 
 // static
 int TsPacket::Sync(const uint8_t* buf, int size) {
   int k = 0;
-  for (; k < size; k++) {
+  while (k < size) {
+    // Jump to the next syncword candidate; memchr is vectorized by the C
+    // library, which matters when the input is far from aligned.
+    const uint8_t* candidate = static_cast<const uint8_t*>(
+        memchr(buf + k, kTsHeaderSyncword, size - k));
+    if (!candidate) {
+      k = size;
+      break;
+    }
+    k = static_cast<int>(candidate - buf);
+
     // Verify that we have 4 syncwords in a row when possible,
     // this should improve synchronization robustness.
     bool is_header = true;
-    for (int i = 0; i < 4; i++) {
+    for (int i = 1; i < kSyncwordsInARow; i++) {
       int idx = k + i * kPacketSize;
       if (idx >= size)
         break;
@@ -38,6 +50,7 @@ int TsPacket::Sync(const uint8_t* buf, int size) {
     }
     if (is_header)
       break;
+    k++;
   }
 
   if (k != 0) {
@@ -47,27 +60,44 @@ int TsPacket::Sync(const uint8_t* buf, int size) {
 }
 
 // static
-TsPacket* TsPacket::Parse(const uint8_t* buf, int size) {
+int TsPacket::CountSyncedPackets(const uint8_t* buf, int size) {
+  const int num_packets = size / kPacketSize;
+  // Length of the run of syncwords at packet boundaries, including the one of
+  // a trailing partial packet.
+  int run = 0;
+  for (int idx = 0; idx < size && buf[idx] == kTsHeaderSyncword;
+       idx += kPacketSize) {
+    run++;
+  }
+  // If the run reaches the end of the data, Sync() checks fewer syncwords for
+  // the last packets and accepts all of them. Otherwise a packet needs the
+  // three following syncwords to be in the run too.
+  if (run * kPacketSize >= size)
+    return num_packets;
+  return std::min(num_packets, std::max(0, run - (kSyncwordsInARow - 1)));
+}
+
+// static
+bool TsPacket::Parse(const uint8_t* buf, int size, TsPacket* packet) {
+  DCHECK(packet);
   if (size < kPacketSize) {
     DVLOG(1) << "Buffer does not hold one full TS packet:"
              << " buffer_size=" << size;
-    return NULL;
+    return false;
   }
 
   DCHECK_EQ(buf[0], kTsHeaderSyncword);
   if (buf[0] != kTsHeaderSyncword) {
     DVLOG(1) << "Not on a TS syncword:"
              << " buf[0]=" << std::hex << static_cast<int>(buf[0]) << std::dec;
-    return NULL;
+    return false;
   }
 
-  std::unique_ptr<TsPacket> ts_packet(new TsPacket());
-  bool status = ts_packet->ParseHeader(buf);
-  if (!status) {
+  if (!packet->ParseHeader(buf)) {
     DVLOG(1) << "Parsing header failed";
-    return NULL;
+    return false;
   }
-  return ts_packet.release();
+  return true;
 }
 
 TsPacket::TsPacket() {}
@@ -75,28 +105,21 @@ TsPacket::TsPacket() {}
 TsPacket::~TsPacket() {}
 
 bool TsPacket::ParseHeader(const uint8_t* buf) {
-  BitReader bit_reader(buf, kPacketSize);
-  payload_ = buf;
-  payload_size_ = kPacketSize;
-
   // Read the TS header: 4 bytes.
-  int syncword;
-  int transport_error_indicator;
-  int payload_unit_start_indicator;
-  int transport_priority;
-  int transport_scrambling_control;
-  int adaptation_field_control;
-  RCHECK(bit_reader.ReadBits(8, &syncword));
-  RCHECK(bit_reader.ReadBits(1, &transport_error_indicator));
-  RCHECK(bit_reader.ReadBits(1, &payload_unit_start_indicator));
-  RCHECK(bit_reader.ReadBits(1, &transport_priority));
-  RCHECK(bit_reader.ReadBits(13, &pid_));
-  RCHECK(bit_reader.ReadBits(2, &transport_scrambling_control));
-  RCHECK(bit_reader.ReadBits(2, &adaptation_field_control));
-  RCHECK(bit_reader.ReadBits(4, &continuity_counter_));
-  payload_unit_start_indicator_ = (payload_unit_start_indicator != 0);
-  payload_ += 4;
-  payload_size_ -= 4;
+  //   syncword                      8 bits
+  //   transport_error_indicator     1 bit
+  //   payload_unit_start_indicator  1 bit
+  //   transport_priority            1 bit
+  //   pid                          13 bits
+  //   transport_scrambling_control  2 bits
+  //   adaptation_field_control      2 bits
+  //   continuity_counter            4 bits
+  payload_unit_start_indicator_ = (buf[1] & 0x40) != 0;
+  pid_ = ((buf[1] & 0x1f) << 8) | buf[2];
+  const int adaptation_field_control = (buf[3] >> 4) & 0x3;
+  continuity_counter_ = buf[3] & 0xf;
+  payload_ = buf + 4;
+  payload_size_ = kPacketSize - 4;
 
   // Default values when no adaptation field.
   discontinuity_indicator_ = false;
@@ -107,8 +130,7 @@ bool TsPacket::ParseHeader(const uint8_t* buf) {
     return true;
 
   // Read the adaptation field if needed.
-  int adaptation_field_length;
-  RCHECK(bit_reader.ReadBits(8, &adaptation_field_length));
+  const int adaptation_field_length = buf[4];
   DVLOG(LOG_LEVEL_TS) << "adaptation_field_length=" << adaptation_field_length;
   payload_ += 1;
   payload_size_ -= 1;
@@ -129,84 +151,54 @@ bool TsPacket::ParseHeader(const uint8_t* buf) {
   if (adaptation_field_length == 0)
     return true;
 
-  bool status = ParseAdaptationField(&bit_reader, adaptation_field_length);
+  bool status = ParseAdaptationField(payload_, adaptation_field_length);
   payload_ += adaptation_field_length;
   payload_size_ -= adaptation_field_length;
   return status;
 }
 
-bool TsPacket::ParseAdaptationField(BitReader* bit_reader,
+bool TsPacket::ParseAdaptationField(const uint8_t* adaptation_field,
                                     int adaptation_field_length) {
   DCHECK_GT(adaptation_field_length, 0);
-  int adaptation_field_start_marker =
-      static_cast<int>(bit_reader->bits_available()) / 8;
-
-  int discontinuity_indicator;
-  int random_access_indicator;
-  int elementary_stream_priority_indicator;
-  int pcr_flag;
-  int opcr_flag;
-  int splicing_point_flag;
-  int transport_private_data_flag;
-  int adaptation_field_extension_flag;
-  RCHECK(bit_reader->ReadBits(1, &discontinuity_indicator));
-  RCHECK(bit_reader->ReadBits(1, &random_access_indicator));
-  RCHECK(bit_reader->ReadBits(1, &elementary_stream_priority_indicator));
-  RCHECK(bit_reader->ReadBits(1, &pcr_flag));
-  RCHECK(bit_reader->ReadBits(1, &opcr_flag));
-  RCHECK(bit_reader->ReadBits(1, &splicing_point_flag));
-  RCHECK(bit_reader->ReadBits(1, &transport_private_data_flag));
-  RCHECK(bit_reader->ReadBits(1, &adaptation_field_extension_flag));
-  discontinuity_indicator_ = (discontinuity_indicator != 0);
-  random_access_indicator_ = (random_access_indicator != 0);
-
-  if (pcr_flag) {
-    int64_t program_clock_reference_base;
-    int reserved;
-    int program_clock_reference_extension;
-    RCHECK(bit_reader->ReadBits(33, &program_clock_reference_base));
-    RCHECK(bit_reader->ReadBits(6, &reserved));
-    RCHECK(bit_reader->ReadBits(9, &program_clock_reference_extension));
-  }
-
-  if (opcr_flag) {
-    int64_t original_program_clock_reference_base;
-    int reserved;
-    int original_program_clock_reference_extension;
-    RCHECK(bit_reader->ReadBits(33, &original_program_clock_reference_base));
-    RCHECK(bit_reader->ReadBits(6, &reserved));
-    RCHECK(
-        bit_reader->ReadBits(9, &original_program_clock_reference_extension));
-  }
-
-  if (splicing_point_flag) {
-    int splice_countdown;
-    RCHECK(bit_reader->ReadBits(8, &splice_countdown));
-  }
+  // Sizes of the optional fields flagged in the first byte.
+  const int kProgramClockReferenceSize = 6;
+  const int kSpliceCountdownSize = 1;
+
+  const uint8_t flags = adaptation_field[0];
+  discontinuity_indicator_ = (flags & 0x80) != 0;
+  random_access_indicator_ = (flags & 0x40) != 0;
+  // elementary_stream_priority_indicator is 0x20.
+  const bool pcr_flag = (flags & 0x10) != 0;
+  const bool opcr_flag = (flags & 0x08) != 0;
+  const bool splicing_point_flag = (flags & 0x04) != 0;
+  const bool transport_private_data_flag = (flags & 0x02) != 0;
+  const bool adaptation_field_extension_flag = (flags & 0x01) != 0;
+
+  int pos = 1;
+  if (pcr_flag)
+    pos += kProgramClockReferenceSize;
+  if (opcr_flag)
+    pos += kProgramClockReferenceSize;
+  if (splicing_point_flag)
+    pos += kSpliceCountdownSize;
 
   if (transport_private_data_flag) {
-    int transport_private_data_length;
-    RCHECK(bit_reader->ReadBits(8, &transport_private_data_length));
-    RCHECK(bit_reader->SkipBits(8 * transport_private_data_length));
+    RCHECK(pos < adaptation_field_length);
+    const int transport_private_data_length = adaptation_field[pos];
+    pos += 1 + transport_private_data_length;
   }
 
   if (adaptation_field_extension_flag) {
-    int adaptation_field_extension_length;
-    RCHECK(bit_reader->ReadBits(8, &adaptation_field_extension_length));
-    RCHECK(bit_reader->SkipBits(8 * adaptation_field_extension_length));
+    RCHECK(pos < adaptation_field_length);
+    const int adaptation_field_extension_length = adaptation_field[pos];
+    pos += 1 + adaptation_field_extension_length;
   }
 
   // The rest of the adaptation field should be stuffing bytes.
-  int adaptation_field_remaining_size =
-      adaptation_field_length -
-      (adaptation_field_start_marker -
-       static_cast<int>(bit_reader->bits_available()) / 8);
-  RCHECK(adaptation_field_remaining_size >= 0);
-  for (int k = 0; k < adaptation_field_remaining_size; k++) {
-    int stuffing_byte;
-    RCHECK(bit_reader->ReadBits(8, &stuffing_byte));
-    RCHECK(stuffing_byte == 0xff);
-  }
+  RCHECK(pos <= adaptation_field_length);
+  RCHECK(std::all_of(adaptation_field + pos,
+                     adaptation_field + adaptation_field_length,
+                     [](uint8_t stuffing_byte) { return stuffing_byte == 0xff; }));
 
   DVLOG(LOG_LEVEL_TS) << "random_access_indicator=" << random_access_indicator_;
   return true;
@@ -12,8 +12,6 @@
 namespace shaka {
 namespace media {
 
-class BitReader;
-
 namespace mp2t {
 
 class TsPacket {
@@ -24,11 +22,16 @@ class TsPacket {
   // to be synchronized on a TS syncword.
   static int Sync(const uint8_t* buf, int size);
 
-  // Parse a TS packet.
-  // Return a TsPacket only when parsing was successful.
-  // Return NULL otherwise.
-  static TsPacket* Parse(const uint8_t* buf, int size);
+  // Return the number of consecutive full TS packets at the start of |buf|
+  // that are synchronized, i.e. for which Sync() would not skip any bytes.
+  static int CountSyncedPackets(const uint8_t* buf, int size);
+
+  // Parse a TS packet into |packet|, which only refers to |buf|, so that a
+  // single instance can be reused for a whole run of packets.
+  // Return true only when parsing was successful.
+  static bool Parse(const uint8_t* buf, int size, TsPacket* packet);
 
+  TsPacket();
   ~TsPacket();
 
   // TS header accessors.
@@ -45,25 +48,25 @@ class TsPacket {
   int payload_size() const { return payload_size_; }
 
  private:
-  TsPacket();
-
   // Parse an Mpeg2 TS header.
   // The buffer size should be at least |kPacketSize|
   bool ParseHeader(const uint8_t* buf);
-  bool ParseAdaptationField(BitReader* bit_reader, int adaptation_field_length);
+  // |adaptation_field| points right after adaptation_field_length.
+  bool ParseAdaptationField(const uint8_t* adaptation_field,
+                            int adaptation_field_length);
 
   // Size of the payload.
-  const uint8_t* payload_;
-  int payload_size_;
+  const uint8_t* payload_ = nullptr;
+  int payload_size_ = 0;
 
   // TS header.
-  bool payload_unit_start_indicator_;
-  int pid_;
-  int continuity_counter_;
+  bool payload_unit_start_indicator_ = false;
+  int pid_ = 0;
+  int continuity_counter_ = 0;
 
   // Params from the adaptation field.
-  bool discontinuity_indicator_;
-  bool random_access_indicator_;
+  bool discontinuity_indicator_ = false;
+  bool random_access_indicator_ = false;
 
   DISALLOW_COPY_AND_ASSIGN(TsPacket);
 };
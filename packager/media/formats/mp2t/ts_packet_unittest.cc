@@ -0,0 +1,112 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/formats/mp2t/ts_packet.h>
+
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace shaka {
+namespace media {
+namespace mp2t {
+namespace {
+
+const uint8_t kSyncword = 0x47;
+const int kPacketSize = TsPacket::kPacketSize;
+
+// Number of leading packets the parser would process one at a time: while
+// Sync() does not skip anything, consume a packet.
+int CountSyncedPacketsWithSync(const uint8_t* buf, int size) {
+  int count = 0;
+  while (size >= kPacketSize && TsPacket::Sync(buf, size) == 0) {
+    buf += kPacketSize;
+    size -= kPacketSize;
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+TEST(TsPacketTest, ParseHeader) {
+  std::vector<uint8_t> packet(kPacketSize, 0xaa);
+  packet[0] = kSyncword;
+  packet[1] = 0x40 | 0x01;  // payload_unit_start_indicator, pid 0x0100.
+  packet[2] = 0x00;
+  packet[3] = 0x30 | 0x07;  // Adaptation field and payload, cc 7.
+  packet[4] = 7;            // adaptation_field_length.
+  packet[5] = 0x40 | 0x10;  // random_access_indicator and PCR.
+  // 6 bytes of PCR and no stuffing.
+
+  TsPacket ts_packet;
+  ASSERT_TRUE(TsPacket::Parse(packet.data(), packet.size(), &ts_packet));
+  EXPECT_TRUE(ts_packet.payload_unit_start_indicator());
+  EXPECT_EQ(0x100, ts_packet.pid());
+  EXPECT_EQ(7, ts_packet.continuity_counter());
+  EXPECT_FALSE(ts_packet.discontinuity_indicator());
+  EXPECT_TRUE(ts_packet.random_access_indicator());
+  EXPECT_EQ(packet.data() + 12, ts_packet.payload());
+  EXPECT_EQ(kPacketSize - 12, ts_packet.payload_size());
+
+  // Adaptation field too short for the PCR.
+  packet[4] = 2;
+  EXPECT_FALSE(TsPacket::Parse(packet.data(), packet.size(), &ts_packet));
+
+  // Adaptation field with stuffing.
+  packet[4] = 20;
+  for (int i = 12; i < 5 + 20; ++i)
+    packet[i] = 0xff;
+  ASSERT_TRUE(TsPacket::Parse(packet.data(), packet.size(), &ts_packet));
+  EXPECT_EQ(kPacketSize - 25, ts_packet.payload_size());
+  packet[20] = 0;
+  EXPECT_FALSE(TsPacket::Parse(packet.data(), packet.size(), &ts_packet));
+
+  // Not a full packet.
+  EXPECT_FALSE(TsPacket::Parse(packet.data(), packet.size() - 1, &ts_packet));
+}
+
+TEST(TsPacketTest, SyncSkipsToFourSyncwordsInARow) {
+  std::vector<uint8_t> data(10 + 5 * kPacketSize, 0);
+  // A lone syncword first, then five packets.
+  data[3] = kSyncword;
+  for (int i = 0; i < 5; ++i)
+    data[10 + i * kPacketSize] = kSyncword;
+  EXPECT_EQ(10, TsPacket::Sync(data.data(), data.size()));
+  EXPECT_EQ(0, TsPacket::CountSyncedPackets(data.data(), data.size()));
+  EXPECT_EQ(5, TsPacket::CountSyncedPackets(data.data() + 10, data.size() - 10));
+  // No syncword at all.
+  EXPECT_EQ(3, TsPacket::Sync(data.data(), 3));
+}
+
+// CountSyncedPackets() must agree with calling Sync() before every packet,
+// which is what the parser used to do.
+TEST(TsPacketTest, CountSyncedPacketsMatchesSync) {
+  std::mt19937 random(1234);
+  const int kNumPackets = 12;
+  for (int iteration = 0; iteration < 2000; ++iteration) {
+    std::vector<uint8_t> data(kNumPackets * kPacketSize + random() % kPacketSize,
+                              0);
+    for (size_t idx = 0; idx < data.size(); idx += kPacketSize)
+      data[idx] = kSyncword;
+    // Corrupt a few syncwords.
+    const int num_corruptions = random() % 3;
+    for (int i = 0; i < num_corruptions; ++i)
+      data[(random() % kNumPackets) * kPacketSize] = 0;
+
+    for (int size : {static_cast<int>(data.size()), kPacketSize,
+                     3 * kPacketSize + 1, 5 * kPacketSize}) {
+      EXPECT_EQ(CountSyncedPacketsWithSync(data.data(), size),
+                TsPacket::CountSyncedPackets(data.data(), size))
+          << "iteration " << iteration << " size " << size;
+    }
+  }
+}
+
+}  // namespace mp2t
+}  // namespace media
+}  // namespace shaka
@@ -6,6 +6,9 @@
 
 #include <packager/media/formats/mp2t/ts_packet_writer_util.h>
 
+#include <cstring>
+
+#include <absl/base/internal/endian.h>
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
@@ -23,50 +26,31 @@ const uint8_t kSyncByte = 0x47;
 
 // This is the size of the first few fields in a TS packet, i.e. TS packet size
 // without adaptation field or the payload.
-const int kTsPacketHeaderSize = 4;
-const int kTsPacketSize = 188;
-const int kTsPacketMaximumPayloadSize = kTsPacketSize - kTsPacketHeaderSize;
-
-// Used for adaptation field padding bytes.
-const uint8_t kPaddingBytes[] = {
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-};
-static_assert(std::size(kPaddingBytes) >= kTsPacketMaximumPayloadSize,
-              "Padding array is not big enough.");
+const size_t kTsPacketHeaderSize = 4;
+const size_t kTsPacketSize = 188;
+const size_t kTsPacketMaximumPayloadSize = kTsPacketSize - kTsPacketHeaderSize;
+
+// The size of the adaptation_field_length field.
+const size_t kAdaptationFieldLengthSize = 1;
+// The size of all leading flags (not including the adaptation_field_length).
+const size_t kAdaptationFieldHeaderSize = 1;
+
+const uint8_t kPaddingByte = 0xFF;
 
 // |remaining_data_size| is the amount of data that has to be written. This may
 // be bigger than a TS packet size.
 // |remaining_data_size| matters if it is short and requires padding.
-void WriteAdaptationField(bool has_pcr,
-                          uint64_t pcr_base,
-                          size_t remaining_data_size,
-                          BufferWriter* writer) {
+// Returns the size of the adaptation field written at |output|.
+size_t WriteAdaptationField(bool has_pcr,
+                            uint64_t pcr_base,
+                            size_t remaining_data_size,
+                            uint8_t* output) {
   // Special case where a TS packet requires 1 byte padding.
   if (!has_pcr && remaining_data_size == kTsPacketMaximumPayloadSize - 1) {
-    writer->AppendInt(static_cast<uint8_t>(0));
-    return;
+    output[0] = 0;
+    return kAdaptationFieldLengthSize;
   }
 
-  // The size of the field itself.
-  const int kAdaptationFieldLengthSize = 1;
-
-  // The size of all leading flags (not including the adaptation_field_length).
-  const int kAdaptationFieldHeaderSize = 1;
   size_t adaptation_field_length =
       kAdaptationFieldHeaderSize + (has_pcr ? kPcrFieldsSize : 0);
   if (remaining_data_size < kTsPacketMaximumPayloadSize) {
@@ -78,12 +62,11 @@ void WriteAdaptationField(bool has_pcr,
     }
   }
 
-  writer->AppendInt(static_cast<uint8_t>(adaptation_field_length));
-  int remaining_bytes = static_cast<int>(adaptation_field_length);
-  writer->AppendInt(static_cast<uint8_t>(
-      // All flags except PCR_flag are 0.
-      static_cast<uint8_t>(has_pcr) << 4));
-  remaining_bytes -= 1;
+  output[0] = static_cast<uint8_t>(adaptation_field_length);
+  // All flags except PCR_flag are 0.
+  output[1] = static_cast<uint8_t>(has_pcr) << 4;
+  size_t bytes_written =
+      kAdaptationFieldLengthSize + kAdaptationFieldHeaderSize;
 
   if (has_pcr) {
     // program_clock_reference_extension = 0.
@@ -91,16 +74,34 @@ void WriteAdaptationField(bool has_pcr,
         static_cast<uint32_t>(pcr_base >> 1);
     const uint16_t pcr_last_bit_reserved_and_pcr_extension =
         ((pcr_base & 1) << 15) | 0x7e00;  // Set the 6 reserved bits to '1'
-    writer->AppendInt(most_significant_32bits_pcr);
-    writer->AppendInt(pcr_last_bit_reserved_and_pcr_extension);
-    remaining_bytes -= kPcrFieldsSize;
+    absl::big_endian::Store32(output + bytes_written,
+                              most_significant_32bits_pcr);
+    absl::big_endian::Store16(output + bytes_written + 4,
+                              pcr_last_bit_reserved_and_pcr_extension);
+    bytes_written += kPcrFieldsSize;
   }
-  DCHECK_GE(remaining_bytes, 0);
-  if (remaining_bytes == 0)
-    return;
 
-  DCHECK_GE(static_cast<int>(std::size(kPaddingBytes)), remaining_bytes);
-  writer->AppendArray(kPaddingBytes, remaining_bytes);
+  const size_t adaptation_field_size =
+      kAdaptationFieldLengthSize + adaptation_field_length;
+  DCHECK_GE(adaptation_field_size, bytes_written);
+  memset(output + bytes_written, kPaddingByte,
+         adaptation_field_size - bytes_written);
+  return adaptation_field_size;
+}
+
+// Returns the number of TS packets carrying a payload of |payload_size| bytes.
+// An empty payload still takes a packet.
+size_t NumTsPackets(size_t payload_size, bool has_pcr) {
+  // The PCR only goes in the first packet.
+  const size_t first_packet_payload_size =
+      has_pcr ? kTsPacketMaximumPayloadSize - kAdaptationFieldLengthSize -
+                    kAdaptationFieldHeaderSize - kPcrFieldsSize
+              : kTsPacketMaximumPayloadSize;
+  if (payload_size <= first_packet_payload_size)
+    return 1;
+  return 1 + (payload_size - first_packet_payload_size +
+              kTsPacketMaximumPayloadSize - 1) /
+                 kTsPacketMaximumPayloadSize;
 }
 
 }  // namespace
@@ -113,44 +114,52 @@ void WritePayloadToBufferWriter(const uint8_t* payload,
                                 uint64_t pcr_base,
                                 ContinuityCounter* continuity_counter,
                                 BufferWriter* writer) {
+  // The header shared by the packets, to which the flags and the
+  // continuity_counter of each packet are added.
+  // transport_error_indicator and transport_priority are both '0'.
+  const uint8_t header[kTsPacketHeaderSize] = {
+      kSyncByte, static_cast<uint8_t>(pid >> 8), static_cast<uint8_t>(pid), 0};
+  const uint8_t kPayloadUnitStartIndicatorBit = 0x40;
+
+  // The packets are written in place, in a buffer sized once for all of them.
+  const size_t num_packets = NumTsPackets(payload_size, has_pcr);
+  uint8_t* packet = writer->Extend(num_packets * kTsPacketSize);
   size_t payload_bytes_written = 0;
 
-  do {
+  for (size_t i = 0; i < num_packets; ++i, packet += kTsPacketSize) {
     const bool must_write_adaptation_header = has_pcr;
     const size_t bytes_left = payload_size - payload_bytes_written;
     const bool has_adaptation_field = must_write_adaptation_header ||
                                       bytes_left < kTsPacketMaximumPayloadSize;
 
-    writer->AppendInt(kSyncByte);
-    writer->AppendInt(static_cast<uint16_t>(
-        // transport_error_indicator and transport_priority are both '0'.
-        static_cast<int>(payload_unit_start_indicator) << 14 | pid));
-
+    memcpy(packet, header, kTsPacketHeaderSize);
+    if (payload_unit_start_indicator)
+      packet[1] |= kPayloadUnitStartIndicatorBit;
     const uint8_t adaptation_field_control =
         ((has_adaptation_field ? 1 : 0) << 1) | ((bytes_left != 0) ? 1 : 0);
     // transport_scrambling_control is '00'.
-    writer->AppendInt(static_cast<uint8_t>(adaptation_field_control << 4 |
-                                           continuity_counter->GetNext()));
+    packet[3] = static_cast<uint8_t>(adaptation_field_control << 4 |
+                                     continuity_counter->GetNext());
 
+    size_t bytes_for_headers = kTsPacketHeaderSize;
     if (has_adaptation_field) {
-      const size_t before = writer->Size();
-      WriteAdaptationField(has_pcr, pcr_base, bytes_left, writer);
-      const size_t bytes_for_adaptation_field = writer->Size() - before;
-
-      const size_t write_bytes =
-          kTsPacketMaximumPayloadSize - bytes_for_adaptation_field;
-      writer->AppendArray(payload + payload_bytes_written, write_bytes);
-      payload_bytes_written += write_bytes;
-    } else {
-      writer->AppendArray(payload + payload_bytes_written,
-                          kTsPacketMaximumPayloadSize);
-      payload_bytes_written += kTsPacketMaximumPayloadSize;
+      bytes_for_headers += WriteAdaptationField(has_pcr, pcr_base, bytes_left,
+                                                packet + kTsPacketHeaderSize);
     }
 
+    const size_t write_bytes = kTsPacketSize - bytes_for_headers;
+    DCHECK_LE(write_bytes, bytes_left);
+    if (write_bytes > 0) {
+      memcpy(packet + bytes_for_headers, payload + payload_bytes_written,
+             write_bytes);
+    }
+    payload_bytes_written += write_bytes;
+
     // Once written, not needed for this payload.
     has_pcr = false;
     payload_unit_start_indicator = false;
-  } while (payload_bytes_written < payload_size);
+  }
+  DCHECK_EQ(payload_bytes_written, payload_size);
 }
 
 }  // namespace mp2t
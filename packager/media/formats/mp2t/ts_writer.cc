@@ -104,7 +104,7 @@ bool WritePesToBuffer(const PesPacket& pes,
   const int pid = ProgramMapTableWriter::kElementaryPid;
 
   // This writer will hold part of PES packet after PES_packet_length field.
-  BufferWriter pes_header_writer;
+  BufferWriter pes_header_writer(kTsPacketSize);
   // The first bit must be '10' for PES with video or audio stream id. The other
   // flags (bits) don't matter so they are 0.
   pes_header_writer.AppendInt(static_cast<uint8_t>(0x80));
@@ -142,21 +142,19 @@ bool WritePesToBuffer(const PesPacket& pes,
   const size_t bytes_consumed = std::min(pes.data().size(), available_payload);
   first_ts_packet_buffer.AppendArray(pes.data().data(), bytes_consumed);
 
-  BufferWriter output_writer;
+  // The TS packets are written straight to the segment buffer.
   WritePayloadToBufferWriter(first_ts_packet_buffer.Buffer(),
                              first_ts_packet_buffer.Size(),
                              kPayloadUnitStartIndicator, pid, kHasPcr, pcr_base,
-                             continuity_counter, &output_writer);
+                             continuity_counter, current_buffer);
 
   const size_t remaining_pes_data_size = pes.data().size() - bytes_consumed;
   if (remaining_pes_data_size > 0) {
     WritePayloadToBufferWriter(pes.data().data() + bytes_consumed,
                                remaining_pes_data_size,
                                !kPayloadUnitStartIndicator, pid, !kHasPcr, 0,
-                               continuity_counter, &output_writer);
+                               continuity_counter, current_buffer);
   }
-
-  current_buffer->AppendBuffer(output_writer);
   return true;
 }
 
@@ -19,7 +19,7 @@
 namespace shaka {
 namespace media {
 
-class BufferWriter;
+class BufferChain;
 class MediaSample;
 class StreamInfo;
 
@@ -69,7 +69,8 @@ class Fragmenter {
   }
   bool fragment_initialized() const { return fragment_initialized_; }
   bool fragment_finalized() const { return fragment_finalized_; }
-  BufferWriter* data() { return data_.get(); }
+  /// @return The sample data of the fragment, referenced from the samples.
+  const BufferChain* data() const { return data_.get(); }
   const std::vector<KeyFrameInfo>& key_frame_infos() const {
     return key_frame_infos_;
   }
@@ -97,7 +98,7 @@ class Fragmenter {
   int64_t fragment_duration_ = 0;
   int64_t earliest_presentation_time_ = 0;
   int64_t first_sap_time_ = 0;
-  std::unique_ptr<BufferWriter> data_;
+  std::unique_ptr<BufferChain> data_;
   // Saves key frames information, for Video.
   std::vector<KeyFrameInfo> key_frame_infos_;
 
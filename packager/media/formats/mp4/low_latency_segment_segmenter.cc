@@ -14,6 +14,7 @@
 #include <packager/file/file_closer.h>
 #include <packager/macros/logging.h>
 #include <packager/macros/status.h>
+#include <packager/media/base/buffer_chain.h>
 #include <packager/media/base/buffer_writer.h>
 #include <packager/media/base/media_handler.h>
 #include <packager/media/base/muxer_options.h>
@@ -22,6 +22,7 @@
 #include <packager/media/base/key_source.h>
 #include <packager/media/base/media_sample.h>
 #include <packager/media/base/rcheck.h>
+#include <packager/media/base/sample_pool.h>
 #include <packager/media/base/video_stream_info.h>
 #include <packager/media/base/video_util.h>
 #include <packager/media/codecs/ac3_audio_util.h>
@@ -308,7 +309,97 @@ bool MP4MediaParser::Parse(const uint8_t* buf, int size) {
     return false;
 
   queue_.Push(buf, size);
+  return ParseQueue();
+}
+
+bool MP4MediaParser::ParseMapped(std::shared_ptr<const void> owner,
+                                 const uint8_t* buf,
+                                 int size) {
+  DCHECK_NE(state_, kWaitingForInit);
+
+  if (state_ == kError)
+    return false;
+
+  if (owner != mapped_data_owner_ || buf != mapped_data_end_) {
+    mapped_data_owner_ = std::move(owner);
+    mapped_data_begin_ = buf;
+  }
+  mapped_data_end_ = buf + size;
+  queue_.PushView(buf, size);
+  return ParseQueue();
+}
+
+bool MP4MediaParser::GetSampleTimings(
+    std::map<uint32_t, std::vector<SampleTiming>>* timings) {
+  DCHECK(timings);
+  // Fragmented files list their samples in the fragments.
+  if (!moov_ || !moov_->extends.tracks.empty())
+    return false;
+
+  TrackRunIterator runs(moov_.get());
+  RCHECK(runs.Init());
+  timings->clear();
+  for (; runs.IsRunValid(); runs.AdvanceRun()) {
+    if (!runs.is_audio() && !runs.is_video())
+      continue;
+    std::vector<SampleTiming>& samples = (*timings)[runs.track_id()];
+    for (; runs.IsSampleValid(); runs.AdvanceSample()) {
+      SampleTiming timing;
+      timing.dts = runs.dts();
+      timing.pts = runs.cts();
+      timing.duration = runs.duration();
+      timing.is_key_frame = runs.is_keyframe();
+      samples.push_back(timing);
+    }
+  }
+  return true;
+}
+
+bool MP4MediaParser::SetSampleRanges(
+    const std::map<uint32_t, SampleRange>& ranges) {
+  DCHECK(!runs_);
+  has_sample_ranges_ = true;
+  sample_ranges_ = ranges;
+  return true;
+}
+
+bool MP4MediaParser::SeekToSampleRanges(int64_t* offset) {
+  DCHECK(offset);
+  // Only the sample tables in the 'moov' box index the whole input.
+  if (!has_sample_ranges_ || state_ != kEmittingSamples || !runs_ ||
+      !moov_->extends.tracks.empty()) {
+    return false;
+  }
 
+  // The samples are iterated in the order of their data, so the samples up to
+  // the first one in the ranges can be skipped without reading their data.
+  while (runs_->IsRunValid()) {
+    if (!runs_->IsSampleValid()) {
+      runs_->AdvanceRun();
+      continue;
+    }
+    if (IsInSampleRange(runs_->track_id()))
+      break;
+    AdvanceSample();
+  }
+
+  const int64_t next_offset = runs_->GetMaxClearOffset() + moof_head_;
+  if (!ReadAndDiscardMDATsUntil(next_offset))
+    return false;
+  // Skip ahead only within the 'mdat' box framed so far, and only if the data
+  // has not been read already.
+  if (!runs_->IsRunValid() || next_offset <= queue_.tail() ||
+      mdat_tail_ <= next_offset) {
+    return false;
+  }
+  DVLOG(1) << "Skipping to offset " << next_offset << " from "
+           << queue_.tail();
+  queue_.ResetTo(next_offset);
+  *offset = next_offset;
+  return true;
+}
+
+bool MP4MediaParser::ParseQueue() {
   bool result, err = false;
 
   do {
@@ -970,6 +1061,12 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
     return true;
   }
 
+  // Skip the samples outside of the sample ranges before reading them.
+  if (!IsInSampleRange(runs_->track_id())) {
+    AdvanceSample();
+    return true;
+  }
+
   DCHECK(!(*err));
 
   const uint8_t* buf;
@@ -1017,8 +1114,8 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
       MediaSample::CopyFrom(media_data, kDummyDataSize, runs_->is_keyframe()));
 
   if (runs_->is_encrypted()) {
-    std::shared_ptr<uint8_t> decrypted_media_data(
-        new uint8_t[media_data_size], std::default_delete<uint8_t[]>());
+    std::shared_ptr<uint8_t> decrypted_media_data =
+        SamplePool::AllocateBuffer(media_data_size);
     std::unique_ptr<DecryptConfig> decrypt_config = runs_->GetDecryptConfig();
     if (!decrypt_config) {
       *err = true;
@@ -1043,6 +1140,12 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
       stream_sample->TransferData(std::move(decrypted_media_data),
                                   media_data_size);
     }
+  } else if (mapped_data_owner_ && media_data >= mapped_data_begin_ &&
+             media_data + media_data_size <= mapped_data_end_) {
+    // Reference the sample in the mapped input instead of copying it.
+    stream_sample->ShareData(
+        std::shared_ptr<const uint8_t>(mapped_data_owner_, media_data),
+        media_data_size);
   } else {
     stream_sample->SetData(media_data, media_data_size);
   }
@@ -1062,10 +1165,29 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
     return false;
   }
 
-  runs_->AdvanceSample();
+  AdvanceSample();
   return true;
 }
 
+bool MP4MediaParser::IsInSampleRange(uint32_t track_id) const {
+  if (!has_sample_ranges_)
+    return true;
+  auto range_iter = sample_ranges_.find(track_id);
+  if (range_iter == sample_ranges_.end())
+    return false;
+  auto count_iter = sample_counts_.find(track_id);
+  const uint64_t sample_index =
+      count_iter == sample_counts_.end() ? 0 : count_iter->second;
+  return sample_index >= range_iter->second.begin &&
+         sample_index < range_iter->second.end;
+}
+
+void MP4MediaParser::AdvanceSample() {
+  if (has_sample_ranges_)
+    ++sample_counts_[runs_->track_id()];
+  runs_->AdvanceSample();
+}
+
 bool MP4MediaParser::ReadAndDiscardMDATsUntil(const int64_t offset) {
   bool err = false;
   while (mdat_tail_ < offset) {
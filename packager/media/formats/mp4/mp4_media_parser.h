@@ -44,6 +44,13 @@ class MP4MediaParser : public MediaParser {
             KeySource* decryption_key_source) override;
   [[nodiscard]] bool Flush() override;
   [[nodiscard]] bool Parse(const uint8_t* buf, int size) override;
+  [[nodiscard]] bool ParseMapped(std::shared_ptr<const void> owner,
+                                 const uint8_t* buf,
+                                 int size) override;
+  bool GetSampleTimings(
+      std::map<uint32_t, std::vector<SampleTiming>>* timings) override;
+  bool SetSampleRanges(const std::map<uint32_t, SampleRange>& ranges) override;
+  bool SeekToSampleRanges(int64_t* offset) override;
   /// @}
 
   /// Handles ISO-BMFF containers which have the 'moov' box trailing the
@@ -57,6 +64,8 @@ class MP4MediaParser : public MediaParser {
  private:
   enum State { kWaitingForInit, kParsingBoxes, kEmittingSamples, kError };
 
+  // Parses the data in |queue_|.
+  bool ParseQueue();
   bool ParseBox(bool* err);
   bool ParseMoov(mp4::BoxReader* reader);
   bool ParseMoof(mp4::BoxReader* reader);
@@ -78,6 +87,13 @@ class MP4MediaParser : public MediaParser {
 
   bool EnqueueSample(bool* err);
 
+  // @return true if the next sample of track |track_id| is to be emitted,
+  //         i.e. it is in the sample range of the track, if there are sample
+  //         ranges.
+  bool IsInSampleRange(uint32_t track_id) const;
+  // Count the current sample of |runs_| and advance to the next one.
+  void AdvanceSample();
+
   void Reset();
 
   State state_;
@@ -87,6 +103,11 @@ class MP4MediaParser : public MediaParser {
   std::unique_ptr<DecryptorSource> decryptor_source_;
 
   OffsetByteQueue queue_;
+  // The range of the input passed to ParseMapped() so far, which the samples
+  // reference instead of copying it.
+  std::shared_ptr<const void> mapped_data_owner_;
+  const uint8_t* mapped_data_begin_ = nullptr;
+  const uint8_t* mapped_data_end_ = nullptr;
 
   // These two parameters are only valid in the |kEmittingSegments| state.
   //
@@ -101,6 +122,13 @@ class MP4MediaParser : public MediaParser {
   std::unique_ptr<Movie> moov_;
   std::unique_ptr<TrackRunIterator> runs_;
 
+  // Whether only |sample_ranges_| are emitted.
+  bool has_sample_ranges_ = false;
+  // TrackId -> SampleRange map.
+  std::map<uint32_t, SampleRange> sample_ranges_;
+  // TrackId -> number of samples enqueued or skipped map.
+  std::map<uint32_t, uint64_t> sample_counts_;
+
   DISALLOW_COPY_AND_ASSIGN(MP4MediaParser);
 };
 
@@ -253,6 +253,36 @@ TEST_F(MP4MediaParserTest, NON_FRAGMENTED_MP4) {
   EXPECT_EQ(201u, num_samples_);
 }
 
+TEST_F(MP4MediaParserTest, SeekToSampleRanges) {
+  InitializeParser(NULL);
+  // Only the second GOP of the video, and none of the audio.
+  const uint32_t kVideoTrackId = 1;
+  const uint32_t kAudioTrackId = 2;
+  ASSERT_TRUE(parser_->SetSampleRanges(
+      {{kVideoTrackId, {30, 60}}, {kAudioTrackId, {0, 0}}}));
+
+  std::vector<uint8_t> buffer = ReadTestDataFile("bear-640x360.mp4");
+  ASSERT_FALSE(buffer.empty());
+  const size_t kPieceSize = 512;
+  size_t position = 0;
+  int64_t offset = 0;
+  bool seeked = false;
+  while (!seeked && position < buffer.size()) {
+    const size_t size = std::min(kPieceSize, buffer.size() - position);
+    ASSERT_TRUE(AppendData(buffer.data() + position, size));
+    position += size;
+    seeked = num_streams_ > 0 && parser_->SeekToSampleRanges(&offset);
+  }
+  ASSERT_TRUE(seeked);
+  // The data of the first GOP is skipped.
+  EXPECT_GT(offset, static_cast<int64_t>(position));
+  EXPECT_EQ(0u, num_samples_);
+
+  EXPECT_TRUE(AppendDataInPieces(buffer.data() + offset,
+                                 buffer.size() - offset, kPieceSize));
+  EXPECT_EQ(30u, num_samples_);
+}
+
 TEST_F(MP4MediaParserTest, CencWithoutDecryptionSource) {
   ASSERT_TRUE(ParseMP4File("bear-640x360-v_frag-cenc-aux.mp4", 512));
   EXPECT_EQ(1u, num_streams_);
@@ -196,7 +196,13 @@ Status MP4Muxer::Finalize() {
 
 Status MP4Muxer::AddMediaSample(size_t stream_id, const MediaSample& sample) {
   if (to_be_initialized_) {
-    RETURN_IF_ERROR(UpdateEditListOffsetFromSample(sample));
+    // A partition of the output has the edit list of the whole output.
+    const std::optional<MuxerOptions::Partition>& partition =
+        options().partition;
+    RETURN_IF_ERROR(
+        partition
+            ? UpdateEditListOffset(partition->first_pts, partition->first_dts)
+            : UpdateEditListOffset(sample.pts(), sample.dts()));
     RETURN_IF_ERROR(DelayInitializeMuxer());
     to_be_initialized_ = false;
   }
@@ -307,7 +313,7 @@ Status MP4Muxer::DelayInitializeMuxer() {
     if (!generate_trak_result)
       return Status(error::MUXER_FAILURE, "Failed to generate trak.");
 
-    // Generate EditList if needed. See UpdateEditListOffsetFromSample() for
+    // Generate EditList if needed. See UpdateEditListOffset() for
     // more information.
     if (edit_list_offset_.value() > 0) {
       EditListEntry entry;
@@ -349,12 +355,10 @@ Status MP4Muxer::DelayInitializeMuxer() {
   return Status::OK;
 }
 
-Status MP4Muxer::UpdateEditListOffsetFromSample(const MediaSample& sample) {
+Status MP4Muxer::UpdateEditListOffset(int64_t pts, int64_t dts) {
   if (edit_list_offset_)
     return Status::OK;
 
-  const int64_t pts = sample.pts();
-  const int64_t dts = sample.dts();
   // An EditList entry is inserted if one of the below conditions occur [4]:
   // (1) pts > dts for the first sample. Due to Chrome's dts bug [1], dts is
   //     used in buffered range API, while pts is used elsewhere (players,
@@ -406,7 +410,7 @@ Status MP4Muxer::UpdateEditListOffsetFromSample(const MediaSample& sample) {
                << dts << ").";
     return Status(error::MUXER_FAILURE, "Not expecting pts < dts.");
   }
-  edit_list_offset_ = std::max(-sample.pts(), static_cast<int64_t>(0));
+  edit_list_offset_ = std::max(-pts, static_cast<int64_t>(0));
   return Status::OK;
 }
 
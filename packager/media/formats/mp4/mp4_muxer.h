@@ -46,7 +46,8 @@ class MP4Muxer : public Muxer {
                          const SegmentInfo& segment_info) override;
 
   Status DelayInitializeMuxer();
-  Status UpdateEditListOffsetFromSample(const MediaSample& sample);
+  // Update the edit list offset from the timestamps of the first sample.
+  Status UpdateEditListOffset(int64_t pts, int64_t dts);
 
   // Generate Audio/Video Track box.
   void InitializeTrak(const StreamInfo* info, Track* trak);
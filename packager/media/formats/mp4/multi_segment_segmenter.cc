@@ -16,6 +16,7 @@
 #include <packager/file/file_closer.h>
 #include <packager/macros/logging.h>
 #include <packager/macros/status.h>
+#include <packager/media/base/buffer_chain.h>
 #include <packager/media/base/buffer_writer.h>
 #include <packager/media/base/muxer_options.h>
 #include <packager/media/base/muxer_util.h>
@@ -59,16 +60,24 @@ std::vector<Range> MultiSegmentSegmenter::GetSegmentRanges() {
 }
 
 Status MultiSegmentSegmenter::DoInitialize() {
+  if (!WritesInitSegment())
+    return Status::OK;
   return WriteInitSegment();
 }
 
 Status MultiSegmentSegmenter::DoFinalize() {
   // Update init segment with media duration set.
-  RETURN_IF_ERROR(WriteInitSegment());
+  if (WritesInitSegment())
+    RETURN_IF_ERROR(WriteInitSegment());
   SetComplete();
   return Status::OK;
 }
 
+bool MultiSegmentSegmenter::WritesInitSegment() const {
+  // Only the first partition of a partitioned output writes it.
+  return !options().partition || options().partition->is_first;
+}
+
 Status MultiSegmentSegmenter::DoFinalizeSegment(int64_t segment_number) {
   return WriteSegment(segment_number);
 }
@@ -130,7 +139,12 @@ Status MultiSegmentSegmenter::WriteSegment(int64_t segment_number) {
   const size_t segment_size = segment_header_size + fragment_buffer()->Size();
   DCHECK_NE(segment_size, 0u);
 
-  RETURN_IF_ERROR(buffer->WriteToFile(file.get()));
+  // Write the segment header and the fragments with a single vectored write.
+  BufferChain segment;
+  segment.TakeBuffer(buffer.get());
+  segment.AppendChain(*fragment_buffer());
+  fragment_buffer()->Clear();
+  RETURN_IF_ERROR(segment.WriteToFile(file.get()));
   if (muxer_listener()) {
     for (const KeyFrameInfo& key_frame_info : key_frame_infos()) {
       muxer_listener()->OnKeyFrame(
@@ -139,7 +153,6 @@ Status MultiSegmentSegmenter::WriteSegment(int64_t segment_number) {
           key_frame_info.size);
     }
   }
-  RETURN_IF_ERROR(fragment_buffer()->WriteToFile(file.get()));
 
   // Close the file, which also does flushing, to make sure the file is written
   // before manifest is updated.
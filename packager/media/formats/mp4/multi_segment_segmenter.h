@@ -41,6 +41,10 @@ class MultiSegmentSegmenter : public Segmenter {
   Status DoFinalize() override;
   Status DoFinalizeSegment(int64_t segment_number) override;
 
+  // @return false if this writes a partition of the output, other than the
+  //         first one.
+  bool WritesInitSegment() const;
+
   // Write segment to file.
   Status WriteInitSegment();
   Status WriteSegment(int64_t segment_number);
@@ -11,6 +11,7 @@
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
+#include <packager/media/base/buffer_chain.h>
 #include <packager/media/base/buffer_writer.h>
 #include <packager/media/base/id3_tag.h>
 #include <packager/media/base/media_sample.h>
@@ -45,7 +46,7 @@ Segmenter::Segmenter(const MuxerOptions& options,
       ftyp_(std::move(ftyp)),
       moov_(std::move(moov)),
       moof_(new MovieFragment()),
-      fragment_buffer_(new BufferWriter()),
+      fragment_buffer_(new BufferChain()),
       sidx_(new SegmentIndex()) {}
 
 Segmenter::~Segmenter() {}
@@ -92,7 +93,9 @@ Status Segmenter::Initialize(
 
   // Use the reference stream's time scale as movie time scale.
   moov_->header.timescale = sidx_->timescale;
-  moof_->header.sequence_number = 1;
+  moof_->header.sequence_number =
+      options_.partition ? options_.partition->first_fragment_sequence_number
+                         : 1;
 
   // Fill in version information.
   const std::string version = GetPackagerVersion();
@@ -113,8 +116,12 @@ Status Segmenter::Finalize() {
   // file for VOD and static live case only.
   moov_->extends.header.fragment_duration = 0;
   for (size_t i = 0; i < stream_durations_.size(); ++i) {
+    // A partition of the output only has the samples of the partition.
+    const int64_t stream_duration = options_.partition
+                                        ? options_.partition->duration
+                                        : stream_durations_[i];
     int64_t duration =
-        Rescale(stream_durations_[i], moov_->tracks[i].media.header.timescale,
+        Rescale(stream_duration, moov_->tracks[i].media.header.timescale,
                 moov_->header.timescale);
     if (duration >
         static_cast<int64_t>(moov_->extends.header.fragment_duration))
@@ -205,9 +212,12 @@ Status Segmenter::FinalizeSegment(size_t stream_id,
 
   const uint64_t moof_start_offset = fragment_buffer_->Size();
 
-  // Write the fragment to buffer.
-  moof_->Write(fragment_buffer_.get());
-  mdat.WriteHeader(fragment_buffer_.get());
+  // Write the fragment to buffer. Only the box headers are copied; the sample
+  // data is referenced.
+  BufferWriter fragment_header(data_offset);
+  moof_->Write(&fragment_header);
+  mdat.WriteHeader(&fragment_header);
+  fragment_buffer_->TakeBuffer(&fragment_header);
 
   bool first_key_frame = true;
   for (const std::unique_ptr<Fragmenter>& fragmenter : fragmenters_) {
@@ -223,7 +233,7 @@ Status Segmenter::FinalizeSegment(size_t stream_id,
           {key_frame_info.timestamp, moof_start_offset,
            fragment_buffer_->Size() - moof_start_offset + key_frame_info.size});
     }
-    fragment_buffer_->AppendBuffer(*fragmenter->data());
+    fragment_buffer_->AppendChain(*fragmenter->data());
   }
 
   // Increase sequence_number for next fragment.
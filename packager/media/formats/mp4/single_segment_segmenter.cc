@@ -7,10 +7,16 @@
 #include <packager/media/formats/mp4/single_segment_segmenter.h>
 
 #include <algorithm>
+#include <filesystem>
+#include <limits>
 
 #include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/strings/strip.h>
 
 #include <packager/file/file_util.h>
+#include <packager/macros/status.h>
+#include <packager/media/base/buffer_chain.h>
 #include <packager/media/base/buffer_writer.h>
 #include <packager/media/base/muxer_options.h>
 #include <packager/media/event/progress_listener.h>
@@ -19,6 +25,32 @@
 namespace shaka {
 namespace media {
 namespace mp4 {
+namespace {
+
+// In single pass mode the sidx box is sized for subsegments of at least this
+// duration, plus a few extra references. The stream duration is not always
+// known up front, in which case a default number of references is reserved.
+// Either way the output is rewritten if the estimate turns out too small.
+const double kMinExpectedSubsegmentDurationInSeconds = 1.0;
+const uint64_t kExtraReservedReferences = 64;
+const uint64_t kDefaultReservedReferences = 4096;
+// Size of a version 1 sidx box without the references, and of a reference.
+const uint64_t kMaxSegmentIndexHeaderSize = 40;
+const uint64_t kSegmentReferenceSize = 12;
+// Room for the mehd box, which is only filled in at the end, with some slack.
+const uint64_t kReservedMoovSlack = 64;
+// A 'free' box needs at least its size and type.
+const uint64_t kFreeBoxHeaderSize = 8;
+
+void WriteFreeBox(uint64_t size, BufferWriter* buffer) {
+  DCHECK_GE(size, kFreeBoxHeaderSize);
+  DCHECK_LE(size, std::numeric_limits<uint32_t>::max());
+  buffer->AppendInt(static_cast<uint32_t>(size));
+  buffer->AppendInt(static_cast<uint32_t>(FOURCC_free));
+  buffer->AppendVector(std::vector<uint8_t>(size - kFreeBoxHeaderSize));
+}
+
+}  // namespace
 
 SingleSegmentSegmenter::SingleSegmentSegmenter(const MuxerOptions& options,
                                                std::unique_ptr<FileType> ftyp,
@@ -26,6 +58,8 @@ SingleSegmentSegmenter::SingleSegmentSegmenter(const MuxerOptions& options,
     : Segmenter(options, std::move(ftyp), std::move(moov)) {}
 
 SingleSegmentSegmenter::~SingleSegmentSegmenter() {
+  if (output_file_)
+    output_file_.release()->Close();
   if (temp_file_)
     temp_file_.release()->Close();
   if (!temp_file_name_.empty()) {
@@ -70,6 +104,12 @@ std::vector<Range> SingleSegmentSegmenter::GetSegmentRanges() {
 }
 
 Status SingleSegmentSegmenter::DoInitialize() {
+  if (options().mp4_params.single_pass_on_demand) {
+    RETURN_IF_ERROR(InitializeSinglePass());
+    if (output_file_)
+      return Status::OK;
+  }
+
   // Single segment segmentation involves two stages:
   //   Stage 1: Create media subsegments from media samples
   //   Stage 2: Update media header (moov) which involves copying of media
@@ -87,6 +127,9 @@ Status SingleSegmentSegmenter::DoInitialize() {
 }
 
 Status SingleSegmentSegmenter::DoFinalize() {
+  if (output_file_)
+    return FinalizeSinglePass();
+
   DCHECK(temp_file_);
   DCHECK(ftyp());
   DCHECK(moov());
@@ -112,11 +155,7 @@ Status SingleSegmentSegmenter::DoFinalize() {
 
   // Write ftyp, moov and sidx to output file.
   std::unique_ptr<BufferWriter> buffer(new BufferWriter());
-  ftyp()->Write(buffer.get());
-  moov()->Write(buffer.get());
-
-  if (options().mp4_params.generate_sidx_in_media_segments)
-    vod_sidx_->Write(buffer.get());
+  WriteHeader(buffer.get());
 
   Status status = buffer->WriteToFile(file.get());
   if (!status.ok())
@@ -215,9 +254,11 @@ Status SingleSegmentSegmenter::DoFinalizeSegment(int64_t segment_number) {
                                    key_frame_info.size);
     }
   }
-  // Append fragment buffer to temp file.
+  // Append fragment buffer to the output file in single pass mode, or to the
+  // temp file otherwise.
   size_t segment_size = fragment_buffer()->Size();
-  Status status = fragment_buffer()->WriteToFile(temp_file_.get());
+  Status status = fragment_buffer()->WriteToFile(
+      output_file_ ? output_file_.get() : temp_file_.get());
   if (!status.ok())
     return status;
 
@@ -231,6 +272,161 @@ Status SingleSegmentSegmenter::DoFinalizeSegment(int64_t segment_number) {
   return Status::OK;
 }
 
+Status SingleSegmentSegmenter::InitializeSinglePass() {
+  const std::string& file_name = options().output_file_name;
+  // The header is patched in place and a fallback may need to replace the
+  // file, which needs a seekable file with a path. This is decided from the
+  // name, as opening any other output would truncate or upload it.
+  if (!File::IsLocalRegularFileName(file_name.c_str())) {
+    LOG(WARNING) << "Single pass output is only supported for local files, "
+                    "writing '"
+                 << file_name << "' through a temporary file.";
+    return Status::OK;
+  }
+  output_file_.reset(File::Open(file_name.c_str(), "w"));
+  if (!output_file_)
+    return Status(error::FILE_FAILURE, "Cannot open file to write " + file_name);
+
+  uint64_t num_references = kDefaultReservedReferences;
+  if (progress_target() > 0 && sidx()->timescale > 0) {
+    const double duration_in_seconds =
+        static_cast<double>(progress_target()) / sidx()->timescale;
+    num_references = static_cast<uint64_t>(
+                         duration_in_seconds /
+                         kMinExpectedSubsegmentDurationInSeconds) +
+                     kExtraReservedReferences;
+  }
+  num_references = std::min<uint64_t>(num_references,
+                                      std::numeric_limits<uint16_t>::max());
+
+  reserved_header_size_ =
+      ftyp()->ComputeSize() + moov()->ComputeSize() + kReservedMoovSlack;
+  if (options().mp4_params.generate_sidx_in_media_segments) {
+    reserved_header_size_ +=
+        kMaxSegmentIndexHeaderSize + kSegmentReferenceSize * num_references;
+  }
+
+  // Fill the reserved space with a 'free' box so the file stays parseable
+  // until the header is in place.
+  BufferWriter buffer;
+  WriteFreeBox(reserved_header_size_, &buffer);
+  return buffer.WriteToFile(output_file_.get());
+}
+
+void SingleSegmentSegmenter::WriteHeader(BufferWriter* buffer) {
+  ftyp()->Write(buffer);
+  moov()->Write(buffer);
+
+  if (options().mp4_params.generate_sidx_in_media_segments)
+    vod_sidx_->Write(buffer);
+}
+
+Status SingleSegmentSegmenter::FinalizeSinglePass() {
+  DCHECK(output_file_);
+  DCHECK(ftyp());
+  DCHECK(moov());
+  DCHECK(vod_sidx_);
+
+  // The media starts right after the reserved space, so whatever the header
+  // does not use is covered by a 'free' box, which sidx.first_offset skips.
+  vod_sidx_->first_offset = 0;
+  size_t init_range_offset = 0;
+  size_t init_range_size = 0;
+  size_t index_range_offset = 0;
+  size_t index_range_size = 0;
+  GetInitRange(&init_range_offset, &init_range_size);
+  GetIndexRange(&index_range_offset, &index_range_size);
+  const uint64_t header_size = init_range_size + index_range_size;
+  if (header_size > reserved_header_size_ ||
+      (header_size < reserved_header_size_ &&
+       header_size + kFreeBoxHeaderSize > reserved_header_size_)) {
+    return RewriteWithHeader();
+  }
+  const uint64_t free_size = reserved_header_size_ - header_size;
+  vod_sidx_->first_offset = free_size;
+
+  BufferWriter buffer;
+  WriteHeader(&buffer);
+  if (free_size > 0)
+    WriteFreeBox(free_size, &buffer);
+  DCHECK_EQ(buffer.Size(), reserved_header_size_);
+
+  const std::string& file_name = options().output_file_name;
+  if (!output_file_->Seek(0))
+    return Status(error::FILE_FAILURE, "Cannot seek in file " + file_name);
+  RETURN_IF_ERROR(buffer.WriteToFile(output_file_.get()));
+  if (!output_file_.release()->Close()) {
+    return Status(
+        error::FILE_FAILURE,
+        "Cannot close file " + file_name +
+            ", possibly file permission issue or running out of disk space.");
+  }
+  VLOG(1) << "Updated media header (moov) in place in '" << file_name
+          << "', " << free_size << " bytes of reserved space unused.";
+  SetComplete();
+  return Status::OK;
+}
+
+Status SingleSegmentSegmenter::RewriteWithHeader() {
+  const std::string& file_name = options().output_file_name;
+  if (!output_file_.release()->Close()) {
+    return Status(
+        error::FILE_FAILURE,
+        "Cannot close file " + file_name +
+            ", possibly file permission issue or running out of disk space.");
+  }
+
+  LOG(INFO) << "Reserved space for the media header in '" << file_name
+            << "' was too small, rewriting the file.";
+
+  // Create the new file next to the output so it can be renamed over it.
+  std::string new_file_name;
+  const std::filesystem::path output_path =
+      std::filesystem::u8path(std::string(absl::StripPrefix(file_name, "file://")));
+  const std::string output_dir = output_path.has_parent_path()
+                                     ? output_path.parent_path().string()
+                                     : std::string(".");
+  if (!TempFilePath(output_dir, &new_file_name))
+    return Status(error::FILE_FAILURE, "Unable to create temporary file.");
+
+  std::unique_ptr<File, FileCloser> new_file(
+      File::Open(new_file_name.c_str(), "w"));
+  if (!new_file) {
+    return Status(error::FILE_FAILURE,
+                  "Cannot open file to write " + new_file_name);
+  }
+  BufferWriter buffer;
+  WriteHeader(&buffer);
+  Status status = buffer.WriteToFile(new_file.get());
+  if (!new_file.release()->Close() && status.ok()) {
+    status = Status(error::FILE_FAILURE,
+                    "Cannot close the temp file " + new_file_name);
+  }
+  if (status.ok() &&
+      !AppendFileRange(file_name, reserved_header_size_, new_file_name)) {
+    status = Status(error::FILE_FAILURE,
+                    "Failed to copy media from " + file_name + " to " +
+                        new_file_name);
+  }
+  if (status.ok()) {
+    std::error_code ec;
+    std::filesystem::rename(std::filesystem::u8path(new_file_name),
+                            output_path, ec);
+    if (ec) {
+      status = Status(error::FILE_FAILURE, "Cannot rename " + new_file_name +
+                                               " to " + file_name + ": " +
+                                               ec.message());
+    }
+  }
+  if (!status.ok()) {
+    if (!File::Delete(new_file_name.c_str()))
+      LOG(ERROR) << "Unable to delete temporary file " << new_file_name;
+    return status;
+  }
+  SetComplete();
+  return Status::OK;
+}
+
 }  // namespace mp4
 }  // namespace media
 }  // namespace shaka
@@ -14,6 +14,9 @@
 
 namespace shaka {
 namespace media {
+
+class BufferWriter;
+
 namespace mp4 {
 
 /// Segmenter for MP4 Dash Video-On-Demand profile. A single MP4 file with a
@@ -26,6 +29,12 @@ namespace mp4 {
 /// is, the Segmenter tries to end subsegment/fragment at the first sample with
 /// overall subsegment/fragment duration not smaller than defined duration and
 /// yet meet SAP requirements.
+///
+/// By default the subsegments are written to a temporary file, which is
+/// copied to the output after the ftyp, moov and sidx boxes once the media is
+/// complete. With @b Mp4OutputParams.single_pass_on_demand, space for those
+/// boxes is reserved at the start of the output instead and they are patched
+/// in place at the end.
 class SingleSegmentSegmenter : public Segmenter {
  public:
   SingleSegmentSegmenter(const MuxerOptions& options,
@@ -46,9 +55,23 @@ class SingleSegmentSegmenter : public Segmenter {
   Status DoFinalize() override;
   Status DoFinalizeSegment(int64_t segment_number) override;
 
+  // Opens the output file for single pass mode and writes a placeholder for
+  // the header boxes. Leaves |output_file_| unset if the output does not
+  // support it.
+  Status InitializeSinglePass();
+  // Writes ftyp, moov and sidx (if enabled) to |buffer|.
+  void WriteHeader(BufferWriter* buffer);
+  Status FinalizeSinglePass();
+  // Used when the header boxes do not fit in the reserved space: writes them
+  // to a new file and appends the media to it.
+  Status RewriteWithHeader();
+
   std::unique_ptr<SegmentIndex> vod_sidx_;
   std::string temp_file_name_;
   std::unique_ptr<File, FileCloser> temp_file_;
+  // Set in single pass mode only.
+  std::unique_ptr<File, FileCloser> output_file_;
+  uint64_t reserved_header_size_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(SingleSegmentSegmenter);
 };
@@ -0,0 +1,277 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/formats/mp4/single_segment_segmenter.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+#include <packager/file/file_util.h>
+#include <packager/media/base/media_handler.h>
+#include <packager/media/base/media_sample.h>
+#include <packager/media/base/muxer_options.h>
+#include <packager/media/base/video_stream_info.h>
+#include <packager/media/formats/mp4/box_definitions.h>
+#include <packager/media/formats/mp4/box_reader.h>
+#include <packager/status/status_test_util.h>
+
+namespace shaka {
+namespace media {
+namespace mp4 {
+namespace {
+
+const int32_t kTimeScale = 1000;
+// Every subsegment is a single key frame of one second.
+const int64_t kSampleDuration = 1000;
+const uint16_t kWidth = 320;
+const uint16_t kHeight = 180;
+const uint8_t kCodecConfig[] = {0x01, 0x64, 0x00, 0x1e, 0xff, 0xe0, 0x00};
+const uint8_t kSampleData[] = {0x00, 0x00, 0x00, 0x02, 0x65, 0x88};
+
+struct TopLevelBox {
+  FourCC type;
+  uint64_t offset;
+  uint64_t size;
+};
+
+// Returns the boxes at the top level of |data|.
+std::vector<TopLevelBox> GetTopLevelBoxes(const std::string& data) {
+  std::vector<TopLevelBox> boxes;
+  const uint8_t* buf = reinterpret_cast<const uint8_t*>(data.data());
+  uint64_t offset = 0;
+  while (offset < data.size()) {
+    TopLevelBox box;
+    box.offset = offset;
+    bool err = false;
+    if (!BoxReader::StartBox(buf + offset, data.size() - offset, &box.type,
+                             &box.size, &err) ||
+        box.size == 0) {
+      ADD_FAILURE() << "Cannot read the box at offset " << offset;
+      break;
+    }
+    boxes.push_back(box);
+    offset += box.size;
+  }
+  EXPECT_EQ(data.size(), offset);
+  return boxes;
+}
+
+}  // namespace
+
+class SingleSegmentSegmenterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(TempFilePath("", &file_name_));
+    options_.output_file_name = file_name_;
+    options_.mp4_params.single_pass_on_demand = true;
+  }
+
+  void TearDown() override { File::Delete(file_name_.c_str()); }
+
+  // Writes |num_subsegments| subsegments to the output in single pass mode,
+  // for a stream which reports |stream_duration_in_seconds|, and reads the
+  // output back to |data_|.
+  void WriteSinglePass(int64_t stream_duration_in_seconds,
+                       int num_subsegments) {
+    ASSERT_NO_FATAL_FAILURE(InitializeSegmenter(stream_duration_in_seconds));
+    ASSERT_NO_FATAL_FAILURE(WriteSubsegments(num_subsegments));
+  }
+
+  void InitializeSegmenter(int64_t stream_duration_in_seconds) {
+    std::shared_ptr<StreamInfo> info(new VideoStreamInfo(
+        1, kTimeScale, stream_duration_in_seconds * kTimeScale, kCodecH264,
+        H26xStreamFormat::kNalUnitStreamWithoutParameterSetNalus,
+        "avc1.64001e", kCodecConfig, sizeof(kCodecConfig), kWidth, kHeight, 1,
+        1, 0, 0, 0, 0, 4, "und", false));
+
+    std::unique_ptr<FileType> ftyp(new FileType);
+    ftyp->major_brand = FOURCC_mp41;
+    ftyp->compatible_brands.push_back(FOURCC_isom);
+    ftyp->compatible_brands.push_back(FOURCC_dash);
+
+    std::unique_ptr<Movie> moov(new Movie);
+    moov->header.next_track_id = 2;
+    moov->tracks.resize(1);
+    moov->extends.tracks.resize(1);
+    Track& trak = moov->tracks[0];
+    trak.header.track_id = 1;
+    trak.header.width = kWidth * 0x10000;
+    trak.header.height = kHeight * 0x10000;
+    trak.media.header.timescale = kTimeScale;
+    moov->extends.tracks[0].track_id = 1;
+    VideoSampleEntry video;
+    video.format = FOURCC_avc1;
+    video.width = kWidth;
+    video.height = kHeight;
+    video.codec_configuration.data.assign(std::begin(kCodecConfig),
+                                          std::end(kCodecConfig));
+    SampleDescription& sample_description =
+        trak.media.information.sample_table.description;
+    sample_description.type = kVideo;
+    sample_description.video_entries.push_back(video);
+
+    segmenter_.reset(
+        new SingleSegmentSegmenter(options_, std::move(ftyp), std::move(moov)));
+    ASSERT_OK(segmenter_->Initialize({info}, nullptr, nullptr));
+  }
+
+  void WriteSubsegments(int num_subsegments) {
+    for (int i = 0; i < num_subsegments; ++i) {
+      std::shared_ptr<MediaSample> sample =
+          MediaSample::CopyFrom(kSampleData, sizeof(kSampleData), true);
+      sample->set_dts(i * kSampleDuration);
+      sample->set_pts(i * kSampleDuration);
+      sample->set_duration(kSampleDuration);
+      ASSERT_OK(segmenter_->AddSample(0, *sample));
+
+      SegmentInfo segment_info;
+      segment_info.start_timestamp = i * kSampleDuration;
+      segment_info.duration = kSampleDuration;
+      segment_info.segment_number = i + 1;
+      ASSERT_OK(segmenter_->FinalizeSegment(0, segment_info));
+    }
+    ASSERT_OK(segmenter_->Finalize());
+
+    ASSERT_TRUE(File::ReadFileToString(file_name_.c_str(), &data_));
+  }
+
+  // Checks that the header is at the start of |data_| and that the index and
+  // segment ranges match the boxes in it. Returns the size of the 'free' box
+  // between the sidx and the first moof, 0 if there is none.
+  void CheckOutput(int num_subsegments, uint64_t* free_size) {
+    const std::vector<TopLevelBox> boxes = GetTopLevelBoxes(data_);
+    ASSERT_GE(boxes.size(), 3u);
+    EXPECT_EQ(FOURCC_ftyp, boxes[0].type);
+    EXPECT_EQ(FOURCC_moov, boxes[1].type);
+    EXPECT_EQ(FOURCC_sidx, boxes[2].type);
+
+    size_t init_offset = 0;
+    size_t init_size = 0;
+    size_t index_offset = 0;
+    size_t index_size = 0;
+    ASSERT_TRUE(segmenter_->GetInitRange(&init_offset, &init_size));
+    ASSERT_TRUE(segmenter_->GetIndexRange(&index_offset, &index_size));
+    EXPECT_EQ(0u, init_offset);
+    EXPECT_EQ(boxes[2].offset, init_size);
+    EXPECT_EQ(boxes[2].offset, index_offset);
+    EXPECT_EQ(boxes[2].size, index_size);
+
+    // The sidx in the file is the final one, with a reference per subsegment.
+    bool err = false;
+    std::unique_ptr<BoxReader> reader(BoxReader::ReadBox(
+        reinterpret_cast<const uint8_t*>(data_.data()) + boxes[2].offset,
+        boxes[2].size, &err));
+    ASSERT_TRUE(reader);
+    SegmentIndex sidx;
+    ASSERT_TRUE(sidx.Parse(reader.get()));
+    EXPECT_EQ(static_cast<size_t>(num_subsegments), sidx.references.size());
+
+    size_t next_box = 3;
+    *free_size = 0;
+    if (next_box < boxes.size() && boxes[next_box].type == FOURCC_free) {
+      *free_size = boxes[next_box].size;
+      ++next_box;
+    }
+    // sidx.first_offset is the distance from the end of the sidx to the first
+    // subsegment, i.e. it skips the 'free' box.
+    EXPECT_EQ(*free_size, sidx.first_offset);
+
+    std::vector<uint64_t> moof_offsets;
+    for (; next_box < boxes.size(); ++next_box) {
+      if (boxes[next_box].type == FOURCC_moof)
+        moof_offsets.push_back(boxes[next_box].offset);
+      else
+        EXPECT_EQ(FOURCC_mdat, boxes[next_box].type);
+    }
+    ASSERT_EQ(static_cast<size_t>(num_subsegments), moof_offsets.size());
+    EXPECT_EQ(boxes[2].offset + boxes[2].size + sidx.first_offset,
+              moof_offsets[0]);
+
+    const std::vector<Range> ranges = segmenter_->GetSegmentRanges();
+    ASSERT_EQ(moof_offsets.size(), ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      EXPECT_EQ(moof_offsets[i], ranges[i].start);
+      EXPECT_EQ(sidx.references[i].referenced_size,
+                ranges[i].end - ranges[i].start + 1);
+    }
+    EXPECT_EQ(data_.size(), ranges.back().end + 1);
+  }
+
+  MuxerOptions options_;
+  std::string file_name_;
+  std::unique_ptr<SingleSegmentSegmenter> segmenter_;
+  std::string data_;
+};
+
+TEST_F(SingleSegmentSegmenterTest, SinglePassPatchesHeaderInPlace) {
+  const int kNumSubsegments = 5;
+  // Space is reserved for a reference per second of the stream, with some to
+  // spare, so most of it is left unused.
+  ASSERT_NO_FATAL_FAILURE(WriteSinglePass(kNumSubsegments, kNumSubsegments));
+
+  uint64_t free_size = 0;
+  ASSERT_NO_FATAL_FAILURE(CheckOutput(kNumSubsegments, &free_size));
+  EXPECT_GT(free_size, 0u);
+}
+
+TEST_F(SingleSegmentSegmenterTest, SinglePassRewritesIfSidxDoesNotFit) {
+  // The stream reports a duration of one second, but has many more
+  // subsegments than space was reserved for.
+  const int kNumSubsegments = 200;
+  ASSERT_NO_FATAL_FAILURE(WriteSinglePass(1, kNumSubsegments));
+
+  // The header is written right before the media.
+  uint64_t free_size = 0;
+  ASSERT_NO_FATAL_FAILURE(CheckOutput(kNumSubsegments, &free_size));
+  EXPECT_EQ(0u, free_size);
+}
+
+TEST_F(SingleSegmentSegmenterTest, SinglePassFallsBackForNonLocalOutput) {
+  File::Delete(file_name_.c_str());
+  file_name_ = "memory://single_pass_output.mp4";
+  options_.output_file_name = file_name_;
+  ASSERT_TRUE(File::WriteStringToFile(file_name_.c_str(), "previous output"));
+
+  const int kNumSubsegments = 3;
+  ASSERT_NO_FATAL_FAILURE(InitializeSegmenter(kNumSubsegments));
+  // The output is not opened, which would truncate it, until it is written
+  // through a temporary file at the end.
+  std::string previous_output;
+  ASSERT_TRUE(File::ReadFileToString(file_name_.c_str(), &previous_output));
+  EXPECT_EQ("previous output", previous_output);
+
+  ASSERT_NO_FATAL_FAILURE(WriteSubsegments(kNumSubsegments));
+  uint64_t free_size = 0;
+  ASSERT_NO_FATAL_FAILURE(CheckOutput(kNumSubsegments, &free_size));
+  EXPECT_EQ(0u, free_size);
+}
+
+TEST_F(SingleSegmentSegmenterTest, SinglePassWithoutSidx) {
+  options_.mp4_params.generate_sidx_in_media_segments = false;
+  const int kNumSubsegments = 3;
+  ASSERT_NO_FATAL_FAILURE(WriteSinglePass(kNumSubsegments, kNumSubsegments));
+
+  // The reserved space left is covered with a 'free' box after the moov.
+  const std::vector<TopLevelBox> boxes = GetTopLevelBoxes(data_);
+  ASSERT_EQ(3u + 2 * kNumSubsegments, boxes.size());
+  EXPECT_EQ(FOURCC_ftyp, boxes[0].type);
+  EXPECT_EQ(FOURCC_moov, boxes[1].type);
+  EXPECT_EQ(FOURCC_free, boxes[2].type);
+  EXPECT_EQ(FOURCC_moof, boxes[3].type);
+
+  size_t init_offset = 0;
+  size_t init_size = 0;
+  ASSERT_TRUE(segmenter_->GetInitRange(&init_offset, &init_size));
+  EXPECT_EQ(boxes[2].offset, init_size);
+}
+
+}  // namespace mp4
+}  // namespace media
+}  // namespace shaka
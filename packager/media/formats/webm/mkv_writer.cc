@@ -6,14 +6,37 @@
 
 #include <packager/media/formats/webm/mkv_writer.h>
 
+#include <cstring>
+
 #include <absl/log/check.h>
+#include <absl/log/log.h>
 
 namespace shaka {
 namespace media {
+namespace {
+
+bool WriteAll(File* file, const std::vector<uint8_t>& data) {
+  size_t total_bytes_written = 0;
+  while (total_bytes_written < data.size()) {
+    const int64_t written = file->Write(data.data() + total_bytes_written,
+                                        data.size() - total_bytes_written);
+    if (written <= 0)
+      return false;
+    total_bytes_written += written;
+  }
+  return true;
+}
 
-MkvWriter::MkvWriter() : position_(0) {}
+}  // namespace
 
-MkvWriter::~MkvWriter() {}
+MkvWriter::MkvWriter() {}
+
+MkvWriter::~MkvWriter() {
+  if (file_) {
+    Status status = Flush();
+    LOG_IF(ERROR, !status.ok()) << status;
+  }
+}
 
 Status MkvWriter::Open(const std::string& name) {
   DCHECK(!file_);
@@ -25,10 +48,21 @@ Status MkvWriter::Open(const std::string& name) {
   // on File.
   seekable_ = file_->Seek(0);
   position_ = 0;
+  buffer_position_ = 0;
   return Status::OK;
 }
 
+void MkvWriter::OpenInMemory() {
+  DCHECK(!file_);
+  in_memory_ = true;
+  seekable_ = true;
+  position_ = 0;
+  buffer_position_ = 0;
+}
+
 Status MkvWriter::Close() {
+  DCHECK(file_);
+  Status status = Flush();
   const std::string file_name = file_->file_name();
   if (!file_.release()->Close()) {
     return Status(
@@ -36,24 +70,52 @@ Status MkvWriter::Close() {
         "Cannot close file " + file_name +
             ", possibly file permission issue or running out of disk space.");
   }
-  return Status::OK;
+  return status;
 }
 
-mkvmuxer::int32 MkvWriter::Write(const void* buf, mkvmuxer::uint32 len) {
+Status MkvWriter::Flush() {
+  if (in_memory_ || buffer_.empty())
+    return Status::OK;
   DCHECK(file_);
 
-  const char* data = reinterpret_cast<const char*>(buf);
-  int64_t total_bytes_written = 0;
-  while (total_bytes_written < len) {
-    const int64_t written =
-        file_->Write(data + total_bytes_written, len - total_bytes_written);
-    if (written < 0)
-      return written;
+  if (!WriteAll(file_.get(), buffer_)) {
+    return Status(error::FILE_FAILURE,
+                  "Error writing to file " + file_->file_name());
+  }
+  // The position may have been moved back within the buffer.
+  const mkvmuxer::int64 buffer_end = buffer_position_ + buffer_.size();
+  if (position_ != buffer_end && !file_->Seek(position_)) {
+    return Status(error::FILE_FAILURE,
+                  "Error seeking in file " + file_->file_name());
+  }
+  buffer_.clear();
+  buffer_position_ = position_;
+  return Status::OK;
+}
 
-    total_bytes_written += written;
+Status MkvWriter::WriteToFile(const std::string& name) {
+  DCHECK(in_memory_);
+  std::unique_ptr<File, FileCloser> file(File::Open(name.c_str(), "w"));
+  if (!file)
+    return Status(error::FILE_FAILURE, "Cannot open file to write " + name);
+  if (!WriteAll(file.get(), buffer_))
+    return Status(error::FILE_FAILURE, "Error writing to file " + name);
+  if (!file.release()->Close()) {
+    return Status(
+        error::FILE_FAILURE,
+        "Cannot close file " + name +
+            ", possibly file permission issue or running out of disk space.");
   }
+  return Status::OK;
+}
 
-  DCHECK_EQ(total_bytes_written, len);
+mkvmuxer::int32 MkvWriter::Write(const void* buf, mkvmuxer::uint32 len) {
+  DCHECK(file_ || in_memory_);
+
+  const size_t offset = position_ - buffer_position_;
+  if (buffer_.size() < offset + len)
+    buffer_.resize(offset + len);
+  memcpy(buffer_.data() + offset, buf, len);
   position_ += len;
   return 0;
 }
@@ -65,11 +127,14 @@ int64_t MkvWriter::WriteFromFile(File* source) {
 int64_t MkvWriter::WriteFromFile(File* source, int64_t max_copy) {
   DCHECK(file_);
 
+  if (!Flush().ok())
+    return -1;
   const int64_t size = File::Copy(source, file_.get(), max_copy);
   if (size < 0)
     return size;
 
   position_ += size;
+  buffer_position_ = position_;
   return size;
 }
 
@@ -78,14 +143,20 @@ mkvmuxer::int64 MkvWriter::Position() const {
 }
 
 mkvmuxer::int32 MkvWriter::Position(mkvmuxer::int64 position) {
-  DCHECK(file_);
+  DCHECK(file_ || in_memory_);
 
-  if (file_->Seek(position)) {
+  if (!seekable_)
+    return -1;
+  const mkvmuxer::int64 buffer_end = buffer_position_ + buffer_.size();
+  if (position >= buffer_position_ && position <= buffer_end) {
     position_ = position;
     return 0;
-  } else {
-    return -1;
   }
+  if (in_memory_ || !Flush().ok() || !file_->Seek(position))
+    return -1;
+  position_ = position;
+  buffer_position_ = position;
+  return 0;
 }
 
 bool MkvWriter::Seekable() const {
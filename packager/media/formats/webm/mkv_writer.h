@@ -7,8 +7,10 @@
 #ifndef PACKAGER_MEDIA_FORMATS_WEBM_MKV_WRITER_H_
 #define PACKAGER_MEDIA_FORMATS_WEBM_MKV_WRITER_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <mkvmuxer/mkvmuxer.h>
 
@@ -20,6 +22,11 @@ namespace shaka {
 namespace media {
 
 /// An implementation of IMkvWriter using our File type.
+///
+/// libwebm writes each EBML element separately, so the output is buffered in
+/// memory, and only written to the file on Flush(), on Close(), or when
+/// seeking outside of the buffer. Seeking within the buffer, e.g. to patch the
+/// size of a Cluster, does not touch the file.
 class MkvWriter : public mkvmuxer::IMkvWriter {
  public:
   MkvWriter();
@@ -30,8 +37,18 @@ class MkvWriter : public mkvmuxer::IMkvWriter {
   /// @param name The path to the file to open.
   /// @return Whether the operation succeeded.
   Status Open(const std::string& name);
-  /// Closes the file.  MUST call Open before calling any other methods.
+  /// Opens the writer without a file. The output is held in memory until it
+  /// is written with WriteToFile().
+  void OpenInMemory();
+  /// Writes the buffered output to the file, then closes it. MUST call Open
+  /// before calling any other methods.
   Status Close();
+  /// Writes the buffered output to the file.
+  Status Flush();
+  /// Writes the output of a writer opened with OpenInMemory() to a new file,
+  /// in a single write.
+  /// @param name The path to the file to write.
+  Status WriteToFile(const std::string& name);
 
   /// Writes out @a len bytes of @a buf.
   /// @return 0 on success.
@@ -60,13 +77,16 @@ class MkvWriter : public mkvmuxer::IMkvWriter {
   /// @return The number of bytes written; or < 0 on error.
   int64_t WriteFromFile(File* source, int64_t max_copy);
 
-  File* file() { return file_.get(); }
-
  private:
   std::unique_ptr<File, FileCloser> file_;
-  // Keep track of the position and whether we can seek.
-  mkvmuxer::int64 position_;
-  bool seekable_;
+  bool in_memory_ = false;
+  // Output not written to |file_| yet, which starts at |buffer_position_|.
+  std::vector<uint8_t> buffer_;
+  mkvmuxer::int64 buffer_position_ = 0;
+  // Keep track of the position and whether we can seek. The position is
+  // always within, or at the end of, |buffer_|.
+  mkvmuxer::int64 position_ = 0;
+  bool seekable_ = false;
 
   DISALLOW_COPY_AND_ASSIGN(MkvWriter);
 };
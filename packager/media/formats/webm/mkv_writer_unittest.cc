@@ -0,0 +1,109 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/formats/webm/mkv_writer.h>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+#include <packager/file/memory_file.h>
+#include <packager/status/status_test_util.h>
+
+namespace shaka {
+namespace media {
+
+class MkvWriterTest : public testing::Test {
+ protected:
+  void TearDown() override { MemoryFile::DeleteAll(); }
+
+  void Write(const std::string& data) {
+    ASSERT_EQ(0, writer_.Write(data.data(), data.size()));
+  }
+
+  std::string ReadFile(const std::string& name) {
+    std::string data;
+    EXPECT_TRUE(File::ReadFileToString(name.c_str(), &data));
+    return data;
+  }
+
+  MkvWriter writer_;
+};
+
+TEST_F(MkvWriterTest, WritesOnFlush) {
+  BufferCallbackParams callback_params;
+  std::vector<std::string> writes;
+  callback_params.write_func = [&writes](const std::string&, const void* buffer,
+                                         uint64_t size) {
+    writes.emplace_back(static_cast<const char*>(buffer), size);
+    return size;
+  };
+  ASSERT_OK(writer_.Open(
+      File::MakeCallbackFileName(callback_params, "output.webm")));
+
+  for (int i = 0; i < 10; ++i)
+    Write("0123456789");
+  EXPECT_EQ(100, writer_.Position());
+  EXPECT_TRUE(writes.empty());
+
+  ASSERT_OK(writer_.Flush());
+  Write("abc");
+  ASSERT_OK(writer_.Close());
+  ASSERT_EQ(2u, writes.size());
+  EXPECT_EQ(100u, writes[0].size());
+  EXPECT_EQ("abc", writes[1]);
+}
+
+TEST_F(MkvWriterTest, SeeksWithinBuffer) {
+  const char kFileName[] = "memory://output.webm";
+  ASSERT_OK(writer_.Open(kFileName));
+  ASSERT_TRUE(writer_.Seekable());
+
+  Write("0123456789");
+  ASSERT_EQ(0, writer_.Position(2));
+  Write("ab");
+  EXPECT_EQ(4, writer_.Position());
+  ASSERT_EQ(0, writer_.Position(10));
+  Write("X");
+  ASSERT_OK(writer_.Close());
+  EXPECT_EQ("01ab456789X", ReadFile(kFileName));
+}
+
+TEST_F(MkvWriterTest, SeeksOutsideBuffer) {
+  const char kFileName[] = "memory://output.webm";
+  ASSERT_OK(writer_.Open(kFileName));
+
+  Write("0123456789");
+  ASSERT_OK(writer_.Flush());
+  ASSERT_EQ(0, writer_.Position(1));
+  Write("ab");
+  // Flushes with the position moved back.
+  ASSERT_EQ(0, writer_.Position(2));
+  ASSERT_OK(writer_.Flush());
+  Write("c");
+  ASSERT_EQ(0, writer_.Position(10));
+  Write("X");
+  ASSERT_OK(writer_.Close());
+  EXPECT_EQ("0ac3456789X", ReadFile(kFileName));
+}
+
+TEST_F(MkvWriterTest, WritesToFileFromMemory) {
+  const char kFileName[] = "memory://segment.webm";
+  writer_.OpenInMemory();
+  ASSERT_TRUE(writer_.Seekable());
+
+  Write("0123456789");
+  ASSERT_EQ(0, writer_.Position(0));
+  Write("a");
+  EXPECT_EQ(-1, writer_.Position(11));
+  ASSERT_OK(writer_.WriteToFile(kFileName));
+  EXPECT_EQ("a123456789", ReadFile(kFileName));
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -40,15 +40,9 @@ Status MultiSegmentSegmenter::FinalizeSegment(int64_t start_timestamp,
         GetSegmentName(options().segment_template, start_timestamp,
                        segment_number, options().bandwidth);
 
-    // Close the file, which also does flushing, to make sure the file is
-    // written before manifest is updated.
-    RETURN_IF_ERROR(writer_->Close());
-
-    if (!File::Copy(temp_file_name_.c_str(), segment_name.c_str()))
-      return Status(error::FILE_FAILURE, "Failure to copy memory file.");
-
-    if (!File::Delete(temp_file_name_.c_str()))
-      return Status(error::FILE_FAILURE, "Failure to delete memory file.");
+    // The segment is assembled in memory; write it out in one go before the
+    // manifest is updated.
+    RETURN_IF_ERROR(writer_->WriteToFile(segment_name));
 
     num_segment_++;
 
@@ -81,8 +75,8 @@ Status MultiSegmentSegmenter::DoInitialize() {
   Status status = writer->Open(options().output_file_name);
   if (!status.ok())
     return status;
-  writer_ = std::move(writer);
-  return WriteSegmentHeader(0, writer_.get());
+  RETURN_IF_ERROR(WriteSegmentHeader(0, writer.get()));
+  return writer->Close();
 }
 
 Status MultiSegmentSegmenter::DoFinalize() {
@@ -92,16 +86,8 @@ Status MultiSegmentSegmenter::DoFinalize() {
 Status MultiSegmentSegmenter::NewSegment(int64_t start_timestamp,
                                          bool is_subsegment) {
   if (!is_subsegment) {
-    temp_file_name_ =
-        "memory://" + GetSegmentName(options().segment_template,
-                                     start_timestamp, num_segment_,
-                                     options().bandwidth);
-
     writer_.reset(new MkvWriter);
-    Status status = writer_->Open(temp_file_name_);
-
-    if (!status.ok())
-      return status;
+    writer_->OpenInMemory();
   }
 
   const int64_t start_timecode = FromBmffTimestamp(start_timestamp);
@@ -51,7 +51,6 @@ class MultiSegmentSegmenter : public Segmenter {
 
   std::unique_ptr<MkvWriter> writer_;
   uint32_t num_segment_;
-  std::string temp_file_name_;
 
   DISALLOW_COPY_AND_ASSIGN(MultiSegmentSegmenter);
 };
@@ -35,6 +35,10 @@ Status SingleSegmentSegmenter::FinalizeSegment(int64_t start_timestamp,
   CHECK(cluster());
   if (!cluster()->Finalize())
     return Status(error::FILE_FAILURE, "Error finalizing cluster.");
+  // The cluster is assembled in memory; write it out at once.
+  status = writer_->Flush();
+  if (!status.ok())
+    return status;
   if (muxer_listener()) {
     const uint64_t size = cluster()->Size();
     muxer_listener()->OnNewSegment(options().output_file_name, start_timestamp,
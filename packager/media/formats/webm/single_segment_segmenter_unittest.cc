@@ -8,6 +8,8 @@
 
 #include <gtest/gtest.h>
 
+#include <packager/file.h>
+#include <packager/file/file_util.h>
 #include <packager/media/formats/webm/segmenter_test_base.h>
 
 namespace shaka {
@@ -21,6 +23,9 @@ const int64_t kDuration = 1000000;
 const int64_t kSegmentNumber1 = 1;
 const int64_t kSegmentNumber2 = 2;
 const bool kSubsegment = true;
+// ID of the Cues and Cluster elements.
+const uint8_t kCuesId[] = {0x1c, 0x53, 0xbb, 0x6b};
+const uint8_t kClusterId[] = {0x1f, 0x43, 0xb6, 0x75};
 
 // clang-format off
 const uint8_t kBasicSupportData[] = {
@@ -153,6 +158,56 @@ class SingleSegmentSegmenterTest : public SegmentTestBase {
             options, *info_, &segmenter_));
   }
 
+  // Writes |num_segments| segments of one sample each in single pass mode
+  // to a local file, and checks that the Cues are right after the header.
+  void TestSinglePass(int num_segments, bool expect_void_after_cues) {
+    std::string file_name;
+    ASSERT_TRUE(TempFilePath("", &file_name));
+    MuxerOptions options = CreateMuxerOptions();
+    options.output_file_name = file_name;
+    options.webm_single_pass_on_demand = true;
+    ASSERT_NO_FATAL_FAILURE(InitializeSegmenter(options));
+
+    for (int i = 0; i < num_segments; i++) {
+      std::shared_ptr<MediaSample> sample =
+          CreateSample(kKeyFrame, kDuration, kNoSideData);
+      ASSERT_OK(segmenter_->AddSample(*sample));
+      ASSERT_OK(segmenter_->FinalizeSegment(i * kDuration, kDuration,
+                                            !kSubsegment, i));
+    }
+    ASSERT_OK(segmenter_->Finalize());
+
+    ClusterParser parser;
+    ASSERT_NO_FATAL_FAILURE(parser.PopulateFromSegment(file_name));
+    EXPECT_EQ(static_cast<size_t>(num_segments), parser.cluster_count());
+
+    std::string data;
+    ASSERT_TRUE(File::ReadFileToString(file_name.c_str(), &data));
+    ASSERT_TRUE(File::Delete(file_name.c_str()));
+    uint64_t init_start = 0;
+    uint64_t init_end = 0;
+    uint64_t index_start = 0;
+    uint64_t index_end = 0;
+    ASSERT_TRUE(segmenter_->GetInitRangeStartAndEnd(&init_start, &init_end));
+    ASSERT_TRUE(segmenter_->GetIndexRangeStartAndEnd(&index_start, &index_end));
+    EXPECT_EQ(init_end + 1, index_start);
+    ASSERT_LT(index_end + sizeof(kClusterId), data.size());
+    EXPECT_EQ(std::string(std::begin(kCuesId), std::end(kCuesId)),
+              data.substr(index_start, sizeof(kCuesId)));
+    // The reserved space left is covered with a Void element.
+    const uint8_t kVoidId = 0xec;
+    EXPECT_EQ(expect_void_after_cues,
+              static_cast<uint8_t>(data[index_end + 1]) == kVoidId);
+
+    const std::vector<Range> ranges = segmenter_->GetSegmentRanges();
+    ASSERT_EQ(static_cast<size_t>(num_segments), ranges.size());
+    EXPECT_EQ(data.size(), ranges.back().end + 1);
+    for (const Range& range : ranges) {
+      EXPECT_EQ(std::string(std::begin(kClusterId), std::end(kClusterId)),
+                data.substr(range.start, sizeof(kClusterId)));
+    }
+  }
+
   std::shared_ptr<StreamInfo> info_;
   std::unique_ptr<webm::Segmenter> segmenter_;
 };
@@ -299,5 +354,41 @@ TEST_F(SingleSegmentSegmenterTest, ReallyLargeTimestamp) {
   }
 }
 
+TEST_F(SingleSegmentSegmenterTest, SinglePass) {
+  TestSinglePass(3, true);
+}
+
+TEST_F(SingleSegmentSegmenterTest, SinglePassRewritesIfCuesDoNotFit) {
+  // Space is reserved for about one cue point per second of the stream
+  // duration.
+  TestSinglePass(200, false);
+}
+
+TEST_F(SingleSegmentSegmenterTest, SinglePassFallsBackForNonLocalOutput) {
+  ASSERT_TRUE(
+      File::WriteStringToFile(OutputFileName().c_str(), "previous output"));
+  MuxerOptions options = CreateMuxerOptions();
+  options.webm_single_pass_on_demand = true;
+  ASSERT_NO_FATAL_FAILURE(InitializeSegmenter(options));
+
+  // The output is not opened, which would truncate it, until it is written
+  // through a temporary file at the end.
+  std::string previous_output;
+  ASSERT_TRUE(
+      File::ReadFileToString(OutputFileName().c_str(), &previous_output));
+  EXPECT_EQ("previous output", previous_output);
+
+  std::shared_ptr<MediaSample> sample =
+      CreateSample(kKeyFrame, kDuration, kNoSideData);
+  ASSERT_OK(segmenter_->AddSample(*sample));
+  ASSERT_OK(segmenter_->FinalizeSegment(0, kDuration, !kSubsegment,
+                                        kSegmentNumber1));
+  ASSERT_OK(segmenter_->Finalize());
+
+  ClusterParser parser;
+  ASSERT_NO_FATAL_FAILURE(parser.PopulateFromSegment(OutputFileName()));
+  EXPECT_EQ(1u, parser.cluster_count());
+}
+
 }  // namespace media
 }  // namespace shaka
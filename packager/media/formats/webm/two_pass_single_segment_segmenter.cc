@@ -7,12 +7,18 @@
 #include <packager/media/formats/webm/two_pass_single_segment_segmenter.h>
 
 #include <algorithm>
+#include <filesystem>
+#include <limits>
+#include <vector>
 
 #include <absl/log/check.h>
+#include <absl/strings/strip.h>
 #include <mkvmuxer/mkvmuxer.h>
 #include <mkvmuxer/mkvmuxerutil.h>
 
 #include <packager/file/file_util.h>
+#include <packager/macros/logging.h>
+#include <packager/macros/status.h>
 #include <packager/media/base/media_sample.h>
 #include <packager/media/base/muxer_options.h>
 #include <packager/media/base/stream_info.h>
@@ -21,6 +27,36 @@ namespace shaka {
 namespace media {
 namespace webm {
 namespace {
+
+// In single pass mode the Cues are sized for clusters of at least this
+// duration, plus a few extra cue points. The stream duration is not always
+// known up front, in which case a default number of cue points is reserved.
+// Either way the output is rewritten if the estimate turns out too small.
+const double kMinExpectedClusterDurationInSeconds = 1.0;
+const uint64_t kExtraReservedCuePoints = 64;
+const uint64_t kDefaultReservedCuePoints = 4096;
+// Largest Void element with a single byte size: the size can code up to 126.
+const uint64_t kMaxVoidSizeWithOneByteSize = 128;
+
+// Writes a Void element of exactly |size| bytes. Nothing is written if |size|
+// is 0; a size of 1 cannot be filled.
+bool WriteVoid(mkvmuxer::IMkvWriter* writer, uint64_t size) {
+  if (size == 0)
+    return true;
+  const int32_t size_size = size <= kMaxVoidSizeWithOneByteSize ? 1 : 8;
+  const uint64_t header_size =
+      mkvmuxer::GetUIntSize(libwebm::kMkvVoid) + size_size;
+  if (size < header_size)
+    return false;
+  if (mkvmuxer::WriteID(writer, libwebm::kMkvVoid) != 0 ||
+      mkvmuxer::WriteUIntSize(writer, size - header_size, size_size) != 0) {
+    return false;
+  }
+  const std::vector<uint8_t> zeros(size - header_size);
+  return zeros.empty() ||
+         writer->Write(zeros.data(),
+                       static_cast<mkvmuxer::uint32>(zeros.size())) == 0;
+}
 // Cues will be inserted before clusters. All clusters will be shifted down by
 // the size of cues. However, cluster positions affect the size of cues. This
 // function adjusts cues size iteratively until it is stable.
@@ -70,6 +106,12 @@ TwoPassSingleSegmentSegmenter::TwoPassSingleSegmentSegmenter(
 TwoPassSingleSegmentSegmenter::~TwoPassSingleSegmentSegmenter() {}
 
 Status TwoPassSingleSegmentSegmenter::DoInitialize() {
+  if (options().webm_single_pass_on_demand) {
+    RETURN_IF_ERROR(InitializeSinglePass());
+    if (single_pass_)
+      return Status::OK;
+  }
+
   // Assume the amount of time to copy the temp file as the same amount
   // of time as to make it.
   set_progress_target(duration() * 2);
@@ -86,6 +128,9 @@ Status TwoPassSingleSegmentSegmenter::DoInitialize() {
 }
 
 Status TwoPassSingleSegmentSegmenter::DoFinalize() {
+  if (single_pass_)
+    return FinalizeSinglePass();
+
   const uint64_t header_size = init_end() + 1;
   const uint64_t cues_pos = header_size - segment_payload_pos();
   const uint64_t cues_size = UpdateCues(cues());
@@ -113,6 +158,7 @@ Status TwoPassSingleSegmentSegmenter::DoFinalize() {
             static_cast<int64_t>(segment_payload_pos() + cues_pos + cues_size));
 
   // Close the temp file and open it for reading.
+  RETURN_IF_ERROR(writer()->Close());
   set_writer(std::unique_ptr<MkvWriter>());
   std::unique_ptr<File, FileCloser> temp_reader(
       File::Open(temp_file_name_.c_str(), "r"));
@@ -185,6 +231,153 @@ bool TwoPassSingleSegmentSegmenter::CopyFileWithClusterRewrite(
          static_cast<int64_t>(last_cluster_payload_size);
 }
 
+Status TwoPassSingleSegmentSegmenter::InitializeSinglePass() {
+  const std::string& file_name = options().output_file_name;
+  // The header is patched in place and a fallback may need to replace the
+  // file, which needs a seekable file with a path. This is decided from the
+  // name, as opening any other output would truncate or upload it.
+  if (!File::IsLocalRegularFileName(file_name.c_str())) {
+    LOG(WARNING) << "Single pass output is only supported for local files, "
+                    "writing '"
+                 << file_name << "' through a temporary file.";
+    return Status::OK;
+  }
+  std::unique_ptr<MkvWriter> output_writer(new MkvWriter);
+  RETURN_IF_ERROR(output_writer->Open(file_name));
+  if (!output_writer->Seekable()) {
+    LOG(WARNING) << "Cannot seek in '" << file_name
+                 << "', writing it through a temporary file.";
+    return output_writer->Close();
+  }
+  set_writer(std::move(output_writer));
+  single_pass_ = true;
+  RETURN_IF_ERROR(SingleSegmentSegmenter::DoInitialize());
+
+  uint64_t num_cue_points = kDefaultReservedCuePoints;
+  if (duration() > 0 && time_scale() > 0) {
+    const double duration_in_seconds =
+        static_cast<double>(duration()) / time_scale();
+    num_cue_points = static_cast<uint64_t>(
+                         duration_in_seconds /
+                         kMinExpectedClusterDurationInSeconds) +
+                     kExtraReservedCuePoints;
+  }
+  // Cue points are sized for the largest time and cluster position.
+  mkvmuxer::CuePoint cue_point;
+  cue_point.set_time(std::numeric_limits<int64_t>::max());
+  cue_point.set_track(track_id());
+  cue_point.set_cluster_pos(std::numeric_limits<int64_t>::max());
+  const uint64_t cues_payload_size = cue_point.Size() * num_cue_points;
+  reserved_cues_size_ =
+      mkvmuxer::EbmlMasterElementSize(libwebm::kMkvCues, cues_payload_size) +
+      cues_payload_size;
+
+  // Fill the reserved space with a Void element so the file stays parseable
+  // until the Cues are in place.
+  if (!WriteVoid(writer(), reserved_cues_size_))
+    return Status(error::FILE_FAILURE, "Error reserving space for Cues.");
+  seek_head()->set_cluster_pos(writer()->Position() - segment_payload_pos());
+  return Status::OK;
+}
+
+Status TwoPassSingleSegmentSegmenter::FinalizeSinglePass() {
+  const uint64_t header_size = init_end() + 1;
+  const uint64_t clusters_start = header_size + reserved_cues_size_;
+  // Whatever the Cues do not use is covered by a Void element, which takes at
+  // least two bytes.
+  const uint64_t cues_size = cues()->Size();
+  if (cues_size > reserved_cues_size_ ||
+      reserved_cues_size_ - cues_size == 1) {
+    return RewriteWithCues();
+  }
+
+  const std::string& file_name = options().output_file_name;
+  const uint64_t file_size = writer()->Position();
+  seek_head()->set_cues_pos(header_size - segment_payload_pos());
+  if (writer()->Position(0) != 0)
+    return Status(error::FILE_FAILURE, "Cannot seek in file " + file_name);
+  RETURN_IF_ERROR(WriteSegmentHeader(file_size, writer()));
+  DCHECK_EQ(writer()->Position(), static_cast<int64_t>(header_size));
+
+  set_index_start(header_size);
+  if (!cues()->Write(writer()))
+    return Status(error::FILE_FAILURE, "Error writing Cues data.");
+  set_index_end(writer()->Position() - 1);
+  if (!WriteVoid(writer(), reserved_cues_size_ - cues_size))
+    return Status(error::FILE_FAILURE, "Error writing Cues data.");
+  DCHECK_EQ(writer()->Position(), static_cast<int64_t>(clusters_start));
+
+  VLOG(1) << "Updated Cues in place in '" << file_name << "', "
+          << reserved_cues_size_ - cues_size
+          << " bytes of reserved space unused.";
+  return writer()->Close();
+}
+
+Status TwoPassSingleSegmentSegmenter::RewriteWithCues() {
+  const std::string& file_name = options().output_file_name;
+  const uint64_t header_size = init_end() + 1;
+  const uint64_t clusters_start = header_size + reserved_cues_size_;
+  const uint64_t clusters_size = writer()->Position() - clusters_start;
+  RETURN_IF_ERROR(writer()->Close());
+  set_writer(std::unique_ptr<MkvWriter>());
+
+  LOG(INFO) << "Reserved space for the Cues in '" << file_name
+            << "' was too small, rewriting the file.";
+
+  // The clusters are moved to right after the header, followed by the Cues.
+  for (int i = 0; i < cues()->cue_entries_size(); ++i) {
+    mkvmuxer::CuePoint* cue = cues()->GetCueByIndex(i);
+    cue->set_cluster_pos(cue->cluster_pos() - reserved_cues_size_);
+  }
+  const uint64_t cues_pos = header_size - segment_payload_pos();
+  const uint64_t cues_size = UpdateCues(cues());
+  seek_head()->set_cues_pos(cues_pos);
+  seek_head()->set_cluster_pos(cues_pos + cues_size);
+
+  // Create the new file next to the output so it can be renamed over it.
+  std::string new_file_name;
+  const std::filesystem::path output_path = std::filesystem::u8path(
+      std::string(absl::StripPrefix(file_name, "file://")));
+  const std::string output_dir = output_path.has_parent_path()
+                                     ? output_path.parent_path().string()
+                                     : std::string(".");
+  if (!TempFilePath(output_dir, &new_file_name))
+    return Status(error::FILE_FAILURE, "Unable to create temporary file.");
+
+  MkvWriter new_writer;
+  RETURN_IF_ERROR(new_writer.Open(new_file_name));
+  Status status = WriteSegmentHeader(header_size + cues_size + clusters_size,
+                                     &new_writer);
+  if (status.ok()) {
+    set_index_start(new_writer.Position());
+    if (!cues()->Write(&new_writer))
+      status = Status(error::FILE_FAILURE, "Error writing Cues data.");
+    set_index_end(new_writer.Position() - 1);
+  }
+  status.Update(new_writer.Close());
+  if (status.ok() &&
+      !AppendFileRange(file_name, clusters_start, new_file_name)) {
+    status = Status(error::FILE_FAILURE,
+                    "Failed to copy clusters from " + file_name + " to " +
+                        new_file_name);
+  }
+  if (status.ok()) {
+    std::error_code ec;
+    std::filesystem::rename(std::filesystem::u8path(new_file_name),
+                            output_path, ec);
+    if (ec) {
+      status = Status(error::FILE_FAILURE, "Cannot rename " + new_file_name +
+                                               " to " + file_name + ": " +
+                                               ec.message());
+    }
+  }
+  if (!status.ok()) {
+    if (!File::Delete(new_file_name.c_str()))
+      LOG(ERROR) << "Unable to delete temporary file " << new_file_name;
+  }
+  return status;
+}
+
 }  // namespace webm
 }  // namespace media
 }  // namespace shaka
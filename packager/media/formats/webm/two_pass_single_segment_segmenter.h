@@ -25,6 +25,11 @@ namespace webm {
 
 /// An implementation of a Segmenter for a single-segment that performs two
 /// passes.  This does not use seeking and is used for non-seekable files.
+///
+/// With @b MuxerOptions.webm_single_pass_on_demand, local output files are
+/// written in a single pass instead: space for the Cues is reserved after the
+/// segment header, the clusters are written directly to the output, and the
+/// header and Cues are patched in place at the end.
 class TwoPassSingleSegmentSegmenter : public SingleSegmentSegmenter {
  public:
   explicit TwoPassSingleSegmentSegmenter(const MuxerOptions& options);
@@ -43,7 +48,17 @@ class TwoPassSingleSegmentSegmenter : public SingleSegmentSegmenter {
                                   MkvWriter* dest,
                                   uint64_t last_size);
 
+  // Opens the output file for single pass mode and reserves space for the
+  // Cues. Leaves |single_pass_| unset if the output does not support it.
+  Status InitializeSinglePass();
+  Status FinalizeSinglePass();
+  // Used when the Cues do not fit in the reserved space: writes the header
+  // and Cues to a new file and appends the clusters to it.
+  Status RewriteWithCues();
+
   std::string temp_file_name_;
+  bool single_pass_ = false;
+  uint64_t reserved_cues_size_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(TwoPassSingleSegmentSegmenter);
 };
@@ -12,6 +12,7 @@
 #include <absl/log/log.h>
 
 #include <packager/macros/logging.h>
+#include <packager/media/base/sample_pool.h>
 #include <packager/media/base/timestamp.h>
 #include <packager/media/codecs/vp8_parser.h>
 #include <packager/media/codecs/vp9_parser.h>
@@ -391,8 +392,8 @@ bool WebMClusterParser::OnBlock(bool is_simple_block,
         buffer->set_decrypt_config(std::move(decrypt_config));
         buffer->set_is_encrypted(true);
       } else {
-        std::shared_ptr<uint8_t> decrypted_media_data(
-            new uint8_t[media_data_size], std::default_delete<uint8_t[]>());
+        std::shared_ptr<uint8_t> decrypted_media_data =
+            SamplePool::AllocateBuffer(media_data_size);
         if (!decryptor_source_->DecryptSampleBuffer(
                 decrypt_config.get(), media_data, media_data_size,
                 decrypted_media_data.get())) {
@@ -152,6 +152,12 @@ class MpdNotifier {
   /// forces a flush.
   virtual bool Flush() = 0;
 
+  /// Call this method to request a flush without waiting for it. Requests
+  /// might be coalesced, so that the MPD is written once for updates from
+  /// several streams. The default implementation calls Flush().
+  /// @return false if a previous flush failed, true otherwise.
+  virtual bool RequestFlush() { return Flush(); }
+
   /// @return include_mspr_pro option flag
   bool include_mspr_pro() const {
     return mpd_options_.mpd_params.include_mspr_pro;
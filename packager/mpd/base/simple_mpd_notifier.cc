@@ -6,15 +6,20 @@
 
 #include <packager/mpd/base/simple_mpd_notifier.h>
 
+#include <algorithm>
+
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
+#include <packager/file.h>
+#include <packager/file/work_stealing_executor.h>
 #include <packager/mpd/base/adaptation_set.h>
 #include <packager/mpd/base/mpd_builder.h>
 #include <packager/mpd/base/mpd_notifier_util.h>
 #include <packager/mpd/base/mpd_utils.h>
 #include <packager/mpd/base/period.h>
 #include <packager/mpd/base/representation.h>
+#include <packager/utils/telemetry.h>
 
 namespace shaka {
 
@@ -23,14 +28,46 @@ SimpleMpdNotifier::SimpleMpdNotifier(const MpdOptions& mpd_options)
       output_path_(mpd_options.mpd_params.mpd_output),
       mpd_builder_(new MpdBuilder(mpd_options)),
       content_protection_in_adaptation_set_(
-          mpd_options.mpd_params.generate_dash_if_iop_compliant_mpd) {
+          mpd_options.mpd_params.generate_dash_if_iop_compliant_mpd),
+      publish_interval_(
+          absl::Seconds(mpd_options.mpd_params.mpd_publish_interval)) {
   for (const std::string& base_url : mpd_options.mpd_params.base_urls)
     mpd_builder_->AddBaseUrl(base_url);
 }
 
-SimpleMpdNotifier::~SimpleMpdNotifier() {}
+SimpleMpdNotifier::~SimpleMpdNotifier() {
+  if (publisher_exited_) {
+    {
+      absl::MutexLock lock(&lock_);
+      stop_publisher_ = true;
+      publish_requested_cond_.Signal();
+    }
+    // A pending request is written before the publisher exits.
+    publisher_exited_->WaitForNotification();
+  }
+  if (publish_stats_.num_mpd_writes > 0) {
+    VLOG(1) << "MPD written " << publish_stats_.num_mpd_writes << " times for "
+            << publish_stats_.num_flush_requests
+            << " flush requests, average latency "
+            << publish_stats_.total_publish_latency /
+                   publish_stats_.num_mpd_writes
+            << ", max latency " << publish_stats_.max_publish_latency;
+  }
+}
 
 bool SimpleMpdNotifier::Init() {
+  if (mpd_type() == MpdType::kDynamic && !publisher_exited_) {
+    publisher_exited_.reset(new absl::Notification);
+    if (!WorkStealingExecutor::Io()->PostBlockingTask([this]() {
+          PublisherLoop();
+          publisher_exited_->Notify();
+        })) {
+      LOG(ERROR) << "Failed to start the MPD publisher. Increase "
+                    "--num_io_threads.";
+      publisher_exited_.reset();
+      return false;
+    }
+  }
   return true;
 }
 
@@ -225,8 +262,96 @@ bool SimpleMpdNotifier::NotifyMediaInfoUpdate(uint32_t container_id,
 }
 
 bool SimpleMpdNotifier::Flush() {
+  absl::MutexLock publish_lock(&publish_lock_);
+  {
+    absl::MutexLock lock(&lock_);
+    ++publish_stats_.num_flush_requests;
+    if (!publish_requested_) {
+      publish_requested_ = true;
+      first_request_time_ = absl::Now();
+    }
+  }
+  return PublishMpd();
+}
+
+bool SimpleMpdNotifier::RequestFlush() {
+  if (!publisher_exited_)
+    return Flush();
+
+  absl::MutexLock lock(&lock_);
+  ++publish_stats_.num_flush_requests;
+  if (!publish_requested_) {
+    publish_requested_ = true;
+    first_request_time_ = absl::Now();
+    publish_requested_cond_.Signal();
+  }
+  return !publish_failed_;
+}
+
+SimpleMpdNotifier::PublishStats SimpleMpdNotifier::GetPublishStats() {
+  absl::MutexLock lock(&lock_);
+  return publish_stats_;
+}
+
+void SimpleMpdNotifier::PublisherLoop() {
+  while (true) {
+    {
+      absl::MutexLock lock(&lock_);
+      while (!publish_requested_ && !stop_publisher_)
+        publish_requested_cond_.Wait(&lock_);
+      if (!publish_requested_)
+        return;
+      // Let the updates within the interval accumulate.
+      const absl::Duration delay =
+          last_publish_time_ + publish_interval_ - absl::Now();
+      if (delay > absl::ZeroDuration())
+        lock_.AwaitWithTimeout(absl::Condition(&stop_publisher_), delay);
+    }
+    absl::MutexLock publish_lock(&publish_lock_);
+    PublishMpd();
+  }
+}
+
+bool SimpleMpdNotifier::PublishMpd() {
+  CHECK(!output_path_.empty());
+
+  // The MPD is generated under |lock_| but written without it, so that the
+  // notifications are not blocked by the file I/O.
+  std::string mpd;
+  absl::Time request_time;
+  {
+    absl::MutexLock lock(&lock_);
+    // The request may have been served by a synchronous Flush().
+    if (!publish_requested_)
+      return !publish_failed_;
+    publish_requested_ = false;
+    request_time = first_request_time_;
+    if (!mpd_builder_->ToString(&mpd)) {
+      LOG(ERROR) << "Failed to write MPD to string.";
+      publish_failed_ = true;
+      return false;
+    }
+  }
+
+  static const uint32_t telemetry_id =
+      Telemetry::Register(Telemetry::Category::kManifest, "MPD write");
+  bool success = false;
+  {
+    ScopedTelemetry telemetry(telemetry_id, 1, mpd.size());
+    success = File::WriteFileAtomically(output_path_.c_str(), mpd);
+  }
+  LOG_IF(ERROR, !success) << "Failed to write mpd to: " << output_path_;
+
   absl::MutexLock lock(&lock_);
-  return WriteMpdToFile(output_path_, mpd_builder_.get());
+  last_publish_time_ = absl::Now();
+  const absl::Duration latency = last_publish_time_ - request_time;
+  ++publish_stats_.num_mpd_writes;
+  publish_stats_.total_publish_latency += latency;
+  publish_stats_.max_publish_latency =
+      std::max(publish_stats_.max_publish_latency, latency);
+  if (!success)
+    publish_failed_ = true;
+  return success;
 }
 
 }  // namespace shaka
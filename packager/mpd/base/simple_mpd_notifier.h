@@ -14,6 +14,8 @@
 #include <vector>
 
 #include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
+#include <absl/time/time.h>
 
 #include <packager/mpd/base/mpd_notifier.h>
 #include <packager/mpd/base/mpd_notifier_util.h>
@@ -28,8 +30,22 @@ struct MpdOptions;
 
 /// A simple MpdNotifier implementation which receives muxer listener event and
 /// generates an Mpd file.
+/// For dynamic MPD, RequestFlush() hands the write over to a publisher task,
+/// which writes the MPD at most once per MpdParams::mpd_publish_interval, so
+/// the muxers do not wait for the MPD to be generated.
 class SimpleMpdNotifier : public MpdNotifier {
  public:
+  /// Statistics of the MPD publication.
+  struct PublishStats {
+    /// Number of flushes requested, including the synchronous ones.
+    uint64_t num_flush_requests = 0;
+    /// Number of times the MPD was written.
+    uint64_t num_mpd_writes = 0;
+    /// Time between the first request of a write and its completion.
+    absl::Duration max_publish_latency;
+    absl::Duration total_publish_latency;
+  };
+
   explicit SimpleMpdNotifier(const MpdOptions& mpd_options);
   ~SimpleMpdNotifier() override;
 
@@ -61,8 +77,12 @@ class SimpleMpdNotifier : public MpdNotifier {
   bool NotifyEndOfStream() override;
 
   bool Flush() override;
+  bool RequestFlush() override;
   /// @}
 
+  /// @return The statistics of the MPD publication so far.
+  PublishStats GetPublishStats();
+
  private:
   SimpleMpdNotifier(const SimpleMpdNotifier&) = delete;
   SimpleMpdNotifier& operator=(const SimpleMpdNotifier&) = delete;
@@ -77,17 +97,35 @@ class SimpleMpdNotifier : public MpdNotifier {
     mpd_builder_ = std::move(mpd_builder);
   }
 
+  void PublisherLoop();
+  // Generates and writes the MPD. |publish_lock_| must be held.
+  bool PublishMpd();
+
   // MPD output path.
   std::string output_path_;
   std::unique_ptr<MpdBuilder> mpd_builder_;
   bool content_protection_in_adaptation_set_ = true;
   absl::Mutex lock_;
+  // Serializes the MPD writes, so that an older MPD never replaces a newer
+  // one. Acquired before |lock_|.
+  absl::Mutex publish_lock_;
 
   uint32_t next_adaptation_set_id_ = 0;
   // Maps Representation ID to Representation.
   std::map<uint32_t, Representation*> representation_map_;
   // Maps Representation ID to AdaptationSet. This is for updating the PSSH.
   std::map<uint32_t, AdaptationSet*> representation_id_to_adaptation_set_;
+
+  // Publication state, guarded by |lock_|.
+  const absl::Duration publish_interval_;
+  bool publish_requested_ = false;
+  bool publish_failed_ = false;
+  bool stop_publisher_ = false;
+  absl::Time first_request_time_;
+  absl::Time last_publish_time_ = absl::InfinitePast();
+  PublishStats publish_stats_;
+  absl::CondVar publish_requested_cond_;
+  std::unique_ptr<absl::Notification> publisher_exited_;
 };
 
 }  // namespace shaka
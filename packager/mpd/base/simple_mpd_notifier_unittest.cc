@@ -484,4 +484,29 @@ TEST_F(SimpleMpdNotifierTest,
   EXPECT_TRUE(notifier.NotifyCueEvent(id3, kCueTimestamp));
 }
 
+// Verify that the flush requests for a dynamic MPD are coalesced.
+TEST_F(SimpleMpdNotifierTest, RequestFlushForDynamicMpd) {
+  MpdOptions mpd_options = empty_mpd_option_;
+  mpd_options.mpd_type = MpdType::kDynamic;
+  mpd_options.mpd_params.mpd_publish_interval = 3600;
+  SimpleMpdNotifier notifier(mpd_options);
+
+  std::unique_ptr<MockMpdBuilder> mock_mpd_builder(new MockMpdBuilder());
+  EXPECT_CALL(*mock_mpd_builder, ToString(_)).WillRepeatedly(Return(true));
+  SetMpdBuilder(&notifier, std::move(mock_mpd_builder));
+  ASSERT_TRUE(notifier.Init());
+
+  const uint64_t kNumRequests = 10;
+  for (uint64_t i = 0; i < kNumRequests; ++i)
+    EXPECT_TRUE(notifier.RequestFlush());
+  // At most one write is done before the interval elapses. The synchronous
+  // flush writes out the remaining requests.
+  EXPECT_TRUE(notifier.Flush());
+
+  const SimpleMpdNotifier::PublishStats stats = notifier.GetPublishStats();
+  EXPECT_EQ(kNumRequests + 1, stats.num_flush_requests);
+  EXPECT_GE(stats.num_mpd_writes, 1u);
+  EXPECT_LE(stats.num_mpd_writes, 2u);
+}
+
 }  // namespace shaka
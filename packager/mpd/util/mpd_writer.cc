@@ -7,13 +7,16 @@
 #include <packager/mpd/util/mpd_writer.h>
 
 #include <cstdint>
+#include <memory>
 
 #include <absl/flags/flag.h>
 #include <absl/log/check.h>
 #include <absl/log/log.h>
+#include <absl/synchronization/blocking_counter.h>
 #include <google/protobuf/text_format.h>
 
 #include <packager/file.h>
+#include <packager/file/work_stealing_executor.h>
 #include <packager/mpd/base/mpd_builder.h>
 #include <packager/mpd/base/mpd_notifier.h>
 #include <packager/mpd/base/mpd_utils.h>
@@ -40,29 +43,99 @@ class SimpleMpdNotifierFactory : public MpdNotifierFactory {
   }
 };
 
-}  // namespace
+// The text format only has printable characters and whitespace, while the
+// binary format has field tags and lengths below 0x20, e.g. for every string
+// and nested message shorter than 32 bytes, which practically every MediaInfo
+// has.
+bool IsTextFormat(const std::string& content) {
+  for (const char c : content) {
+    const unsigned char byte = static_cast<unsigned char>(c);
+    if (byte < 0x20 && byte != '\t' && byte != '\n' && byte != '\r')
+      return false;
+  }
+  return true;
+}
 
-MpdWriter::MpdWriter() : notifier_factory_(new SimpleMpdNotifierFactory()) {}
-MpdWriter::~MpdWriter() {}
+bool ParseTextFormat(const std::string& content, MediaInfo* media_info) {
+  return ::google::protobuf::TextFormat::ParseFromString(content, media_info);
+}
 
-bool MpdWriter::AddFile(const std::string& media_info_path) {
+bool ReadMediaInfoFromFile(const std::string& media_info_path,
+                           MediaInfo* media_info) {
   std::string file_content;
   if (!File::ReadFileToString(media_info_path.c_str(), &file_content)) {
     LOG(ERROR) << "Failed to read " << media_info_path << " to string.";
     return false;
   }
 
-  MediaInfo media_info;
-  if (!::google::protobuf::TextFormat::ParseFromString(file_content,
-                                                       &media_info)) {
-    LOG(ERROR) << "Failed to parse " << file_content << " to MediaInfo.";
+  // The detected format is tried first. A binary MediaInfo may happen to
+  // contain no control characters, and a text one may contain some, so the
+  // other format is tried if it fails.
+  const bool is_text = IsTextFormat(file_content);
+  bool parsed = is_text ? ParseTextFormat(file_content, media_info)
+                        : media_info->ParseFromString(file_content);
+  if (!parsed) {
+    media_info->Clear();
+    parsed = is_text ? media_info->ParseFromString(file_content)
+                     : ParseTextFormat(file_content, media_info);
+  }
+  if (!parsed) {
+    LOG(ERROR) << "Failed to parse " << media_info_path << " to MediaInfo.";
     return false;
   }
+  return true;
+}
 
-  media_infos_.push_back(media_info);
+}  // namespace
+
+MpdWriter::MpdWriter() : notifier_factory_(new SimpleMpdNotifierFactory()) {}
+MpdWriter::~MpdWriter() {}
+
+bool MpdWriter::AddFile(const std::string& media_info_path) {
+  MediaInfo media_info;
+  if (!ReadMediaInfoFromFile(media_info_path, &media_info))
+    return false;
+
+  media_infos_.push_back(std::move(media_info));
   return true;
 }
 
+bool MpdWriter::AddFiles(const std::vector<std::string>& media_info_paths,
+                         std::vector<std::string>* failed_paths) {
+  if (media_info_paths.empty())
+    return true;
+
+  // This thread parses the first file while the others are parsed on the
+  // executor.
+  std::vector<MediaInfo> media_infos(media_info_paths.size());
+  // Not a std::vector<bool>, whose elements cannot be set concurrently.
+  std::unique_ptr<bool[]> added(new bool[media_info_paths.size()]);
+  absl::BlockingCounter files_done(
+      static_cast<int>(media_info_paths.size() - 1));
+  WorkStealingExecutor* executor = WorkStealingExecutor::Cpu();
+  for (size_t i = 1; i < media_info_paths.size(); ++i) {
+    executor->PostTask(
+        [&media_info_paths, &media_infos, &added, &files_done, i]() {
+          added[i] = ReadMediaInfoFromFile(media_info_paths[i], &media_infos[i]);
+          files_done.DecrementCount();
+        });
+  }
+  added[0] = ReadMediaInfoFromFile(media_info_paths[0], &media_infos[0]);
+  files_done.Wait();
+
+  bool all_added = true;
+  for (size_t i = 0; i < media_info_paths.size(); ++i) {
+    if (added[i]) {
+      media_infos_.push_back(std::move(media_infos[i]));
+      continue;
+    }
+    all_added = false;
+    if (failed_paths)
+      failed_paths->push_back(media_info_paths[i]);
+  }
+  return all_added;
+}
+
 void MpdWriter::AddBaseUrl(const std::string& base_url) {
   base_urls_.push_back(base_url);
 }
@@ -51,12 +51,20 @@ class MpdWriter {
   ~MpdWriter();
 
   // Add |media_info_path| for MPD generation.
-  // The content of |media_info_path| should be a string representation of
-  // MediaInfo, i.e. the content should be a result of using
-  // google::protobuf::TestFormat::Print*() methods.
+  // The content of |media_info_path| should be a serialized MediaInfo, either
+  // a string representation, i.e. the result of using
+  // google::protobuf::TextFormat::Print*() methods, or the protobuf binary
+  // format. The format is detected from the content.
   // If necessary, this method can be called after WriteMpd*() methods.
   bool AddFile(const std::string& media_info_path);
 
+  // Same as calling AddFile() on each of |media_info_paths| in order, except
+  // that the files are read and parsed in parallel. The paths of the files
+  // which could not be added are appended to |failed_paths|, if not NULL.
+  // Returns true if all the files were added.
+  bool AddFiles(const std::vector<std::string>& media_info_paths,
+                std::vector<std::string>* failed_paths);
+
   // |base_url| will be used for <BaseURL> element for the MPD. The BaseURL
   // element will be a direct child element of the <MPD> element.
   void AddBaseUrl(const std::string& base_url);
@@ -7,11 +7,17 @@
 #include <packager/mpd/util/mpd_writer.h>
 
 #include <filesystem>
+#include <list>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <google/protobuf/text_format.h>
+
+#include <packager/file.h>
 #include <packager/file/file_test_util.h>
+#include <packager/mpd/base/media_info.pb.h>
 #include <packager/mpd/base/mock_mpd_notifier.h>
 #include <packager/mpd/base/mpd_options.h>
 #include <packager/mpd/test/mpd_builder_test_helper.h>
@@ -69,6 +75,10 @@ class MpdWriterTest : public ::testing::Test {
     mpd_writer_.SetMpdNotifierFactoryForTest(std::move(notifier_factory_));
   }
 
+  const std::list<MediaInfo>& media_infos() const {
+    return mpd_writer_.media_infos_;
+  }
+
   std::unique_ptr<TestMpdNotifierFactory> notifier_factory_;
   MpdWriter mpd_writer_;
 };
@@ -99,4 +109,64 @@ TEST_F(MpdWriterTest, WriteMpdToFile) {
   EXPECT_TRUE(mpd_writer_.WriteMpdToFile(temp->path().c_str()));
 }
 
+// Verify that text and binary MediaInfo files are added in order, and that
+// the files which cannot be read are reported.
+TEST_F(MpdWriterTest, AddFiles) {
+  const std::string text_file =
+      GetTestDataFilePath(kFileNameVideoMediaInfo1).string();
+  std::string text_content;
+  ASSERT_TRUE(File::ReadFileToString(text_file.c_str(), &text_content));
+  MediaInfo text_media_info;
+  ASSERT_TRUE(::google::protobuf::TextFormat::ParseFromString(
+      text_content, &text_media_info));
+
+  std::string binary_content;
+  ASSERT_TRUE(File::ReadFileToString(
+      GetTestDataFilePath(kFileNameVideoMediaInfo2).string().c_str(),
+      &binary_content));
+  MediaInfo binary_media_info;
+  ASSERT_TRUE(::google::protobuf::TextFormat::ParseFromString(
+      binary_content, &binary_media_info));
+  ASSERT_TRUE(binary_media_info.SerializeToString(&binary_content));
+  TempFile binary_file;
+  ASSERT_TRUE(File::WriteStringToFile(binary_file.path().c_str(),
+                                      binary_content));
+
+  const std::string missing_file = binary_file.path() + ".missing";
+  std::vector<std::string> failed_files;
+  EXPECT_FALSE(mpd_writer_.AddFiles(
+      {binary_file.path(), missing_file, text_file}, &failed_files));
+  EXPECT_EQ(std::vector<std::string>{missing_file}, failed_files);
+
+  ASSERT_EQ(2u, media_infos().size());
+  EXPECT_EQ(binary_media_info.SerializeAsString(),
+            media_infos().front().SerializeAsString());
+  EXPECT_EQ(text_media_info.SerializeAsString(),
+            media_infos().back().SerializeAsString());
+
+  SetMpdNotifierFactoryForTest();
+  TempFile mpd_file;
+  EXPECT_TRUE(mpd_writer_.WriteMpdToFile(mpd_file.path().c_str()));
+}
+
+// Verify that a binary MediaInfo without any control character, which looks
+// like the text format, is still parsed.
+TEST_F(MpdWriterTest, AddBinaryFileWithoutControlCharacters) {
+  MediaInfo media_info;
+  // The field tags, the varint and the string length are all printable.
+  media_info.set_reference_time_scale(10000);
+  media_info.set_media_file_name(std::string(40, 'a') + ".mp4");
+  std::string binary_content;
+  ASSERT_TRUE(media_info.SerializeToString(&binary_content));
+  for (const char c : binary_content)
+    ASSERT_GE(static_cast<unsigned char>(c), 0x20);
+  TempFile binary_file;
+  ASSERT_TRUE(File::WriteStringToFile(binary_file.path().c_str(),
+                                      binary_content));
+
+  EXPECT_TRUE(mpd_writer_.AddFile(binary_file.path()));
+  ASSERT_EQ(1u, media_infos().size());
+  EXPECT_EQ(binary_content, media_infos().front().SerializeAsString());
+}
+
 }  // namespace shaka
@@ -9,32 +9,44 @@
 #include <algorithm>
 #include <chrono>
 #include <optional>
+#include <set>
+#include <thread>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 #include <absl/strings/match.h>
+#include <absl/strings/numbers.h>
 #include <absl/strings/str_format.h>
+#include <absl/synchronization/notification.h>
 
 #include <packager/app/job_manager.h>
 #include <packager/app/muxer_factory.h>
 #include <packager/app/packager_util.h>
 #include <packager/app/single_thread_job_manager.h>
 #include <packager/file.h>
+#include <packager/file/http_connection_pool.h>
+#include <packager/file/http_upload_queue.h>
+#include <packager/file/work_stealing_executor.h>
 #include <packager/hls/base/hls_notifier.h>
 #include <packager/hls/base/simple_hls_notifier.h>
 #include <packager/macros/logging.h>
 #include <packager/macros/status.h>
+#include <packager/media/base/aes_cryptor.h>
 #include <packager/media/base/cc_stream_filter.h>
 #include <packager/media/base/language_utils.h>
 #include <packager/media/base/muxer.h>
 #include <packager/media/base/muxer_util.h>
+#include <packager/media/base/prefetching_key_source.h>
+#include <packager/media/base/threaded_queue_handler.h>
 #include <packager/media/chunking/chunking_handler.h>
 #include <packager/media/chunking/cue_alignment_handler.h>
 #include <packager/media/chunking/segment_coordinator.h>
+#include <packager/media/chunking/segment_partitioner.h>
 #include <packager/media/chunking/text_chunker.h>
 #include <packager/media/crypto/encryption_handler.h>
 #include <packager/media/demuxer/demuxer.h>
 #include <packager/media/event/muxer_listener_factory.h>
+#include <packager/media/event/partitioned_muxer_listener.h>
 #include <packager/media/event/vod_media_info_dump_muxer_listener.h>
 #include <packager/media/formats/ttml/ttml_to_mp4_handler.h>
 #include <packager/media/formats/webvtt/text_padder.h>
@@ -43,6 +55,7 @@
 #include <packager/media/trick_play/trick_play_handler.h>
 #include <packager/mpd/base/media_info.pb.h>
 #include <packager/mpd/base/simple_mpd_notifier.h>
+#include <packager/utils/telemetry.h>
 #include <packager/version/version.h>
 
 namespace shaka {
@@ -60,6 +73,10 @@ namespace {
 
 const char kMediaInfoSuffix[] = ".media_info";
 
+// Maximum number of stream data buffered in front of each output branch when
+// PackagingParams::parallel_outputs is set.
+const size_t kOutputQueueCapacity = 64;
+
 MuxerListenerFactory::StreamData ToMuxerListenerData(
     const StreamDescriptor& stream) {
   MuxerListenerFactory::StreamData data;
@@ -281,6 +298,24 @@ Status ValidateParams(const PackagingParams& packaging_params,
                   "Negative --start_segment_number is not allowed.");
   }
 
+  if (packaging_params.num_cpu_threads < 0 ||
+      packaging_params.num_io_threads < 0) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Negative --num_cpu_threads or --num_io_threads is not "
+                  "allowed.");
+  }
+
+  if (packaging_params.vod_partitions < 0) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Negative --vod_partitions is not allowed.");
+  }
+
+  if (packaging_params.ad_cue_generator_params
+          .max_buffered_duration_in_seconds < 0) {
+    return Status(error::INVALID_ARGUMENT,
+                  "Negative --ad_cue_max_buffered_duration is not allowed.");
+  }
+
   if (stream_descriptors.empty()) {
     return Status(error::INVALID_ARGUMENT,
                   "Stream descriptors cannot be empty.");
@@ -460,6 +495,7 @@ Status CreateDemuxer(const StreamDescriptor& stream,
   std::shared_ptr<Demuxer> demuxer = std::make_shared<Demuxer>(stream.input);
   demuxer->set_dump_stream_info(packaging_params.test_params.dump_stream_info);
   demuxer->set_input_format(stream.input_format);
+  demuxer->set_map_input(packaging_params.mmap_inputs);
 
   if (packaging_params.decryption_params.key_provider != KeyProvider::kNone) {
     std::unique_ptr<KeySource> decryption_key_source(
@@ -476,7 +512,7 @@ Status CreateDemuxer(const StreamDescriptor& stream,
   return Status::OK;
 }
 
-std::shared_ptr<MediaHandler> CreateEncryptionHandler(
+std::shared_ptr<EncryptionHandler> CreateEncryptionHandler(
     const PackagingParams& packaging_params,
     const StreamDescriptor& stream,
     KeySource* key_source) {
@@ -585,11 +621,241 @@ Status CreateTtmlJobs(
 
       if (packaging_params.output_media_info) {
         VodMediaInfoDumpMuxerListener::WriteMediaInfoToFile(
-            text_media_info, stream.output + kMediaInfoSuffix);
+            text_media_info, stream.output + kMediaInfoSuffix,
+            packaging_params.output_media_info_binary);
+      }
+    }
+  }
+
+  return Status::OK;
+}
+
+// Returns the maximum number of partitions the streams of an input can be
+// packaged in, see PackagingParams::vod_partitions.
+size_t GetMaxVodPartitions(
+    const std::vector<std::reference_wrapper<const StreamDescriptor>>&
+        input_streams,
+    const PackagingParams& packaging_params,
+    bool has_sync_points) {
+  if (packaging_params.single_threaded ||
+      packaging_params.vod_partitions == 1 || has_sync_points ||
+      packaging_params.chunking_params.low_latency_dash_mode) {
+    return 1;
+  }
+
+  // Segments are only reported to the manifests once every partition is
+  // packaged, which only works with static manifests.
+  const MpdParams& mpd_params = packaging_params.mpd_params;
+  if (!mpd_params.mpd_output.empty() && !mpd_params.generate_static_live_mpd)
+    return 1;
+  const HlsParams& hls_params = packaging_params.hls_params;
+  if (!hls_params.master_playlist_output.empty() &&
+      hls_params.playlist_type != HlsPlaylistType::kVod) {
+    return 1;
+  }
+
+  const EncryptionParams& encryption_params =
+      packaging_params.encryption_params;
+  if (encryption_params.key_provider != KeyProvider::kNone) {
+    if (encryption_params.crypto_period_duration_in_seconds !=
+        EncryptionParams::kNoKeyRotation) {
+      return 1;
+    }
+    // An explicit IV is only used from the start of the output.
+    if (!encryption_params.raw_key.iv.empty())
+      return 1;
+    for (const auto& entry : encryption_params.raw_key.key_map) {
+      if (!entry.second.iv.empty())
+        return 1;
+    }
+  }
+
+  for (const StreamDescriptor& stream : input_streams) {
+    if (stream.segment_template.empty() ||
+        GetOutputFormat(stream) != CONTAINER_MOV || stream.trick_play_factor ||
+        stream.cc_index >= 0 || IsTextStream(stream)) {
+      return 1;
+    }
+  }
+
+  if (packaging_params.vod_partitions > 0)
+    return packaging_params.vod_partitions;
+  if (packaging_params.num_cpu_threads > 0)
+    return packaging_params.num_cpu_threads;
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Returns the index of the timeline of the stream selected by
+// |stream_selector|, the same way Demuxer selects it, or -1 if there is none.
+int FindTimeline(const std::vector<StreamTimeline>& timelines,
+                 const std::string& stream_selector) {
+  StreamType stream_type = kStreamUnknown;
+  if (stream_selector == "video") {
+    stream_type = kStreamVideo;
+  } else if (stream_selector == "audio") {
+    stream_type = kStreamAudio;
+  } else {
+    size_t index = 0;
+    if (!absl::SimpleAtoi(stream_selector, &index) ||
+        index >= timelines.size()) {
+      return -1;
+    }
+    return static_cast<int>(index);
+  }
+  for (size_t i = 0; i < timelines.size(); ++i) {
+    if (timelines[i].stream_info->stream_type() == stream_type)
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+
+// Package the streams of a VOD input in partitions, each with a demuxer and a
+// pipeline of its own, see SegmentPartitionPlan.
+// |packaged| is set to false if the input is to be packaged as a whole.
+Status CreatePartitionedJobs(
+    const std::vector<std::reference_wrapper<const StreamDescriptor>>&
+        input_streams,
+    const PackagingParams& packaging_params,
+    size_t max_partitions,
+    KeySource* encryption_key_source,
+    MuxerListenerFactory* muxer_listener_factory,
+    MuxerFactory* muxer_factory,
+    JobManager* job_manager,
+    bool* packaged) {
+  DCHECK(!input_streams.empty());
+  DCHECK(packaged);
+  *packaged = false;
+  const std::string& input = input_streams.front().get().input;
+
+  std::vector<StreamTimeline> timelines;
+  {
+    std::shared_ptr<Demuxer> demuxer;
+    RETURN_IF_ERROR(
+        CreateDemuxer(input_streams.front(), packaging_params, &demuxer));
+    Status status = demuxer->ReadTimelines(&timelines);
+    if (status.error_code() == error::UNIMPLEMENTED) {
+      LOG(INFO) << status.error_message() << " Packaging it as a whole.";
+      return Status::OK;
+    }
+    RETURN_IF_ERROR(status);
+  }
+
+  std::vector<int> stream_timelines;
+  for (const StreamDescriptor& stream : input_streams) {
+    const int timeline = FindTimeline(timelines, stream.stream_selector);
+    if (timeline < 0)
+      return Status::OK;
+    stream_timelines.push_back(timeline);
+  }
+
+  const EncryptionParams& encryption_params =
+      packaging_params.encryption_params;
+  const double clear_lead_in_seconds =
+      encryption_key_source ? encryption_params.clear_lead_in_seconds : 0;
+  SegmentPartitionPlan plan;
+  RETURN_IF_ERROR(PartitionSegments(timelines, packaging_params.chunking_params,
+                                    max_partitions, clear_lead_in_seconds,
+                                    &plan));
+  const size_t num_partitions = plan.num_partitions();
+  if (num_partitions <= 1)
+    return Status::OK;
+  LOG(INFO) << "Packaging " << input << " in " << num_partitions
+            << " partitions.";
+
+  // A constant IV is stored in the init segment, so every partition uses the
+  // same one. Per-sample IVs are random in each partition instead.
+  std::vector<uint8_t> iv;
+  if (encryption_key_source && encryption_params.protection_scheme ==
+                                   EncryptionParams::kProtectionSchemeCbcs) {
+    if (!AesCryptor::GenerateRandomIv(FOURCC_cbcs, &iv))
+      return Status(error::INTERNAL_ERROR, "Failed to generate random iv.");
+  }
+
+  // The listeners of the partitions of each output.
+  std::vector<std::vector<std::unique_ptr<MuxerListener>>> muxer_listeners;
+  for (const StreamDescriptor& stream : input_streams) {
+    muxer_listeners.push_back(
+        PartitionedMuxerListener::CreatePartitionListeners(
+            muxer_listener_factory->CreateListener(ToMuxerListenerData(stream)),
+            num_partitions));
+  }
+
+  for (size_t p = 0; p < num_partitions; ++p) {
+    std::shared_ptr<Demuxer> demuxer;
+    RETURN_IF_ERROR(
+        CreateDemuxer(input_streams.front(), packaging_params, &demuxer));
+    std::map<uint32_t, SampleRange> sample_ranges;
+    for (const SegmentPartitionPlan::Stream& plan_stream : plan.streams) {
+      const StreamPartition& partition = plan_stream.partitions[p];
+      sample_ranges[plan_stream.track_id] = {partition.first_sample,
+                                             partition.end_sample};
+    }
+    demuxer->SetSampleRanges(std::move(sample_ranges));
+    job_manager->Add("RemuxJob", demuxer);
+
+    // The clear lead is entirely in the first partition.
+    PackagingParams partition_params = packaging_params;
+    if (p > 0)
+      partition_params.encryption_params.clear_lead_in_seconds = 0;
+
+    auto segment_coordinator = std::make_shared<SegmentCoordinator>();
+    std::shared_ptr<MediaHandler> replicator;
+    std::string previous_selector;
+
+    for (size_t i = 0; i < input_streams.size(); ++i) {
+      const StreamDescriptor& stream = input_streams[i];
+      const SegmentPartitionPlan::Stream& plan_stream =
+          plan.streams[stream_timelines[i]];
+      const StreamPartition& partition = plan_stream.partitions[p];
+
+      if (i == 0 || previous_selector != stream.stream_selector) {
+        previous_selector = stream.stream_selector;
+        if (!stream.language.empty())
+          demuxer->SetLanguageOverride(stream.stream_selector, stream.language);
+
+        ChunkingParams chunking_params = packaging_params.chunking_params;
+        chunking_params.start_segment_number = partition.start_segment_number;
+        std::shared_ptr<EncryptionHandler> encryption_handler =
+            CreateEncryptionHandler(partition_params, stream,
+                                    encryption_key_source);
+        if (encryption_handler)
+          encryption_handler->OverrideIv(iv);
+        auto chunker = std::make_shared<ChunkingHandler>(chunking_params);
+        replicator = std::make_shared<Replicator>();
+
+        RETURN_IF_ERROR(MediaHandler::Chain(
+            {chunker, segment_coordinator, encryption_handler, replicator}));
+        RETURN_IF_ERROR(demuxer->SetHandler(stream.stream_selector, chunker));
       }
+
+      MuxerOptions::Partition muxer_partition;
+      muxer_partition.is_first = p == 0;
+      muxer_partition.first_fragment_sequence_number =
+          1 + partition.fragments_before;
+      muxer_partition.first_pts = plan_stream.first_pts;
+      muxer_partition.first_dts = plan_stream.first_dts;
+      muxer_partition.duration = plan_stream.duration;
+      std::shared_ptr<Muxer> muxer = muxer_factory->CreateMuxer(
+          GetOutputFormat(stream), stream, muxer_partition);
+      if (!muxer) {
+        return Status(error::INVALID_ARGUMENT, "Failed to create muxer for " +
+                                                   stream.input + ":" +
+                                                   stream.stream_selector);
+      }
+      muxer->SetMuxerListener(std::move(muxer_listeners[i][p]));
+
+      std::vector<std::shared_ptr<MediaHandler>> handlers;
+      handlers.emplace_back(replicator);
+      if (packaging_params.parallel_outputs) {
+        handlers.emplace_back(
+            std::make_shared<ThreadedQueueHandler>(kOutputQueueCapacity));
+      }
+      handlers.emplace_back(muxer);
+      RETURN_IF_ERROR(MediaHandler::Chain(handlers));
     }
   }
 
+  *packaged = true;
   return Status::OK;
 }
 
@@ -612,7 +878,29 @@ Status CreateAudioVideoJobs(
   std::map<std::string, std::shared_ptr<SegmentCoordinator>>
       segment_coordinators;
 
+  // VOD inputs packaged in partitions instead of as a whole.
+  std::set<std::string> partitioned_inputs;
+  std::map<std::string,
+           std::vector<std::reference_wrapper<const StreamDescriptor>>>
+      input_streams;
+  for (const StreamDescriptor& stream : streams)
+    input_streams[stream.input].push_back(stream);
+  for (const auto& entry : input_streams) {
+    const size_t max_partitions = GetMaxVodPartitions(
+        entry.second, packaging_params, sync_points != nullptr);
+    if (max_partitions <= 1)
+      continue;
+    bool packaged = false;
+    RETURN_IF_ERROR(CreatePartitionedJobs(
+        entry.second, packaging_params, max_partitions, encryption_key_source,
+        muxer_listener_factory, muxer_factory, job_manager, &packaged));
+    if (packaged)
+      partitioned_inputs.insert(entry.first);
+  }
+
   for (const StreamDescriptor& stream : streams) {
+    if (partitioned_inputs.count(stream.input) > 0)
+      continue;
     bool seen_input_before = sources.find(stream.input) != sources.end();
     if (seen_input_before) {
       continue;
@@ -621,7 +909,8 @@ Status CreateAudioVideoJobs(
     RETURN_IF_ERROR(
         CreateDemuxer(stream, packaging_params, &sources[stream.input]));
     cue_aligners[stream.input] =
-        sync_points ? std::make_shared<CueAlignmentHandler>(sync_points)
+        sync_points ? std::make_shared<CueAlignmentHandler>(
+                          sync_points, packaging_params.ad_cue_generator_params)
                     : nullptr;
     segment_coordinators[stream.input] = std::make_shared<SegmentCoordinator>();
   }
@@ -641,6 +930,9 @@ Status CreateAudioVideoJobs(
   std::map<std::string, size_t> stream_counters;
 
   for (const StreamDescriptor& stream : streams) {
+    if (partitioned_inputs.count(stream.input) > 0)
+      continue;
+
     // Get the demuxer for this stream.
     auto& demuxer = sources[stream.input];
     auto& cue_aligner = cue_aligners[stream.input];
@@ -727,6 +1019,13 @@ Status CreateAudioVideoJobs(
     std::vector<std::shared_ptr<MediaHandler>> handlers;
     handlers.emplace_back(replicator);
 
+    // Run each output branch on its own thread, decoupled from the demuxing
+    // thread by a bounded queue.
+    if (packaging_params.parallel_outputs && !packaging_params.single_threaded) {
+      handlers.emplace_back(
+          std::make_shared<ThreadedQueueHandler>(kOutputQueueCapacity));
+    }
+
     // Trick play is optional.
     if (stream.trick_play_factor) {
       handlers.emplace_back(
@@ -838,9 +1137,59 @@ Status CreateAllJobs(const std::vector<StreamDescriptor>& stream_descriptors,
 }  // namespace
 }  // namespace media
 
+namespace {
+
+bool WriteTelemetry(const TelemetryParams& telemetry_params) {
+  const std::string stats =
+      Telemetry::Format(Telemetry::GetStats(), telemetry_params.format);
+  if (!File::WriteFileAtomically(telemetry_params.output.c_str(), stats)) {
+    LOG(ERROR) << "Failed to write telemetry to " << telemetry_params.output;
+    return false;
+  }
+  return true;
+}
+
+void LogHttpConnectionStats() {
+  const HttpConnectionPool::Stats stats =
+      HttpConnectionPool::GetInstance()->GetStats();
+  if (stats.requests == 0)
+    return;
+  LOG(INFO) << "HTTP: " << stats.requests << " requests ("
+            << stats.failed_requests << " failed), " << stats.new_connections
+            << " connections made (" << stats.tls_connections << " TLS), "
+            << stats.reused_connections << " requests on reused connections, "
+            << stats.http2_requests << " over HTTP/2.";
+}
+
+void LogHttpUploadQueueStats(HttpUploadQueue* upload_queue) {
+  const HttpUploadQueue::Stats stats = upload_queue->GetStats();
+  LOG(INFO) << "HTTP upload queue: " << stats.files_uploaded << " files and "
+            << stats.manifests_uploaded << " manifests uploaded ("
+            << stats.manifests_replaced << " manifest versions skipped), "
+            << stats.bytes_uploaded << " bytes, " << stats.retries
+            << " retries, " << stats.failed_uploads << " failures, up to "
+            << stats.max_queued_bytes << " bytes queued, "
+            << stats.writer_waits << " waits on a full queue.";
+}
+
+void LogKeyPrefetchStats(media::PrefetchingKeySource* key_source) {
+  const media::PrefetchingKeySource::Stats stats = key_source->GetStats();
+  LOG(INFO) << "Key prefetch: " << stats.keys_requested << " keys requested, "
+            << stats.keys_prefetched << " fetched ahead, "
+            << stats.keys_fetched << " fetches, " << stats.keys_evicted
+            << " evicted, " << stats.prefetches_failed
+            << " failed prefetches, " << stats.stalls << " stalls for "
+            << stats.stall_time << ".";
+}
+
+}  // namespace
+
 struct Packager::PackagerInternal {
+  TelemetryParams telemetry_params;
   std::shared_ptr<media::FakeClock> fake_clock;
   std::unique_ptr<KeySource> encryption_key_source;
+  // Points to |encryption_key_source| if the keys are prefetched.
+  media::PrefetchingKeySource* prefetching_key_source = nullptr;
   std::unique_ptr<MpdNotifier> mpd_notifier;
   std::unique_ptr<hls::HlsNotifier> hls_notifier;
   BufferCallbackParams buffer_callback_params;
@@ -864,8 +1213,17 @@ Status Packager::Initialize(
         packaging_params.test_params.injected_library_version);
   }
 
+  WorkStealingExecutor::SetDefaultNumWorkers(packaging_params.num_cpu_threads,
+                                             packaging_params.num_io_threads);
+
   std::unique_ptr<PackagerInternal> internal(new PackagerInternal);
 
+  internal->telemetry_params = packaging_params.telemetry_params;
+  if (internal->telemetry_params.enabled ||
+      !internal->telemetry_params.output.empty()) {
+    Telemetry::Enable();
+  }
+
   // Create encryption key source if needed.
   if (packaging_params.encryption_params.key_provider != KeyProvider::kNone) {
     internal->encryption_key_source = CreateEncryptionKeySource(
@@ -874,6 +1232,20 @@ Status Packager::Initialize(
         packaging_params.encryption_params);
     if (!internal->encryption_key_source)
       return Status(error::INVALID_ARGUMENT, "Failed to create key source.");
+
+    const EncryptionParams& encryption_params =
+        packaging_params.encryption_params;
+    if (encryption_params.crypto_period_duration_in_seconds > 0 &&
+        encryption_params.crypto_period_prefetch_count > 0) {
+      media::PrefetchingKeySource::Options options;
+      options.prefetch_count = encryption_params.crypto_period_prefetch_count;
+      options.max_cached_keys = std::max(
+          options.max_cached_keys,
+          static_cast<size_t>(2 * options.prefetch_count + 2));
+      internal->prefetching_key_source = new media::PrefetchingKeySource(
+          std::move(internal->encryption_key_source), options);
+      internal->encryption_key_source.reset(internal->prefetching_key_source);
+    }
   }
 
   // Update MPD output and HLS output if needed.
@@ -935,6 +1307,11 @@ Status Packager::Initialize(
 
   if (!hls_params.master_playlist_output.empty()) {
     internal->hls_notifier.reset(new hls::SimpleHlsNotifier(hls_params));
+    if (!internal->hls_notifier->Init()) {
+      LOG(ERROR) << "HlsNotifier failed to initialize.";
+      return Status(error::INVALID_ARGUMENT,
+                    "Failed to initialize HlsNotifier.");
+    }
   }
 
   std::unique_ptr<SyncPointQueue> sync_points;
@@ -988,6 +1365,7 @@ Status Packager::Initialize(
 
   media::MuxerListenerFactory muxer_listener_factory(
       packaging_params.output_media_info,
+      packaging_params.output_media_info_binary,
       packaging_params.mpd_params.use_segment_list,
       internal->mpd_notifier.get(), internal->hls_notifier.get());
 
@@ -1005,17 +1383,49 @@ Status Packager::Run() {
   if (!internal_)
     return Status(error::INVALID_ARGUMENT, "Not yet initialized.");
 
-  RETURN_IF_ERROR(internal_->job_manager->RunJobs());
+  const TelemetryParams& telemetry_params = internal_->telemetry_params;
+  absl::Notification telemetry_done;
+  std::thread telemetry_writer;
+  if (!telemetry_params.output.empty() &&
+      telemetry_params.snapshot_interval_seconds > 0) {
+    telemetry_writer = std::thread([&telemetry_params, &telemetry_done]() {
+      const absl::Duration interval =
+          absl::Seconds(telemetry_params.snapshot_interval_seconds);
+      while (!telemetry_done.WaitForNotificationWithTimeout(interval))
+        WriteTelemetry(telemetry_params);
+    });
+  }
+
+  Status status = internal_->job_manager->RunJobs();
 
-  if (internal_->hls_notifier) {
+  if (status.ok() && internal_->hls_notifier) {
     if (!internal_->hls_notifier->Flush())
-      return Status(error::INVALID_ARGUMENT, "Failed to flush Hls.");
+      status = Status(error::INVALID_ARGUMENT, "Failed to flush Hls.");
   }
-  if (internal_->mpd_notifier) {
+  if (status.ok() && internal_->mpd_notifier) {
     if (!internal_->mpd_notifier->Flush())
-      return Status(error::INVALID_ARGUMENT, "Failed to flush Mpd.");
+      status = Status(error::INVALID_ARGUMENT, "Failed to flush Mpd.");
   }
-  return Status::OK;
+  // The outputs are only complete once uploaded.
+  if (HttpUploadQueue* upload_queue = HttpUploadQueue::GetInstance()) {
+    Status upload_status = upload_queue->Flush();
+    if (status.ok())
+      status = upload_status;
+    if (VLOG_IS_ON(1))
+      LogHttpUploadQueueStats(upload_queue);
+  }
+  if (VLOG_IS_ON(1) && internal_->prefetching_key_source)
+    LogKeyPrefetchStats(internal_->prefetching_key_source);
+  if (VLOG_IS_ON(1))
+    LogHttpConnectionStats();
+
+  if (telemetry_writer.joinable()) {
+    telemetry_done.Notify();
+    telemetry_writer.join();
+  }
+  if (!telemetry_params.output.empty())
+    WriteTelemetry(telemetry_params);
+  return status;
 }
 
 void Packager::Cancel() {
@@ -1026,6 +1436,10 @@ void Packager::Cancel() {
   internal_->job_manager->CancelJobs();
 }
 
+PipelineStats Packager::GetPipelineStats() const {
+  return Telemetry::GetStats();
+}
+
 std::string Packager::GetLibraryVersion() {
   return GetPackagerVersion();
 }
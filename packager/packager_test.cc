@@ -10,6 +10,8 @@
 #include <regex>
 
 #include <absl/log/log.h>
+#include <absl/strings/match.h>
+#include <absl/synchronization/notification.h>
 #include <packager/file.h>
 #include <packager/packager.h>
 
@@ -32,6 +34,8 @@ const char kOutputVideoTemplate[] = "output_video_$Number$.m4s";
 const char kOutputAudio[] = "output_audio.mp4";
 const char kOutputAudioTemplate[] = "output_audio_$Number$.m4s";
 const char kOutputMpd[] = "output.mpd";
+const char kOutputMasterPlaylist[] = "master.m3u8";
+const char kOutputVideoPlaylist[] = "video.m3u8";
 
 const double kSegmentDurationInSeconds = 1.0;
 const uint8_t kKeyId[] = {
@@ -293,6 +297,50 @@ TEST_F(PackagerTest, LowLatencyDashEnabledAndUtcTimingNotSet) {
               HasSubstr("--utc_timings must be be set"));
 }
 
+TEST_F(PackagerTest, PublishesLiveHlsPlaylistsWhilePackaging) {
+  auto packaging_params = SetupPackagingParams();
+  packaging_params.mpd_params.mpd_output.clear();
+  packaging_params.hls_params.playlist_type = HlsPlaylistType::kLive;
+  packaging_params.hls_params.master_playlist_output =
+      GetFullPath(kOutputMasterPlaylist);
+
+  // The media playlist has to be published before the end of the run, so the
+  // write of a later segment waits for it.
+  absl::Notification playlist_written;
+  bool waited_for_playlist = false;
+  bool playlist_written_before_segment = false;
+  packaging_params.buffer_callback_params.write_func =
+      [&playlist_written, &waited_for_playlist,
+       &playlist_written_before_segment](const std::string& name, const void*,
+                                         uint64_t length) {
+        if (absl::EndsWith(name, kOutputVideoPlaylist)) {
+          if (!playlist_written.HasBeenNotified())
+            playlist_written.Notify();
+        } else if (absl::EndsWith(name, "output_video_4.m4s") &&
+                   !waited_for_playlist) {
+          waited_for_playlist = true;
+          playlist_written_before_segment =
+              playlist_written.WaitForNotificationWithTimeout(
+                  absl::Seconds(10));
+        }
+        return static_cast<int64_t>(length);
+      };
+
+  std::vector<StreamDescriptor> stream_descriptors;
+  StreamDescriptor stream_descriptor;
+  stream_descriptor.input = kTestFile;
+  stream_descriptor.stream_selector = "video";
+  stream_descriptor.segment_template = GetFullPath(kOutputVideoTemplate);
+  stream_descriptor.hls_playlist_name = kOutputVideoPlaylist;
+  stream_descriptors.push_back(stream_descriptor);
+
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(packaging_params, stream_descriptors));
+  ASSERT_EQ(Status::OK, packager.Run());
+  EXPECT_TRUE(playlist_written_before_segment);
+}
+
 namespace {
 
 // Helper to extract SegmentTimeline entries from an AdaptationSet in MPD XML.
@@ -0,0 +1,488 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/telemetry.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/log/log.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_format.h>
+#include <absl/synchronization/mutex.h>
+
+namespace shaka {
+namespace {
+
+// Up to kMaxChunks * kEntriesPerChunk entries. The counters of a thread are
+// allocated a chunk at a time, as entries get used.
+const uint32_t kEntriesPerChunk = 64;
+const uint32_t kMaxChunks = 64;
+const uint32_t kMaxEntries = kEntriesPerChunk * kMaxChunks;
+
+struct Totals {
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+  uint64_t time_ns = 0;
+  uint64_t flushes = 0;
+  uint64_t flush_time_ns = 0;
+  uint64_t max_queue_depth = 0;
+  uint64_t dropped = 0;
+};
+
+// The counters of an entry on one thread. Only the owning thread writes them,
+// but snapshots read them from other threads, hence the atomics.
+struct Counters {
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<uint64_t> time_ns{0};
+  std::atomic<uint64_t> flushes{0};
+  std::atomic<uint64_t> flush_time_ns{0};
+  std::atomic<uint64_t> max_queue_depth{0};
+  std::atomic<uint64_t> dropped{0};
+
+  void Reset() {
+    count.store(0, std::memory_order_relaxed);
+    bytes.store(0, std::memory_order_relaxed);
+    time_ns.store(0, std::memory_order_relaxed);
+    flushes.store(0, std::memory_order_relaxed);
+    flush_time_ns.store(0, std::memory_order_relaxed);
+    max_queue_depth.store(0, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+  }
+
+  void AddTo(Totals* totals) const {
+    totals->count += count.load(std::memory_order_relaxed);
+    totals->bytes += bytes.load(std::memory_order_relaxed);
+    totals->time_ns += time_ns.load(std::memory_order_relaxed);
+    totals->flushes += flushes.load(std::memory_order_relaxed);
+    totals->flush_time_ns += flush_time_ns.load(std::memory_order_relaxed);
+    totals->max_queue_depth =
+        std::max(totals->max_queue_depth,
+                 max_queue_depth.load(std::memory_order_relaxed));
+    totals->dropped += dropped.load(std::memory_order_relaxed);
+  }
+};
+
+// Single writer increment, cheaper than fetch_add.
+void Increment(std::atomic<uint64_t>* counter, uint64_t value) {
+  counter->store(counter->load(std::memory_order_relaxed) + value,
+                 std::memory_order_relaxed);
+}
+
+class ThreadCounters;
+
+struct EntryKey {
+  Telemetry::Category category;
+  std::string name;
+  int32_t stream_index;
+
+  bool operator<(const EntryKey& other) const {
+    return std::tie(category, name, stream_index) <
+           std::tie(other.category, other.name, other.stream_index);
+  }
+};
+
+struct Registry {
+  absl::Mutex mutex;
+  std::vector<EntryKey> entries ABSL_GUARDED_BY(mutex);
+  // Released entries are not reported, and their ids are reused.
+  std::vector<bool> released ABSL_GUARDED_BY(mutex);
+  std::vector<uint32_t> free_ids ABSL_GUARDED_BY(mutex);
+  std::map<EntryKey, uint32_t> ids ABSL_GUARDED_BY(mutex);
+  // Instance numbers in use, by base name.
+  std::map<std::string, std::set<int>> instances ABSL_GUARDED_BY(mutex);
+  bool warned_full ABSL_GUARDED_BY(mutex) = false;
+  std::set<ThreadCounters*> threads ABSL_GUARDED_BY(mutex);
+  // Counters of the threads which have exited.
+  std::vector<Totals> retired ABSL_GUARDED_BY(mutex);
+  std::chrono::steady_clock::time_point start_time ABSL_GUARDED_BY(mutex);
+  bool started ABSL_GUARDED_BY(mutex) = false;
+};
+
+Registry* GetRegistry() {
+  // Never destroyed, as threads may exit after static destruction.
+  static Registry* registry = new Registry;
+  return registry;
+}
+
+class ThreadCounters {
+ public:
+  ThreadCounters() {
+    for (std::atomic<Counters*>& chunk : chunks_)
+      chunk.store(nullptr, std::memory_order_relaxed);
+    Registry* registry = GetRegistry();
+    absl::MutexLock lock(&registry->mutex);
+    registry->threads.insert(this);
+  }
+
+  ~ThreadCounters() {
+    Registry* registry = GetRegistry();
+    {
+      absl::MutexLock lock(&registry->mutex);
+      registry->threads.erase(this);
+      if (registry->retired.size() < kMaxEntries)
+        registry->retired.resize(kMaxEntries);
+      AddTo(&registry->retired);
+    }
+    for (std::atomic<Counters*>& chunk : chunks_)
+      delete[] chunk.load(std::memory_order_relaxed);
+  }
+
+  Counters* Get(uint32_t id) {
+    std::atomic<Counters*>& chunk = chunks_[id / kEntriesPerChunk];
+    Counters* counters = chunk.load(std::memory_order_relaxed);
+    if (!counters) {
+      counters = new Counters[kEntriesPerChunk];
+      chunk.store(counters, std::memory_order_release);
+    }
+    return &counters[id % kEntriesPerChunk];
+  }
+
+  // Called with the registry mutex held, when |id| is reused. Its previous
+  // owner is gone, so this thread does not write to it concurrently.
+  void Reset(uint32_t id) {
+    Counters* counters =
+        chunks_[id / kEntriesPerChunk].load(std::memory_order_acquire);
+    if (counters)
+      counters[id % kEntriesPerChunk].Reset();
+  }
+
+  // Called with the registry mutex held.
+  void AddTo(std::vector<Totals>* totals) const {
+    for (uint32_t i = 0; i < kMaxChunks; ++i) {
+      const Counters* counters = chunks_[i].load(std::memory_order_acquire);
+      if (!counters)
+        continue;
+      for (uint32_t j = 0; j < kEntriesPerChunk; ++j) {
+        const uint32_t id = i * kEntriesPerChunk + j;
+        if (id < totals->size())
+          counters[j].AddTo(&(*totals)[id]);
+      }
+    }
+  }
+
+ private:
+  ThreadCounters(const ThreadCounters&) = delete;
+  ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+  std::atomic<Counters*> chunks_[kMaxChunks];
+};
+
+ThreadCounters* GetThreadCounters() {
+  thread_local std::unique_ptr<ThreadCounters> thread_counters(
+      new ThreadCounters);
+  return thread_counters.get();
+}
+
+// Time spent in the instrumented operations nested in the innermost active
+// ScopedTelemetry of this thread.
+thread_local int64_t g_nested_ns = 0;
+
+const char* CategoryName(Telemetry::Category category) {
+  switch (category) {
+    case Telemetry::Category::kHandler:
+      return "handler";
+    case Telemetry::Category::kFile:
+      return "file";
+    case Telemetry::Category::kManifest:
+      return "manifest";
+  }
+  return "unknown";
+}
+
+std::string EscapeString(const std::string& value) {
+  std::string escaped;
+  for (char c : value) {
+    if (c == '"' || c == '\\')
+      escaped += '\\';
+    escaped += c;
+  }
+  return escaped;
+}
+
+std::string FormatJson(const PipelineStats& stats) {
+  std::string json =
+      absl::StrFormat("{\n  \"elapsed_seconds\": %.3f,\n  \"entries\": [",
+                      stats.elapsed_seconds);
+  const double elapsed = std::max(stats.elapsed_seconds, 1e-9);
+  for (size_t i = 0; i < stats.entries.size(); ++i) {
+    const PipelineStats::Entry& entry = stats.entries[i];
+    absl::StrAppendFormat(
+        &json,
+        "%s\n    {\"category\": \"%s\", \"name\": \"%s\", "
+        "\"stream_index\": %d, \"count\": %u, \"bytes\": %u, "
+        "\"time_us\": %u, \"flushes\": %u, \"flush_time_us\": %u, "
+        "\"max_queue_depth\": %u, \"dropped\": %u, "
+        "\"count_per_second\": %.3f, \"bytes_per_second\": %.3f}",
+        i == 0 ? "" : ",", EscapeString(entry.category),
+        EscapeString(entry.name), entry.stream_index, entry.count, entry.bytes,
+        entry.time_us, entry.flushes, entry.flush_time_us,
+        entry.max_queue_depth, entry.dropped, entry.count / elapsed,
+        entry.bytes / elapsed);
+  }
+  json += "\n  ]\n}\n";
+  return json;
+}
+
+std::string FormatPrometheus(const PipelineStats& stats) {
+  struct Metric {
+    const char* name;
+    const char* type;
+    const char* help;
+    uint64_t PipelineStats::Entry::*field;
+    double scale;
+  };
+  const Metric kMetrics[] = {
+      {"count_total", "counter", "Samples or operations processed.",
+       &PipelineStats::Entry::count, 1},
+      {"bytes_total", "counter", "Bytes processed.",
+       &PipelineStats::Entry::bytes, 1},
+      {"time_seconds_total", "counter", "Time spent processing.",
+       &PipelineStats::Entry::time_us, 1e-6},
+      {"flushes_total", "counter", "Flush requests handled.",
+       &PipelineStats::Entry::flushes, 1},
+      {"flush_time_seconds_total", "counter", "Time spent flushing.",
+       &PipelineStats::Entry::flush_time_us, 1e-6},
+      {"max_queue_depth", "gauge", "Largest queue depth observed.",
+       &PipelineStats::Entry::max_queue_depth, 1},
+      {"dropped_total", "counter", "Samples or datagrams dropped.",
+       &PipelineStats::Entry::dropped, 1},
+  };
+
+  std::string text = absl::StrFormat(
+      "# HELP shaka_packager_elapsed_seconds Time since telemetry started.\n"
+      "# TYPE shaka_packager_elapsed_seconds gauge\n"
+      "shaka_packager_elapsed_seconds %.3f\n",
+      stats.elapsed_seconds);
+  for (const Metric& metric : kMetrics) {
+    absl::StrAppendFormat(&text,
+                          "# HELP shaka_packager_%s %s\n"
+                          "# TYPE shaka_packager_%s %s\n",
+                          metric.name, metric.help, metric.name, metric.type);
+    for (const PipelineStats::Entry& entry : stats.entries) {
+      absl::StrAppendFormat(
+          &text,
+          "shaka_packager_%s{category=\"%s\",name=\"%s\",stream=\"%d\"} ",
+          metric.name, EscapeString(entry.category), EscapeString(entry.name),
+          entry.stream_index);
+      // Integers are printed as such, so that large counters keep every digit.
+      const uint64_t value = entry.*metric.field;
+      if (metric.scale == 1)
+        absl::StrAppendFormat(&text, "%u\n", value);
+      else
+        absl::StrAppendFormat(&text, "%.6f\n", value * metric.scale);
+    }
+  }
+  return text;
+}
+
+}  // namespace
+
+// static
+void Telemetry::Enable() {
+  Registry* registry = GetRegistry();
+  absl::MutexLock lock(&registry->mutex);
+  if (!registry->started) {
+    registry->started = true;
+    registry->start_time = std::chrono::steady_clock::now();
+  }
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+// static
+uint32_t Telemetry::Register(Category category,
+                             const std::string& name,
+                             int32_t stream_index) {
+  Registry* registry = GetRegistry();
+  EntryKey key{category, name, stream_index};
+  absl::MutexLock lock(&registry->mutex);
+  auto iter = registry->ids.find(key);
+  if (iter != registry->ids.end())
+    return iter->second;
+
+  if (!registry->free_ids.empty()) {
+    const uint32_t id = registry->free_ids.back();
+    registry->free_ids.pop_back();
+    for (ThreadCounters* thread_counters : registry->threads)
+      thread_counters->Reset(id);
+    if (id < registry->retired.size())
+      registry->retired[id] = Totals();
+    registry->entries[id] = key;
+    registry->released[id] = false;
+    registry->ids[key] = id;
+    return id;
+  }
+
+  if (registry->entries.size() >= kMaxEntries) {
+    if (!registry->warned_full) {
+      LOG(WARNING) << "Too many telemetry entries (" << kMaxEntries
+                   << "), not recording " << name
+                   << " and the other new entries.";
+      registry->warned_full = true;
+    }
+    return kInvalidId;
+  }
+  const uint32_t id = static_cast<uint32_t>(registry->entries.size());
+  registry->entries.push_back(key);
+  registry->released.push_back(false);
+  registry->ids[key] = id;
+  return id;
+}
+
+// static
+void Telemetry::Release(uint32_t id) {
+  if (id == kInvalidId)
+    return;
+  Registry* registry = GetRegistry();
+  absl::MutexLock lock(&registry->mutex);
+  if (id >= registry->entries.size() || registry->released[id])
+    return;
+  registry->ids.erase(registry->entries[id]);
+  registry->released[id] = true;
+  registry->free_ids.push_back(id);
+  registry->warned_full = false;
+}
+
+// static
+std::string Telemetry::UniqueName(const std::string& base) {
+  Registry* registry = GetRegistry();
+  absl::MutexLock lock(&registry->mutex);
+  std::set<int>& instances = registry->instances[base];
+  int instance = 0;
+  while (instances.count(instance) > 0)
+    ++instance;
+  instances.insert(instance);
+  return absl::StrFormat("%s#%d", base, instance);
+}
+
+// static
+void Telemetry::ReleaseUniqueName(const std::string& name) {
+  const size_t pos = name.rfind('#');
+  int instance = 0;
+  if (pos == std::string::npos ||
+      !absl::SimpleAtoi(name.substr(pos + 1), &instance)) {
+    return;
+  }
+  Registry* registry = GetRegistry();
+  absl::MutexLock lock(&registry->mutex);
+  auto iter = registry->instances.find(name.substr(0, pos));
+  if (iter == registry->instances.end())
+    return;
+  iter->second.erase(instance);
+  if (iter->second.empty())
+    registry->instances.erase(iter);
+}
+
+// static
+void Telemetry::RecordQueueDepth(uint32_t id, uint64_t depth) {
+  if (!enabled() || id == kInvalidId)
+    return;
+  Counters* counters = GetThreadCounters()->Get(id);
+  if (depth > counters->max_queue_depth.load(std::memory_order_relaxed))
+    counters->max_queue_depth.store(depth, std::memory_order_relaxed);
+}
+
+// static
+void Telemetry::RecordDropped(uint32_t id, uint64_t count) {
+  if (!enabled() || id == kInvalidId)
+    return;
+  Increment(&GetThreadCounters()->Get(id)->dropped, count);
+}
+
+// static
+PipelineStats Telemetry::GetStats() {
+  Registry* registry = GetRegistry();
+  absl::MutexLock lock(&registry->mutex);
+
+  std::vector<Totals> totals(registry->entries.size());
+  for (size_t i = 0; i < totals.size() && i < registry->retired.size(); ++i)
+    totals[i] = registry->retired[i];
+  for (const ThreadCounters* thread_counters : registry->threads)
+    thread_counters->AddTo(&totals);
+
+  PipelineStats stats;
+  if (registry->started) {
+    stats.elapsed_seconds = std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() -
+                                registry->start_time)
+                                .count();
+  }
+  stats.entries.reserve(totals.size());
+  for (size_t i = 0; i < totals.size(); ++i) {
+    if (registry->released[i])
+      continue;
+    const EntryKey& key = registry->entries[i];
+    stats.entries.emplace_back();
+    PipelineStats::Entry& entry = stats.entries.back();
+    entry.category = CategoryName(key.category);
+    entry.name = key.name;
+    entry.stream_index = key.stream_index;
+    entry.count = totals[i].count;
+    entry.bytes = totals[i].bytes;
+    entry.time_us = totals[i].time_ns / 1000;
+    entry.flushes = totals[i].flushes;
+    entry.flush_time_us = totals[i].flush_time_ns / 1000;
+    entry.max_queue_depth = totals[i].max_queue_depth;
+    entry.dropped = totals[i].dropped;
+  }
+  return stats;
+}
+
+// static
+std::string Telemetry::Format(const PipelineStats& stats,
+                              TelemetryParams::Format format) {
+  switch (format) {
+    case TelemetryParams::Format::kJson:
+      return FormatJson(stats);
+    case TelemetryParams::Format::kPrometheus:
+      return FormatPrometheus(stats);
+  }
+  return "";
+}
+
+ScopedTelemetry::ScopedTelemetry(uint32_t id,
+                                 uint64_t count,
+                                 uint64_t bytes,
+                                 Kind kind)
+    : id_(Telemetry::enabled() ? id : Telemetry::kInvalidId),
+      count_(count),
+      bytes_(bytes),
+      kind_(kind) {
+  if (id_ == Telemetry::kInvalidId)
+    return;
+  outer_nested_ns_ = g_nested_ns;
+  g_nested_ns = 0;
+  start_ = std::chrono::steady_clock::now();
+}
+
+ScopedTelemetry::~ScopedTelemetry() {
+  if (id_ == Telemetry::kInvalidId)
+    return;
+  const int64_t elapsed_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start_)
+          .count();
+  const int64_t self_ns = std::max<int64_t>(elapsed_ns - g_nested_ns, 0);
+  g_nested_ns = outer_nested_ns_ + elapsed_ns;
+
+  Counters* counters = GetThreadCounters()->Get(id_);
+  if (kind_ == kFlush) {
+    Increment(&counters->flushes, 1);
+    Increment(&counters->flush_time_ns, self_ns);
+  } else {
+    Increment(&counters->count, count_);
+    Increment(&counters->bytes, bytes_);
+    Increment(&counters->time_ns, self_ns);
+  }
+}
+
+}  // namespace shaka
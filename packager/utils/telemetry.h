@@ -0,0 +1,121 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_UTILS_TELEMETRY_H_
+#define PACKAGER_UTILS_TELEMETRY_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <packager/telemetry_params.h>
+
+namespace shaka {
+
+/// Process-wide pipeline telemetry.
+///
+/// Instrumented code registers an entry once, then records operations with
+/// ScopedTelemetry. Each thread accumulates into its own counters, which are
+/// only summed up when a snapshot is taken with GetStats(), so recording never
+/// contends between threads. When telemetry is disabled, recording costs a
+/// relaxed atomic load.
+class Telemetry {
+ public:
+  enum class Category {
+    kHandler,
+    kFile,
+    kManifest,
+  };
+
+  /// Returned by Register() when there are too many entries.
+  static constexpr uint32_t kInvalidId = UINT32_MAX;
+
+  /// @return true if telemetry is collected.
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  /// Start collecting. The elapsed time of the statistics starts with the
+  /// first call.
+  static void Enable();
+
+  /// Register an entry, or look up an existing one with the same key. Can be
+  /// called whether telemetry is enabled or not.
+  /// @param stream_index is the input stream index of handlers, -1 otherwise.
+  /// @return The id to record with, or kInvalidId if there are too many
+  ///         entries.
+  static uint32_t Register(Category category,
+                           const std::string& name,
+                           int32_t stream_index = -1);
+
+  /// Release an entry which is no longer recorded to. It is dropped from the
+  /// statistics and its id may be reused. Entries looked up by several users
+  /// should not be released.
+  static void Release(uint32_t id);
+
+  /// @return @a base followed by the lowest instance number of @a base not in
+  ///         use, e.g. "Muxer#2".
+  static std::string UniqueName(const std::string& base);
+
+  /// Make the instance number of a name returned by UniqueName() available
+  /// again.
+  static void ReleaseUniqueName(const std::string& name);
+
+  /// Record the depth of a queue feeding entry @a id.
+  static void RecordQueueDepth(uint32_t id, uint64_t depth);
+
+  /// Record items lost before reaching entry @a id, e.g. UDP datagrams dropped
+  /// by the kernel.
+  static void RecordDropped(uint32_t id, uint64_t count);
+
+  /// @return A snapshot of the statistics of every registered entry.
+  static PipelineStats GetStats();
+
+  /// @return @a stats in the requested format.
+  static std::string Format(const PipelineStats& stats,
+                            TelemetryParams::Format format);
+
+ private:
+  friend class ScopedTelemetry;
+
+  static inline std::atomic<bool> enabled_{false};
+};
+
+/// Records an operation on a telemetry entry over the lifetime of this object.
+/// The time recorded excludes the time of the instrumented operations nested
+/// in it on the same thread, e.g. downstream handlers.
+class ScopedTelemetry {
+ public:
+  enum Kind {
+    kOperation,
+    kFlush,
+  };
+
+  /// Does nothing if telemetry is disabled or @a id is kInvalidId.
+  /// @param count is the number of samples or operations to count.
+  ScopedTelemetry(uint32_t id,
+                  uint64_t count,
+                  uint64_t bytes,
+                  Kind kind = kOperation);
+  ~ScopedTelemetry();
+
+  /// Set the bytes processed, if not known beforehand.
+  void set_bytes(uint64_t bytes) { bytes_ = bytes; }
+
+ private:
+  ScopedTelemetry(const ScopedTelemetry&) = delete;
+  ScopedTelemetry& operator=(const ScopedTelemetry&) = delete;
+
+  const uint32_t id_;
+  const uint64_t count_;
+  uint64_t bytes_;
+  const Kind kind_;
+  std::chrono::steady_clock::time_point start_;
+  int64_t outer_nested_ns_ = 0;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_UTILS_TELEMETRY_H_
@@ -0,0 +1,216 @@
+// Copyright 2026 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/telemetry.h>
+
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using ::testing::HasSubstr;
+
+namespace shaka {
+namespace {
+
+// Telemetry is process wide, so every test uses entries of its own.
+const PipelineStats::Entry* FindEntry(const PipelineStats& stats,
+                                      const std::string& name,
+                                      int32_t stream_index = -1) {
+  for (const PipelineStats::Entry& entry : stats.entries) {
+    if (entry.name == name && entry.stream_index == stream_index)
+      return &entry;
+  }
+  return nullptr;
+}
+
+void SleepFor(std::chrono::milliseconds duration) {
+  const auto end = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < end)
+    std::this_thread::sleep_for(end - std::chrono::steady_clock::now());
+}
+
+}  // namespace
+
+// Must run first, as telemetry cannot be disabled once enabled.
+TEST(TelemetryTest, DisabledRecordsNothing) {
+  ASSERT_FALSE(Telemetry::enabled());
+  const uint32_t id = Telemetry::Register(Telemetry::Category::kFile, "Off");
+  {
+    ScopedTelemetry telemetry(id, 1, 100);
+  }
+  Telemetry::RecordQueueDepth(id, 10);
+
+  const PipelineStats stats = Telemetry::GetStats();
+  const PipelineStats::Entry* entry = FindEntry(stats, "Off");
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(0u, entry->count);
+  EXPECT_EQ(0u, entry->bytes);
+  EXPECT_EQ(0u, entry->max_queue_depth);
+  EXPECT_EQ(0, stats.elapsed_seconds);
+}
+
+TEST(TelemetryTest, RegisterIsIdempotent) {
+  const uint32_t id =
+      Telemetry::Register(Telemetry::Category::kHandler, "Register", 0);
+  EXPECT_NE(Telemetry::kInvalidId, id);
+  EXPECT_EQ(id,
+            Telemetry::Register(Telemetry::Category::kHandler, "Register", 0));
+  EXPECT_NE(id,
+            Telemetry::Register(Telemetry::Category::kHandler, "Register", 1));
+  EXPECT_NE(id, Telemetry::Register(Telemetry::Category::kFile, "Register", 0));
+}
+
+TEST(TelemetryTest, UniqueName) {
+  EXPECT_EQ("UniqueName#0", Telemetry::UniqueName("UniqueName"));
+  EXPECT_EQ("UniqueName#1", Telemetry::UniqueName("UniqueName"));
+  EXPECT_EQ("OtherName#0", Telemetry::UniqueName("OtherName"));
+
+  Telemetry::ReleaseUniqueName("UniqueName#0");
+  EXPECT_EQ("UniqueName#0", Telemetry::UniqueName("UniqueName"));
+  EXPECT_EQ("UniqueName#2", Telemetry::UniqueName("UniqueName"));
+}
+
+TEST(TelemetryTest, ExcludesNestedTime) {
+  Telemetry::Enable();
+  const uint32_t outer_id =
+      Telemetry::Register(Telemetry::Category::kHandler, "Outer", 0);
+  const uint32_t inner_id =
+      Telemetry::Register(Telemetry::Category::kHandler, "Inner", 0);
+  {
+    ScopedTelemetry outer(outer_id, 1, 10);
+    SleepFor(std::chrono::milliseconds(20));
+    {
+      ScopedTelemetry inner(inner_id, 1, 20);
+      SleepFor(std::chrono::milliseconds(100));
+    }
+    {
+      ScopedTelemetry flush(inner_id, 0, 0, ScopedTelemetry::kFlush);
+    }
+  }
+
+  const PipelineStats stats = Telemetry::GetStats();
+  const PipelineStats::Entry* outer = FindEntry(stats, "Outer", 0);
+  const PipelineStats::Entry* inner = FindEntry(stats, "Inner", 0);
+  ASSERT_TRUE(outer);
+  ASSERT_TRUE(inner);
+  EXPECT_EQ("handler", outer->category);
+  EXPECT_EQ(1u, outer->count);
+  EXPECT_EQ(10u, outer->bytes);
+  EXPECT_EQ(1u, inner->count);
+  EXPECT_EQ(20u, inner->bytes);
+  EXPECT_EQ(1u, inner->flushes);
+  EXPECT_GE(inner->time_us, 100000u);
+  EXPECT_GE(outer->time_us, 20000u);
+  EXPECT_LT(outer->time_us, 100000u);
+  EXPECT_GT(stats.elapsed_seconds, 0);
+}
+
+TEST(TelemetryTest, AggregatesThreads) {
+  Telemetry::Enable();
+  const uint32_t id = Telemetry::Register(Telemetry::Category::kFile, "Threads");
+  const int kNumThreads = 4;
+  const int kNumOperations = 1000;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([id, i]() {
+      for (int j = 0; j < kNumOperations; ++j) {
+        ScopedTelemetry telemetry(id, 1, 0);
+        telemetry.set_bytes(2);
+      }
+      Telemetry::RecordQueueDepth(id, 100 + i);
+      Telemetry::RecordDropped(id, 2);
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  // Recorded by a live thread.
+  {
+    ScopedTelemetry telemetry(id, 1, 2);
+  }
+
+  const PipelineStats stats = Telemetry::GetStats();
+  const PipelineStats::Entry* entry = FindEntry(stats, "Threads");
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(kNumThreads * kNumOperations + 1u, entry->count);
+  EXPECT_EQ(2u * entry->count, entry->bytes);
+  EXPECT_EQ(100u + kNumThreads - 1, entry->max_queue_depth);
+  EXPECT_EQ(2u * kNumThreads, entry->dropped);
+}
+
+TEST(TelemetryTest, ReusesReleasedEntries) {
+  Telemetry::Enable();
+  const uint32_t id =
+      Telemetry::Register(Telemetry::Category::kHandler, "Released", 0);
+  {
+    ScopedTelemetry telemetry(id, 1, 10);
+  }
+  Telemetry::RecordQueueDepth(id, 10);
+  Telemetry::RecordDropped(id, 10);
+  Telemetry::Release(id);
+  EXPECT_FALSE(FindEntry(Telemetry::GetStats(), "Released", 0));
+
+  // The released id is reused, without the counts of its previous entry.
+  EXPECT_EQ(id,
+            Telemetry::Register(Telemetry::Category::kHandler, "Reused", 0));
+  const PipelineStats::Entry* entry =
+      FindEntry(Telemetry::GetStats(), "Reused", 0);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(0u, entry->count);
+  EXPECT_EQ(0u, entry->bytes);
+  EXPECT_EQ(0u, entry->max_queue_depth);
+  EXPECT_EQ(0u, entry->dropped);
+  Telemetry::Release(id);
+}
+
+TEST(TelemetryTest, RegistersAgainOnceEntriesAreReleased) {
+  std::vector<uint32_t> ids;
+  while (true) {
+    const uint32_t id = Telemetry::Register(
+        Telemetry::Category::kHandler, "Full",
+        static_cast<int32_t>(ids.size()));
+    if (id == Telemetry::kInvalidId)
+      break;
+    ids.push_back(id);
+  }
+  ASSERT_FALSE(ids.empty());
+
+  Telemetry::Release(ids.back());
+  EXPECT_EQ(ids.back(),
+            Telemetry::Register(Telemetry::Category::kHandler, "NotFull", 0));
+  Telemetry::Release(ids.back());
+  ids.pop_back();
+  for (uint32_t id : ids)
+    Telemetry::Release(id);
+}
+
+TEST(TelemetryTest, Format) {
+  Telemetry::Enable();
+  const uint32_t id =
+      Telemetry::Register(Telemetry::Category::kManifest, "Format \"write\"");
+  {
+    ScopedTelemetry telemetry(id, 1, 5);
+  }
+  const PipelineStats stats = Telemetry::GetStats();
+
+  const std::string json =
+      Telemetry::Format(stats, TelemetryParams::Format::kJson);
+  EXPECT_THAT(json, HasSubstr("\"elapsed_seconds\": "));
+  EXPECT_THAT(json, HasSubstr("{\"category\": \"manifest\", "
+                              "\"name\": \"Format \\\"write\\\"\", "
+                              "\"stream_index\": -1, \"count\": 1, "
+                              "\"bytes\": 5, "));
+
+  const std::string text =
+      Telemetry::Format(stats, TelemetryParams::Format::kPrometheus);
+  EXPECT_THAT(text, HasSubstr("# TYPE shaka_packager_bytes_total counter\n"));
+  EXPECT_THAT(text, HasSubstr("shaka_packager_bytes_total{category="
+                              "\"manifest\",name=\"Format \\\"write\\\"\","
+                              "stream=\"-1\"} 5\n"));
+}
+
+}  // namespace shaka